@@ -31,15 +31,13 @@
 #define CEREAL_ARCHIVES_ADAPTERS_HPP_
 
 #include "cereal/details/helpers.hpp"
+#include <memory>
 #include <utility>
 
 namespace cereal
 {
   #ifdef CEREAL_FUTURE_EXPERIMENTAL
 
-  // Forward declaration for friend access
-  template <class U, class A> U & get_user_data( A & );
-
   //! Wraps an archive and gives access to user data
   /*! This adapter is useful if you require access to
       either raw pointers or references within your
@@ -55,6 +53,9 @@ namespace cereal
 
       @note This feature is experimental and may be altered or removed in a future release. See issue #46.
 
+      Adapters can be nested to attach user data of several types, which are all
+      available through get_user_data.  For the same type, the outermost adapter wins.
+
       @code{.cpp}
       struct MyUserData
       {
@@ -119,14 +120,13 @@ namespace cereal
       template <class ... Args>
       UserDataAdapter( UserData & ud, Args && ... args ) :
         Archive( std::forward<Args>( args )... ),
-        userdata( ud )
-      { }
+        itsUserData{ std::addressof( ud ), &detail::user_data_key<UserData>::value, nullptr }
+      {
+        this->attachUserData( itsUserData );
+      }
 
     private:
-      //! Overload the rtti function to enable dynamic_cast
-      void rtti() {}
-      friend UserData & get_user_data<UserData>( Archive & ar );
-      UserData & userdata; //!< The actual user data
+      detail::UserDataLink itsUserData; //!< Links ud in front of the user data of any wrapped adapter
   };
 
   //! Retrieves user data from an archive wrapped by UserDataAdapter
@@ -137,7 +137,8 @@ namespace cereal
       @note This feature is experimental and may be altered or removed in a future release. See issue #46.
 
       @note The correct use of this function cannot be enforced at compile
-            time.
+            time.  Checking it at run time costs a single pointer comparison
+            for each nested UserDataAdapter and does not require RTTI.
 
       @relates UserDataAdapter
       @tparam UserData The data struct contained in the archive
@@ -148,14 +149,11 @@ namespace cereal
   template <class UserData, class Archive>
   UserData & get_user_data( Archive & ar )
   {
-    try
-    {
-      return dynamic_cast<UserDataAdapter<UserData, Archive> &>( ar ).userdata;
-    }
-    catch( std::bad_cast const & )
-    {
-      throw ::cereal::Exception("Attempting to get user data from archive not wrapped in UserDataAdapter");
-    }
+    UserData * const userdata = ar.template getUserData<UserData>();
+    if( !userdata )
+      CEREAL_THROW_EXCEPTION(::cereal::Exception("Attempting to get user data from archive not wrapped in UserDataAdapter"));
+
+    return *userdata;
   }
   #endif // CEREAL_FUTURE_EXPERIMENTAL
 } // namespace cereal
@@ -30,6 +30,7 @@
 #define CEREAL_ARCHIVES_BINARY_HPP_
 
 #include "cereal/cereal.hpp"
+#include <cstring>
 #include <sstream>
 
 namespace cereal
@@ -62,15 +63,30 @@ namespace cereal
       ~BinaryOutputArchive() CEREAL_NOEXCEPT = default;
 
       //! Writes size bytes of data to the output stream
+      /*! Nothing is written once an error occurred, see setThrowOnError */
       void saveBinary( const void * data, std::streamsize size )
       {
+        if( !ok() )
+          return;
+
         auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
 
+        #if CEREAL_TRACE
+        addTracedBytes( writtenSize );
+        #endif
+
         if(writtenSize != size)
-          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+          saveFailed( size, writtenSize );
       }
 
     private:
+      //! Reports a failed write, kept out of line of saveBinary
+      CEREAL_NOINLINE void saveFailed( std::streamsize size, std::streamsize writtenSize )
+      {
+        CEREAL_THROW_ON_ERROR(*this, "Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        setError("Failed to write to output stream");
+      }
+
       std::ostream & itsStream;
   };
 
@@ -97,15 +113,37 @@ namespace cereal
       ~BinaryInputArchive() CEREAL_NOEXCEPT = default;
 
       //! Reads size bytes of data from the input stream
+      /*! Once an error occurred, nothing is read and the data is zeroed instead, see setThrowOnError */
       void loadBinary( void * const data, std::streamsize size )
       {
-        auto const readSize = itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size );
+        auto const readSize = ok() ? itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) : 0;
+
+        #if CEREAL_TRACE
+        addTracedBytes( readSize );
+        #endif
 
         if(readSize != size)
-          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+          loadFailed( data, size, readSize );
+      }
+
+      //! The number of bytes the stream can provide without blocking, which is at most what it holds
+      /*! Load functions use this to allocate a large size at once when its data is known to be there.
+          Returns -1 when the stream holds nothing more.
+          @internal */
+      std::streamsize availableBytes()
+      {
+        return itsStream.rdbuf()->in_avail();
       }
 
     private:
+      //! Reports a failed read and zeroes the data, kept out of line of loadBinary
+      CEREAL_NOINLINE void loadFailed( void * const data, std::streamsize size, std::streamsize readSize )
+      {
+        CEREAL_THROW_ON_ERROR(*this, "Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+        std::memset( data, 0, static_cast<std::size_t>( size ) );
+        setError("Failed to read from input stream");
+      }
+
       std::istream & itsStream;
   };
 
@@ -0,0 +1,233 @@
+/*! \file binary_size.hpp
+    \brief An archive that computes the size of binary archive output without producing it */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_BINARY_SIZE_HPP_
+#define CEREAL_ARCHIVES_BINARY_SIZE_HPP_
+
+#include "cereal/cereal.hpp"
+#include "cereal/archives/binary.hpp"
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An output archive that counts the bytes a BinaryOutputArchive would write
+  /*! This runs the same serialization functions as BinaryOutputArchive, including
+      the metadata written for pointers, polymorphic types and class versions the
+      first time they occur, but only adds up the sizes of the data instead of
+      writing it anywhere.  This makes it much cheaper than saving, so it can be used
+      to allocate an output buffer of the exact size up front.
+
+      A PortableBinaryOutputArchive writes one more byte, which holds its endianness.
+
+      Serialization functions restricted to BinaryOutputArchive (for example with
+      CEREAL_ARCHIVE_RESTRICT) are not used by this archive.
+
+      @code{.cpp}
+      std::string buffer;
+      buffer.reserve( cereal::serialized_size( message ) );
+      @endcode
+
+      \ingroup Archives */
+  class BinarySizeArchive : public OutputArchive<BinarySizeArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! The archive whose output is measured
+      using measured_archive = BinaryOutputArchive;
+
+      BinarySizeArchive() :
+        OutputArchive<BinarySizeArchive, AllowEmptyClassElision>(this),
+        itsSize( 0 )
+      { }
+
+      ~BinarySizeArchive() CEREAL_NOEXCEPT = default;
+
+      //! Counts size bytes of data
+      void saveBinary( const void *, std::streamsize size )
+      {
+        itsSize += static_cast<std::uint64_t>( size );
+      }
+
+      //! The number of bytes counted so far
+      std::uint64_t size() const
+      {
+        return itsSize;
+      }
+
+    private:
+      std::uint64_t itsSize;
+  };
+
+  //! Saving for POD types to binary size
+  template<class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME(BinarySizeArchive & ar, T const & t)
+  {
+    ar.saveBinary(std::addressof(t), sizeof(t));
+  }
+
+  //! Serializing NVP types to binary size
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( BinarySizeArchive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Serializing SizeTags to binary size
+  template <class T> inline
+  void CEREAL_SERIALIZE_FUNCTION_NAME( BinarySizeArchive & ar, SizeTag<T> & t )
+  {
+    ar( t.size );
+  }
+
+  //! Saving binary data to binary size
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME(BinarySizeArchive & ar, BinaryData<T> const & bd)
+  {
+    ar.saveBinary( bd.data, static_cast<std::streamsize>( bd.size ) );
+  }
+
+  // ######################################################################
+  //! Computes the number of bytes a BinaryOutputArchive would write for some data
+  /*! This is equivalent to saving all of the arguments with a single archive,
+      see BinarySizeArchive.
+      @relates BinarySizeArchive */
+  template <class ... Types> inline
+  std::uint64_t serialized_size( Types && ... args )
+  {
+    BinarySizeArchive ar;
+    ar( std::forward<Types>( args )... );
+    return ar.size();
+  }
+
+  // ######################################################################
+  //! The number of bytes binary archives use for types whose size does not depend on their value
+  /*! Types with a fixed serialized size derive from std::integral_constant<std::size_t, size>.
+      This is the case for arithmetic types, as well as std::array, C arrays,
+      std::pair and std::tuple of types with a fixed size.
+
+      Specialize this for your own types that always save the same number of bytes:
+
+      @code{.cpp}
+      struct Vec3
+      {
+        float x, y, z;
+
+        template <class Archive>
+        void serialize( Archive & ar ) { ar( x, y, z ); }
+      };
+
+      namespace cereal
+      {
+        template <> struct fixed_serialized_size<Vec3> :
+          std::integral_constant<std::size_t, 3 * fixed_serialized_size<float>::value> {};
+      }
+      @endcode
+
+      @sa serialized_size */
+  template <class T, class SFINAE = void>
+  struct fixed_serialized_size {};
+
+  namespace binary_size_detail
+  {
+    template <class>
+    struct void_type { using type = void; };
+
+    //! Whether a type has a fixed_serialized_size
+    template <class T, class SFINAE = void>
+    struct has_fixed_size : std::false_type {};
+
+    template <class T>
+    struct has_fixed_size<T, typename void_type<decltype( fixed_serialized_size<T>::value )>::type> : std::true_type {};
+
+    //! Sums the fixed sizes of types, which must all have one
+    template <class ... Types>
+    struct sum_fixed_sizes : std::integral_constant<std::size_t, 0> {};
+
+    template <class T, class ... Types>
+    struct sum_fixed_sizes<T, Types...> :
+      std::integral_constant<std::size_t, fixed_serialized_size<T>::value + sum_fixed_sizes<Types...>::value> {};
+
+    //! Whether all types have a fixed_serialized_size
+    template <class ... Types>
+    struct all_fixed_size : std::true_type {};
+
+    template <class T, class ... Types>
+    struct all_fixed_size<T, Types...> :
+      std::integral_constant<bool, has_fixed_size<T>::value && all_fixed_size<Types...>::value> {};
+  } // namespace binary_size_detail
+
+  //! Arithmetic types are saved at their full width
+  template <class T>
+  struct fixed_serialized_size<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> :
+    std::integral_constant<std::size_t, sizeof(T)> {};
+
+  //! Arrays save their elements without a size
+  template <class T, std::size_t N>
+  struct fixed_serialized_size<std::array<T, N>, typename std::enable_if<binary_size_detail::has_fixed_size<T>::value>::type> :
+    std::integral_constant<std::size_t, N * fixed_serialized_size<T>::value> {};
+
+  //! @overload
+  template <class T, std::size_t N>
+  struct fixed_serialized_size<T[N], typename std::enable_if<binary_size_detail::has_fixed_size<T>::value>::type> :
+    std::integral_constant<std::size_t, N * fixed_serialized_size<T>::value> {};
+
+  //! Pairs save both of their members
+  template <class T1, class T2>
+  struct fixed_serialized_size<std::pair<T1, T2>, typename std::enable_if<binary_size_detail::all_fixed_size<T1, T2>::value>::type> :
+    binary_size_detail::sum_fixed_sizes<T1, T2> {};
+
+  //! Tuples save all of their members
+  template <class ... Types>
+  struct fixed_serialized_size<std::tuple<Types...>, typename std::enable_if<binary_size_detail::all_fixed_size<Types...>::value>::type> :
+    binary_size_detail::sum_fixed_sizes<Types...> {};
+
+  //! The number of bytes binary archives use for a type with a fixed serialized size
+  /*! Unlike serialized_size for values, this is a constant expression, so it can
+      size buffers at compile time.  It only compiles for types with a fixed_serialized_size.
+
+      @code{.cpp}
+      std::array<char, cereal::serialized_size<std::pair<std::uint32_t, double>>()> buffer; // 12 bytes
+      @endcode
+
+      @relates fixed_serialized_size */
+  template <class T> inline
+  constexpr std::size_t serialized_size()
+  {
+    return fixed_serialized_size<T>::value;
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::BinarySizeArchive)
+
+#endif // CEREAL_ARCHIVES_BINARY_SIZE_HPP_
@@ -0,0 +1,606 @@
+/*! \file bitstream.hpp
+    \brief Bit packed binary input and output archives */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_BITSTREAM_HPP_
+#define CEREAL_ARCHIVES_BITSTREAM_HPP_
+
+#include "cereal/cereal.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <type_traits>
+
+namespace cereal
+{
+  namespace bitstream_detail
+  {
+    //! Shifts right, giving zero for shifts of 64 or more bits
+    inline std::uint64_t shift_right( std::uint64_t value, unsigned shift )
+    {
+      return shift < 64 ? value >> shift : 0;
+    }
+
+    //! A mask of the lowest count bits
+    inline std::uint64_t low_bits( unsigned count )
+    {
+      return count < 64 ? ( std::uint64_t( 1 ) << count ) - 1 : ~std::uint64_t( 0 );
+    }
+
+    //! The number of bits needed to represent values from 0 to range
+    constexpr unsigned bit_width( std::uint64_t range )
+    {
+      return range == 0 ? 0 : 1 + bit_width( range >> 1 );
+    }
+
+    //! Checks whether a signed value is between Lo and Hi
+    template <std::intmax_t Lo, std::intmax_t Hi, class I> inline
+    bool in_range( I value, std::true_type /* signed */ )
+    {
+      return static_cast<std::intmax_t>( value ) >= Lo && static_cast<std::intmax_t>( value ) <= Hi;
+    }
+
+    //! Checks whether an unsigned value is between Lo and Hi
+    template <std::intmax_t Lo, std::intmax_t Hi, class I> inline
+    bool in_range( I value, std::false_type /* signed */ )
+    {
+      return Hi >= 0 && static_cast<std::uintmax_t>( value ) <= static_cast<std::uintmax_t>( Hi ) &&
+             ( Lo <= 0 || static_cast<std::uintmax_t>( value ) >= static_cast<std::uintmax_t>( Lo ) );
+    }
+
+    //! Checks whether a value is between Lo and Hi
+    template <std::intmax_t Lo, std::intmax_t Hi, class I> inline
+    bool in_range( I value )
+    {
+      return in_range<Lo, Hi>( value, std::is_signed<I>() );
+    }
+
+    //! The unsigned integer type with the given size in bytes
+    template <std::size_t Size> struct unsigned_of;
+    template <> struct unsigned_of<1> { using type = std::uint8_t; };
+    template <> struct unsigned_of<2> { using type = std::uint16_t; };
+    template <> struct unsigned_of<4> { using type = std::uint32_t; };
+    template <> struct unsigned_of<8> { using type = std::uint64_t; };
+
+    //! The integral type a bit field of T is converted through
+    template <class T, class = void>
+    struct integer_of { using type = T; };
+
+    template <class T>
+    struct integer_of<T, typename std::enable_if<std::is_enum<T>::value>::type>
+    { using type = typename std::underlying_type<T>::type; };
+  } // namespace bitstream_detail
+
+  // ######################################################################
+  //! An output archive that packs data at bit granularity
+  /*! This archive accumulates data into 64 bit words, which makes it suitable for
+      small, frequent messages such as real-time network packets.  A bool takes a
+      single bit, and the bits and bounded wrappers store integers and enums in
+      exactly as many bits as they need:
+
+      @code{.cpp}
+      enum class Mode { Idle, Walk, Run, Jump, Fall };
+
+      struct State
+      {
+        bool grounded;
+        Mode mode;
+        std::int32_t health;  // 0 to 1000
+        std::uint8_t team;    // uses the low 3 bits
+        float heading;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( grounded,                                  // 1 bit
+              cereal::bounded<0, 4>( mode ),             // 3 bits
+              cereal::bounded<0, 1000>( health ),        // 10 bits
+              cereal::bits<3>( team ),                   // 3 bits
+              heading );                                 // 32 bits
+        }
+      };
+      @endcode
+
+      Other arithmetic values are stored at their full width, but are not aligned
+      to bytes.  Sizes are stored in a variable length encoding that takes a single
+      byte below 128.  Bulk binary data, such as strings and vectors of arithmetic
+      types, is aligned to a byte boundary and copied directly.
+
+      Values are stored least significant bit first, independent of the endianness
+      of the machine.  As with BinaryOutputArchive, bulk binary data is copied as
+      is, so its endianness is that of the machine.
+
+      Data is written as each 64 bit word fills, and the remaining bits are
+      written, padded to a whole byte, when the archive is destroyed.
+
+      The bits and bounded wrappers can be used with any archive; other archives
+      save the wrapped value as they would normally.
+
+      \ingroup Archives */
+  class BitstreamOutputArchive : public OutputArchive<BitstreamOutputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, outputting to the provided stream
+      /*! @param stream The stream to output to.  It should be opened in binary mode. */
+      BitstreamOutputArchive( std::ostream & stream ) :
+        OutputArchive<BitstreamOutputArchive, AllowEmptyClassElision>( this ),
+        itsStream( stream ),
+        itsWord( 0 ),
+        itsBits( 0 )
+      { }
+
+      //! Writes any remaining bits to the stream
+      ~BitstreamOutputArchive() CEREAL_NOEXCEPT
+      {
+        if( itsBits > 0 && ok() )
+          writeWord( ( itsBits + 7 ) / 8 );
+      }
+
+      //! Writes the count lowest bits of value (count from 1 to 64)
+      void saveBits( std::uint64_t value, unsigned count )
+      {
+        value &= bitstream_detail::low_bits( count );
+        itsWord |= value << itsBits;
+        itsBits += count;
+
+        if( itsBits >= 64 )
+        {
+          writeWord( 8 );
+          itsBits -= 64;
+          itsWord = bitstream_detail::shift_right( value, count - itsBits );
+        }
+      }
+
+      //! Writes size bytes of data, aligned to a byte boundary
+      void saveBinary( const void * data, std::size_t size )
+      {
+        auto bytes = reinterpret_cast<unsigned char const *>( data );
+
+        alignToByte();
+        for( ; size > 0 && itsBits > 0; --size )
+          saveBits( *bytes++, 8 );
+
+        if( size > 0 && ok() )
+          write( bytes, size );
+      }
+
+      //! Writes a size using one byte for every 7 bits
+      void saveSize( std::uint64_t size )
+      {
+        for( ; size >= 0x80; size >>= 7 )
+          saveBits( ( size & 0x7F ) | 0x80, 8 );
+        saveBits( size, 8 );
+      }
+
+    private:
+      //! Pads the current word to a byte boundary
+      void alignToByte()
+      {
+        unsigned const padding = ( 8 - itsBits % 8 ) % 8;
+        if( padding > 0 )
+          saveBits( 0, padding );
+      }
+
+      //! Writes the lowest bytes of the current word
+      void writeWord( unsigned bytes )
+      {
+        unsigned char buffer[8];
+        for( unsigned i = 0; i < 8; ++i )
+          buffer[i] = static_cast<unsigned char>( itsWord >> ( 8 * i ) );
+        if( ok() )
+          write( buffer, bytes );
+        itsWord = 0;
+      }
+
+      //! Writes bytes to the stream
+      void write( unsigned char const * bytes, std::size_t size )
+      {
+        auto const writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<char const *>( bytes ), static_cast<std::streamsize>( size ) );
+
+        #if CEREAL_TRACE
+        addTracedBytes( writtenSize );
+        #endif
+
+        if( writtenSize != static_cast<std::streamsize>( size ) )
+          setError("Failed to write to output stream");
+      }
+
+      std::ostream & itsStream;
+      std::uint64_t itsWord; //!< Bits not yet written, starting at the least significant bit
+      unsigned itsBits;      //!< The number of bits in itsWord
+  };
+
+  // ######################################################################
+  //! An input archive designed to load data saved using BitstreamOutputArchive
+  /*! The archive reads only the bytes it needs, so data that follows in the
+      stream can be read after the archive is destroyed.
+
+      \ingroup Archives */
+  class BitstreamInputArchive : public InputArchive<BitstreamInputArchive, AllowEmptyClassElision>
+  {
+    public:
+      //! Construct, loading from the provided stream
+      BitstreamInputArchive( std::istream & stream ) :
+        InputArchive<BitstreamInputArchive, AllowEmptyClassElision>( this ),
+        itsStream( stream ),
+        itsWord( 0 ),
+        itsBits( 0 )
+      { }
+
+      ~BitstreamInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Reads count bits (from 1 to 64)
+      /*! Once an error occurred, nothing is read and zero is returned instead, see setThrowOnError */
+      std::uint64_t loadBits( unsigned count )
+      {
+        if( count <= itsBits )
+        {
+          std::uint64_t const value = itsWord & bitstream_detail::low_bits( count );
+          itsWord = bitstream_detail::shift_right( itsWord, count );
+          itsBits -= count;
+          return value;
+        }
+
+        // take what is left of the current word, then read just enough bytes for the rest
+        std::uint64_t const low = itsWord;
+        unsigned const lowBits = itsBits;
+        unsigned const needed = count - lowBits;
+        readWord( ( needed + 7 ) / 8 );
+
+        std::uint64_t const high = itsWord & bitstream_detail::low_bits( needed );
+        itsWord = bitstream_detail::shift_right( itsWord, needed );
+        itsBits -= needed;
+        return low | ( high << lowBits );
+      }
+
+      //! Reads size bytes of data, aligned to a byte boundary
+      /*! Once an error occurred, nothing is read and the data is zeroed instead */
+      void loadBinary( void * const data, std::size_t size )
+      {
+        auto bytes = reinterpret_cast<unsigned char *>( data );
+
+        itsWord >>= itsBits % 8;
+        itsBits -= itsBits % 8;
+        for( ; size > 0 && itsBits > 0; --size )
+          *bytes++ = static_cast<unsigned char>( loadBits( 8 ) );
+
+        if( size > 0 )
+          read( bytes, size );
+      }
+
+      //! Reads a size saved with BitstreamOutputArchive::saveSize
+      std::uint64_t loadSize()
+      {
+        std::uint64_t size = 0;
+        for( unsigned shift = 0; shift < 64; shift += 7 )
+        {
+          auto const byte = loadBits( 8 );
+          size |= ( byte & 0x7F ) << shift;
+          if( !( byte & 0x80 ) )
+            return size;
+        }
+
+        CEREAL_THROW_ON_ERROR(*this, "Invalid size encoding in bit stream");
+        setError("Invalid size encoding in bit stream");
+        return 0;
+      }
+
+    private:
+      //! Replaces the current word with the given number of bytes from the stream
+      void readWord( unsigned bytes )
+      {
+        unsigned char buffer[8] = {};
+        read( buffer, bytes );
+
+        itsWord = 0;
+        for( unsigned i = 0; i < bytes; ++i )
+          itsWord |= std::uint64_t( buffer[i] ) << ( 8 * i );
+        itsBits = 8 * bytes;
+      }
+
+      //! Reads bytes from the stream
+      void read( unsigned char * bytes, std::size_t size )
+      {
+        auto const readSize = ok() ? itsStream.rdbuf()->sgetn( reinterpret_cast<char *>( bytes ), static_cast<std::streamsize>( size ) ) : 0;
+
+        #if CEREAL_TRACE
+        addTracedBytes( readSize );
+        #endif
+
+        if( readSize != static_cast<std::streamsize>( size ) )
+          readFailed( bytes, size, readSize );
+      }
+
+      //! Reports a failed read and zeroes the data, kept out of line of read
+      void readFailed( unsigned char * bytes, std::size_t size, std::streamsize readSize )
+      {
+        CEREAL_THROW_ON_ERROR(*this, "Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+        std::memset( bytes, 0, size );
+        setError("Failed to read from input stream");
+      }
+
+      std::istream & itsStream;
+      std::uint64_t itsWord; //!< Bits not yet loaded, starting at the least significant bit
+      unsigned itsBits;      //!< The number of bits in itsWord
+  };
+
+  // ######################################################################
+  //! A value stored in a fixed number of bits, see bits
+  /*! @internal */
+  template <unsigned N, class T>
+  class BitField
+  {
+    private:
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      BitField & operator=( BitField const & ) = delete;
+
+    public:
+      using value_type = typename std::decay<T>::type;
+      using integer_type = typename bitstream_detail::integer_of<value_type>::type;
+
+      static_assert( std::is_integral<integer_type>::value, "cereal::bits can only be used with integers, bools and enums" );
+      static_assert( N >= 1 && N <= 8 * sizeof(integer_type), "cereal::bits needs between 1 bit and the width of its type" );
+
+      BitField( T && v ) : value( std::forward<T>( v ) ) {}
+
+      Type value;
+  };
+
+  //! Saves an integer, bool or enum in its N lowest bits
+  /*! A BitstreamOutputArchive stores exactly N bits; signed values are sign extended
+      when loaded.  Other archives save the value normally.
+
+      @code{.cpp}
+      ar( cereal::bits<3>( priority ) ); // priority must be between 0 and 7
+      @endcode
+      @relates BitstreamOutputArchive */
+  template <unsigned N, class T> inline
+  BitField<N, T> bits( T && value )
+  {
+    return { std::forward<T>( value ) };
+  }
+
+  //! A value stored as its offset within a range, see bounded
+  /*! @internal */
+  template <std::intmax_t Lo, std::intmax_t Hi, class T>
+  class Bounded
+  {
+    private:
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      Bounded & operator=( Bounded const & ) = delete;
+
+    public:
+      using value_type = typename std::decay<T>::type;
+      using integer_type = typename bitstream_detail::integer_of<value_type>::type;
+
+      static_assert( std::is_integral<integer_type>::value, "cereal::bounded can only be used with integers, bools and enums" );
+      static_assert( Lo <= Hi, "cereal::bounded needs Lo <= Hi" );
+
+      //! The number of bits used to store a value
+      static constexpr unsigned width = bitstream_detail::bit_width( static_cast<std::uint64_t>( Hi ) - static_cast<std::uint64_t>( Lo ) );
+
+      Bounded( T && v ) : value( std::forward<T>( v ) ) {}
+
+      Type value;
+  };
+
+  //! Saves an integer, bool or enum known to be between Lo and Hi (inclusive)
+  /*! A BitstreamOutputArchive stores the offset from Lo in as few bits as can hold
+      Hi - Lo, and saving a value outside of the range is an error.  Other archives
+      save the value normally.
+
+      @code{.cpp}
+      ar( cereal::bounded<-90, 90>( latitude ) ); // 8 bits
+      @endcode
+      @relates BitstreamOutputArchive */
+  template <std::intmax_t Lo, std::intmax_t Hi, class T> inline
+  Bounded<Lo, Hi, T> bounded( T && value )
+  {
+    return { std::forward<T>( value ) };
+  }
+
+  // ######################################################################
+  // Common BitstreamArchive serialization functions
+
+  //! Saving for bools, in a single bit
+  inline void CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, bool const & b )
+  {
+    ar.saveBits( b ? 1 : 0, 1 );
+  }
+
+  //! Loading for bools, from a single bit
+  inline void CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, bool & b )
+  {
+    b = ar.loadBits( 1 ) != 0;
+  }
+
+  //! Saving for other arithmetic types, at their full width
+  template <class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, T const & t )
+  {
+    static_assert( sizeof(T) <= sizeof(std::uint64_t), "Bitstream archives only support arithmetic types of up to 64 bits" );
+    typename bitstream_detail::unsigned_of<sizeof(T)>::type word;
+    std::memcpy( &word, std::addressof( t ), sizeof(T) );
+    ar.saveBits( word, 8 * sizeof(T) );
+  }
+
+  //! Loading for other arithmetic types, at their full width
+  template <class T> inline
+  typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, T & t )
+  {
+    static_assert( sizeof(T) <= sizeof(std::uint64_t), "Bitstream archives only support arithmetic types of up to 64 bits" );
+    auto const word = static_cast<typename bitstream_detail::unsigned_of<sizeof(T)>::type>( ar.loadBits( 8 * sizeof(T) ) );
+    std::memcpy( std::addressof( t ), &word, sizeof(T) );
+  }
+
+  //! Serializing NVP types to bit streams
+  template <class Archive, class T> inline
+  CEREAL_ARCHIVE_RESTRICT(BitstreamInputArchive, BitstreamOutputArchive)
+  CEREAL_SERIALIZE_FUNCTION_NAME( Archive & ar, NameValuePair<T> & t )
+  {
+    ar( t.value );
+  }
+
+  //! Saving SizeTags to bit streams
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, SizeTag<T> const & t )
+  {
+    ar.saveSize( static_cast<std::uint64_t>( t.size ) );
+  }
+
+  //! Loading SizeTags from bit streams
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, SizeTag<T> & t )
+  {
+    t.size = static_cast<typename std::decay<decltype( t.size )>::type>( ar.loadSize() );
+  }
+
+  //! Saving binary data
+  template <class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, BinaryData<T> const & bd )
+  {
+    ar.saveBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  //! Loading binary data
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, BinaryData<T> & bd )
+  {
+    ar.loadBinary( bd.data, static_cast<std::size_t>( bd.size ) );
+  }
+
+  // ######################################################################
+  // bits and bounded serialization functions
+
+  //! Saving bit fields to bit streams
+  template <unsigned N, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, BitField<N, T> const & b )
+  {
+    using integer_type = typename BitField<N, T>::integer_type;
+    ar.saveBits( static_cast<std::uint64_t>( static_cast<integer_type>( b.value ) ), N );
+  }
+
+  //! Loading bit fields from bit streams
+  template <unsigned N, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, BitField<N, T> & b )
+  {
+    using integer_type = typename BitField<N, T>::integer_type;
+    std::uint64_t word = ar.loadBits( N );
+
+    // sign extend signed values
+    if( std::is_signed<integer_type>::value && N < 64 && ( ( word >> ( N - 1 ) ) & 1 ) )
+      word |= ~bitstream_detail::low_bits( N );
+
+    b.value = static_cast<typename BitField<N, T>::value_type>( static_cast<integer_type>( word ) );
+  }
+
+  //! Saving bounded values to bit streams
+  template <std::intmax_t Lo, std::intmax_t Hi, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( BitstreamOutputArchive & ar, Bounded<Lo, Hi, T> const & b )
+  {
+    using integer_type = typename Bounded<Lo, Hi, T>::integer_type;
+    auto const value = static_cast<integer_type>( b.value );
+
+    if( !bitstream_detail::in_range<Lo, Hi>( value ) )
+    {
+      CEREAL_THROW_ON_ERROR(ar, "Value " + std::to_string( value ) + " is outside of its bounds [" + std::to_string( Lo ) + ", " + std::to_string( Hi ) + "]");
+      ar.setError("Value is outside of its bounds");
+      return;
+    }
+
+    if( Bounded<Lo, Hi, T>::width > 0 )
+      ar.saveBits( static_cast<std::uint64_t>( value ) - static_cast<std::uint64_t>( Lo ), Bounded<Lo, Hi, T>::width );
+  }
+
+  //! Loading bounded values from bit streams
+  template <std::intmax_t Lo, std::intmax_t Hi, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( BitstreamInputArchive & ar, Bounded<Lo, Hi, T> & b )
+  {
+    using integer_type = typename Bounded<Lo, Hi, T>::integer_type;
+    std::uint64_t const offset = Bounded<Lo, Hi, T>::width > 0 ? ar.loadBits( Bounded<Lo, Hi, T>::width ) : 0;
+
+    if( offset > static_cast<std::uint64_t>( Hi ) - static_cast<std::uint64_t>( Lo ) )
+    {
+      CEREAL_THROW_ON_ERROR(ar, "Loaded value is outside of its bounds [" + std::to_string( Lo ) + ", " + std::to_string( Hi ) + "]");
+      ar.setError("Loaded value is outside of its bounds");
+      b.value = static_cast<typename Bounded<Lo, Hi, T>::value_type>( static_cast<integer_type>( Lo ) );
+      return;
+    }
+
+    b.value = static_cast<typename Bounded<Lo, Hi, T>::value_type>( static_cast<integer_type>( static_cast<std::uint64_t>( Lo ) + offset ) );
+  }
+
+  //! Saving bit fields to other archives, as their plain value
+  template <class Archive, unsigned N, class T,
+            traits::DisableIf<std::is_same<Archive, BitstreamOutputArchive>::value> = traits::sfinae> inline
+  typename BitField<N, T>::integer_type CEREAL_SAVE_MINIMAL_FUNCTION_NAME( Archive const &, BitField<N, T> const & b )
+  {
+    return static_cast<typename BitField<N, T>::integer_type>( b.value );
+  }
+
+  //! Loading bit fields from other archives, as their plain value
+  template <class Archive, unsigned N, class T,
+            traits::DisableIf<std::is_same<Archive, BitstreamInputArchive>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_MINIMAL_FUNCTION_NAME( Archive const &, BitField<N, T> & b, typename BitField<N, T>::integer_type const & value )
+  {
+    b.value = static_cast<typename BitField<N, T>::value_type>( value );
+  }
+
+  //! Saving bounded values to other archives, as their plain value
+  template <class Archive, std::intmax_t Lo, std::intmax_t Hi, class T,
+            traits::DisableIf<std::is_same<Archive, BitstreamOutputArchive>::value> = traits::sfinae> inline
+  typename Bounded<Lo, Hi, T>::integer_type CEREAL_SAVE_MINIMAL_FUNCTION_NAME( Archive const &, Bounded<Lo, Hi, T> const & b )
+  {
+    return static_cast<typename Bounded<Lo, Hi, T>::integer_type>( b.value );
+  }
+
+  //! Loading bounded values from other archives, as their plain value
+  template <class Archive, std::intmax_t Lo, std::intmax_t Hi, class T,
+            traits::DisableIf<std::is_same<Archive, BitstreamInputArchive>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_MINIMAL_FUNCTION_NAME( Archive const &, Bounded<Lo, Hi, T> & b, typename Bounded<Lo, Hi, T>::integer_type const & value )
+  {
+    b.value = static_cast<typename Bounded<Lo, Hi, T>::value_type>( value );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::BitstreamOutputArchive)
+CEREAL_REGISTER_ARCHIVE(cereal::BitstreamInputArchive)
+
+// tie input and output archives together
+CEREAL_SETUP_ARCHIVE_TRAITS(cereal::BitstreamInputArchive, cereal::BitstreamOutputArchive)
+
+#endif // CEREAL_ARCHIVES_BITSTREAM_HPP_
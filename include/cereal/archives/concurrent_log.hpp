@@ -0,0 +1,620 @@
+/*! \file concurrent_log.hpp
+    \brief A log of binary records that many threads can write to concurrently */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_CONCURRENT_LOG_HPP_
+#define CEREAL_ARCHIVES_CONCURRENT_LOG_HPP_
+
+#include "cereal/archives/binary.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cereal
+{
+  class ConcurrentLogArchive;
+
+  // ######################################################################
+  //! Options for a ConcurrentLogArchive
+  /*! Options can either be directly passed to the constructor, or chained using the
+      modifier functions for an interface analogous to named parameters:
+
+      @code{.cpp}
+      cereal::ConcurrentLogArchive log( os, cereal::ConcurrentLogOptions().bufferSize( 1 << 20 ) );
+      @endcode */
+  class ConcurrentLogOptions
+  {
+    public:
+      //! Default options: 64 KiB of buffer per thread, written out at least every millisecond
+      static ConcurrentLogOptions Default(){ return ConcurrentLogOptions(); }
+
+      //! Specify specific options for the log
+      /*! @param bufferSize_ Size of the buffer each logging thread writes records to, in bytes
+          @param flushInterval_ Longest time the background writer sleeps between passes */
+      explicit ConcurrentLogOptions( std::size_t bufferSize_ = 1 << 16,
+                                     std::chrono::microseconds flushInterval_ = std::chrono::milliseconds(1) ) :
+        itsBufferSize( bufferSize_ ),
+        itsFlushInterval( flushInterval_ )
+      { }
+
+      /*! @name Option Modifiers
+          An interface for setting option settings analogous to named parameters.
+
+          @code{cpp}
+          cereal::ConcurrentLogOptions()
+            .bufferSize( 1 << 20 )
+            .flushInterval( std::chrono::milliseconds(10) )
+          @endcode
+          */
+      //! @{
+
+      //! Size of the buffer each logging thread writes records to, rounded up to a power of two
+      /*! A thread whose buffer is full waits for the background writer to empty it.  Records
+          larger than the buffer are written to the stream directly, see ConcurrentLogArchive. */
+      ConcurrentLogOptions & bufferSize( std::size_t bytes ){ itsBufferSize = bytes; return *this; }
+      //! Longest time the background writer sleeps between passes over the buffers
+      ConcurrentLogOptions & flushInterval( std::chrono::microseconds value ){ itsFlushInterval = value; return *this; }
+
+      //! @}
+
+    private:
+      friend class ConcurrentLogArchive;
+
+      std::size_t itsBufferSize;
+      std::chrono::microseconds itsFlushInterval;
+  };
+
+  namespace concurrent_log_detail
+  {
+    //! Size of a frame header: thread id, sequence number and payload size
+    static const std::size_t header_size = sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(size_type);
+
+    //! Keeps members written by different threads on separate cache lines
+    struct CacheLinePad { char bytes[64]; };
+
+    //! Rounds a buffer size up to a power of two that holds at least one frame header
+    inline std::size_t buffer_capacity( std::size_t size )
+    {
+      std::size_t capacity = 64;
+      while( capacity < size )
+        capacity <<= 1;
+      return capacity;
+    }
+
+    //! A stream buffer that appends to a vector, which keeps its capacity between records
+    class RecordSink : public std::streambuf
+    {
+      public:
+        std::vector<char> & data(){ return itsData; }
+
+      protected:
+        std::streamsize xsputn( char const * s, std::streamsize n ) override
+        {
+          itsData.insert( itsData.end(), s, s + n );
+          return n;
+        }
+
+        int_type overflow( int_type c ) override
+        {
+          if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+            itsData.push_back( traits_type::to_char_type( c ) );
+          return traits_type::not_eof( c );
+        }
+
+      private:
+        std::vector<char> itsData;
+    };
+
+    //! A read only stream buffer over the current record of a reader
+    class RecordSource : public std::streambuf
+    {
+      public:
+        void reset( char const * data, std::size_t size )
+        {
+          char * begin = const_cast<char *>( data );
+          setg( begin, begin, begin + size );
+        }
+    };
+
+    //! The buffer a single thread logs into
+    /*! This is a single producer, single consumer ring of complete frames.  The logging
+        thread copies a frame in and advances head, the background writer copies frames out
+        and advances tail.  Both count bytes and never wrap. */
+    struct Producer
+    {
+      explicit Producer( std::size_t capacity ) :
+        ring( capacity ), mask( capacity - 1 ),
+        head( 0 ), tail( 0 ), retired( false ), closed( false ),
+        threadId( 0 ), sequence( 0 ), stream( &sink )
+      { }
+
+      std::vector<char> ring;
+      std::uint64_t const mask;
+
+      CacheLinePad pad0;
+      std::atomic<std::uint64_t> head; //!< Written by the logging thread
+      CacheLinePad pad1;
+      std::atomic<std::uint64_t> tail; //!< Written by the background writer
+      CacheLinePad pad2;
+
+      std::atomic<bool> retired; //!< Set when the logging thread exits
+      std::atomic<bool> closed;  //!< Set when the log is destroyed
+
+      // Only used by the logging thread
+      std::uint32_t threadId;
+      std::uint64_t sequence;
+      RecordSink sink;
+      std::ostream stream;
+    };
+
+    //! The buffers of the current thread, keyed by the id of their log
+    struct Registrations
+    {
+      ~Registrations()
+      {
+        for( auto & entry : entries )
+          entry.second->retired.store( true, std::memory_order_release );
+      }
+
+      std::vector<std::pair<std::uint64_t, std::shared_ptr<Producer>>> entries;
+    };
+
+    inline Registrations & registrations()
+    {
+      static thread_local Registrations instance;
+      return instance;
+    }
+
+    //! Ids are never reused, so a thread cannot mistake a new log for a destroyed one at the same address
+    inline std::uint64_t next_log_id()
+    {
+      static std::atomic<std::uint64_t> id( 0 );
+      return ++id;
+    }
+  } // namespace concurrent_log_detail
+
+  // ######################################################################
+  //! A log of binary records that many threads can write to concurrently
+  /*! Each call to operator() serializes its arguments as one record with a
+      BinaryOutputArchive.  Sharing one BinaryOutputArchive between threads needs a lock
+      around every record.  Here each thread serializes into its own buffer and never takes
+      a lock.  A background thread moves complete records from the buffers to the stream.
+
+      Each record is written as a frame: the id of the logging thread (std::uint32_t), the
+      sequence number of the record within that thread (std::uint64_t), and the size of the
+      payload (size_type), followed by the payload.  Thread ids are assigned from 0 in the
+      order threads first log.  Records of one thread appear in the order they were logged,
+      while records of different threads are interleaved in no particular order.
+
+      Every record is saved with a fresh archive, so it carries its own shared pointer,
+      polymorphic type and class version information and can be loaded without the records
+      before it.  Read the log with ConcurrentLogReader.  Records without pointers or
+      versioned classes can also be read in sequence with a single BinaryInputArchive:
+
+      @code{.cpp}
+      std::uint32_t thread;
+      std::uint64_t sequence;
+      cereal::size_type size;
+      iar( thread, sequence, cereal::make_size_tag( size ) );
+      iar( event );
+      @endcode
+
+      Logging only waits when the buffer of the thread is full.  A record larger than the
+      whole buffer waits for the buffer to drain and then writes directly to the stream
+      under a lock.
+
+      The stream must not be used by anything else until the log is destroyed, and no thread
+      may still be logging when it is.
+
+      \ingroup Archives */
+  class ConcurrentLogArchive
+  {
+    public:
+      //! Construct, writing records to the provided stream
+      /*! Starts the background writer thread.
+          @param stream The stream to output to
+          @param options The buffer size and flush interval */
+      explicit ConcurrentLogArchive( std::ostream & stream, ConcurrentLogOptions const & options = ConcurrentLogOptions::Default() ) :
+        itsStream( stream ),
+        itsId( concurrent_log_detail::next_log_id() ),
+        itsBufferSize( concurrent_log_detail::buffer_capacity( options.itsBufferSize ) ),
+        itsFlushInterval( options.itsFlushInterval ),
+        itsNextThreadId( 0 ),
+        itsFailed( false ),
+        itsStopping( false ),
+        itsSpaceWanted( false ),
+        itsRequested( 0 ),
+        itsServed( 0 ),
+        itsWriter( &ConcurrentLogArchive::run, this )
+      { }
+
+      ConcurrentLogArchive( ConcurrentLogArchive const & ) = delete;
+      ConcurrentLogArchive & operator=( ConcurrentLogArchive const & ) = delete;
+
+      //! Writes all remaining records, flushes the stream and stops the background writer
+      ~ConcurrentLogArchive()
+      {
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          itsStopping = true;
+        }
+        itsWake.notify_one();
+        itsWriter.join();
+
+        for( auto const & producer : itsProducers )
+          producer->closed.store( true, std::memory_order_release );
+      }
+
+      //! Logs its arguments as one record
+      /*! @return Whether the record was logged.  A record whose archive reported an error
+                  instead of throwing is dropped without using a sequence number */
+      template <class ... Types> inline
+      bool operator()( Types && ... args )
+      {
+        auto & producer = localProducer();
+        auto & frame = producer.sink.data();
+
+        frame.resize( concurrent_log_detail::header_size );
+        {
+          BinaryOutputArchive ar( producer.stream );
+          ar( std::forward<Types>( args )... );
+
+          if( !ar.ok() )
+          {
+            frame.clear();
+            producer.stream.clear();
+            return false;
+          }
+        }
+
+        auto const size = static_cast<size_type>( frame.size() - concurrent_log_detail::header_size );
+        std::memcpy( frame.data(), &producer.threadId, sizeof(std::uint32_t) );
+        std::memcpy( frame.data() + sizeof(std::uint32_t), &producer.sequence, sizeof(std::uint64_t) );
+        std::memcpy( frame.data() + sizeof(std::uint32_t) + sizeof(std::uint64_t), &size, sizeof(size_type) );
+
+        publish( producer );
+        ++producer.sequence;
+        return true;
+      }
+
+      //! Blocks until every record logged before this call is written and the stream is flushed
+      void flush()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        std::uint64_t const request = ++itsRequested;
+        itsWake.notify_one();
+        itsFlushed.wait( lock, [&]{ return itsServed >= request; } );
+      }
+
+      //! Whether everything written so far reached the stream
+      bool ok() const
+      {
+        return !itsFailed.load( std::memory_order_relaxed );
+      }
+
+    private:
+      //! The buffer of the calling thread, registering it on its first record
+      concurrent_log_detail::Producer & localProducer()
+      {
+        for( auto const & entry : concurrent_log_detail::registrations().entries )
+          if( entry.first == itsId )
+            return *entry.second;
+
+        return registerThread();
+      }
+
+      //! Creates a buffer for the calling thread
+      concurrent_log_detail::Producer & registerThread()
+      {
+        auto & entries = concurrent_log_detail::registrations().entries;
+        entries.erase( std::remove_if( entries.begin(), entries.end(),
+                                       []( std::pair<std::uint64_t, std::shared_ptr<concurrent_log_detail::Producer>> const & entry )
+                                       { return entry.second->closed.load( std::memory_order_acquire ); } ),
+                       entries.end() );
+
+        auto producer = std::make_shared<concurrent_log_detail::Producer>( itsBufferSize );
+        {
+          std::lock_guard<std::mutex> lock( itsRegistryMutex );
+          producer->threadId = itsNextThreadId++;
+          itsProducers.push_back( producer );
+        }
+
+        entries.emplace_back( itsId, producer );
+        return *producer;
+      }
+
+      //! Copies the frame of a producer into its buffer
+      void publish( concurrent_log_detail::Producer & producer )
+      {
+        auto const & frame = producer.sink.data();
+        std::uint64_t const size = frame.size();
+        std::uint64_t const capacity = producer.ring.size();
+        std::uint64_t const head = producer.head.load( std::memory_order_relaxed );
+
+        // Records that do not fit go directly to the stream once the records before them are written
+        if( size > capacity )
+        {
+          waitForSpace( producer, head, capacity );
+          std::lock_guard<std::mutex> lock( itsOutputMutex );
+          write( frame.data(), frame.size() );
+          return;
+        }
+
+        waitForSpace( producer, head, size );
+
+        auto const offset = static_cast<std::size_t>( head & producer.mask );
+        auto const first = static_cast<std::size_t>( (std::min)( size, capacity - offset ) );
+        std::memcpy( &producer.ring[offset], frame.data(), first );
+        std::memcpy( &producer.ring[0], frame.data() + first, frame.size() - first );
+
+        producer.head.store( head + size, std::memory_order_release );
+      }
+
+      //! Waits until the buffer of a producer has room for size bytes
+      void waitForSpace( concurrent_log_detail::Producer & producer, std::uint64_t head, std::uint64_t size )
+      {
+        auto const capacity = static_cast<std::uint64_t>( producer.ring.size() );
+        if( capacity - ( head - producer.tail.load( std::memory_order_acquire ) ) >= size )
+          return;
+
+        // Set under the lock, so that the writer either sees it before it waits or gets the notification
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          itsSpaceWanted = true;
+        }
+        itsWake.notify_one();
+        while( capacity - ( head - producer.tail.load( std::memory_order_acquire ) ) < size )
+          std::this_thread::yield();
+      }
+
+      //! The background writer
+      void run()
+      {
+        std::unique_lock<std::mutex> lock( itsMutex );
+        for( ;; )
+        {
+          bool const stopping = itsStopping;
+          std::uint64_t const requested = itsRequested;
+          itsSpaceWanted = false;
+          lock.unlock();
+
+          drain( stopping || requested != itsServed );
+
+          lock.lock();
+          itsServed = requested;
+          itsFlushed.notify_all();
+
+          if( stopping )
+            return;
+
+          itsWake.wait_for( lock, itsFlushInterval,
+                            [&]{ return itsStopping || itsRequested != itsServed || itsSpaceWanted; } );
+        }
+      }
+
+      //! Writes the records in all buffers to the stream
+      void drain( bool flushStream )
+      {
+        {
+          std::lock_guard<std::mutex> lock( itsRegistryMutex );
+          itsDraining.assign( itsProducers.begin(), itsProducers.end() );
+        }
+
+        bool anyRetired = false;
+        {
+          std::lock_guard<std::mutex> lock( itsOutputMutex );
+          for( auto const & producer : itsDraining )
+          {
+            // A retired thread has published all of its records before retiring
+            anyRetired |= producer->retired.load( std::memory_order_acquire );
+
+            std::uint64_t const head = producer->head.load( std::memory_order_acquire );
+            std::uint64_t const tail = producer->tail.load( std::memory_order_relaxed );
+            if( head == tail )
+              continue;
+
+            auto const offset = static_cast<std::size_t>( tail & producer->mask );
+            auto const size = static_cast<std::size_t>( head - tail );
+            auto const first = (std::min)( size, producer->ring.size() - offset );
+            write( &producer->ring[offset], first );
+            write( &producer->ring[0], size - first );
+
+            producer->tail.store( head, std::memory_order_release );
+          }
+
+          if( flushStream && !itsStream.flush() )
+            itsFailed.store( true, std::memory_order_relaxed );
+        }
+        itsDraining.clear();
+
+        if( anyRetired )
+        {
+          std::lock_guard<std::mutex> lock( itsRegistryMutex );
+          itsProducers.erase( std::remove_if( itsProducers.begin(), itsProducers.end(),
+                                              []( std::shared_ptr<concurrent_log_detail::Producer> const & producer )
+                                              {
+                                                return producer->retired.load( std::memory_order_acquire ) &&
+                                                       producer->head.load( std::memory_order_relaxed ) == producer->tail.load( std::memory_order_relaxed );
+                                              } ),
+                              itsProducers.end() );
+        }
+      }
+
+      //! Writes bytes to the stream, requires itsOutputMutex
+      void write( char const * data, std::size_t size )
+      {
+        if( size && itsStream.rdbuf()->sputn( data, static_cast<std::streamsize>( size ) ) != static_cast<std::streamsize>( size ) )
+          itsFailed.store( true, std::memory_order_relaxed );
+      }
+
+      std::ostream & itsStream;
+      std::uint64_t const itsId;
+      std::size_t const itsBufferSize;
+      std::chrono::microseconds const itsFlushInterval;
+
+      std::mutex itsRegistryMutex; //!< Guards itsProducers and itsNextThreadId
+      std::vector<std::shared_ptr<concurrent_log_detail::Producer>> itsProducers;
+      std::uint32_t itsNextThreadId;
+      std::vector<std::shared_ptr<concurrent_log_detail::Producer>> itsDraining; //!< Only used by the background writer
+
+      std::mutex itsOutputMutex; //!< Guards writing to itsStream
+      std::atomic<bool> itsFailed;
+
+      std::mutex itsMutex; //!< Guards the state below, shared with the background writer
+      std::condition_variable itsWake;
+      std::condition_variable itsFlushed;
+      bool itsStopping;
+      bool itsSpaceWanted; //!< Whether a thread is waiting for its buffer to drain
+      std::uint64_t itsRequested;
+      std::uint64_t itsServed;
+
+      std::thread itsWriter; //!< Declared last so that it starts once everything else is constructed
+  };
+
+  // ######################################################################
+  //! Reads the records of a ConcurrentLogArchive in the order they were written
+  /*! @code{.cpp}
+      cereal::ConcurrentLogReader reader( is );
+      while( reader.next() )
+      {
+        Event event;
+        if( reader( event ) )
+          handle( reader.threadId(), reader.sequence(), event );
+      }
+
+      bool const complete = reader.ok(); // false if the log was truncated
+      @endcode
+
+      \ingroup Archives */
+  class ConcurrentLogReader
+  {
+    public:
+      //! Construct, reading records from the provided stream
+      explicit ConcurrentLogReader( std::istream & stream ) :
+        itsStream( stream ),
+        itsOk( true ),
+        itsThreadId( 0 ),
+        itsSequence( 0 ),
+        itsRecordStream( &itsRecordSource )
+      { }
+
+      //! Reads the next record
+      /*! @return false if the stream ended before it, or within it, in which case ok() is false
+                  and no further records are read */
+      bool next()
+      {
+        if( !itsOk )
+          return false;
+
+        char header[concurrent_log_detail::header_size];
+        auto const headerSize = itsStream.rdbuf()->sgetn( header, sizeof(header) );
+        if( headerSize == 0 )
+          return false;
+        if( headerSize != static_cast<std::streamsize>( sizeof(header) ) )
+          return truncated();
+
+        size_type size;
+        std::memcpy( &itsThreadId, header, sizeof(std::uint32_t) );
+        std::memcpy( &itsSequence, header + sizeof(std::uint32_t), sizeof(std::uint64_t) );
+        std::memcpy( &size, header + sizeof(std::uint32_t) + sizeof(std::uint64_t), sizeof(size_type) );
+
+        // Grow in chunks, so that a corrupted size does not allocate more than the stream holds
+        itsRecord.clear();
+        while( itsRecord.size() < size )
+        {
+          auto const offset = itsRecord.size();
+          auto const chunk = static_cast<std::size_t>( (std::min)( size - offset, static_cast<size_type>( 1 << 20 ) ) );
+          itsRecord.resize( offset + chunk );
+          if( itsStream.rdbuf()->sgetn( itsRecord.data() + offset, static_cast<std::streamsize>( chunk ) ) != static_cast<std::streamsize>( chunk ) )
+            return truncated();
+        }
+
+        return true;
+      }
+
+      //! Whether every record read so far was complete
+      bool ok() const
+      {
+        return itsOk;
+      }
+
+      //! Loads the current record, which can be loaded more than once
+      /*! @return Whether the record loaded, false if its archive recorded an error, see
+                  InputArchive::setThrowOnError.  By default its archive throws instead.
+          @throws Exception if the record does not hold the requested data */
+      template <class ... Types> inline
+      bool operator()( Types && ... args )
+      {
+        itsRecordSource.reset( itsRecord.data(), itsRecord.size() );
+        itsRecordStream.clear();
+
+        BinaryInputArchive ar( itsRecordStream );
+        ar( std::forward<Types>( args )... );
+        return ar.ok();
+      }
+
+      //! The id of the thread that logged the current record
+      std::uint32_t threadId() const { return itsThreadId; }
+
+      //! The sequence number of the current record within its thread
+      std::uint64_t sequence() const { return itsSequence; }
+
+      //! The size of the payload of the current record, in bytes
+      std::size_t size() const { return itsRecord.size(); }
+
+    private:
+      //! Marks the log as truncated, after which no further records are read
+      bool truncated()
+      {
+        itsOk = false;
+        itsRecord.clear();
+        return false;
+      }
+
+      std::istream & itsStream;
+      bool itsOk;
+      std::uint32_t itsThreadId;
+      std::uint64_t itsSequence;
+      std::vector<char> itsRecord;
+      concurrent_log_detail::RecordSource itsRecordSource;
+      std::istream itsRecordStream;
+  };
+} // namespace cereal
+
+#endif // CEREAL_ARCHIVES_CONCURRENT_LOG_HPP_
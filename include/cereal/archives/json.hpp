@@ -40,6 +40,7 @@ namespace cereal
   { RapidJSONException( const char * what_ ) : Exception( what_ ) {} };
 }
 
+#if CEREAL_EXCEPTIONS
 // Inform rapidjson that assert will throw
 #ifndef CEREAL_RAPIDJSON_ASSERT_THROWS
 #define CEREAL_RAPIDJSON_ASSERT_THROWS
@@ -50,6 +51,13 @@ namespace cereal
 #define CEREAL_RAPIDJSON_ASSERT(x) if(!(x)){ \
   throw ::cereal::RapidJSONException("rapidjson internal assertion failure: " #x); }
 #endif // RAPIDJSON_ASSERT
+#else
+// Without exceptions, rapidjson assertions abort.  JSONInputArchive checks its
+// input before handing it to rapidjson, so these only fail on misuse of the archive
+#ifndef CEREAL_RAPIDJSON_ASSERT
+#define CEREAL_RAPIDJSON_ASSERT(x) if(!(x)){ std::abort(); }
+#endif // RAPIDJSON_ASSERT
+#endif // CEREAL_EXCEPTIONS
 
 // Enable support for parsing of nan, inf, -inf
 #ifndef CEREAL_RAPIDJSON_WRITE_DEFAULT_FLAGS
@@ -72,6 +80,8 @@ namespace cereal
 #include <stack>
 #include <vector>
 #include <string>
+#include <cerrno>
+#include <cstdlib>
 
 namespace cereal
 {
@@ -431,17 +441,30 @@ namespace cereal
       //! @{
 
       //! Construct, reading from the provided stream
-      /*! @param stream The stream to read from */
+      /*! If the stream does not hold a JSON object or array, this throws, or records an error
+          if exceptions are disabled (see setThrowOnError).
+
+          @param stream The stream to read from */
       JSONInputArchive(std::istream & stream) :
         InputArchive<JSONInputArchive>(this),
         itsNextName( nullptr ),
         itsReadStream(stream)
       {
         itsDocument.ParseStream<>(itsReadStream);
-        if (itsDocument.IsArray())
+        if (itsDocument.HasParseError())
+        {
+          itsIteratorStack.emplace_back();
+          loadFailed("JSON Parsing failed - the input is not valid JSON");
+        }
+        else if (itsDocument.IsArray())
           itsIteratorStack.emplace_back(itsDocument.Begin(), itsDocument.End());
-        else
+        else if (itsDocument.IsObject())
           itsIteratorStack.emplace_back(itsDocument.MemberBegin(), itsDocument.MemberEnd());
+        else
+        {
+          itsIteratorStack.emplace_back();
+          loadFailed("JSON Parsing failed - the root node is not an object or array");
+        }
       }
 
       ~JSONInputArchive() CEREAL_NOEXCEPT = default;
@@ -461,9 +484,13 @@ namespace cereal
         auto decoded = base64::decode( encoded );
 
         if( size != decoded.size() )
-          throw Exception("Decoded binary data size does not match specified size");
+        {
+          std::memset( data, 0, size );
+          loadFailed("Decoded binary data size does not match specified size");
+        }
+        else
+          std::memcpy( data, decoded.data(), decoded.size() );
 
-        std::memcpy( data, decoded.data(), decoded.size() );
         itsNextName = nullptr;
       };
 
@@ -480,19 +507,19 @@ namespace cereal
       class Iterator
       {
         public:
-          Iterator() : itsIndex( 0 ), itsType(Null_) {}
+          Iterator() : itsIndex( 0 ), itsSize( 0 ), itsType(Null_) {}
 
           Iterator(MemberIterator begin, MemberIterator end) :
-            itsMemberItBegin(begin), itsMemberItEnd(end), itsIndex(0), itsType(Member)
+            itsMemberItBegin(begin), itsMemberItEnd(end), itsIndex(0), itsSize(static_cast<size_t>( std::distance( begin, end ) )), itsType(Member)
           {
-            if( std::distance( begin, end ) == 0 )
+            if( itsSize == 0 )
               itsType = Null_;
           }
 
           Iterator(ValueIterator begin, ValueIterator end) :
-            itsValueItBegin(begin), itsIndex(0), itsType(Value)
+            itsValueItBegin(begin), itsIndex(0), itsSize(static_cast<size_t>( std::distance( begin, end ) )), itsType(Value)
           {
-            if( std::distance( begin, end ) == 0 )
+            if( itsSize == 0 )
               itsType = Null_;
           }
 
@@ -504,13 +531,17 @@ namespace cereal
           }
 
           //! Get the value of the current node
-          GenericValue const & value()
+          /*! @return nullptr if the iterator is empty or past its last node */
+          GenericValue const * value() const
           {
+            if( itsIndex >= itsSize )
+              return nullptr;
+
             switch(itsType)
             {
-              case Value : return itsValueItBegin[itsIndex];
-              case Member: return itsMemberItBegin[itsIndex].value;
-              default: throw cereal::Exception("JSONInputArchive internal error: null or empty iterator to object or array!");
+              case Value : return &itsValueItBegin[itsIndex];
+              case Member: return &itsMemberItBegin[itsIndex].value;
+              default: return nullptr;
             }
           }
 
@@ -524,8 +555,8 @@ namespace cereal
           }
 
           //! Adjust our position such that we are at the node with the given name
-          /*! @throws Exception if no such named node exists */
-          inline void search( const char * searchName )
+          /*! @return false if no such named node exists */
+          inline bool search( const char * searchName )
           {
             const auto len = std::strlen( searchName );
             size_t index = 0;
@@ -536,17 +567,18 @@ namespace cereal
                   ( std::strlen( currentName ) == len ) )
               {
                 itsIndex = index;
-                return;
+                return true;
               }
             }
 
-            throw Exception("JSON Parsing failed - provided NVP (" + std::string(searchName) + ") not found");
+            return false;
           }
 
         private:
           MemberIterator itsMemberItBegin, itsMemberItEnd; //!< The member iterator (object)
           ValueIterator itsValueItBegin;                   //!< The value iterator (array)
           size_t itsIndex;                                 //!< The current index of this iterator
+          size_t itsSize;                                  //!< The number of nodes this iterator covers
           enum Type {Value, Member, Null_} itsType;        //!< Whether this holds values (array) or members (objects) or nothing
       };
 
@@ -554,7 +586,7 @@ namespace cereal
       /*! This needs to be called before every load or node start occurs.  This function will
           check to see if an NVP has been provided (with setNextName) and if so, see if that name matches the actual
           next name given.  If the names do not match, it will search in the current level of the JSON for that name.
-          If the name is not found, an exception will be thrown.
+          If the name is not found, an exception will be thrown, or an error recorded (see setThrowOnError).
 
           Resets the NVP name after called.
 
@@ -562,19 +594,57 @@ namespace cereal
       inline void search()
       {
         // The name an NVP provided with setNextName()
-        if( itsNextName )
+        if( itsNextName && ok() )
         {
           // The actual name of the current node
           auto const actualName = itsIteratorStack.back().name();
 
           // Do a search if we don't see a name coming up, or if the names don't match
-          if( !actualName || std::strcmp( itsNextName, actualName ) != 0 )
-            itsIteratorStack.back().search( itsNextName );
+          if( ( !actualName || std::strcmp( itsNextName, actualName ) != 0 ) &&
+              !itsIteratorStack.back().search( itsNextName ) )
+          {
+            CEREAL_THROW_ON_ERROR(*this, "JSON Parsing failed - provided NVP (" + std::string(itsNextName) + ") not found");
+            setError("JSON Parsing failed - provided NVP not found");
+          }
         }
 
         itsNextName = nullptr;
       }
 
+      //! Searches for the next node and checks its type, moving past it
+      /*! @param isType The GenericValue member function that checks the expected type
+          @return The node, or nullptr if it does not exist or has the wrong type, in which
+                  case an error is thrown or recorded (see setThrowOnError) */
+      GenericValue const * nextValue( bool (GenericValue::*isType)() const )
+      {
+        search();
+        if( !ok() )
+          return nullptr;
+
+        auto const value = itsIteratorStack.back().value();
+        if( !value )
+        {
+          loadFailed("JSON Parsing failed - no more nodes to load");
+          return nullptr;
+        }
+
+        if( !(value->*isType)() )
+        {
+          loadFailed("JSON Parsing failed - node has the wrong type");
+          return nullptr;
+        }
+
+        ++itsIteratorStack.back();
+        return value;
+      }
+
+      //! Reports an error caused by the data being loaded
+      void loadFailed( char const * error )
+      {
+        CEREAL_THROW_ON_ERROR(*this, error);
+        setError( error );
+      }
+
     public:
       //! Starts a new node, going into its proper iterator
       /*! This places an iterator for the next node to be parsed onto the iterator stack.  If the next
@@ -590,10 +660,18 @@ namespace cereal
       {
         search();
 
-        if(itsIteratorStack.back().value().IsArray())
-          itsIteratorStack.emplace_back(itsIteratorStack.back().value().Begin(), itsIteratorStack.back().value().End());
+        auto const value = ok() ? itsIteratorStack.back().value() : nullptr;
+        if( value && value->IsArray() )
+          itsIteratorStack.emplace_back(value->Begin(), value->End());
+        else if( value && value->IsObject() )
+          itsIteratorStack.emplace_back(value->MemberBegin(), value->MemberEnd());
         else
-          itsIteratorStack.emplace_back(itsIteratorStack.back().value().MemberBegin(), itsIteratorStack.back().value().MemberEnd());
+        {
+          // Keep the stack balanced for finishNode, an empty iterator loads nothing
+          itsIteratorStack.emplace_back();
+          if( ok() )
+            loadFailed(value ? "JSON Parsing failed - node is not an object or array" : "JSON Parsing failed - no more nodes to load");
+        }
       }
 
       //! Finishes the most recently started node
@@ -617,14 +695,14 @@ namespace cereal
       }
 
       //! Loads a value from the current node - small signed overload
+      /*! If the node does not exist or has the wrong type, the value is zeroed and an error
+          is thrown or recorded (see setThrowOnError).  This applies to all loadValue overloads. */
       template <class T, traits::EnableIf<std::is_signed<T>::value,
                                           sizeof(T) < sizeof(int64_t)> = traits::sfinae> inline
       void loadValue(T & val)
       {
-        search();
-
-        val = static_cast<T>( itsIteratorStack.back().value().GetInt() );
-        ++itsIteratorStack.back();
+        auto const value = nextValue( &GenericValue::IsInt );
+        val = value ? static_cast<T>( value->GetInt() ) : T();
       }
 
       //! Loads a value from the current node - small unsigned overload
@@ -633,26 +711,24 @@ namespace cereal
                                           !std::is_same<bool, T>::value> = traits::sfinae> inline
       void loadValue(T & val)
       {
-        search();
-
-        val = static_cast<T>( itsIteratorStack.back().value().GetUint() );
-        ++itsIteratorStack.back();
+        auto const value = nextValue( &GenericValue::IsUint );
+        val = value ? static_cast<T>( value->GetUint() ) : T();
       }
 
       //! Loads a value from the current node - bool overload
-      void loadValue(bool & val)        { search(); val = itsIteratorStack.back().value().GetBool(); ++itsIteratorStack.back(); }
+      void loadValue(bool & val)        { auto const v = nextValue( &GenericValue::IsBool ); val = v ? v->GetBool() : false; }
       //! Loads a value from the current node - int64 overload
-      void loadValue(int64_t & val)     { search(); val = itsIteratorStack.back().value().GetInt64(); ++itsIteratorStack.back(); }
+      void loadValue(int64_t & val)     { auto const v = nextValue( &GenericValue::IsInt64 ); val = v ? v->GetInt64() : 0; }
       //! Loads a value from the current node - uint64 overload
-      void loadValue(uint64_t & val)    { search(); val = itsIteratorStack.back().value().GetUint64(); ++itsIteratorStack.back(); }
+      void loadValue(uint64_t & val)    { auto const v = nextValue( &GenericValue::IsUint64 ); val = v ? v->GetUint64() : 0; }
       //! Loads a value from the current node - float overload
-      void loadValue(float & val)       { search(); val = static_cast<float>(itsIteratorStack.back().value().GetDouble()); ++itsIteratorStack.back(); }
+      void loadValue(float & val)       { auto const v = nextValue( &GenericValue::IsNumber ); val = v ? static_cast<float>(v->GetDouble()) : 0.0f; }
       //! Loads a value from the current node - double overload
-      void loadValue(double & val)      { search(); val = itsIteratorStack.back().value().GetDouble(); ++itsIteratorStack.back(); }
+      void loadValue(double & val)      { auto const v = nextValue( &GenericValue::IsNumber ); val = v ? v->GetDouble() : 0.0; }
       //! Loads a value from the current node - string overload
-      void loadValue(std::string & val) { search(); val = itsIteratorStack.back().value().GetString(); ++itsIteratorStack.back(); }
+      void loadValue(std::string & val) { auto const v = nextValue( &GenericValue::IsString ); if( v ) val = v->GetString(); else val.clear(); }
       //! Loads a nullptr from the current node
-      void loadValue(std::nullptr_t&)   { search(); CEREAL_RAPIDJSON_ASSERT(itsIteratorStack.back().value().IsNull()); ++itsIteratorStack.back(); }
+      void loadValue(std::nullptr_t&)   { nextValue( &GenericValue::IsNull ); }
 
       // Special cases to handle various flavors of long, which tend to conflict with
       // the int32_t or int64_t on various compiler/OS combinations.  MSVC doesn't need any of this.
@@ -696,11 +772,25 @@ namespace cereal
 
     private:
       //! Convert a string to a long long
-      void stringToNumber( std::string const & str, long long & val ) { val = std::stoll( str ); }
+      void stringToNumber( std::string const & str, long long & val )
+      { char * end; errno = 0; val = std::strtoll( str.c_str(), &end, 10 ); checkNumber( str, end, val ); }
       //! Convert a string to an unsigned long long
-      void stringToNumber( std::string const & str, unsigned long long & val ) { val = std::stoull( str ); }
+      void stringToNumber( std::string const & str, unsigned long long & val )
+      { char * end; errno = 0; val = std::strtoull( str.c_str(), &end, 10 ); checkNumber( str, end, val ); }
       //! Convert a string to a long double
-      void stringToNumber( std::string const & str, long double & val ) { val = std::stold( str ); }
+      void stringToNumber( std::string const & str, long double & val )
+      { char * end; errno = 0; val = std::strtold( str.c_str(), &end ); checkNumber( str, end, val ); }
+
+      //! Zeroes the value and reports an error if the string was not a number in range
+      template <class T> inline
+      void checkNumber( std::string const & str, char const * end, T & val )
+      {
+        if( end == str.c_str() || errno == ERANGE )
+        {
+          val = T();
+          loadFailed("JSON Parsing failed - could not convert string to number");
+        }
+      }
 
     public:
       //! Loads a value from the current node - long double and long long overloads
@@ -718,12 +808,21 @@ namespace cereal
       }
 
       //! Loads the size for a SizeTag
+      /*! The size is zero if the current node is not an array */
       void loadSize(size_type & size)
       {
-        if (itsIteratorStack.size() == 1)
-          size = itsDocument.Size();
+        GenericValue const * value = nullptr;
+        if( ok() )
+          value = itsIteratorStack.size() == 1 ? &itsDocument : (itsIteratorStack.rbegin() + 1)->value();
+
+        if( value && value->IsArray() )
+          size = value->Size();
         else
-          size = (itsIteratorStack.rbegin() + 1)->value().Size();
+        {
+          size = 0;
+          if( ok() )
+            loadFailed("JSON Parsing failed - node is not an array");
+        }
       }
 
       //! @}
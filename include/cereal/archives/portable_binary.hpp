@@ -30,6 +30,7 @@
 #define CEREAL_ARCHIVES_PORTABLE_BINARY_HPP_
 
 #include "cereal/cereal.hpp"
+#include <cstring>
 #include <sstream>
 #include <limits>
 
@@ -131,6 +132,9 @@ namespace cereal
       template <std::streamsize DataSize> inline
       void saveBinary( const void * data, std::streamsize size )
       {
+        if( !ok() )
+          return;
+
         std::streamsize writtenSize = 0;
 
         if( itsConvertEndianness )
@@ -142,11 +146,22 @@ namespace cereal
         else
           writtenSize = itsStream.rdbuf()->sputn( reinterpret_cast<const char*>( data ), size );
 
+        #if CEREAL_TRACE
+        addTracedBytes( writtenSize );
+        #endif
+
         if(writtenSize != size)
-          throw Exception("Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+          saveFailed( size, writtenSize );
       }
 
     private:
+      //! Reports a failed write, kept out of line of saveBinary
+      CEREAL_NOINLINE void saveFailed( std::streamsize size, std::streamsize writtenSize )
+      {
+        CEREAL_THROW_ON_ERROR(*this, "Failed to write " + std::to_string(size) + " bytes to output stream! Wrote " + std::to_string(writtenSize));
+        setError("Failed to write to output stream");
+      }
+
       std::ostream & itsStream;
       const uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon saving
   };
@@ -239,10 +254,17 @@ namespace cereal
       void loadBinary( void * const data, std::streamsize size )
       {
         // load data
-        auto const readSize = itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size );
+        auto const readSize = ok() ? itsStream.rdbuf()->sgetn( reinterpret_cast<char*>( data ), size ) : 0;
+
+        #if CEREAL_TRACE
+        addTracedBytes( readSize );
+        #endif
 
         if(readSize != size)
-          throw Exception("Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+        {
+          loadFailed( data, size, readSize );
+          return;
+        }
 
         // flip bits if needed
         if( itsConvertEndianness )
@@ -253,7 +275,24 @@ namespace cereal
         }
       }
 
+      //! The number of bytes the stream can provide without blocking, which is at most what it holds
+      /*! Load functions use this to allocate a large size at once when its data is known to be there.
+          Returns -1 when the stream holds nothing more.
+          @internal */
+      std::streamsize availableBytes()
+      {
+        return itsStream.rdbuf()->in_avail();
+      }
+
     private:
+      //! Reports a failed read and zeroes the data, kept out of line of loadBinary
+      CEREAL_NOINLINE void loadFailed( void * const data, std::streamsize size, std::streamsize readSize )
+      {
+        CEREAL_THROW_ON_ERROR(*this, "Failed to read " + std::to_string(size) + " bytes from input stream! Read " + std::to_string(readSize));
+        std::memset( data, 0, static_cast<std::size_t>( size ) );
+        setError("Failed to read from input stream");
+      }
+
       std::istream & itsStream;
       uint8_t itsConvertEndianness; //!< If set to true, we will need to swap bytes upon loading
   };
@@ -31,6 +31,13 @@
 #include "cereal/cereal.hpp"
 #include "cereal/details/util.hpp"
 
+// Without exceptions, rapidxml reports parse errors through parse_error_handler,
+// which cereal defines below to return to the XMLInputArchive being constructed
+#if !CEREAL_EXCEPTIONS && !defined(CEREAL_RAPIDXML_NO_EXCEPTIONS)
+#define CEREAL_RAPIDXML_NO_EXCEPTIONS
+#define CEREAL_XML_PARSE_ERROR_HANDLER
+#endif
+
 #include "cereal/external/rapidxml/rapidxml.hpp"
 #include "cereal/external/rapidxml/rapidxml_print.hpp"
 #include "cereal/external/base64.hpp"
@@ -42,6 +49,9 @@
 #include <string>
 #include <cstring>
 #include <cmath>
+#include <cerrno>
+#include <cstdlib>
+#include <csetjmp>
 
 namespace cereal
 {
@@ -62,7 +72,28 @@ namespace cereal
     {
       return c == ' ' || c == '\t' || c == '\n' || c == '\r';
     }
+
+    #ifdef CEREAL_XML_PARSE_ERROR_HANDLER
+    //! Where rapidxml::parse_error_handler returns to when parsing on this thread fails
+    inline std::jmp_buf *& parseErrorTarget()
+    {
+      static thread_local std::jmp_buf * target = nullptr;
+      return target;
+    }
+    #endif // CEREAL_XML_PARSE_ERROR_HANDLER
+  }
+
+  #ifdef CEREAL_XML_PARSE_ERROR_HANDLER
+  namespace rapidxml
+  {
+    //! Returns to the XMLInputArchive that started parsing, which reports the error
+    /*! The parser only holds trivially destructible state, so it can be left with longjmp */
+    inline void parse_error_handler( const char *, void * )
+    {
+      std::longjmp( *xml_detail::parseErrorTarget(), 1 );
+    }
   }
+  #endif // CEREAL_XML_PARSE_ERROR_HANDLER
 
   // ######################################################################
   //! An output archive designed to save data to XML
@@ -411,36 +442,27 @@ namespace cereal
 
       //! Construct, reading in from the provided stream
       /*! Reads in an entire XML document from some stream and parses it as soon
-          as serialization starts
+          as serialization starts.  If the document cannot be parsed, this throws,
+          or records an error if exceptions are disabled (see setThrowOnError).
 
           @param stream The stream to read from.  Can be a stringstream or a file. */
       XMLInputArchive( std::istream & stream ) :
         InputArchive<XMLInputArchive>( this ),
         itsData( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() )
       {
-        try
-        {
-          itsData.push_back('\0'); // rapidxml will do terrible things without the data being null terminated
-          itsXML.parse<rapidxml::parse_trim_whitespace | rapidxml::parse_no_data_nodes | rapidxml::parse_declaration_node>( reinterpret_cast<char *>( itsData.data() ) );
-        }
-        catch( rapidxml::parse_error const & )
+        itsData.push_back('\0'); // rapidxml will do terrible things without the data being null terminated
+        if( !parse() )
         {
-          //std::cerr << "-----Original-----" << std::endl;
-          //stream.seekg(0);
-          //std::cout << std::string( std::istreambuf_iterator<char>( stream ), std::istreambuf_iterator<char>() ) << std::endl;
-
-          //std::cerr << "-----Error-----" << std::endl;
-          //std::cerr << e.what() << std::endl;
-          //std::cerr << e.where<char>() << std::endl;
-          throw Exception("XML Parsing failed - likely due to invalid characters or invalid naming");
+          itsNodes.emplace();
+          loadFailed("XML Parsing failed - likely due to invalid characters or invalid naming");
+          return;
         }
 
         // Parse the root
         auto root = itsXML.first_node( xml_detail::CEREAL_XML_STRING );
+        itsNodes.emplace( root );
         if( root == nullptr )
-          throw Exception("Could not detect cereal root node - likely due to empty or invalid input");
-        else
-          itsNodes.emplace( root );
+          loadFailed("Could not detect cereal root node - likely due to empty or invalid input");
       }
 
       ~XMLInputArchive() CEREAL_NOEXCEPT = default;
@@ -462,9 +484,12 @@ namespace cereal
         auto decoded = base64::decode( encoded );
 
         if( size != decoded.size() )
-          throw Exception("Decoded binary data size does not match specified size");
-
-        std::memcpy( data, decoded.data(), decoded.size() );
+        {
+          std::memset( data, 0, size );
+          loadFailed("Decoded binary data size does not match specified size");
+        }
+        else
+          std::memcpy( data, decoded.data(), decoded.size() );
 
         finishNode();
       }
@@ -484,22 +509,31 @@ namespace cereal
 
           We check to see if the specified NVP matches what the next automatically loaded node is.  If they
           match, we just continue as normal, going in order.  If they don't match, we attempt to find a node
-          named after the NVP that is being loaded.  If that NVP does not exist, we throw an exception. */
+          named after the NVP that is being loaded.  If that NVP does not exist, we throw an exception, or
+          record an error if the archive does not throw (see setThrowOnError).  After an error, an empty
+          node is started instead, from which nothing is loaded. */
       void startNode()
       {
         auto next = itsNodes.top().child; // By default we would move to the next child node
         auto const expectedName = itsNodes.top().name; // this is the expected name from the NVP, if provided
 
+        if( !ok() )
+          next = nullptr;
         // If we were given an NVP name, look for it in the current level of the document.
         //    We only need to do this if either we have exhausted the siblings of the current level or
         //    the NVP name does not match the name of the node we would normally read next
-        if( expectedName && ( next == nullptr || std::strcmp( next->name(), expectedName ) != 0 ) )
+        else if( expectedName && ( next == nullptr || std::strcmp( next->name(), expectedName ) != 0 ) )
         {
           next = itsNodes.top().search( expectedName );
 
           if( next == nullptr )
-            throw Exception("XML Parsing failed - provided NVP (" + std::string(expectedName) + ") not found");
+          {
+            CEREAL_THROW_ON_ERROR(*this, "XML Parsing failed - provided NVP (" + std::string(expectedName) + ") not found");
+            setError("XML Parsing failed - provided NVP not found");
+          }
         }
+        else if( next == nullptr )
+          loadFailed("XML Parsing failed - no more nodes to load");
 
         itsNodes.emplace( next );
       }
@@ -535,7 +569,7 @@ namespace cereal
                                           std::is_same<T, bool>::value> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        std::istringstream is( itsNodes.top().node->value() );
+        std::istringstream is( nodeValue() );
         is.setf( std::ios::boolalpha );
         is >> value;
       }
@@ -546,7 +580,7 @@ namespace cereal
                                           sizeof(T) == sizeof(char)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = *reinterpret_cast<T*>( itsNodes.top().node->value() );
+        value = *reinterpret_cast<T const *>( nodeValue() );
       }
 
       //! Load an int8_t from the current top node (ensures we parse entire number)
@@ -569,7 +603,7 @@ namespace cereal
                                           sizeof(T) < sizeof(long long)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoul( itsNodes.top().node->value() ) );
+        value = static_cast<T>( loadNumber<unsigned long>( []( char const * s, char ** end ){ return std::strtoul( s, end, 10 ); } ) );
       }
 
       //! Loads a type best represented as an unsigned long long from the current top node
@@ -578,7 +612,7 @@ namespace cereal
                                           sizeof(T) >= sizeof(long long)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoull( itsNodes.top().node->value() ) );
+        value = static_cast<T>( loadNumber<unsigned long long>( []( char const * s, char ** end ){ return std::strtoull( s, end, 10 ); } ) );
       }
 
       //! Loads a type best represented as an int from the current top node
@@ -587,7 +621,14 @@ namespace cereal
                                           sizeof(T) <= sizeof(int)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoi( itsNodes.top().node->value() ) );
+        auto const number = loadNumber<long>( []( char const * s, char ** end ){ return std::strtol( s, end, 10 ); } );
+        if( number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max() )
+        {
+          value = T();
+          loadFailed("XML Parsing failed - could not convert value to number");
+        }
+        else
+          value = static_cast<T>( number );
       }
 
       //! Loads a type best represented as a long from the current top node
@@ -596,7 +637,7 @@ namespace cereal
                                           sizeof(T) <= sizeof(long)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stol( itsNodes.top().node->value() ) );
+        value = static_cast<T>( loadNumber<long>( []( char const * s, char ** end ){ return std::strtol( s, end, 10 ); } ) );
       }
 
       //! Loads a type best represented as a long long from the current top node
@@ -605,65 +646,32 @@ namespace cereal
                                           sizeof(T) <= sizeof(long long)> = traits::sfinae> inline
       void loadValue( T & value )
       {
-        value = static_cast<T>( std::stoll( itsNodes.top().node->value() ) );
+        value = static_cast<T>( loadNumber<long long>( []( char const * s, char ** end ){ return std::strtoll( s, end, 10 ); } ) );
       }
 
       //! Loads a type best represented as a float from the current top node
       void loadValue( float & value )
       {
-        try
-        {
-          value = std::stof( itsNodes.top().node->value() );
-        }
-        catch( std::out_of_range const & )
-        {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
-        }
+        value = loadNumber<float>( []( char const * s, char ** end ){ return std::strtof( s, end ); } );
       }
 
       //! Loads a type best represented as a double from the current top node
       void loadValue( double & value )
       {
-        try
-        {
-          value = std::stod( itsNodes.top().node->value() );
-        }
-        catch( std::out_of_range const & )
-        {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
-        }
+        value = loadNumber<double>( []( char const * s, char ** end ){ return std::strtod( s, end ); } );
       }
 
       //! Loads a type best represented as a long double from the current top node
       void loadValue( long double & value )
       {
-        try
-        {
-          value = std::stold( itsNodes.top().node->value() );
-        }
-        catch( std::out_of_range const & )
-        {
-          // special case for denormalized values
-          std::istringstream is( itsNodes.top().node->value() );
-          is >> value;
-          if( std::fpclassify( value ) != FP_SUBNORMAL )
-            throw;
-        }
+        value = loadNumber<long double>( []( char const * s, char ** end ){ return std::strtold( s, end ); } );
       }
 
       //! Loads a string from the current node from the current top node
       template<class CharT, class Traits, class Alloc> inline
       void loadValue( std::basic_string<CharT, Traits, Alloc> & str )
       {
-        std::basic_istringstream<CharT, Traits> is( itsNodes.top().node->value() );
+        std::basic_istringstream<CharT, Traits> is( nodeValue() );
 
         str.assign( std::istreambuf_iterator<CharT, Traits>( is ),
                     std::istreambuf_iterator<CharT, Traits>() );
@@ -676,12 +684,77 @@ namespace cereal
         value = getNumChildren( itsNodes.top().node );
       }
 
+    private:
+      //! Parses itsData into itsXML
+      /*! @return false if the data is not valid XML */
+      bool parse()
+      {
+        #ifdef CEREAL_XML_PARSE_ERROR_HANDLER
+        std::jmp_buf target;
+        auto & current = xml_detail::parseErrorTarget();
+        auto const previous = current;
+        current = &target;
+        if( setjmp( target ) != 0 )
+        {
+          current = previous;
+          itsXML.clear();
+          return false;
+        }
+        itsXML.parse<rapidxml::parse_trim_whitespace | rapidxml::parse_no_data_nodes | rapidxml::parse_declaration_node>( reinterpret_cast<char *>( itsData.data() ) );
+        current = previous;
+        #else
+        try
+        {
+          itsXML.parse<rapidxml::parse_trim_whitespace | rapidxml::parse_no_data_nodes | rapidxml::parse_declaration_node>( reinterpret_cast<char *>( itsData.data() ) );
+        }
+        catch( rapidxml::parse_error const & )
+        {
+          return false;
+        }
+        #endif // CEREAL_XML_PARSE_ERROR_HANDLER
+        return true;
+      }
+
+      //! The value of the current top node, or an empty string if there is none
+      const char * nodeValue() const
+      {
+        auto const node = itsNodes.top().node;
+        return node ? node->value() : "";
+      }
+
+      //! Converts the value of the current top node to a number with a strto* function
+      /*! If the value is not a number in range, zero is returned and an error is thrown or
+          recorded (see setThrowOnError).  Values that underflow to a denormal are accepted. */
+      template <class T, class Convert> inline
+      T loadNumber( Convert convert )
+      {
+        char const * begin = nodeValue();
+        char * end;
+        errno = 0;
+        T const number = convert( begin, &end );
+        if( end == begin || ( errno == ERANGE && std::fpclassify( number ) != FP_SUBNORMAL ) )
+        {
+          loadFailed("XML Parsing failed - could not convert value to number");
+          return T();
+        }
+
+        return number;
+      }
+
+      //! Reports an error caused by the data being loaded
+      void loadFailed( char const * error )
+      {
+        CEREAL_THROW_ON_ERROR(*this, error);
+        setError( error );
+      }
+
     protected:
       //! Gets the number of children (usually interpreted as size) for the specified node
+      /*! @return 0 for a null node */
       static size_t getNumChildren( rapidxml::xml_node<> * node )
       {
         size_t size = 0;
-        node = node->first_node(); // get first child
+        node = node ? node->first_node() : nullptr; // get first child
 
         while( node != nullptr )
         {
@@ -699,7 +772,7 @@ namespace cereal
       {
         NodeInfo( rapidxml::xml_node<> * n = nullptr ) :
           node( n ),
-          child( n->first_node() ),
+          child( n ? n->first_node() : nullptr ),
           size( XMLInputArchive::getNumChildren( n ) ),
           name( nullptr )
         { }
@@ -720,7 +793,7 @@ namespace cereal
             @return The node if found, nullptr otherwise */
         rapidxml::xml_node<> * search( const char * searchName )
         {
-          if( searchName )
+          if( searchName && node )
           {
             size_t new_size = XMLInputArchive::getNumChildren( node );
             const size_t name_size = rapidxml::internal::measure( searchName );
@@ -0,0 +1,840 @@
+/*! \file xml_stream.hpp
+    \brief Streaming XML input archive */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ARCHIVES_XML_STREAM_HPP_
+#define CEREAL_ARCHIVES_XML_STREAM_HPP_
+#include "cereal/archives/xml.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <streambuf>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <cerrno>
+#include <cstdlib>
+
+namespace cereal
+{
+  // ######################################################################
+  //! An input archive designed to load data from XML without building a document
+  /*! Unlike XMLInputArchive, which parses the entire stream into an in memory
+      tree before loading anything, this archive tokenizes the stream as data is
+      loaded.  Its memory use is proportional to the depth of the document and the
+      size of the largest single value, not to the size of the document, which makes
+      it suitable for very large files.
+
+      Input should have been produced by the XMLOutputArchive.  The tokenizer
+      understands elements, attributes, text with the predefined and numeric
+      character references, comments, processing instructions and the XML
+      declaration, which covers everything XMLOutputArchive writes.
+
+      Because the stream is only read forward, data must be loaded in the order it
+      was saved.  When an NVP does not match the name of the next node, the archive
+      skips forward over sibling nodes until it finds one with that name; it cannot
+      go back to nodes that have already been passed.
+
+      The size of a dynamically sized container is the number of its child nodes.
+      To determine it, the archive scans ahead to the end of the container and then
+      seeks back, so loading containers requires a seekable stream (e.g. a file or
+      a stringstream) and reads their contents twice.
+
+      Malformed input is reported like any other error of the data being loaded,
+      see setThrowOnError.  After an error, the archive stops reading and further
+      loads produce zeroed values.
+
+      @code{cpp}
+      std::ifstream is( "large.xml" );
+      cereal::XMLStreamInputArchive ar( is );
+      ar( someData1, someData2 ); // loads exactly as XMLInputArchive would
+      @endcode
+
+      \ingroup Archives */
+  class XMLStreamInputArchive : public InputArchive<XMLStreamInputArchive>, public traits::TextArchive
+  {
+    public:
+      /*! @name Common Functionality
+          Common use cases for directly interacting with an XMLStreamInputArchive */
+      //! @{
+
+      //! Construct, reading in from the provided stream
+      /*! Reads up to and including the start of the cereal root node.  The remainder
+          of the stream is read as data is loaded.
+
+          @param stream The stream to read from.  Can be a stringstream or a file. */
+      XMLStreamInputArchive( std::istream & stream ) :
+        InputArchive<XMLStreamInputArchive>( this ),
+        itsBuffer( stream.rdbuf() ),
+        itsHasPending( false )
+      {
+        if( nextTag( itsPending ) != TagType::Start ||
+            itsPending.name != xml_detail::CEREAL_XML_STRING )
+        {
+          itsNodes.emplace_back( true, false );
+          loadFailed("Could not detect cereal root node - likely due to empty or invalid input");
+        }
+        else
+          itsNodes.emplace_back( itsPending.empty, itsPending.preserve );
+      }
+
+      ~XMLStreamInputArchive() CEREAL_NOEXCEPT = default;
+
+      //! Loads some binary data, encoded as a base64 string, optionally specified by some name
+      /*! This will automatically start and finish a node to load the data, and can be called directly by
+          users.
+
+          Note that this follows the same ordering rules specified in the class description in regards
+          to loading in/out of order */
+      void loadBinaryValue( void * data, size_t size, const char * name = nullptr )
+      {
+        setNextName( name );
+        startNode();
+
+        std::string encoded;
+        loadValue( encoded );
+
+        auto decoded = base64::decode( encoded );
+
+        if( size != decoded.size() )
+        {
+          std::memset( data, 0, size );
+          loadFailed("Decoded binary data size does not match specified size");
+        }
+        else
+          std::memcpy( data, decoded.data(), decoded.size() );
+
+        finishNode();
+      }
+
+      //! @}
+      /*! @name Internal Functionality
+          Functionality designed for use by those requiring control over the inner mechanisms of
+          the XMLStreamInputArchive */
+      //! @{
+
+      //! Prepares to start reading the next node
+      /*! Reads the start tag of the next child of the current node.  If an NVP name
+          was set and does not match, following siblings are skipped until one matches.
+          If no such sibling exists, we throw an exception, or record an error if the
+          archive does not throw (see setThrowOnError).  After an error, an empty node
+          is started instead, from which nothing is loaded. */
+      void startNode()
+      {
+        auto const expectedName = itsNodes.back().name;
+
+        peekChild();
+
+        if( expectedName )
+        {
+          while( itsHasPending && itsPending.name != expectedName )
+          {
+            skipPending();
+            peekChild();
+          }
+
+          if( !itsHasPending && ok() )
+          {
+            CEREAL_THROW_ON_ERROR(*this, "XML Parsing failed - provided NVP (" + std::string(expectedName) + ") not found");
+            setError("XML Parsing failed - provided NVP not found");
+          }
+        }
+        else if( !itsHasPending )
+          loadFailed("XML Parsing failed - no more nodes to load");
+
+        if( !itsHasPending )
+        {
+          itsNodes.emplace_back( true, false );
+          return;
+        }
+
+        itsHasPending = false;
+        itsNodes.emplace_back( itsPending.empty, itsPending.preserve );
+      }
+
+      //! Finishes reading the current node
+      /*! Any of its content that was not loaded is skipped */
+      void finishNode()
+      {
+        if( itsHasPending )
+          skipPending();
+
+        if( !itsNodes.back().closed )
+          skipContent();
+
+        itsNodes.pop_back();
+
+        // Reset name
+        itsNodes.back().name = nullptr;
+      }
+
+      //! Retrieves the name of the next node
+      //! will return @c nullptr if there are no more nodes at this level
+      const char * getNodeName()
+      {
+        peekChild();
+        return itsHasPending ? itsPending.name.c_str() : nullptr;
+      }
+
+      //! Sets the name for the next node created with startNode
+      void setNextName( const char * name )
+      {
+        itsNodes.back().name = name;
+      }
+
+      //! Loads a bool from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          std::is_same<T, bool>::value> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        std::istringstream is( readValue() );
+        is.setf( std::ios::boolalpha );
+        is >> value;
+      }
+
+      //! Loads a char (signed or unsigned) from the current top node
+      template <class T, traits::EnableIf<std::is_integral<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          sizeof(T) == sizeof(char)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        value = static_cast<T>( readValue()[0] );
+      }
+
+      //! Load an int8_t from the current top node (ensures we parse entire number)
+      void loadValue( int8_t & value )
+      {
+        int32_t val; loadValue( val ); value = static_cast<int8_t>( val );
+      }
+
+      //! Load a uint8_t from the current top node (ensures we parse entire number)
+      void loadValue( uint8_t & value )
+      {
+        uint32_t val; loadValue( val ); value = static_cast<uint8_t>( val );
+      }
+
+      //! Loads a type best represented as an unsigned long from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          !std::is_same<T, char>::value,
+                                          !std::is_same<T, unsigned char>::value,
+                                          sizeof(T) < sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        value = static_cast<T>( loadNumber<unsigned long>( []( char const * s, char ** end ){ return std::strtoul( s, end, 10 ); } ) );
+      }
+
+      //! Loads a type best represented as an unsigned long long from the current top node
+      template <class T, traits::EnableIf<std::is_unsigned<T>::value,
+                                          !std::is_same<T, bool>::value,
+                                          sizeof(T) >= sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        value = static_cast<T>( loadNumber<unsigned long long>( []( char const * s, char ** end ){ return std::strtoull( s, end, 10 ); } ) );
+      }
+
+      //! Loads a type best represented as an int from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          !std::is_same<T, char>::value,
+                                          sizeof(T) <= sizeof(int)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        auto const number = loadNumber<long>( []( char const * s, char ** end ){ return std::strtol( s, end, 10 ); } );
+        if( number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max() )
+        {
+          value = T();
+          loadFailed("XML Parsing failed - could not convert value to number");
+        }
+        else
+          value = static_cast<T>( number );
+      }
+
+      //! Loads a type best represented as a long from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          (sizeof(T) > sizeof(int)),
+                                          sizeof(T) <= sizeof(long)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        value = static_cast<T>( loadNumber<long>( []( char const * s, char ** end ){ return std::strtol( s, end, 10 ); } ) );
+      }
+
+      //! Loads a type best represented as a long long from the current top node
+      template <class T, traits::EnableIf<std::is_signed<T>::value,
+                                          (sizeof(T) > sizeof(long)),
+                                          sizeof(T) <= sizeof(long long)> = traits::sfinae> inline
+      void loadValue( T & value )
+      {
+        value = static_cast<T>( loadNumber<long long>( []( char const * s, char ** end ){ return std::strtoll( s, end, 10 ); } ) );
+      }
+
+      //! Loads a type best represented as a float from the current top node
+      void loadValue( float & value )
+      {
+        value = loadNumber<float>( []( char const * s, char ** end ){ return std::strtof( s, end ); } );
+      }
+
+      //! Loads a type best represented as a double from the current top node
+      void loadValue( double & value )
+      {
+        value = loadNumber<double>( []( char const * s, char ** end ){ return std::strtod( s, end ); } );
+      }
+
+      //! Loads a type best represented as a long double from the current top node
+      void loadValue( long double & value )
+      {
+        value = loadNumber<long double>( []( char const * s, char ** end ){ return std::strtold( s, end ); } );
+      }
+
+      //! Loads a string from the current node from the current top node
+      template<class CharT, class Traits, class Alloc> inline
+      void loadValue( std::basic_string<CharT, Traits, Alloc> & str )
+      {
+        auto const & value = readValue();
+        str.assign( value.begin(), value.end() );
+      }
+
+      //! Loads the size of the current top node
+      /*! Scans ahead over the children of the node and seeks back to where it started */
+      template <class T> inline
+      void loadSize( T & value )
+      {
+        value = countChildren();
+      }
+
+    protected:
+      //! The kinds of markup returned by nextTag
+      enum class TagType { Start, End, EndOfInput };
+
+      //! A start tag read from the stream
+      struct Tag
+      {
+        std::string name;  //!< The element name
+        bool empty;        //!< Whether the tag was self closing
+        bool preserve;     //!< Whether the element had xml:space="preserve"
+      };
+
+      //! A struct that contains metadata about a node
+      struct NodeInfo
+      {
+        NodeInfo( bool closed_, bool preserve_ ) :
+          closed( closed_ ),
+          preserve( preserve_ ),
+          name( nullptr )
+        { }
+
+        bool closed;       //!< Whether the end tag of this node has been read
+        bool preserve;     //!< Whether whitespace around the value is significant
+        const char * name; //!< The NVP name for next child node
+      }; // NodeInfo
+
+      //! Reads the next start tag of a child of the current node, if there is one and it was not already read
+      void peekChild()
+      {
+        auto & top = itsNodes.back();
+        if( itsHasPending || top.closed )
+          return;
+
+        auto const type = nextTag( itsPending );
+        if( type == TagType::Start )
+          itsHasPending = true;
+        else
+        {
+          // after an error, nodes are treated as closed so that nothing more is read
+          top.closed = true;
+          if( type == TagType::EndOfInput )
+            loadFailed("XML Parsing failed - unexpected end of input");
+        }
+      }
+
+      //! Skips over the content of a child whose start tag was read but not loaded
+      void skipPending()
+      {
+        itsHasPending = false;
+        if( !itsPending.empty )
+          skipContent();
+      }
+
+      //! Skips forward past the end tag matching an already read start tag
+      void skipContent()
+      {
+        for( size_t depth = 1; depth > 0; )
+        {
+          switch( nextTag( itsScratch ) )
+          {
+            case TagType::Start: if( !itsScratch.empty ) ++depth; break;
+            case TagType::End: --depth; break;
+            default: loadFailed("XML Parsing failed - unexpected end of input"); return;
+          }
+        }
+      }
+
+      //! Counts the children of the current node without consuming them
+      /*! @return 0 if an error occurred */
+      size_t countChildren()
+      {
+        if( itsNodes.back().closed )
+          return itsHasPending ? 1 : 0;
+
+        auto const start = itsBuffer->pubseekoff( 0, std::ios_base::cur, std::ios_base::in );
+        if( start == std::streampos( std::streamoff( -1 ) ) )
+        {
+          loadFailed("XML Parsing failed - loading a container size requires a seekable stream");
+          return 0;
+        }
+
+        size_t size = 0;
+        if( itsHasPending )
+        {
+          ++size;
+          if( !itsPending.empty )
+            skipContent();
+        }
+
+        for( ;; )
+        {
+          auto const type = nextTag( itsScratch );
+          if( type == TagType::End )
+            break;
+          else if( type != TagType::Start )
+          {
+            loadFailed("XML Parsing failed - unexpected end of input");
+            return 0;
+          }
+
+          ++size;
+          if( !itsScratch.empty )
+            skipContent();
+        }
+
+        if( itsBuffer->pubseekpos( start, std::ios_base::in ) != start )
+        {
+          loadFailed("XML Parsing failed - could not seek back after loading a container size");
+          return 0;
+        }
+
+        return ok() ? size : 0;
+      }
+
+      //! Reads the text content of the current top node
+      /*! Entities are expanded and surrounding whitespace is trimmed unless the node
+          preserves it */
+      std::string const & readValue()
+      {
+        itsValue.clear();
+        auto const & top = itsNodes.back();
+        if( top.closed || itsHasPending || !ok() )
+          return itsValue;
+
+        for( auto c = itsBuffer->sgetc(); c != '<'; c = itsBuffer->sgetc() )
+        {
+          if( c == std::char_traits<char>::eof() )
+          {
+            loadFailed("XML Parsing failed - unexpected end of input");
+            itsValue.clear();
+            return itsValue;
+          }
+
+          itsBuffer->sbumpc();
+          if( c == '&' )
+            readEntity( itsValue );
+          else
+            itsValue.push_back( static_cast<char>( c ) );
+
+          if( !ok() )
+          {
+            itsValue.clear();
+            return itsValue;
+          }
+        }
+
+        if( !top.preserve )
+        {
+          auto const begin = std::find_if( itsValue.begin(), itsValue.end(), [](char c){ return !xml_detail::isWhitespace( c ); } );
+          auto const end = std::find_if( itsValue.rbegin(), itsValue.rend(), [](char c){ return !xml_detail::isWhitespace( c ); } ).base();
+          if( begin < end )
+            itsValue.assign( begin, end );
+          else
+            itsValue.clear();
+        }
+
+        return itsValue;
+      }
+
+      //! Converts the text content of the current top node to a number with a strto* function
+      /*! If the value is not a number in range, zero is returned and an error is thrown or
+          recorded (see setThrowOnError).  Values that underflow to a denormal are accepted. */
+      template <class T, class Convert> inline
+      T loadNumber( Convert convert )
+      {
+        char const * begin = readValue().c_str();
+        char * end;
+        errno = 0;
+        T const number = convert( begin, &end );
+        if( end == begin || ( errno == ERANGE && std::fpclassify( number ) != FP_SUBNORMAL ) )
+        {
+          loadFailed("XML Parsing failed - could not convert value to number");
+          return T();
+        }
+
+        return number;
+      }
+
+      //! Reports an error caused by the data being loaded
+      void loadFailed( char const * error )
+      {
+        CEREAL_THROW_ON_ERROR(*this, error);
+        setError( error );
+      }
+
+      //! @}
+
+    private:
+      //! Reads a character, reporting an error at the end of the input
+      /*! @return '\0' after an error, callers check ok() to stop reading */
+      char get()
+      {
+        auto const c = ok() ? itsBuffer->sbumpc() : std::char_traits<char>::eof();
+        if( c == std::char_traits<char>::eof() )
+        {
+          loadFailed("XML Parsing failed - unexpected end of input");
+          return '\0';
+        }
+        return static_cast<char>( c );
+      }
+
+      //! Skips input until after the given terminator (at most three characters)
+      void skipPast( const char * terminator )
+      {
+        const size_t length = std::strlen( terminator );
+        char last[3] = {};
+        for( ;; )
+        {
+          last[0] = last[1]; last[1] = last[2]; last[2] = get();
+          if( !ok() || std::memcmp( last + 3 - length, terminator, length ) == 0 )
+            return;
+        }
+      }
+
+      //! Reads the next start or end tag, skipping text, comments and other markup
+      /*! @param tag Filled in with the start tag that was read
+          @return The type of the tag read, EndOfInput after an error */
+      TagType nextTag( Tag & tag )
+      {
+        while( ok() )
+        {
+          // skip any text up to the next markup
+          auto c = itsBuffer->sbumpc();
+          while( c != '<' && c != std::char_traits<char>::eof() )
+            c = itsBuffer->sbumpc();
+
+          if( c == std::char_traits<char>::eof() )
+            return TagType::EndOfInput;
+
+          c = get();
+          if( !ok() )
+            break;
+          else if( c == '/' )
+          {
+            skipPast( ">" );
+            return TagType::End;
+          }
+          else if( c == '?' )
+            skipPast( "?>" );
+          else if( c == '!' )
+          {
+            c = get();
+            if( c == '-' )
+            {
+              get();
+              skipPast( "-->" );
+            }
+            else if( c == '[' )
+              skipPast( "]]>" );
+            else
+              skipPast( ">" );
+          }
+          else
+          {
+            readStartTag( static_cast<char>( c ), tag );
+            return ok() ? TagType::Start : TagType::EndOfInput;
+          }
+        }
+
+        return TagType::EndOfInput;
+      }
+
+      //! Reads the name and attributes of a start tag, after its first name character
+      void readStartTag( char c, Tag & tag )
+      {
+        tag.name.clear();
+        tag.empty = false;
+        tag.preserve = false;
+
+        // get() returns '\0' after an error, which ends the name and attribute loops
+        for( ; c != '\0' && !xml_detail::isWhitespace( c ) && c != '/' && c != '>'; c = get() )
+          tag.name.push_back( c );
+
+        while( ok() )
+        {
+          while( xml_detail::isWhitespace( c ) )
+            c = get();
+
+          if( c == '>' )
+            return;
+          else if( c == '/' )
+          {
+            if( get() != '>' )
+              malformed( "XML Parsing failed - malformed tag", tag.name );
+            tag.empty = true;
+            return;
+          }
+
+          // attribute name
+          itsAttribute.clear();
+          for( ; c != '\0' && !xml_detail::isWhitespace( c ) && c != '='; c = get() )
+            itsAttribute.push_back( c );
+          while( xml_detail::isWhitespace( c ) )
+            c = get();
+          if( c != '=' )
+          {
+            malformed( "XML Parsing failed - malformed attribute in tag", tag.name );
+            return;
+          }
+
+          // attribute value
+          do c = get(); while( xml_detail::isWhitespace( c ) );
+          if( c != '"' && c != '\'' )
+          {
+            malformed( "XML Parsing failed - malformed attribute in tag", tag.name );
+            return;
+          }
+
+          const char quote = c;
+          const bool isSpace = itsAttribute == "xml:space";
+          itsAttribute.clear();
+          for( c = get(); c != '\0' && c != quote; c = get() )
+            itsAttribute.push_back( c );
+
+          if( isSpace )
+            tag.preserve = itsAttribute == "preserve";
+
+          c = get();
+        }
+      }
+
+      //! Reports a malformed tag, naming it in the detailed message
+      void malformed( char const * error, std::string const & tagName )
+      {
+        CEREAL_THROW_ON_ERROR(*this, error + std::string( " <" ) + tagName + ">");
+        setError( error );
+      }
+
+      //! Expands a character or entity reference, after its leading ampersand
+      void readEntity( std::string & out )
+      {
+        char name[12];
+        size_t length = 0;
+        for( char c = get(); c != ';'; c = get() )
+        {
+          if( !ok() )
+            return;
+          if( length == sizeof(name) - 1 )
+          {
+            loadFailed("XML Parsing failed - malformed entity reference");
+            return;
+          }
+          name[length++] = c;
+        }
+        name[length] = '\0';
+
+        if( name[0] == '#' )
+        {
+          const bool hex = name[1] == 'x' || name[1] == 'X';
+          char * end = nullptr;
+          auto const code = std::strtoul( name + ( hex ? 2 : 1 ), &end, hex ? 16 : 10 );
+          if( *end != '\0' || end == name + ( hex ? 2 : 1 ) )
+            loadFailed("XML Parsing failed - malformed character reference");
+          else if( !appendUtf8( out, code ) )
+            loadFailed("XML Parsing failed - invalid character reference");
+        }
+        else if( std::strcmp( name, "lt" ) == 0 )   out.push_back( '<' );
+        else if( std::strcmp( name, "gt" ) == 0 )   out.push_back( '>' );
+        else if( std::strcmp( name, "amp" ) == 0 )  out.push_back( '&' );
+        else if( std::strcmp( name, "quot" ) == 0 ) out.push_back( '"' );
+        else if( std::strcmp( name, "apos" ) == 0 ) out.push_back( '\'' );
+        else
+        {
+          CEREAL_THROW_ON_ERROR(*this, "XML Parsing failed - unknown entity &" + std::string( name ) + ";");
+          setError("XML Parsing failed - unknown entity");
+        }
+      }
+
+      //! Appends a code point encoded as UTF-8
+      /*! @return false if the code point is out of range */
+      static bool appendUtf8( std::string & out, unsigned long code )
+      {
+        if( code < 0x80 )
+          out.push_back( static_cast<char>( code ) );
+        else if( code < 0x800 )
+        {
+          out.push_back( static_cast<char>( 0xC0 | ( code >> 6 ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+        else if( code < 0x10000 )
+        {
+          out.push_back( static_cast<char>( 0xE0 | ( code >> 12 ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+        else if( code < 0x110000 )
+        {
+          out.push_back( static_cast<char>( 0xF0 | ( code >> 18 ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+          out.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+        else
+          return false;
+
+        return true;
+      }
+
+      std::streambuf * itsBuffer;      //!< The buffer of the stream being read
+      std::vector<NodeInfo> itsNodes;  //!< One entry per open node, from the root down
+      Tag itsPending;                  //!< The start tag of the next child, if it has been read
+      bool itsHasPending;              //!< Whether itsPending holds an unloaded child
+      Tag itsScratch;                  //!< Tag storage used while skipping content
+      std::string itsAttribute;        //!< Storage for attribute names and values
+      std::string itsValue;            //!< The text of the most recently loaded value
+  }; // XMLStreamInputArchive
+
+  // ######################################################################
+  // XMLStreamInputArchive prologue and epilogue functions
+  // ######################################################################
+
+  // ######################################################################
+  //! Prologue for NVPs for streaming XML input archives
+  /*! NVPs do not start or finish nodes - they just set up the names */
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  //! Epilogue for NVPs for streaming XML input archives
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, NameValuePair<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for deferred data for streaming XML input archives
+  /*! Do nothing for the defer wrapper */
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  //! Epilogue for deferred data for streaming XML input archives
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, DeferredData<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for SizeTags for streaming XML input archives
+  /*! SizeTags do not start or finish nodes */
+  template <class T> inline
+  void prologue( XMLStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  //! Epilogue for SizeTags for streaming XML input archives
+  template <class T> inline
+  void epilogue( XMLStreamInputArchive &, SizeTag<T> const & )
+  { }
+
+  // ######################################################################
+  //! Prologue for all other types for streaming XML input archives (except minimal types)
+  /*! Starts the next node, which will be given data by the type about to be loaded */
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, XMLStreamInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, XMLStreamInputArchive>::value> = traits::sfinae> inline
+  void prologue( XMLStreamInputArchive & ar, T const & )
+  {
+    ar.startNode();
+  }
+
+  //! Epilogue for all other types for streaming XML input archives (except minimal types)
+  /*! Finishes the node started in the prologue */
+  template <class T, traits::DisableIf<traits::has_minimal_base_class_serialization<T, traits::has_minimal_input_serialization, XMLStreamInputArchive>::value ||
+                                       traits::has_minimal_input_serialization<T, XMLStreamInputArchive>::value> = traits::sfinae> inline
+  void epilogue( XMLStreamInputArchive & ar, T const & )
+  {
+    ar.finishNode();
+  }
+
+  // ######################################################################
+  // XMLStreamInputArchive serialization functions
+  // ######################################################################
+
+  //! Loading NVP types from XML
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, NameValuePair<T> & t )
+  {
+    ar.setNextName( t.name );
+    ar( t.value );
+  }
+
+  //! Loading SizeTags from XML
+  template <class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, SizeTag<T> & st )
+  {
+    ar.loadSize( st.size );
+  }
+
+  //! Loading for POD types from xml
+  template <class T, traits::EnableIf<std::is_arithmetic<T>::value> = traits::sfinae> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, T & t )
+  {
+    ar.loadValue( t );
+  }
+
+  //! loading string from xml
+  template<class CharT, class Traits, class Alloc> inline
+  void CEREAL_LOAD_FUNCTION_NAME( XMLStreamInputArchive & ar, std::basic_string<CharT, Traits, Alloc> & str )
+  {
+    ar.loadValue( str );
+  }
+} // namespace cereal
+
+// register archives for polymorphic support
+CEREAL_REGISTER_ARCHIVE(cereal::XMLStreamInputArchive)
+
+// data loaded by this archive is saved by the XMLOutputArchive, which is already
+// paired with XMLInputArchive, so only the input to output direction is set up
+namespace cereal { namespace traits { namespace detail {
+  template <> struct get_output_from_input<cereal::XMLStreamInputArchive>
+  { using type = cereal::XMLOutputArchive; };
+} } } // end namespaces
+
+#endif // CEREAL_ARCHIVES_XML_STREAM_HPP_
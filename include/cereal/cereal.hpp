@@ -43,6 +43,7 @@
 #include "cereal/macros.hpp"
 #include "cereal/details/traits.hpp"
 #include "cereal/details/helpers.hpp"
+#include "cereal/details/trace.hpp"
 #include "cereal/types/base_class.hpp"
 
 namespace cereal
@@ -266,7 +267,7 @@ namespace cereal
       static std::uint32_t registerVersion()                                     \
       {                                                                          \
         ::cereal::detail::StaticObject<Versions>::getInstance().mapping.emplace( \
-             std::type_index(typeid(TYPE)).hash_code(), VERSION_NUMBER );        \
+          ::cereal::detail::type_index_of<TYPE>().hash_code(), VERSION_NUMBER ); \
         return VERSION_NUMBER;                                                   \
       }                                                                          \
       CEREAL_UNUSED_FUNCTION                                                     \
@@ -298,8 +299,20 @@ namespace cereal
     public:
       //! Construct the output archive
       /*! @param derived A pointer to the derived ArchiveType (pass this from the derived archive) */
-      OutputArchive(ArchiveType * const derived) : self(derived), itsCurrentPointerId(1), itsCurrentPolymorphicTypeId(1)
-      { }
+      OutputArchive(ArchiveType * const derived) : self(derived), itsTopLevelDepth(0), itsCurrentPointerId(1), itsCurrentPolymorphicTypeId(1),
+        itsThrowOnError(CEREAL_EXCEPTIONS != 0), itsError(nullptr)
+      {
+        #if CEREAL_TRACE
+        detail::trace<ArchiveType>( TraceEvent::ArchiveCreated, self, 0 );
+        #endif
+      }
+
+      #if CEREAL_TRACE
+      ~OutputArchive() CEREAL_NOEXCEPT
+      {
+        detail::trace<ArchiveType>( TraceEvent::ArchiveDestroyed, self, itsTracedBytes );
+      }
+      #endif
 
       OutputArchive & operator=( OutputArchive const & ) = delete;
 
@@ -308,6 +321,10 @@ namespace cereal
       template <class ... Types> inline
       ArchiveType & operator()( Types && ... args )
       {
+        TopLevelScope scope( *this );
+        #if CEREAL_TRACE
+        detail::TraceCall<typename detail::trace_call_type<Types...>::type, ArchiveType> trace( *self, itsTracedBytes, itsTopLevelDepth == 1 );
+        #endif
         self->process( std::forward<Types>( args )... );
         return *self;
       }
@@ -316,6 +333,7 @@ namespace cereal
       /*! This will cause any data wrapped in DeferredData to be immediately serialized */
       void serializeDeferments()
       {
+        TopLevelScope scope( *this );
         for( auto & deferment : itsDeferments )
           deferment();
       }
@@ -346,6 +364,7 @@ namespace cereal
       template <class T> inline
       ArchiveType & operator&( T && arg )
       {
+        TopLevelScope scope( *this );
         self->process( std::forward<T>( arg ) );
         return *self;
       }
@@ -357,12 +376,112 @@ namespace cereal
       template <class T> inline
       ArchiveType & operator<<( T && arg )
       {
+        TopLevelScope scope( *this );
         self->process( std::forward<T>( arg ) );
         return *self;
       }
 
       //! @}
 
+      /*! @name Error handling
+          Archives report errors either by throwing or through a sticky error state. */
+      //! @{
+
+      //! Sets whether errors are reported by throwing an Exception
+      /*! By default, an archive throws an Exception as soon as it encounters an error,
+          such as failing to write to its stream.  When this is disabled, the archive
+          records the first error in a sticky error state instead, which can be queried
+          with ok() and error().  The binary archives stop writing once an error occurred.
+
+          Without exceptions (see CEREAL_EXCEPTIONS) archives never throw, regardless of
+          this setting.
+
+          @param throwOnError Whether errors should throw */
+      void setThrowOnError( bool throwOnError )
+      {
+        itsThrowOnError = CEREAL_EXCEPTIONS && throwOnError;
+      }
+
+      //! Whether errors are reported by throwing an Exception
+      /*! @sa setThrowOnError */
+      bool throwsOnError() const
+      {
+        return itsThrowOnError;
+      }
+
+      //! Whether no error has occurred so far
+      /*! @sa setThrowOnError */
+      bool ok() const
+      {
+        return itsError == nullptr;
+      }
+
+      //! The first error that occurred, or nullptr if there was none
+      /*! @sa setThrowOnError */
+      char const * error() const
+      {
+        return itsError;
+      }
+
+      //! Reports an error that occurred while saving
+      /*! Throws an Exception with the given message if the archive throws on errors,
+          and records it otherwise.  Only the first error is kept.
+
+          @param error A description of the error, which must outlive the archive
+          @internal */
+      void setError( char const * error )
+      {
+        #if CEREAL_EXCEPTIONS
+        if( itsThrowOnError )
+          throw Exception( error );
+        #endif
+
+        if( !itsError )
+          itsError = error;
+      }
+
+      //! @}
+
+      #if CEREAL_TRACE
+      //! The number of bytes the archive processed so far, as reported to tracing
+      /*! Archives that do not count their bytes report 0, see TraceRecord::bytes */
+      std::uint64_t tracedBytes() const
+      {
+        return itsTracedBytes;
+      }
+      #endif // CEREAL_TRACE
+
+      //! Starts a new epoch, forgetting the identity of all previously saved pointers
+      /*! Pointer tracking state normally lives as long as the archive, which keeps it
+          growing when a single archive is used for a long running stream of data.  Calling
+          this at a boundary in the stream (e.g. between messages) drops that state, so any
+          pointer saved after this point is saved in full again, even if it was seen before.
+
+          A marker is written to the archive so that the matching call to
+          InputArchive::startEpoch at the same point of the load can verify the boundary and
+          drop its own state, including its references to previously loaded shared pointers.
+
+          @param retainTypeInfo Whether polymorphic type names and class versions already
+                                written stay registered.  If true, they are not written again
+                                after the boundary.  The choice is recorded in the marker, so
+                                the input archive needs no matching argument. */
+      void startEpoch( bool retainTypeInfo = true )
+      {
+        self->process( make_nvp<ArchiveType>("cereal_epoch",
+                         detail::epoch_marker | (retainTypeInfo ? detail::epoch_retain_type_info : 0)) );
+
+        itsSharedPointerMap.clear();
+        itsCurrentPointerId = 1;
+        itsBaseClassSet.clear();
+
+        if( !retainTypeInfo )
+        {
+          itsPolymorphicTypeMap.clear();
+          itsCurrentPolymorphicTypeId = 1;
+          itsVersionedTypes.clear();
+        }
+      }
+
       //! Registers a shared pointer with the archive
       /*! This function is used to track shared pointer targets to prevent
           unnecessary saves from taking place if multiple shared pointers
@@ -387,6 +506,29 @@ namespace cereal
           return id->second;
       }
 
+      //! Saves the object behind a chained pointer, see cereal::chain
+      /*! The object is pushed onto a work stack.  If no chain is being saved yet,
+          the stack is then drained right away, so objects reached through further
+          chained pointers are saved one after another instead of recursively.
+
+          @internal
+          @param save Saves the object at the given address
+          @param addr The address of the object */
+      void saveChained( void (*save)( ArchiveType &, void const * ), void const * addr )
+      {
+        itsChainedObjects.emplace_back( save, addr );
+        if( itsChaining )
+          return;
+
+        ChainScope scope( *this );
+        while( !itsChainedObjects.empty() )
+        {
+          auto const object = itsChainedObjects.back();
+          itsChainedObjects.pop_back();
+          object.first( *self, object.second );
+        }
+      }
+
       //! Registers a polymorphic type name with the archive
       /*! This function is used to track polymorphic types to prevent
           unnecessary saves of identifying strings used by the polymorphic
@@ -416,6 +558,9 @@ namespace cereal
         prologue( *self, head );
         self->processImpl( head );
         epilogue( *self, head );
+        #if CEREAL_TRACE
+        detail::trace_size_tag( *self, head );
+        #endif
       }
 
       //! Unwinds to process all data
@@ -431,12 +576,8 @@ namespace cereal
       template <class T> inline
       ArchiveType & processImpl(virtual_base_class<T> const & b)
       {
-        traits::detail::base_class_id id(b.base_ptr);
-        if(itsBaseClassSet.count(id) == 0)
-        {
-          itsBaseClassSet.insert(id);
+        if(itsBaseClassSet.insert( traits::detail::base_class_id(b.base_ptr) ))
           self->processImpl( *b.base_ptr );
-        }
         return *self;
       }
 
@@ -568,7 +709,7 @@ namespace cereal
       template <class T> inline
       std::uint32_t registerClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
+        static const auto hash = detail::type_index_of<T>().hash_code();
         const auto insertResult = itsVersionedTypes.insert( hash );
         const auto lock = detail::StaticObject<detail::Versions>::lock();
         const auto version =
@@ -637,10 +778,59 @@ namespace cereal
     #undef PROCESS_IF
 
     private:
+      //! Tracks nesting of calls made to the archive
+      /*! Virtual base classes only need to be tracked while the object containing
+          them is being serialized, which always completes within a single outermost
+          call to the archive.  The tracked virtual bases are forgotten once that call
+          returns, so memory use stays flat when a long lived archive streams many
+          objects.
+          @internal */
+      class TopLevelScope
+      {
+        public:
+          TopLevelScope( OutputArchive & ar ) : itsArchive( ar ) { ++itsArchive.itsTopLevelDepth; }
+
+          ~TopLevelScope()
+          {
+            if( --itsArchive.itsTopLevelDepth == 0 && !itsArchive.itsBaseClassSet.empty() )
+              itsArchive.itsBaseClassSet.clear();
+          }
+
+          TopLevelScope( TopLevelScope const & ) = delete;
+          TopLevelScope & operator=( TopLevelScope const & ) = delete;
+
+        private:
+          OutputArchive & itsArchive;
+      };
+
+      //! Marks a chain as being saved, see saveChained
+      /*! Leaves the work stack empty even if saving an object throws.
+          @internal */
+      class ChainScope
+      {
+        public:
+          ChainScope( OutputArchive & ar ) : itsArchive( ar ) { itsArchive.itsChaining = true; }
+
+          ~ChainScope()
+          {
+            itsArchive.itsChaining = false;
+            itsArchive.itsChainedObjects.clear();
+          }
+
+          ChainScope( ChainScope const & ) = delete;
+          ChainScope & operator=( ChainScope const & ) = delete;
+
+        private:
+          OutputArchive & itsArchive;
+      };
+
       ArchiveType * const self;
 
-      //! A set of all base classes that have been serialized
-      std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
+      //! The virtual base classes serialized during the current outermost call
+      traits::detail::BaseClassSet itsBaseClassSet;
+
+      //! The number of nested calls currently being made to the archive
+      std::size_t itsTopLevelDepth;
 
       //! Maps from addresses to pointer ids
       std::unordered_map<void const *, std::uint32_t> itsSharedPointerMap;
@@ -656,6 +846,31 @@ namespace cereal
 
       //! Keeps track of classes that have versioning information associated with them
       std::unordered_set<size_type> itsVersionedTypes;
+
+      //! Objects behind chained pointers that still need to be saved
+      std::vector<std::pair<void (*)( ArchiveType &, void const * ), void const *>> itsChainedObjects;
+
+      //! Whether a chain is currently being saved
+      bool itsChaining = false;
+
+      //! Whether errors are thrown rather than recorded
+      bool itsThrowOnError;
+
+      //! The first error that occurred, if any
+      char const * itsError;
+
+    #if CEREAL_TRACE
+    protected:
+      //! Counts bytes processed by the derived archive, see tracedBytes
+      void addTracedBytes( std::streamsize size )
+      {
+        itsTracedBytes += static_cast<std::uint64_t>( size );
+      }
+
+    private:
+      //! The number of bytes processed so far
+      std::uint64_t itsTracedBytes = 0;
+    #endif // CEREAL_TRACE
   }; // class OutputArchive
 
   // ######################################################################
@@ -684,10 +899,26 @@ namespace cereal
       InputArchive(ArchiveType * const derived) :
         self(derived),
         itsBaseClassSet(),
+        itsTopLevelDepth(0),
         itsSharedPointerMap(),
         itsPolymorphicTypeMap(),
-        itsVersionedTypes()
-      { }
+        itsVersionedTypes(),
+        itsTrustedSource(false),
+        itsReuseStorage(false),
+        itsThrowOnError(CEREAL_EXCEPTIONS != 0),
+        itsError(nullptr)
+      {
+        #if CEREAL_TRACE
+        detail::trace<ArchiveType>( TraceEvent::ArchiveCreated, self, 0 );
+        #endif
+      }
+
+      #if CEREAL_TRACE
+      ~InputArchive() CEREAL_NOEXCEPT
+      {
+        detail::trace<ArchiveType>( TraceEvent::ArchiveDestroyed, self, itsTracedBytes );
+      }
+      #endif
 
       InputArchive & operator=( InputArchive const & ) = delete;
 
@@ -696,6 +927,10 @@ namespace cereal
       template <class ... Types> inline
       ArchiveType & operator()( Types && ... args )
       {
+        TopLevelScope scope( *this );
+        #if CEREAL_TRACE
+        detail::TraceCall<typename detail::trace_call_type<Types...>::type, ArchiveType> trace( *self, itsTracedBytes, itsTopLevelDepth == 1 );
+        #endif
         process( std::forward<Types>( args )... );
         return *self;
       }
@@ -704,6 +939,7 @@ namespace cereal
       /*! This will cause any data wrapped in DeferredData to be immediately serialized */
       void serializeDeferments()
       {
+        TopLevelScope scope( *this );
         for( auto & deferment : itsDeferments )
           deferment();
       }
@@ -734,6 +970,7 @@ namespace cereal
       template <class T> inline
       ArchiveType & operator&( T && arg )
       {
+        TopLevelScope scope( *this );
         self->process( std::forward<T>( arg ) );
         return *self;
       }
@@ -745,12 +982,167 @@ namespace cereal
       template <class T> inline
       ArchiveType & operator>>( T && arg )
       {
+        TopLevelScope scope( *this );
         self->process( std::forward<T>( arg ) );
         return *self;
       }
 
       //! @}
 
+      //! Marks the data loaded by this archive as coming from a trusted source
+      /*! Trusted data is assumed to have been written by the matching cereal output
+          archive and not altered since.  Load functions can query this to skip
+          re-establishing invariants the writer already guaranteed, for example
+          re-heapifying a std::priority_queue, comparing the already sorted keys
+          of ordered associative containers, or hashing the keys of containers using
+          PersistedHash.
+
+          Loading data that does not meet these guarantees in trusted mode can leave
+          containers with broken invariants.  By default archives are not trusted
+          and loading behaves exactly as if this option did not exist.
+
+          @param trusted Whether the source of this archive is trusted */
+      void setTrustedSource( bool trusted )
+      {
+        itsTrustedSource = trusted;
+      }
+
+      //! Whether the data loaded by this archive comes from a trusted source
+      /*! @sa setTrustedSource */
+      bool isTrustedSource() const
+      {
+        return itsTrustedSource;
+      }
+
+      //! Lets load functions reuse the storage of the objects they load into
+      /*! This is meant for reloading the same objects periodically.  The elements of
+          ordered and unordered maps and sets are then loaded into the nodes the
+          containers already hold, rather than freeing every node and allocating new
+          ones.  Together with strings, vectors and lists, which always keep their
+          storage when loaded into, reloading data of the same shape then allocates
+          nearly nothing.
+
+          Reusing nodes requires the node handles of C++17, without them this option
+          has no effect.  Elements are loaded into existing objects, so their load
+          functions must overwrite all of their state, as they must already for elements
+          of vectors.  By default storage is not reused.
+
+          @param reuse Whether load functions may reuse storage */
+      void setReuseStorage( bool reuse )
+      {
+        itsReuseStorage = reuse;
+      }
+
+      //! Whether load functions may reuse the storage of the objects they load into
+      /*! @sa setReuseStorage */
+      bool reusesStorage() const
+      {
+        return itsReuseStorage;
+      }
+
+      /*! @name Error handling
+          Archives report errors either by throwing or through a sticky error state. */
+      //! @{
+
+      //! Sets whether errors are reported by throwing an Exception
+      /*! By default, an archive throws an Exception as soon as it encounters an error,
+          such as reaching the end of its input early or finding an invalid pointer id.
+          When this is disabled, the archive records the first error in a sticky error
+          state instead, which can be queried with ok() and error().  This avoids the
+          cost of exceptions where malformed input is expected rather than exceptional.
+
+          Once an error occurred, archives stop reading and load zeroed values instead,
+          so that sizes read as zero and the remaining load finishes quickly.  The JSON
+          and XML archives parse their input when they are constructed, so a parse error
+          is thrown before this can be called, unless exceptions are disabled.
+
+          Without exceptions (see CEREAL_EXCEPTIONS) archives never throw, regardless of
+          this setting.
+
+          @param throwOnError Whether errors should throw */
+      void setThrowOnError( bool throwOnError )
+      {
+        itsThrowOnError = CEREAL_EXCEPTIONS && throwOnError;
+      }
+
+      //! Whether errors are reported by throwing an Exception
+      /*! @sa setThrowOnError */
+      bool throwsOnError() const
+      {
+        return itsThrowOnError;
+      }
+
+      //! Whether no error has occurred so far
+      /*! @sa setThrowOnError */
+      bool ok() const
+      {
+        return itsError == nullptr;
+      }
+
+      //! The first error that occurred, or nullptr if there was none
+      /*! @sa setThrowOnError */
+      char const * error() const
+      {
+        return itsError;
+      }
+
+      //! Reports an error that occurred while loading
+      /*! Throws an Exception with the given message if the archive throws on errors,
+          and records it otherwise.  Only the first error is kept.
+
+          @param error A description of the error, which must outlive the archive
+          @internal */
+      void setError( char const * error )
+      {
+        #if CEREAL_EXCEPTIONS
+        if( itsThrowOnError )
+          throw Exception( error );
+        #endif
+
+        if( !itsError )
+          itsError = error;
+      }
+
+      //! @}
+
+      #if CEREAL_TRACE
+      //! The number of bytes the archive processed so far, as reported to tracing
+      /*! Archives that do not count their bytes report 0, see TraceRecord::bytes */
+      std::uint64_t tracedBytes() const
+      {
+        return itsTracedBytes;
+      }
+      #endif // CEREAL_TRACE
+
+      //! Starts a new epoch at a boundary marked by OutputArchive::startEpoch
+      /*! This must be called at the same point of the load at which the output archive
+          started its epoch.  It releases all shared pointers loaded so far, so their lifetime
+          is no longer tied to the archive, and drops the type information that the output
+          archive chose not to retain.
+
+          @throws Exception if no epoch marker is found at this point of the archive, unless
+                            errors are recorded instead (see setThrowOnError) */
+      void startEpoch()
+      {
+        std::uint32_t marker = 0;
+        self->process( make_nvp<ArchiveType>("cereal_epoch", marker) );
+
+        if( (marker & ~detail::epoch_retain_type_info) != detail::epoch_marker )
+        {
+          setError("Error while trying to start an epoch. No epoch marker found in the archive");
+          return;
+        }
+
+        itsSharedPointerMap.clear();
+        itsBaseClassSet.clear();
+
+        if( !(marker & detail::epoch_retain_type_info) )
+        {
+          itsPolymorphicTypeMap.clear();
+          itsVersionedTypes.clear();
+        }
+      }
+
       //! Retrieves a shared pointer given a unique key for it
       /*! This is used to retrieve a previously registered shared_ptr
           which has already been loaded.
@@ -758,14 +1150,19 @@ namespace cereal
           @internal
           @param id The unique id that was serialized for the pointer
           @return A shared pointer to the data
-          @throw Exception if the id does not exist */
+          @throw Exception if the id does not exist, unless errors are recorded instead
+                           (see setThrowOnError), in which case a null pointer is returned */
       inline std::shared_ptr<void> getSharedPointer(std::uint32_t const id)
       {
         if(id == 0) return std::shared_ptr<void>(nullptr);
 
         auto iter = itsSharedPointerMap.find( id );
         if(iter == itsSharedPointerMap.end())
-          throw Exception("Error while trying to deserialize a smart pointer. Could not find id " + std::to_string(id));
+        {
+          CEREAL_THROW_ON_ERROR(*this, "Error while trying to deserialize a smart pointer. Could not find id " + std::to_string(id));
+          setError("Error while trying to deserialize a smart pointer. Could not find id");
+          return std::shared_ptr<void>(nullptr);
+        }
 
         return iter->second;
       }
@@ -783,19 +1180,45 @@ namespace cereal
         itsSharedPointerMap[stripped_id] = ptr;
       }
 
+      //! Loads the object behind a chained pointer, see cereal::chain
+      /*! The object, which must already be constructed, is pushed onto a work stack.
+          If no chain is being loaded yet, the stack is then drained right away, in the
+          same order as OutputArchive::saveChained.
+
+          @internal
+          @param load Loads the object at the given address
+          @param addr The address of the object */
+      void loadChained( void (*load)( ArchiveType &, void * ), void * addr )
+      {
+        itsChainedObjects.emplace_back( load, addr );
+        if( itsChaining )
+          return;
+
+        ChainScope scope( *this );
+        while( !itsChainedObjects.empty() )
+        {
+          auto const object = itsChainedObjects.back();
+          itsChainedObjects.pop_back();
+          object.first( *self, object.second );
+        }
+      }
+
       //! Retrieves the string for a polymorphic type given a unique key for it
       /*! This is used to retrieve a string previously registered during
           a polymorphic load.
 
           @internal
           @param id The unique id that was serialized for the polymorphic type
-          @return The string identifier for the tyep */
+          @return The string identifier for the tyep, or an empty string if the id does not
+                  exist and errors are recorded instead of thrown (see setThrowOnError) */
       inline std::string getPolymorphicName(std::uint32_t const id)
       {
         auto name = itsPolymorphicTypeMap.find( id );
         if(name == itsPolymorphicTypeMap.end())
         {
-          throw Exception("Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
+          CEREAL_THROW_ON_ERROR(*this, "Error while trying to deserialize a polymorphic pointer. Could not find type id " + std::to_string(id));
+          setError("Error while trying to deserialize a polymorphic pointer. Could not find type id");
+          return std::string();
         }
         return name->second;
       }
@@ -821,6 +1244,9 @@ namespace cereal
         prologue( *self, head );
         self->processImpl( head );
         epilogue( *self, head );
+        #if CEREAL_TRACE
+        detail::trace_size_tag( *self, head );
+        #endif
       }
 
       //! Unwinds to process all data
@@ -836,12 +1262,8 @@ namespace cereal
       template <class T> inline
       ArchiveType & processImpl(virtual_base_class<T> & b)
       {
-        traits::detail::base_class_id id(b.base_ptr);
-        if(itsBaseClassSet.count(id) == 0)
-        {
-          itsBaseClassSet.insert(id);
+        if(itsBaseClassSet.insert( traits::detail::base_class_id(b.base_ptr) ))
           self->processImpl( *b.base_ptr );
-        }
         return *self;
       }
 
@@ -982,7 +1404,7 @@ namespace cereal
       template <class T> inline
       std::uint32_t loadClassVersion()
       {
-        static const auto hash = std::type_index(typeid(T)).hash_code();
+        static const auto hash = detail::type_index_of<T>().hash_code();
         auto lookupResult = itsVersionedTypes.find( hash );
 
         if( lookupResult != itsVersionedTypes.end() ) // already exists
@@ -1067,10 +1489,59 @@ namespace cereal
       #undef PROCESS_IF
 
     private:
+      //! Tracks nesting of calls made to the archive
+      /*! Virtual base classes only need to be tracked while the object containing
+          them is being serialized, which always completes within a single outermost
+          call to the archive.  The tracked virtual bases are forgotten once that call
+          returns, so memory use stays flat when a long lived archive streams many
+          objects.
+          @internal */
+      class TopLevelScope
+      {
+        public:
+          TopLevelScope( InputArchive & ar ) : itsArchive( ar ) { ++itsArchive.itsTopLevelDepth; }
+
+          ~TopLevelScope()
+          {
+            if( --itsArchive.itsTopLevelDepth == 0 && !itsArchive.itsBaseClassSet.empty() )
+              itsArchive.itsBaseClassSet.clear();
+          }
+
+          TopLevelScope( TopLevelScope const & ) = delete;
+          TopLevelScope & operator=( TopLevelScope const & ) = delete;
+
+        private:
+          InputArchive & itsArchive;
+      };
+
+      //! Marks a chain as being loaded, see loadChained
+      /*! Leaves the work stack empty even if loading an object throws.
+          @internal */
+      class ChainScope
+      {
+        public:
+          ChainScope( InputArchive & ar ) : itsArchive( ar ) { itsArchive.itsChaining = true; }
+
+          ~ChainScope()
+          {
+            itsArchive.itsChaining = false;
+            itsArchive.itsChainedObjects.clear();
+          }
+
+          ChainScope( ChainScope const & ) = delete;
+          ChainScope & operator=( ChainScope const & ) = delete;
+
+        private:
+          InputArchive & itsArchive;
+      };
+
       ArchiveType * const self;
 
-      //! A set of all base classes that have been serialized
-      std::unordered_set<traits::detail::base_class_id, traits::detail::base_class_id_hash> itsBaseClassSet;
+      //! The virtual base classes loaded during the current outermost call
+      traits::detail::BaseClassSet itsBaseClassSet;
+
+      //! The number of nested calls currently being made to the archive
+      std::size_t itsTopLevelDepth;
 
       //! Maps from pointer ids to metadata
       std::unordered_map<std::uint32_t, std::shared_ptr<void>> itsSharedPointerMap;
@@ -1080,6 +1551,37 @@ namespace cereal
 
       //! Maps from type hash codes to version numbers
       std::unordered_map<std::size_t, std::uint32_t> itsVersionedTypes;
+
+      //! Objects behind chained pointers that still need to be loaded
+      std::vector<std::pair<void (*)( ArchiveType &, void * ), void *>> itsChainedObjects;
+
+      //! Whether a chain is currently being loaded
+      bool itsChaining = false;
+
+      //! Whether load functions may take fast paths for data from a trusted writer
+      bool itsTrustedSource;
+
+      //! Whether load functions may reuse the storage of the objects they load into
+      bool itsReuseStorage;
+
+      //! Whether errors are thrown rather than recorded
+      bool itsThrowOnError;
+
+      //! The first error that occurred, if any
+      char const * itsError;
+
+    #if CEREAL_TRACE
+    protected:
+      //! Counts bytes processed by the derived archive, see tracedBytes
+      void addTracedBytes( std::streamsize size )
+      {
+        itsTracedBytes += static_cast<std::uint64_t>( size );
+      }
+
+    private:
+      //! The number of bytes processed so far
+      std::uint64_t itsTracedBytes = 0;
+    #endif // CEREAL_TRACE
   }; // class InputArchive
 } // namespace cereal
 
@@ -0,0 +1,542 @@
+/*! \file chunked.hpp
+    \brief Archives split into independently loadable chunks, loaded in parallel on NUMA nodes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_CHUNKED_HPP_
+#define CEREAL_CHUNKED_HPP_
+
+#include "cereal/details/helpers.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace cereal
+{
+  namespace chunked_detail
+  {
+    //! Marks the end of a chunked archive ("CRLCHNK1" in little endian)
+    static const std::uint64_t magic = 0x314b4e48434c5243ull;
+
+    //! Size of the trailer: chunk count and magic
+    static const std::size_t trailer_size = 2 * sizeof(std::uint64_t);
+
+    //! The index and trailer are little endian regardless of the archive, so they can be found before choosing one
+    inline void write_u64( std::ostream & os, std::uint64_t value )
+    {
+      char bytes[sizeof(value)];
+      for( std::size_t i = 0; i < sizeof(value); ++i )
+        bytes[i] = static_cast<char>( ( value >> ( 8 * i ) ) & 0xff );
+      os.write( bytes, sizeof(bytes) );
+    }
+
+    inline std::uint64_t read_u64( char const * data )
+    {
+      std::uint64_t value = 0;
+      for( std::size_t i = 0; i < sizeof(value); ++i )
+        value |= static_cast<std::uint64_t>( static_cast<unsigned char>( data[i] ) ) << ( 8 * i );
+      return value;
+    }
+
+    //! Reports a malformed or unwritable chunked archive
+    /*! Throws an Exception, or does nothing if exceptions are disabled, in which case the
+        caller returns false.  Unlike CEREAL_THROW_EXCEPTION this does not abort, since
+        these errors come from the data rather than from misuse. */
+    inline void failed( char const * what )
+    {
+      #if CEREAL_EXCEPTIONS
+      throw Exception( what );
+      #else
+      (void)what;
+      #endif
+    }
+
+    //! A stream buffer that forwards to another one, counting the bytes written
+    class CountingStreambuf : public std::streambuf
+    {
+      public:
+        explicit CountingStreambuf( std::streambuf & target ) : itsTarget( target ), itsCount( 0 ) { }
+
+        std::uint64_t count() const { return itsCount; }
+
+      protected:
+        std::streamsize xsputn( char const * s, std::streamsize n ) override
+        {
+          auto const written = itsTarget.sputn( s, n );
+          itsCount += static_cast<std::uint64_t>( written );
+          return written;
+        }
+
+        int_type overflow( int_type c ) override
+        {
+          if( traits_type::eq_int_type( c, traits_type::eof() ) )
+            return traits_type::not_eof( c );
+
+          auto const result = itsTarget.sputc( traits_type::to_char_type( c ) );
+          if( !traits_type::eq_int_type( result, traits_type::eof() ) )
+            ++itsCount;
+          return result;
+        }
+
+        int sync() override
+        {
+          return itsTarget.pubsync();
+        }
+
+      private:
+        std::streambuf & itsTarget;
+        std::uint64_t itsCount;
+    };
+
+    //! A read only stream buffer over one chunk
+    class ChunkStreambuf : public std::streambuf
+    {
+      public:
+        ChunkStreambuf( char const * data, std::size_t size )
+        {
+          char * begin = const_cast<char *>( data );
+          setg( begin, begin, begin + size );
+        }
+    };
+
+    //! Parses a list of CPUs or nodes in the kernel's format, e.g. "0-3,8,10-11"
+    inline std::vector<int> parse_list( std::string const & list )
+    {
+      std::vector<int> values;
+      char const * pos = list.c_str();
+      while( *pos )
+      {
+        char * end;
+        long const first = std::strtol( pos, &end, 10 );
+        long last = first;
+        if( end == pos )
+          return {};
+
+        if( *end == '-' )
+        {
+          pos = end + 1;
+          last = std::strtol( pos, &end, 10 );
+          if( end == pos )
+            return {};
+        }
+
+        for( long value = first; value <= last; ++value )
+          values.push_back( static_cast<int>( value ) );
+
+        pos = *end == ',' ? end + 1 : end;
+        if( *end != ',' && *end != '\0' )
+          return {};
+      }
+      return values;
+    }
+
+    inline bool read_line( std::string const & path, std::string & line )
+    {
+      std::ifstream is( path );
+      return static_cast<bool>( std::getline( is, line ) );
+    }
+
+    //! Restricts the calling thread to some CPUs, leaving it unrestricted if that fails or the list is empty
+    inline void pin_to_cpus( std::vector<int> const & cpus )
+    {
+      #ifdef __linux__
+      if( cpus.empty() )
+        return;
+
+      cpu_set_t set;
+      CPU_ZERO( &set );
+      for( int cpu : cpus )
+        if( cpu >= 0 && cpu < CPU_SETSIZE )
+          CPU_SET( cpu, &set );
+
+      pthread_setaffinity_np( pthread_self(), sizeof(set), &set );
+      #else
+      static_cast<void>( cpus );
+      #endif
+    }
+  } // namespace chunked_detail
+
+  // ######################################################################
+  //! The NUMA nodes chunks are loaded on, and the CPUs that belong to each
+  /*! Nodes are numbered densely from 0, skipping nodes without CPUs this process may run on.
+      A topology with a single node has no CPU list, so threads are not pinned.  This is what
+      is detected on machines without NUMA, and on platforms other than Linux. */
+  class NumaTopology
+  {
+    public:
+      //! A single node spanning all CPUs
+      NumaTopology() : itsCpus( 1 ) { }
+
+      //! A topology with the given CPUs for each node
+      /*! An empty list of nodes is treated as a single node */
+      explicit NumaTopology( std::vector<std::vector<int>> cpusOfNodes ) :
+        itsCpus( std::move( cpusOfNodes ) )
+      {
+        if( itsCpus.empty() )
+          itsCpus.resize( 1 );
+      }
+
+      //! The topology of this machine, detected once from /sys/devices/system/node
+      static NumaTopology const & system()
+      {
+        static NumaTopology const topology = detect();
+        return topology;
+      }
+
+      //! The number of nodes
+      std::size_t nodes() const { return itsCpus.size(); }
+
+      //! The CPUs of a node, empty if threads are not pinned to it
+      std::vector<int> const & cpus( std::size_t node ) const { return itsCpus[node]; }
+
+      //! The node a CPU belongs to, or 0 if it is not part of any
+      std::size_t nodeOfCpu( int cpu ) const
+      {
+        for( std::size_t node = 0; node < itsCpus.size(); ++node )
+          if( std::find( itsCpus[node].begin(), itsCpus[node].end(), cpu ) != itsCpus[node].end() )
+            return node;
+        return 0;
+      }
+
+      //! The node the calling thread is currently running on
+      std::size_t currentNode() const
+      {
+        #ifdef __linux__
+        if( itsCpus.size() > 1 )
+          return nodeOfCpu( sched_getcpu() );
+        #endif
+        return 0;
+      }
+
+    private:
+      static NumaTopology detect()
+      {
+        #ifdef __linux__
+        std::string online;
+        if( !chunked_detail::read_line( "/sys/devices/system/node/online", online ) )
+          return NumaTopology();
+
+        cpu_set_t allowed;
+        bool const restricted = sched_getaffinity( 0, sizeof(allowed), &allowed ) == 0;
+
+        std::vector<std::vector<int>> nodes;
+        for( int node : chunked_detail::parse_list( online ) )
+        {
+          std::string list;
+          if( !chunked_detail::read_line( "/sys/devices/system/node/node" + std::to_string( node ) + "/cpulist", list ) )
+            continue;
+
+          std::vector<int> cpus;
+          for( int cpu : chunked_detail::parse_list( list ) )
+            if( !restricted || ( cpu < CPU_SETSIZE && CPU_ISSET( cpu, &allowed ) ) )
+              cpus.push_back( cpu );
+
+          if( !cpus.empty() )
+            nodes.push_back( std::move( cpus ) );
+        }
+
+        if( nodes.size() > 1 )
+          return NumaTopology( std::move( nodes ) );
+        #endif
+        return NumaTopology();
+      }
+
+      std::vector<std::vector<int>> itsCpus;
+  };
+
+  class ChunkedLoadOptions;
+
+  namespace chunked_detail
+  {
+    template <class Archive, class Container>
+    bool load_chunks( char const * data, std::size_t size, Container & chunks, ChunkedLoadOptions const & options );
+  }
+
+  // ######################################################################
+  //! Options for load_chunked
+  /*! Options can either be directly passed to load_chunked, or chained using the
+      modifier functions for an interface analogous to named parameters:
+
+      @code{.cpp}
+      cereal::load_chunked<cereal::BinaryInputArchive>( data, size, shards,
+        cereal::ChunkedLoadOptions().nodeOfChunk( []( std::size_t chunk ){ return ownerNode[chunk]; } ) );
+      @endcode */
+  class ChunkedLoadOptions
+  {
+    public:
+      //! Default options: the detected topology, chunks spread round robin, one thread per CPU
+      static ChunkedLoadOptions Default(){ return ChunkedLoadOptions(); }
+
+      ChunkedLoadOptions() :
+        itsTopology( NumaTopology::system() ),
+        itsThreadsPerNode( 0 )
+      { }
+
+      /*! @name Option Modifiers
+          An interface for setting option settings analogous to named parameters.
+
+          @code{cpp}
+          cereal::ChunkedLoadOptions()
+            .nodeOfChunk( owner )
+            .threadsPerNode( 4 )
+          @endcode
+          */
+      //! @{
+
+      //! The nodes to load on, NumaTopology::system() by default
+      ChunkedLoadOptions & topology( NumaTopology value ){ itsTopology = std::move( value ); return *this; }
+      //! The node whose threads will use each chunk, taken modulo the number of nodes
+      /*! By default chunk i is loaded on node i % nodes. */
+      ChunkedLoadOptions & nodeOfChunk( std::function<std::size_t( std::size_t )> value ){ itsNodeOfChunk = std::move( value ); return *this; }
+      //! The number of threads loading on each node (0 for one per CPU of the node)
+      ChunkedLoadOptions & threadsPerNode( std::size_t value ){ itsThreadsPerNode = value; return *this; }
+
+      //! @}
+
+    private:
+      template <class Archive, class Container>
+      friend bool chunked_detail::load_chunks( char const *, std::size_t, Container &, ChunkedLoadOptions const & );
+
+      NumaTopology itsTopology;
+      std::function<std::size_t( std::size_t )> itsNodeOfChunk;
+      std::size_t itsThreadsPerNode;
+  };
+
+  // ######################################################################
+  //! Saves each element of a container as its own chunk, followed by an index of the chunks
+  /*! Each chunk is saved with a fresh Archive, so it can be loaded without the others,
+      see load_chunked.  Shared pointers are therefore not shared between chunks.
+
+      The chunks are followed by the offset of each chunk and the end of the last one,
+      the number of chunks and a marker, all as little endian std::uint64_t.
+
+      @return false if an archive that does not throw recorded an error, or if exceptions
+              are disabled and writing to the stream failed
+      @throws Exception if writing to the stream fails */
+  template <class Archive, class Container> inline
+  bool save_chunked( std::ostream & os, Container const & chunks )
+  {
+    chunked_detail::CountingStreambuf counter( *os.rdbuf() );
+    std::ostream counted( &counter );
+
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve( static_cast<std::size_t>( std::distance( chunks.begin(), chunks.end() ) ) + 1 );
+
+    for( auto const & chunk : chunks )
+    {
+      offsets.push_back( counter.count() );
+      Archive ar( counted );
+      ar( chunk );
+      if( !ar.ok() )
+        return false;
+    }
+    offsets.push_back( counter.count() );
+
+    for( auto offset : offsets )
+      chunked_detail::write_u64( counted, offset );
+    chunked_detail::write_u64( counted, offsets.size() - 1 );
+    chunked_detail::write_u64( counted, chunked_detail::magic );
+
+    if( !counted.flush() )
+    {
+      chunked_detail::failed( "Failed to write chunked archive" );
+      return false;
+    }
+
+    return true;
+  }
+
+  namespace chunked_detail
+  {
+    //! Implementation of load_chunked
+    template <class Archive, class Container> inline
+    bool load_chunks( char const * data, std::size_t size, Container & chunks, ChunkedLoadOptions const & options )
+    {
+      if( size < trailer_size || read_u64( data + size - sizeof(std::uint64_t) ) != magic )
+      {
+        failed( "Not a chunked archive" );
+        return false;
+      }
+
+      std::uint64_t const count = read_u64( data + size - trailer_size );
+      std::uint64_t const available = ( size - trailer_size ) / sizeof(std::uint64_t);
+      if( count >= available )
+      {
+        failed( "Chunked archive index is larger than the archive" );
+        return false;
+      }
+
+      std::uint64_t const indexOffset = size - trailer_size - ( count + 1 ) * sizeof(std::uint64_t);
+      std::vector<std::uint64_t> offsets( static_cast<std::size_t>( count + 1 ) );
+      for( std::size_t i = 0; i < offsets.size(); ++i )
+      {
+        offsets[i] = read_u64( data + indexOffset + i * sizeof(std::uint64_t) );
+        if( ( i > 0 && offsets[i] < offsets[i - 1] ) || offsets[i] > indexOffset )
+        {
+          failed( "Chunked archive index is corrupted" );
+          return false;
+        }
+      }
+
+      chunks.clear();
+      chunks.resize( static_cast<std::size_t>( count ) );
+
+      auto const & topology = options.itsTopology;
+      std::size_t const nodes = topology.nodes();
+
+      std::vector<std::vector<std::size_t>> chunksOfNode( nodes );
+      for( std::size_t i = 0; i < chunks.size(); ++i )
+        chunksOfNode[( options.itsNodeOfChunk ? options.itsNodeOfChunk( i ) : i ) % nodes].push_back( i );
+
+      std::unique_ptr<std::atomic<std::size_t>[]> next( new std::atomic<std::size_t>[nodes] );
+      std::atomic<bool> failed( false );
+      std::mutex errorMutex;
+      std::exception_ptr error;
+
+      auto const work = [&]( std::size_t node )
+      {
+        auto const & list = chunksOfNode[node];
+        for( std::size_t n; !failed.load( std::memory_order_relaxed ) && ( n = next[node]++ ) < list.size(); )
+        {
+          std::size_t const i = list[n];
+          ChunkStreambuf buffer( data + offsets[i], static_cast<std::size_t>( offsets[i + 1] - offsets[i] ) );
+          std::istream is( &buffer );
+
+          #if CEREAL_EXCEPTIONS
+          try
+          #endif
+          {
+            Archive ar( is );
+            ar( chunks[i] );
+            if( !ar.ok() )
+              failed = true;
+          }
+          #if CEREAL_EXCEPTIONS
+          catch( ... )
+          {
+            std::lock_guard<std::mutex> lock( errorMutex );
+            if( !error )
+              error = std::current_exception();
+            failed = true;
+          }
+          #endif
+        }
+      };
+
+      std::size_t const hardwareThreads = (std::max)( std::thread::hardware_concurrency(), 1u );
+      std::vector<std::thread> threads;
+      for( std::size_t node = 0; node < nodes; ++node )
+      {
+        next[node] = 0;
+
+        std::size_t threadsOfNode = options.itsThreadsPerNode;
+        if( threadsOfNode == 0 )
+          threadsOfNode = topology.cpus( node ).empty() ? ( hardwareThreads + nodes - 1 ) / nodes : topology.cpus( node ).size();
+        threadsOfNode = (std::min)( threadsOfNode, chunksOfNode[node].size() );
+
+        // Without pinning a single thread gains nothing over the caller
+        if( nodes == 1 && threadsOfNode == 1 && topology.cpus( node ).empty() )
+        {
+          work( node );
+          continue;
+        }
+
+        for( std::size_t t = 0; t < threadsOfNode; ++t )
+          threads.emplace_back( [&, node]()
+          {
+            pin_to_cpus( topology.cpus( node ) );
+            work( node );
+          } );
+      }
+
+      for( auto & thread : threads )
+        thread.join();
+
+      #if CEREAL_EXCEPTIONS
+      if( error )
+        std::rethrow_exception( error );
+      #endif
+
+      return !failed;
+    }
+  } // namespace chunked_detail
+
+  //! Loads the chunks saved by save_chunked in parallel, each on the NUMA node that will use it
+  /*! Chunks are distributed to nodes with ChunkedLoadOptions::nodeOfChunk.  Each node has its
+      own threads, pinned to the CPUs of the node, which load its chunks.  Memory the chunks
+      allocate while loading is first touched by those threads, so the kernel places it on
+      that node, close to the threads that will use it.  For the most benefit, the chunks
+      should keep their data on the heap (e.g. in containers or behind a std::unique_ptr), since
+      the elements of the container itself are allocated by the caller.
+
+      On a machine with a single node the chunks are loaded in parallel without pinning.
+
+      @param data The chunked archive, for example a memory mapped file
+      @param size The size of the archive in bytes
+      @param chunks A random access container (e.g. std::vector) resized to hold the chunks
+      @param options The topology, placement of chunks and number of threads
+      @return Whether all chunks loaded, false if an archive that does not throw recorded an error,
+              or if exceptions are disabled and the archive or its index is malformed
+      @throws Exception if the archive or its index is malformed, or the first exception
+                        thrown while loading a chunk */
+  template <class Archive, class Container> inline
+  bool load_chunked( char const * data, std::size_t size, Container & chunks,
+                     ChunkedLoadOptions const & options = ChunkedLoadOptions::Default() )
+  {
+    return chunked_detail::load_chunks<Archive>( data, size, chunks, options );
+  }
+
+  //! Loads a chunked archive from a stream, see load_chunked
+  /*! The whole stream is read into memory first. */
+  template <class Archive, class Container> inline
+  bool load_chunked( std::istream & is, Container & chunks,
+                     ChunkedLoadOptions const & options = ChunkedLoadOptions::Default() )
+  {
+    std::string const data( ( std::istreambuf_iterator<char>( is ) ), std::istreambuf_iterator<char>() );
+    return load_chunked<Archive>( data.data(), data.size(), chunks, options );
+  }
+} // namespace cereal
+
+#endif // CEREAL_CHUNKED_HPP_
@@ -0,0 +1,756 @@
+/*! \file compressed_strings.hpp
+    \brief Compression of short strings with a trained symbol table */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_COMPRESSED_STRINGS_HPP_
+#define CEREAL_COMPRESSED_STRINGS_HPP_
+
+#include "cereal/cereal.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cereal
+{
+  namespace compressed_strings_detail
+  {
+    //! The code that is followed by a byte that no symbol encodes
+    constexpr unsigned char escape = 255;
+
+    //! The largest number of bytes a symbol holds
+    constexpr std::size_t max_symbol_length = 8;
+
+    //! The number of bytes of each string that are used for training
+    constexpr std::size_t max_sample_string = 512;
+
+    //! The number of bytes that are used for training
+    constexpr std::size_t sample_size = 1 << 14;
+
+    //! The number of rounds of training
+    constexpr int training_rounds = 5;
+
+    //! log2 of the number of slots of the tables that find symbols of two or more bytes
+    constexpr int hash_bits = 10;
+
+    //! Loads up to eight bytes into a word, padding it with zeros
+    inline std::uint64_t load_word( unsigned char const * data, std::size_t size )
+    {
+      std::uint64_t word = 0;
+      if( size >= max_symbol_length )
+        std::memcpy( &word, data, max_symbol_length );
+      else
+        std::memcpy( &word, data, size );
+      return word;
+    }
+
+    //! A mask for the first length bytes of a word, as they are laid out in memory
+    inline std::uint64_t prefix_mask( std::size_t length )
+    {
+      std::uint64_t mask = 0;
+      std::memset( &mask, 0xFF, length );
+      return mask;
+    }
+
+    //! The first byte of a word, as it is laid out in memory
+    inline unsigned char first_byte( std::uint64_t word )
+    {
+      unsigned char byte;
+      std::memcpy( &byte, &word, 1 );
+      return byte;
+    }
+
+    //! Hashes the prefix of a word into a table of 2^hash_bits slots
+    inline std::size_t hash_prefix( std::uint64_t prefix )
+    {
+      return static_cast<std::size_t>( ( prefix * 0x9E3779B97F4A7C15ull ) >> ( 64 - hash_bits ) );
+    }
+
+    //! Appends a length as a variable length integer of 7 bits per byte
+    inline void append_length( std::string & out, std::size_t length )
+    {
+      while( length >= 0x80 )
+      {
+        out.push_back( static_cast<char>( ( length & 0x7F ) | 0x80 ) );
+        length >>= 7;
+      }
+      out.push_back( static_cast<char>( length ) );
+    }
+
+    //! Reads a length written by append_length, returning false if it does not fit before end
+    inline bool read_length( unsigned char const *& in, unsigned char const * end, std::size_t & length )
+    {
+      length = 0;
+      for( int shift = 0; in != end && shift < 64; shift += 7 )
+      {
+        unsigned char const byte = *in++;
+        length |= static_cast<std::size_t>( byte & 0x7F ) << shift;
+        if( !( byte & 0x80 ) )
+          return length <= static_cast<std::size_t>( end - in );
+      }
+      return false;
+    }
+  } // namespace compressed_strings_detail
+
+  // ######################################################################
+  //! A table of up to 255 symbols of one to eight bytes that strings are encoded with
+  /*! Every symbol is encoded as a single byte code, and bytes that are not covered by
+      a symbol are escaped, which takes two bytes.  Each string is encoded on its own,
+      so it can be decoded without any other string.  This is the approach of FSST
+      (Fast Static Symbol Table), which suits large numbers of short strings with
+      common substrings, such as URLs, file paths or keys, much better than general
+      purpose compressors.
+
+      Decoding copies eight bytes per code from the table, so it is very fast.
+      Tables are trained on a sample of strings with train, and can be serialized
+      with archives that support binary data.  See compressed_strings for saving
+      strings with a table. */
+  class StringSymbolTable
+  {
+    public:
+      //! Creates a table without symbols, which escapes every byte
+      StringSymbolTable() : itsCount( 0 )
+      {
+        index();
+      }
+
+      //! Trains a table on a range of std::string
+      /*! Up to 16 KiB of the strings, taken evenly from the range, are used as a sample.
+          Starting with no symbols, the sample is encoded a few times.  After each pass,
+          the table is rebuilt from the symbols, bytes and pairs of adjacent symbols that
+          saved the most bytes. */
+      template <class Iterator> static
+      StringSymbolTable train( Iterator begin, Iterator end )
+      {
+        using namespace compressed_strings_detail;
+
+        std::vector<std::pair<unsigned char const *, std::size_t>> sample;
+        std::size_t total = 0;
+        for( Iterator i = begin; i != end; ++i )
+          total += std::min( i->size(), max_sample_string );
+
+        std::size_t const stride = total / sample_size + 1;
+        std::size_t position = 0;
+        for( Iterator i = begin; i != end; ++i, ++position )
+          if( position % stride == 0 && !i->empty() )
+            sample.emplace_back( reinterpret_cast<unsigned char const *>( i->data() ), std::min( i->size(), max_sample_string ) );
+
+        StringSymbolTable table;
+        for( int round = 0; round < training_rounds; ++round )
+          table = table.improve( sample );
+
+        return table;
+      }
+
+      //! The number of symbols in the table
+      std::size_t size() const
+      {
+        return itsCount;
+      }
+
+      //! Appends the encoding of size bytes of data to out
+      void encode( char const * data, std::size_t size, std::string & out ) const
+      {
+        std::size_t const start = out.size();
+        out.resize( start + 2 * size );
+
+        auto in = reinterpret_cast<unsigned char const *>( data );
+        auto const first = reinterpret_cast<unsigned char *>( &out[0] + start );
+        auto o = first;
+        while( size > 0 )
+        {
+          std::uint64_t const word = compressed_strings_detail::load_word( in, size );
+          unsigned char const code = match( word, size );
+          *o++ = code;
+          if( code == compressed_strings_detail::escape )
+          {
+            *o++ = *in++;
+            --size;
+          }
+          else
+          {
+            in += itsLengths[code];
+            size -= itsLengths[code];
+          }
+        }
+
+        out.resize( start + static_cast<std::size_t>( o - first ) );
+      }
+
+      //! Decodes size bytes of data encoded with this table into out
+      /*! @return Whether the data was a valid encoding */
+      bool decode( char const * data, std::size_t size, std::string & out ) const
+      {
+        if( size == 0 )
+        {
+          out.clear();
+          return true;
+        }
+
+        std::vector<char> buffer( max_decoded_size( size ) );
+        char * const end = decode( reinterpret_cast<unsigned char const *>( data ), size, buffer.data() );
+        if( !end )
+          return false;
+
+        out.assign( buffer.data(), static_cast<std::size_t>( end - buffer.data() ) );
+        return true;
+      }
+
+      //! The largest number of bytes decoding size bytes writes, see decode
+      static std::size_t max_decoded_size( std::size_t size )
+      {
+        return size * compressed_strings_detail::max_symbol_length;
+      }
+
+      //! Decodes size bytes of data encoded with this table
+      /*! Writes whole symbols of eight bytes, so out must have room for
+          max_decoded_size( size ) bytes even though fewer are decoded.
+          @return The end of the decoded bytes, or nullptr if the data was not a valid encoding */
+      char * decode( unsigned char const * in, std::size_t size, char * out ) const
+      {
+        unsigned char const * const end = in + size;
+        unsigned char invalid = 0;
+
+        auto const decodeSymbol = [&]( unsigned char code )
+        {
+          std::memcpy( out, &itsSymbols[code], compressed_strings_detail::max_symbol_length );
+          out += itsLengths[code];
+          invalid |= itsLengths[code] == 0;
+        };
+
+        // four codes at a time while none of them is an escape
+        while( end - in >= 4 )
+        {
+          std::uint32_t codes;
+          std::memcpy( &codes, in, 4 );
+          std::uint32_t const inverted = ~codes;
+          if( ( inverted - 0x01010101u ) & ~inverted & 0x80808080u )
+            break;
+
+          decodeSymbol( in[0] );
+          decodeSymbol( in[1] );
+          decodeSymbol( in[2] );
+          decodeSymbol( in[3] );
+          in += 4;
+        }
+
+        while( in != end )
+        {
+          unsigned char const code = *in++;
+          if( code != compressed_strings_detail::escape )
+            decodeSymbol( code );
+          else if( in != end )
+            *out++ = static_cast<char>( *in++ );
+          else
+            return nullptr;
+        }
+
+        return invalid ? nullptr : out;
+      }
+
+      //! Saves the symbols of the table
+      template <class Archive>
+      void CEREAL_SAVE_FUNCTION_NAME( Archive & ar ) const
+      {
+        char symbols[255 * compressed_strings_detail::max_symbol_length];
+        std::size_t size = 0;
+        for( std::size_t code = 0; code < itsCount; ++code )
+        {
+          std::memcpy( symbols + size, &itsSymbols[code], itsLengths[code] );
+          size += itsLengths[code];
+        }
+
+        ar( itsCount );
+        ar( binary_data( itsLengths, itsCount ) );
+        ar( binary_data( symbols, size ) );
+      }
+
+      //! Loads the symbols of a table
+      template <class Archive>
+      void CEREAL_LOAD_FUNCTION_NAME( Archive & ar )
+      {
+        std::uint8_t count;
+        ar( count );
+
+        std::uint8_t lengths[256] = {};
+        ar( binary_data( lengths, count ) );
+
+        std::size_t size = 0;
+        for( std::size_t code = 0; code < count; ++code )
+        {
+          if( lengths[code] == 0 || lengths[code] > compressed_strings_detail::max_symbol_length )
+          {
+            CEREAL_THROW_ON_ERROR(ar, "Invalid symbol length " + std::to_string( lengths[code] ) + " in string symbol table");
+            ar.setError("Invalid symbol length in string symbol table");
+            return;
+          }
+          size += lengths[code];
+        }
+
+        char symbols[255 * compressed_strings_detail::max_symbol_length];
+        ar( binary_data( symbols, size ) );
+        if( !ar.ok() )
+          return;
+
+        itsCount = count;
+        size = 0;
+        for( std::size_t code = 0; code < 256; ++code )
+        {
+          itsSymbols[code] = 0;
+          itsLengths[code] = code < itsCount ? lengths[code] : 0;
+          std::memcpy( &itsSymbols[code], symbols + size, itsLengths[code] );
+          size += itsLengths[code];
+        }
+
+        index();
+      }
+
+    private:
+      //! A symbol that could be added to a table, with the number of bytes it would save
+      struct Candidate
+      {
+        std::uint64_t symbol;
+        std::size_t length;
+        std::size_t gain;
+      };
+
+      //! Finds the code of the longest symbol at the start of word, or escape
+      /*! @param word The next bytes, padded with zeros
+          @param size The number of bytes left */
+      unsigned char match( std::uint64_t word, std::size_t size ) const
+      {
+        using namespace compressed_strings_detail;
+
+        if( size >= 3 )
+        {
+          unsigned char const code = itsLongCodes[hash_prefix( word & itsPrefix3 )];
+          if( code != escape && itsLengths[code] <= size && ( word & itsMasks[code] ) == itsSymbols[code] )
+            return code;
+        }
+
+        if( size >= 2 )
+        {
+          unsigned char const code = itsPairCodes[hash_prefix( word & itsPrefix2 )];
+          if( code != escape && ( word & itsPrefix2 ) == itsSymbols[code] )
+            return code;
+        }
+
+        return itsByteCodes[first_byte( word )];
+      }
+
+      //! Builds the tables that find symbols for encoding
+      /*! Only one symbol of three or more bytes can start with the same three bytes,
+          and only one symbol of two bytes can be in the same slot of its table.
+          @return Whether the last symbol could be indexed */
+      bool indexSymbol( std::size_t code )
+      {
+        using namespace compressed_strings_detail;
+
+        std::uint64_t const symbol = itsSymbols[code];
+        unsigned char * slot;
+        if( itsLengths[code] >= 3 )
+          slot = &itsLongCodes[hash_prefix( symbol & itsPrefix3 )];
+        else if( itsLengths[code] == 2 )
+          slot = &itsPairCodes[hash_prefix( symbol & itsPrefix2 )];
+        else
+          slot = &itsByteCodes[first_byte( symbol )];
+
+        if( *slot != escape )
+          return false;
+
+        *slot = static_cast<unsigned char>( code );
+        itsMasks[code] = prefix_mask( itsLengths[code] );
+        return true;
+      }
+
+      //! Rebuilds all tables that find symbols
+      void index()
+      {
+        using namespace compressed_strings_detail;
+
+        itsPrefix2 = prefix_mask( 2 );
+        itsPrefix3 = prefix_mask( 3 );
+        std::memset( itsLongCodes, escape, sizeof(itsLongCodes) );
+        std::memset( itsPairCodes, escape, sizeof(itsPairCodes) );
+        std::memset( itsByteCodes, escape, sizeof(itsByteCodes) );
+        std::memset( itsMasks, 0, sizeof(itsMasks) );
+
+        for( std::size_t code = 0; code < itsCount; ++code )
+          indexSymbol( code );
+      }
+
+      //! Encodes a sample with this table and builds a better one from the symbols that saved the most
+      StringSymbolTable improve( std::vector<std::pair<unsigned char const *, std::size_t>> const & sample ) const
+      {
+        using namespace compressed_strings_detail;
+
+        // Symbols have codes below 256, escaped bytes are counted as 256 + byte
+        std::vector<std::size_t> counts( 512 );
+        std::vector<std::uint16_t> pairCounts( 512 * 512 );
+
+        auto const extendedCode = [&]( unsigned char const * in, std::size_t size ) -> std::size_t
+        {
+          unsigned char const code = match( load_word( in, size ), size );
+          return code == escape ? 256 + *in : code;
+        };
+
+        for( auto const & string : sample )
+        {
+          unsigned char const * in = string.first;
+          std::size_t size = string.second;
+          std::size_t previous = extendedCode( in, size );
+          for( ;; )
+          {
+            ++counts[previous];
+            std::size_t const length = previous < 256 ? itsLengths[previous] : 1;
+            // Single bytes are counted as well, so they can become symbols of their own
+            if( length > 1 )
+              ++counts[256 + *in];
+
+            in += length;
+            size -= length;
+            if( size == 0 )
+              break;
+
+            std::size_t const next = extendedCode( in, size );
+            if( pairCounts[previous * 512 + next] < 0xFFFF )
+              ++pairCounts[previous * 512 + next];
+            previous = next;
+          }
+        }
+
+        auto const symbolOf = [&]( std::size_t code, std::size_t & length ) -> std::uint64_t
+        {
+          if( code < 256 )
+          {
+            length = itsLengths[code];
+            return itsSymbols[code];
+          }
+
+          length = 1;
+          unsigned char const byte = static_cast<unsigned char>( code - 256 );
+          return load_word( &byte, 1 );
+        };
+
+        std::vector<Candidate> candidates;
+        for( std::size_t code = 0; code < 512; ++code )
+        {
+          if( !counts[code] )
+            continue;
+
+          std::size_t length;
+          std::uint64_t const symbol = symbolOf( code, length );
+          candidates.push_back( { symbol, length, counts[code] * length } );
+
+          for( std::size_t next = 0; next < 512; ++next )
+          {
+            std::size_t const count = pairCounts[code * 512 + next];
+            if( !count )
+              continue;
+
+            std::size_t nextLength;
+            std::uint64_t nextSymbol = symbolOf( next, nextLength );
+            if( length + nextLength > max_symbol_length )
+              continue;
+
+            std::uint64_t concatenated = symbol;
+            std::memcpy( reinterpret_cast<unsigned char *>( &concatenated ) + length, &nextSymbol, nextLength );
+            candidates.push_back( { concatenated, length + nextLength, count * ( length + nextLength ) } );
+          }
+        }
+
+        // merge the gains of the same symbols found in different ways
+        std::sort( candidates.begin(), candidates.end(), []( Candidate const & a, Candidate const & b )
+        { return a.length != b.length ? a.length < b.length : a.symbol < b.symbol; } );
+
+        std::vector<Candidate> merged;
+        for( auto const & candidate : candidates )
+          if( !merged.empty() && merged.back().length == candidate.length && merged.back().symbol == candidate.symbol )
+            merged.back().gain += candidate.gain;
+          else
+            merged.push_back( candidate );
+
+        std::stable_sort( merged.begin(), merged.end(), []( Candidate const & a, Candidate const & b )
+        { return a.gain > b.gain; } );
+
+        StringSymbolTable table;
+        for( auto const & candidate : merged )
+        {
+          if( table.itsCount == 255 )
+            break;
+
+          table.itsSymbols[table.itsCount] = candidate.symbol;
+          table.itsLengths[table.itsCount] = static_cast<std::uint8_t>( candidate.length );
+          if( table.indexSymbol( table.itsCount ) )
+            ++table.itsCount;
+          else
+          {
+            table.itsSymbols[table.itsCount] = 0;
+            table.itsLengths[table.itsCount] = 0;
+          }
+        }
+
+        return table;
+      }
+
+      std::uint8_t itsCount;                     //!< The number of symbols, which have the codes below it
+      std::uint64_t itsSymbols[256] = {};        //!< The bytes of each symbol, padded with zeros
+      std::uint8_t itsLengths[256] = {};         //!< The length of each symbol, zero for unused codes
+      std::uint64_t itsMasks[256];               //!< A mask for the bytes of each symbol
+      std::uint64_t itsPrefix2;                  //!< A mask for the first two bytes of a word
+      std::uint64_t itsPrefix3;                  //!< A mask for the first three bytes of a word
+      unsigned char itsLongCodes[1 << compressed_strings_detail::hash_bits]; //!< Symbols of three or more bytes by their first three
+      unsigned char itsPairCodes[1 << compressed_strings_detail::hash_bits]; //!< Symbols of two bytes
+      unsigned char itsByteCodes[256];           //!< Symbols of one byte
+  };
+
+  // ######################################################################
+  //! A string or sequence of strings saved with a StringSymbolTable
+  /*! Use compressed_strings to create these.  They can only be used with archives
+      that support binary data, such as the binary and portable binary archives.
+
+      The wrapped data can be a std::string or a sequence container of them, such as
+      a std::vector<std::string>.  Without a table, one is trained on the data when
+      saving and saved before it.  With a table, only the encoded data is saved, so
+      the same table can be shared by any number of strings and containers by saving
+      it once, for example at the start of the archive.
+
+      A sequence is saved as its size, followed by a single block holding the
+      encoded length and encoding of each string.
+
+      @code{.cpp}
+      struct AccessLog
+      {
+        std::vector<std::string> urls;
+        std::vector<std::string> userAgents;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          // each container trains and saves its own table
+          ar( cereal::compressed_strings( urls ), cereal::compressed_strings( userAgents ) );
+        }
+      };
+
+      // a table shared by an entire archive
+      auto table = cereal::StringSymbolTable::train( keys.begin(), keys.end() );
+      archive( table );
+      for( auto const & record : records )
+        archive( cereal::compressed_strings( record.key, table ), record.value );
+      @endcode
+
+      @internal */
+  template <class T>
+  class CompressedStrings
+  {
+    private:
+      // Store a reference if passed an lvalue reference, otherwise
+      // make a copy of the data
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      CompressedStrings & operator=( CompressedStrings const & ) = delete;
+
+    public:
+      CompressedStrings( T && v, StringSymbolTable const * t ) : value( std::forward<T>( v ) ), table( t ) {}
+
+      Type value;
+      StringSymbolTable const * table; //!< The table to use, or nullptr to train and save one
+  };
+
+  //! Saves strings compressed with a table trained on them
+  /*! @relates CompressedStrings */
+  template <class T> inline
+  CompressedStrings<T> compressed_strings( T && value )
+  {
+    return { std::forward<T>( value ), nullptr };
+  }
+
+  //! Saves strings compressed with an existing table, which must be the same when loading
+  /*! @relates CompressedStrings */
+  template <class T> inline
+  CompressedStrings<T> compressed_strings( T && value, StringSymbolTable const & table )
+  {
+    return { std::forward<T>( value ), &table };
+  }
+
+  namespace compressed_strings_detail
+  {
+    //! Reports invalid compressed strings
+    template <class Archive> inline
+    void invalid_data( Archive & ar )
+    {
+      CEREAL_THROW_ON_ERROR(ar, "Invalid compressed string data");
+      ar.setError("Invalid compressed string data");
+    }
+
+    //! Trains a table on a single string
+    inline StringSymbolTable train( std::string const & string )
+    {
+      return StringSymbolTable::train( &string, &string + 1 );
+    }
+
+    //! Trains a table on a sequence of strings
+    template <class Container> inline
+    StringSymbolTable train( Container const & container )
+    {
+      return StringSymbolTable::train( container.begin(), container.end() );
+    }
+
+    //! Saves a single string
+    template <class Archive> inline
+    void save_data( Archive & ar, StringSymbolTable const & table, std::string const & string )
+    {
+      std::string encoded;
+      table.encode( string.data(), string.size(), encoded );
+
+      ar( make_size_tag( static_cast<size_type>( encoded.size() ) ) );
+      ar( binary_data( encoded.data(), encoded.size() ) );
+    }
+
+    //! Loads a single string
+    template <class Archive> inline
+    void load_data( Archive & ar, StringSymbolTable const & table, std::string & string )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      std::string encoded;
+      detail::append_binary_data( ar, encoded, static_cast<std::size_t>( size ) );
+      if( ar.ok() && !table.decode( encoded.data(), encoded.size(), string ) )
+        invalid_data( ar );
+    }
+
+    //! Saves a sequence of strings as its size, followed by a block of all encoded strings
+    template <class Archive, class Container> inline
+    void save_data( Archive & ar, StringSymbolTable const & table, Container const & container )
+    {
+      static_assert( std::is_same<typename Container::value_type, std::string>::value,
+                     "compressed_strings requires a std::string or a sequence container of std::string" );
+
+      std::string block, encoded;
+      for( auto const & string : container )
+      {
+        encoded.clear();
+        table.encode( string.data(), string.size(), encoded );
+        append_length( block, encoded.size() );
+        block += encoded;
+      }
+
+      ar( make_size_tag( static_cast<size_type>( container.size() ) ) );
+      ar( make_size_tag( static_cast<size_type>( block.size() ) ) );
+      ar( binary_data( block.data(), block.size() ) );
+    }
+
+    //! Loads a sequence of strings
+    /*! Strings are assigned to the elements already in the container, keeping their capacity */
+    template <class Archive, class Container> inline
+    void load_data( Archive & ar, StringSymbolTable const & table, Container & container )
+    {
+      static_assert( std::is_same<typename Container::value_type, std::string>::value,
+                     "compressed_strings requires a std::string or a sequence container of std::string" );
+
+      size_type count, size;
+      ar( make_size_tag( count ) );
+      ar( make_size_tag( size ) );
+
+      std::string block;
+      detail::append_binary_data( ar, block, static_cast<std::size_t>( size ) );
+      if( !ar.ok() )
+        return;
+
+      // every string takes at least one byte for its length
+      if( count > block.size() )
+        return invalid_data( ar );
+
+      container.resize( static_cast<std::size_t>( count ) );
+
+      auto in = reinterpret_cast<unsigned char const *>( block.data() );
+      auto const end = in + block.size();
+      std::vector<char> decoded;
+      for( auto & string : container )
+      {
+        std::size_t length;
+        if( !read_length( in, end, length ) )
+          return invalid_data( ar );
+
+        if( length == 0 )
+        {
+          string.clear();
+          continue;
+        }
+
+        if( decoded.size() < StringSymbolTable::max_decoded_size( length ) )
+          decoded.resize( StringSymbolTable::max_decoded_size( length ) );
+
+        char const * const decodedEnd = table.decode( in, length, decoded.data() );
+        if( !decodedEnd )
+          return invalid_data( ar );
+
+        string.assign( decoded.data(), static_cast<std::size_t>( decodedEnd - decoded.data() ) );
+        in += length;
+      }
+
+      if( in != end )
+        invalid_data( ar );
+    }
+  } // namespace compressed_strings_detail
+
+  //! Saving for CompressedStrings
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<char>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, CompressedStrings<T> const & cs )
+  {
+    if( cs.table )
+      return compressed_strings_detail::save_data( ar, *cs.table, cs.value );
+
+    StringSymbolTable const table = compressed_strings_detail::train( cs.value );
+    ar( table );
+    compressed_strings_detail::save_data( ar, table, cs.value );
+  }
+
+  //! Loading for CompressedStrings
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<char>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, CompressedStrings<T> & cs )
+  {
+    if( cs.table )
+      return compressed_strings_detail::load_data( ar, *cs.table, cs.value );
+
+    StringSymbolTable table;
+    ar( table );
+    if( ar.ok() )
+      compressed_strings_detail::load_data( ar, table, cs.value );
+  }
+} // namespace cereal
+
+#endif // CEREAL_COMPRESSED_STRINGS_HPP_
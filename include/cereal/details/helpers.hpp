@@ -32,8 +32,13 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cstdlib>
 #include <utility>
 #include <memory>
+#include <string>
+#include <iterator>
+#include <limits>
+#include <algorithm>
 #include <unordered_map>
 #include <stdexcept>
 
@@ -51,6 +56,30 @@ namespace cereal
     explicit Exception( const char * what_ ) : std::runtime_error(what_) {}
   };
 
+  //! Throws an exception, or aborts if exceptions are disabled
+  /*! This is used for errors that can only result from misusing cereal, such
+      as an unregistered polymorphic relation.  Errors caused by the data being
+      loaded are reported through the archive instead, see CEREAL_THROW_ON_ERROR.
+      @internal */
+  #if CEREAL_EXCEPTIONS
+  #define CEREAL_THROW_EXCEPTION(...) throw __VA_ARGS__
+  #else
+  #define CEREAL_THROW_EXCEPTION(...) std::abort()
+  #endif
+
+  //! Throws an Exception with a detailed message if the archive throws on errors
+  /*! The message is only built if it is thrown.  This should be followed by a call
+      to setError on the archive with a static message, which records the error when
+      the archive does not throw (see InputArchive::setThrowOnError).
+      @internal */
+  #if CEREAL_EXCEPTIONS
+  #define CEREAL_THROW_ON_ERROR(ar, message) \
+    do { if( (ar).throwsOnError() ) throw ::cereal::Exception( message ); } while( false )
+  #else
+  #define CEREAL_THROW_ON_ERROR(ar, message) \
+    do { (void)sizeof( message ); } while( false )
+  #endif
+
   // ######################################################################
   //! The size type used by cereal
   /*! To ensure compatability between 32, 64, etc bit machines, we need to use
@@ -63,6 +92,7 @@ namespace cereal
   // forward decls
   class BinaryOutputArchive;
   class BinaryInputArchive;
+  class BinarySizeArchive;
 
   // ######################################################################
   namespace detail
@@ -174,7 +204,8 @@ namespace cereal
   template<class Archive, class T> inline
   typename
   std::enable_if<std::is_same<Archive, ::cereal::BinaryInputArchive>::value ||
-                 std::is_same<Archive, ::cereal::BinaryOutputArchive>::value,
+                 std::is_same<Archive, ::cereal::BinaryOutputArchive>::value ||
+                 std::is_same<Archive, ::cereal::BinarySizeArchive>::value,
   T && >::type
   make_nvp( const char *, T && value )
   {
@@ -187,7 +218,8 @@ namespace cereal
   template<class Archive, class T> inline
   typename
   std::enable_if<!std::is_same<Archive, ::cereal::BinaryInputArchive>::value &&
-                 !std::is_same<Archive, ::cereal::BinaryOutputArchive>::value,
+                 !std::is_same<Archive, ::cereal::BinaryOutputArchive>::value &&
+                 !std::is_same<Archive, ::cereal::BinarySizeArchive>::value,
   NameValuePair<T> >::type
   make_nvp( const char * name, T && value)
   {
@@ -262,6 +294,30 @@ namespace cereal
   // ######################################################################
   namespace detail
   {
+    //! Identifies the type of the user data attached to an archive
+    /*! Each type has its own key, so checking the type of the user data is a single
+        pointer comparison, without RTTI.
+        @internal */
+    template <class T>
+    struct user_data_key
+    {
+      static const char value;
+    };
+
+    template <class T>
+    const char user_data_key<T>::value = 0;
+
+    //! User data attached to an archive by a UserDataAdapter
+    /*! Nested adapters each attach their own link, which point to the links of the
+        adapters they wrap.
+        @internal */
+    struct UserDataLink
+    {
+      void const * data;         //!< The attached user data
+      char const * key;          //!< Identifies the type of data, see user_data_key
+      UserDataLink const * next; //!< The user data attached by the wrapped adapter, if any
+    };
+
     // base classes for type checking
     /* The rtti virtual function only exists to enable an archive to
        be used in a polymorphic fashion, if necessary.  See the
@@ -274,8 +330,31 @@ namespace cereal
         OutputArchiveBase & operator=( OutputArchiveBase && ) CEREAL_NOEXCEPT { return *this; }
         virtual ~OutputArchiveBase() CEREAL_NOEXCEPT = default;
 
+        //! Attaches user data to the archive in front of any attached before, see UserDataAdapter
+        /*! @internal */
+        void attachUserData( UserDataLink & link ) CEREAL_NOEXCEPT
+        {
+          link.next = itsUserData;
+          itsUserData = &link;
+        }
+
+        //! Gets the user data of type T attached last to the archive, or nullptr if there is none
+        /*! @internal */
+        template <class T>
+        T * getUserData() const CEREAL_NOEXCEPT
+        {
+          // the key includes the constness of T, so this only restores the type that was stored
+          for( UserDataLink const * link = itsUserData; link; link = link->next )
+            if( link->key == &user_data_key<T>::value )
+              return static_cast<T *>( const_cast<void *>( link->data ) );
+
+          return nullptr;
+        }
+
       private:
         virtual void rtti() {}
+
+        UserDataLink const * itsUserData = nullptr; //!< The user data attached last
     };
 
     class InputArchiveBase
@@ -286,8 +365,31 @@ namespace cereal
         InputArchiveBase & operator=( InputArchiveBase && ) CEREAL_NOEXCEPT { return *this; }
         virtual ~InputArchiveBase() CEREAL_NOEXCEPT = default;
 
+        //! Attaches user data to the archive in front of any attached before, see UserDataAdapter
+        /*! @internal */
+        void attachUserData( UserDataLink & link ) CEREAL_NOEXCEPT
+        {
+          link.next = itsUserData;
+          itsUserData = &link;
+        }
+
+        //! Gets the user data of type T attached last to the archive, or nullptr if there is none
+        /*! @internal */
+        template <class T>
+        T * getUserData() const CEREAL_NOEXCEPT
+        {
+          // the key includes the constness of T, so this only restores the type that was stored
+          for( UserDataLink const * link = itsUserData; link; link = link->next )
+            if( link->key == &user_data_key<T>::value )
+              return static_cast<T *>( const_cast<void *>( link->data ) );
+
+          return nullptr;
+        }
+
       private:
         virtual void rtti() {}
+
+        UserDataLink const * itsUserData = nullptr; //!< The user data attached last
     };
 
     // forward decls for polymorphic support
@@ -297,6 +399,10 @@ namespace cereal
     // used during saving pointers
     static const uint32_t msb_32bit  = 0x80000000;
     static const int32_t msb2_32bit = 0x40000000;
+
+    // used to mark epoch boundaries, the low byte holds the epoch flags
+    static const uint32_t epoch_marker = 0x45504f00;
+    static const uint32_t epoch_retain_type_info = 0x1;
   }
 
   // ######################################################################
@@ -387,6 +493,452 @@ namespace cereal
     return {std::forward<KeyType>(key), std::forward<ValueType>(value)};
   }
 
+  namespace detail
+  {
+    // ######################################################################
+    //! Prefetches the memory that saving a value will read through its pointers
+    /*! Values that own no memory are left alone.
+        @internal */
+    template <class T> inline
+    void prefetch_contents( T const & )
+    { }
+
+    //! Prefetches the characters of a string
+    /*! @internal */
+    template <class C, class T, class A> inline
+    void prefetch_contents( std::basic_string<C, T, A> const & s )
+    {
+      CEREAL_PREFETCH( s.data() );
+    }
+
+    //! Prefetches the object a std::shared_ptr points to
+    /*! @internal */
+    template <class T> inline
+    void prefetch_contents( std::shared_ptr<T> const & p )
+    {
+      CEREAL_PREFETCH( p.get() );
+    }
+
+    //! Prefetches the object a std::unique_ptr points to
+    /*! @internal */
+    template <class T, class D> inline
+    void prefetch_contents( std::unique_ptr<T, D> const & p )
+    {
+      CEREAL_PREFETCH( p.get() );
+    }
+
+    //! Prefetches the contents of both members of a pair, e.g. the key and value of a map entry
+    /*! @internal */
+    template <class T1, class T2> inline
+    void prefetch_contents( std::pair<T1, T2> const & p )
+    {
+      prefetch_contents( p.first );
+      prefetch_contents( p.second );
+    }
+
+    //! Whether a value owns memory that prefetch_contents prefetches
+    /*! @internal */
+    template <class T>
+    struct owns_memory : std::false_type {};
+
+    template <class C, class T, class A>
+    struct owns_memory<std::basic_string<C, T, A>> : std::true_type {};
+
+    template <class T>
+    struct owns_memory<std::shared_ptr<T>> : std::true_type {};
+
+    template <class T, class D>
+    struct owns_memory<std::unique_ptr<T, D>> : std::true_type {};
+
+    template <class T1, class T2>
+    struct owns_memory<std::pair<T1, T2>> :
+      std::integral_constant<bool, owns_memory<typename std::remove_cv<T1>::type>::value ||
+                                   owns_memory<typename std::remove_cv<T2>::type>::value> {};
+
+    //! Calls a function for every element of a node based container
+    /*! Used when the elements own no memory: following the links is serial, so there
+        is nothing to prefetch that the loop does not already wait for.
+        @internal */
+    template <class Iterator, class Function> inline
+    void for_each_node_prefetched( Iterator begin, Iterator const end, Function && function, std::false_type /* owns_memory */ )
+    {
+      for( ; begin != end; ++begin )
+        function( *begin );
+    }
+
+    //! Calls a function for every element of a node based container, prefetching ahead
+    /*! A second iterator runs CEREAL_PREFETCH_DISTANCE elements ahead of the element
+        being processed.  Each step prefetches the next node, which the following step
+        reads, as well as the memory owned by the element the iterator is on.  Following
+        the links stays serial, but the misses on the memory owned by the elements
+        overlap with each other and with processing the elements in between.
+        @internal */
+    template <class Iterator, class Function> inline
+    void for_each_node_prefetched( Iterator begin, Iterator const end, Function && function, std::true_type /* owns_memory */ )
+    {
+      Iterator ahead = begin;
+      for( std::size_t i = 0; i < CEREAL_PREFETCH_DISTANCE && ahead != end; ++i )
+        ++ahead;
+
+      for( ; begin != end; ++begin )
+      {
+        if( ahead != end )
+        {
+          prefetch_contents( *ahead );
+          if( ++ahead != end )
+            CEREAL_PREFETCH( std::addressof( *ahead ) );
+        }
+        function( *begin );
+      }
+    }
+
+    //! Calls a function for every element of a node based container, prefetching ahead
+    /*! Prefetches only if the elements own memory, see owns_memory
+        @internal */
+    template <class Iterator, class Function> inline
+    void for_each_node_prefetched( Iterator begin, Iterator const end, Function && function )
+    {
+      using T = typename std::iterator_traits<Iterator>::value_type;
+      for_each_node_prefetched( begin, end, std::forward<Function>( function ),
+                                std::integral_constant<bool, CEREAL_PREFETCH_DISTANCE != 0 && owns_memory<T>::value>() );
+    }
+
+    //! Calls a function for every element of an array, prefetching the memory owned by elements ahead
+    /*! The memory owned by the element CEREAL_PREFETCH_DISTANCE positions ahead of the one
+        being processed is prefetched, see prefetch_contents.
+        @internal */
+    template <class T, class Function> inline
+    void for_each_element_prefetched( T const * begin, T const * const end, Function && function )
+    {
+      for( ; begin != end; ++begin )
+      {
+        #if CEREAL_PREFETCH_DISTANCE > 0
+        if( end - begin > CEREAL_PREFETCH_DISTANCE )
+          prefetch_contents( begin[CEREAL_PREFETCH_DISTANCE] );
+        #endif
+        function( *begin );
+      }
+    }
+  } // namespace detail
+
+  // ######################################################################
+  //! An allocator adaptor that default-initializes elements instead of value-initializing them
+  /*! Containers value-initialize the elements added by resize(), which zero fills
+      arithmetic types.  With this adaptor they are left uninitialized instead, so a
+      std::vector<float, cereal::default_init_allocator<float>> is loaded by reading
+      straight into its storage without writing it twice.
+
+      @code{.cpp}
+      std::vector<float, cereal::default_init_allocator<float>> samples;
+      archive( samples );
+      @endcode
+
+      @tparam T The type of the elements
+      @tparam A The allocator to adapt
+      @ingroup Utility */
+  template <class T, class A = std::allocator<T>>
+  class default_init_allocator : public A
+  {
+    private:
+      using Traits = std::allocator_traits<A>;
+
+    public:
+      template <class U>
+      struct rebind
+      {
+        using other = default_init_allocator<U, typename Traits::template rebind_alloc<U>>;
+      };
+
+      default_init_allocator() = default;
+
+      //! Adapts a copy of an allocator
+      default_init_allocator( A const & a ) : A( a ) {}
+
+      template <class U, class B>
+      default_init_allocator( default_init_allocator<U, B> const & other ) : A( static_cast<B const &>( other ) ) {}
+
+      //! Default-initializes an element
+      template <class U>
+      void construct( U * ptr )
+      {
+        ::new( static_cast<void *>( ptr ) ) U;
+      }
+
+      //! Constructs an element with arguments using the adapted allocator
+      template <class U, class ... Args>
+      void construct( U * ptr, Args && ... args )
+      {
+        Traits::construct( static_cast<A &>( *this ), ptr, std::forward<Args>( args )... );
+      }
+  };
+
+  namespace detail
+  {
+    //! The number of elements of a type allocated at once when loading a size from an archive
+    /*! A size read from malformed data can be far larger than the data behind it, so
+        containers are grown about a megabyte at a time and stop once loading fails,
+        instead of allocating everything up front.
+        @internal */
+    template <class T> inline constexpr
+    std::size_t load_step()
+    {
+      return sizeof(T) < 1048576 ? 1048576 / sizeof(T) : 1;
+    }
+
+    //! Whether an archive is known to hold at least a number of bytes more, see BinaryInputArchive::availableBytes
+    /*! @internal */
+    template <class Archive> inline
+    auto holds_bytes( Archive & ar, std::size_t bytes, int ) -> decltype( ar.availableBytes(), bool() )
+    {
+      std::streamsize const available = ar.availableBytes();
+      return available > 0 && static_cast<std::size_t>( available ) >= bytes;
+    }
+
+    //! Archives that cannot tell how much they hold are never known to hold enough
+    /*! @internal */
+    template <class Archive> inline
+    bool holds_bytes( Archive &, std::size_t, long )
+    {
+      return false;
+    }
+
+    //! The number of elements a container can hold without reallocating
+    /*! @internal */
+    template <class Container> inline
+    auto load_capacity( Container const & container, int ) -> decltype( std::size_t( container.capacity() ) )
+    {
+      return container.capacity();
+    }
+
+    //! The number of elements an unordered container can hold without rehashing
+    /*! @internal */
+    template <class Container> inline
+    auto load_capacity( Container const & container, long ) -> decltype( std::size_t( container.bucket_count() ) )
+    {
+      return static_cast<std::size_t>( static_cast<float>( container.bucket_count() ) * container.max_load_factor() );
+    }
+
+    //! Grows the capacity of a container being loaded to hold at least needed of its total elements
+    /*! All of the total elements are reserved at once for data from a trusted source, or when
+        the archive is known to hold at least as many bytes as they take up in memory.  Otherwise
+        a size read from malformed data can be far larger than the data behind it, so the
+        capacity grows geometrically, by at least a load_step, and is clamped to the total.
+        The final storage then holds exactly the total with O(log) reallocations, or rehashes
+        for unordered containers.
+        @internal */
+    template <class Archive, class Container> inline
+    auto reserve_for_load( Archive & ar, Container & container, std::size_t needed, std::size_t total )
+      -> decltype( container.reserve( total ), load_capacity( container, 0 ), void() )
+    {
+      using T = typename Container::value_type;
+
+      std::size_t const capacity = load_capacity( container, 0 );
+      if( needed <= capacity )
+        return;
+
+      if( ar.isTrustedSource() || ( total > load_step<T>() && holds_bytes( ar, total * sizeof(T), 0 ) ) )
+        container.reserve( total );
+      else
+      {
+        std::size_t const grown = capacity + (std::max)( capacity, load_step<T>() );
+        container.reserve( (std::min)( total, (std::max)( grown, needed ) ) );
+      }
+    }
+
+    //! Does nothing for containers without a capacity, such as std::deque
+    /*! @internal */
+    template <class Archive, class Container> inline
+    void reserve_for_load( Archive &, Container &, std::size_t, ... )
+    { }
+
+    //! Loads binary data for a number of elements in chunks, passing each chunk to a function
+    /*! The chunks are read into a small buffer on the stack.  Stops after a chunk
+        fails to load.
+        @internal */
+    template <class T, class Archive, class Function> inline
+    void load_binary_chunks( Archive & ar, std::size_t size, Function && function )
+    {
+      std::size_t const chunkSize = ( 4096 + sizeof(T) - 1 ) / sizeof(T);
+      T buffer[chunkSize];
+
+      while( size > 0 && ar.ok() )
+      {
+        std::size_t const count = size < chunkSize ? size : chunkSize;
+        ar( BinaryData<T *>( buffer, count * sizeof(T) ) );
+        function( static_cast<T const *>( buffer ), count );
+        size -= count;
+      }
+    }
+
+    //! Loads binary data for a number of elements and appends them to a container
+    /*! Growing a container with resize() value-initializes the new elements, which
+        zero fills memory that is overwritten right after.  Instead, the data is read
+        in chunks into a small buffer and inserted at the end of the container, so its
+        memory is written only once.  Capacity is grown ahead of the chunks, see
+        reserve_for_load.
+        @internal */
+    template <class Archive, class Container> inline
+    void append_binary_data( Archive & ar, Container & container, std::size_t size )
+    {
+      using T = typename Container::value_type;
+      std::size_t const total = container.size() + size;
+      load_binary_chunks<T>( ar, size, [&ar, &container, total]( T const * data, std::size_t count )
+      {
+        reserve_for_load( ar, container, container.size() + count, total );
+        container.insert( container.end(), data, data + count );
+      } );
+    }
+
+    //! Loads binary data for a number of elements over the elements starting at an iterator
+    /*! This is for containers that do not store their elements contiguously, which
+        binary data cannot be read into directly.
+        @internal */
+    template <class Archive, class Iterator> inline
+    void overwrite_binary_data( Archive & ar, Iterator iter, std::size_t size )
+    {
+      using T = typename std::iterator_traits<Iterator>::value_type;
+      load_binary_chunks<T>( ar, size, [&iter]( T const * data, std::size_t count )
+      {
+        iter = std::copy( data, data + count, iter );
+      } );
+    }
+
+    //! The maximum size of a container
+    /*! @internal */
+    template <class Container> inline
+    auto load_max_size( Container const & container, int ) -> decltype( std::size_t( container.max_size() ) )
+    {
+      return container.max_size();
+    }
+
+    //! Containers without max_size(), such as some contiguous_container types, do not limit their size
+    /*! @internal */
+    template <class Container> inline
+    std::size_t load_max_size( Container const &, long )
+    {
+      return (std::numeric_limits<std::size_t>::max)();
+    }
+
+    //! Checks that a size loaded from an archive does not exceed the maximum size of a container
+    /*! @return Whether the size fits, otherwise an error has been reported to the archive
+        @internal */
+    template <class Archive, class Container> inline
+    bool check_load_size( Archive & ar, Container const & container, std::size_t size )
+    {
+      std::size_t const maxSize = load_max_size( container, 0 );
+      if( size <= maxSize )
+        return true;
+
+      CEREAL_THROW_ON_ERROR( ar, "Loaded size " + std::to_string( size ) + " exceeds the maximum size of the container " + std::to_string( maxSize ) );
+      ar.setError( "Loaded size exceeds the maximum size of the container" );
+      return false;
+    }
+
+    //! Resizes a container to a size loaded from an archive in steps, loading the new elements of each step
+    /*! The function is called with the indices [first, last) of the elements to load.  Elements
+        the container already holds are loaded in place first, then the container is grown a
+        load_step at a time and the new elements of each step are loaded.  Stops after a step
+        fails to load.  Capacity is grown ahead of the steps, see reserve_for_load.
+        @internal */
+    template <class Archive, class Container, class Function> inline
+    void load_in_steps( Archive & ar, Container & container, std::size_t size, Function && function )
+    {
+      std::size_t const step = load_step<typename Container::value_type>();
+      std::size_t loaded = size < container.size() ? size : container.size();
+
+      container.resize( loaded );
+      if( loaded )
+        function( std::size_t( 0 ), loaded );
+
+      while( loaded < size && ar.ok() )
+      {
+        std::size_t const next = size - loaded < step ? size : loaded + step;
+        reserve_for_load( ar, container, next, size );
+        container.resize( next );
+        function( loaded, next );
+        loaded = next;
+      }
+    }
+
+    //! Loads binary data for a number of elements straight into the storage of a contiguous container
+    /*! The container is grown in steps, see load_in_steps.
+        @internal */
+    template <class Archive, class Container> inline
+    void load_binary_in_steps( Archive & ar, Container & container, std::size_t size )
+    {
+      using T = typename Container::value_type;
+      load_in_steps( ar, container, size, [&ar, &container]( std::size_t first, std::size_t last )
+      {
+        ar( BinaryData<T *>( &container[0] + first, ( last - first ) * sizeof(T) ) );
+      } );
+    }
+
+    //! Whether a container supports node handles, which C++17 added to associative containers
+    template <class Container, class SFINAE = void>
+    struct has_node_handles : std::false_type {};
+
+    #ifdef CEREAL_HAS_CPP17
+    template <class Container>
+    struct has_node_handles<Container, std::void_t<typename Container::node_type,
+      decltype( std::declval<Container &>().extract( std::declval<typename Container::const_iterator>() ) )>> : std::true_type {};
+    #endif // CEREAL_HAS_CPP17
+
+    //! Whether an associative container is unordered
+    template <class Container, class SFINAE = void>
+    struct is_unordered : std::false_type {};
+
+    template <class Container>
+    struct is_unordered<Container, decltype( std::declval<Container const &>().bucket_count(), void() )> : std::true_type {};
+
+    //! Creates an empty ordered container that compares keys and allocates like another one
+    template <class Container> inline
+    Container empty_like( Container const & container, std::size_t, std::false_type /* unordered */ )
+    {
+      return Container( container.key_comp(), container.get_allocator() );
+    }
+
+    //! Creates an empty unordered container that hashes keys and allocates like another one
+    /*! Its bucket array is sized for size elements */
+    template <class Container> inline
+    Container empty_like( Container const & container, std::size_t size, std::true_type /* unordered */ )
+    {
+      Container result( 0, container.hash_function(), container.key_eq(), container.get_allocator() );
+      result.reserve( size );
+      return result;
+    }
+
+    //! Loads elements into the nodes an associative container already holds
+    /*! The container is emptied and its nodes are extracted one at a time.  load loads
+        an element into the value of each node, which is then inserted back.  Nodes that
+        are missing are default constructed and the ones left over are freed, so loading
+        elements of the same shape as before does not allocate, apart from the bucket
+        array of unordered containers.
+
+        Like loading into a new element, insertion is hinted by the previous element, or
+        by the end of the container if appendAtEnd is set.  Requires node handles.
+        @internal */
+    template <class Container, class Load> inline
+    void load_into_nodes( Container & container, std::size_t size, bool appendAtEnd, Load && load )
+    {
+      Container nodes = empty_like( container, size, is_unordered<Container>() );
+      nodes.swap( container );
+
+      auto hint = container.begin();
+      for( std::size_t i = 0; i < size; ++i )
+      {
+        if( nodes.empty() )
+          nodes.emplace();
+
+        auto node = nodes.extract( nodes.begin() );
+        load( node );
+
+        if( appendAtEnd )
+          hint = container.end();
+        hint = container.insert( hint, std::move( node ) );
+      }
+    }
+  } // namespace detail
+
   namespace detail
   {
     //! Tag for Version, which due to its anonymous namespace, becomes a different
@@ -47,10 +47,10 @@
 
 #include "cereal/details/polymorphic_impl_fwd.hpp"
 #include "cereal/details/static_object.hpp"
+#include "cereal/details/type_index.hpp"
 #include "cereal/types/memory.hpp"
 #include "cereal/types/string.hpp"
 #include <functional>
-#include <typeindex>
 #include <map>
 #include <limits>
 #include <set>
@@ -124,25 +124,26 @@ namespace cereal
     struct PolymorphicCasters
     {
       //! Maps from a derived type index to a set of chainable casters
-      using DerivedCasterMap = std::unordered_map<std::type_index, std::vector<PolymorphicCaster const *>>;
+      using DerivedCasterMap = type_map<std::vector<PolymorphicCaster const *>>;
       //! Maps from base type index to a map from derived type index to caster
-      std::unordered_map<std::type_index, DerivedCasterMap> map;
+      type_map<DerivedCasterMap> map;
 
-      std::multimap<std::type_index, std::type_index> reverseMap;
+      std::multimap<type_index, type_index> reverseMap;
 
       //! Error message used for unregistered polymorphic casts
-      #define UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(LoadSave)                                                                                                                \
-        throw cereal::Exception("Trying to " #LoadSave " a registered polymorphic type with an unregistered polymorphic cast.\n"                                               \
-                                "Could not find a path to a base class (" + util::demangle(baseInfo.name()) + ") for type: " + ::cereal::util::demangledName<Derived>() + "\n" \
-                                "Make sure you either serialize the base class at some point via cereal::base_class or cereal::virtual_base_class.\n"                          \
-                                "Alternatively, manually register the association with CEREAL_REGISTER_POLYMORPHIC_RELATION.");
+      #define UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(LoadSave)                                                                                                                 \
+        CEREAL_THROW_ON_ERROR(ar, "Trying to " #LoadSave " a registered polymorphic type with an unregistered polymorphic cast.\n"                                              \
+                                  "Could not find a path to a base class (" + util::demangle(baseInfo.name()) + ") for type: " + ::cereal::util::demangledName<Derived>() + "\n" \
+                                  "Make sure you either serialize the base class at some point via cereal::base_class or cereal::virtual_base_class.\n"                        \
+                                  "Alternatively, manually register the association with CEREAL_REGISTER_POLYMORPHIC_RELATION.");                                              \
+        ar.setError("Trying to " #LoadSave " a registered polymorphic type with an unregistered polymorphic cast");
 
       //! Checks if the mapping object that can perform the upcast or downcast exists, and returns it if so
       /*! Uses the type index from the base and derived class to find the matching
           registered caster. If no matching caster exists, the bool in the pair will be false and the vector
           reference should not be used. */
       static std::pair<bool, std::vector<PolymorphicCaster const *> const &>
-      lookup_if_exists( std::type_index const & baseIndex, std::type_index const & derivedIndex )
+      lookup_if_exists( type_index const & baseIndex, type_index const & derivedIndex )
       {
         // First phase of lookup - match base type index
         auto const & baseMap = StaticObject<PolymorphicCasters>::getInstance().map;
@@ -161,34 +162,32 @@ namespace cereal
 
       //! Gets the mapping object that can perform the upcast or downcast
       /*! Uses the type index from the base and derived class to find the matching
-          registered caster. If no matching caster exists, calls the exception function.
+          registered caster. If no matching caster exists, calls the error function and returns nullptr.
 
-          The returned PolymorphicCaster is capable of upcasting or downcasting between the two types. */
+          The returned PolymorphicCasters are capable of upcasting or downcasting between the two types. */
       template <class F> inline
-      static std::vector<PolymorphicCaster const *> const & lookup( std::type_index const & baseIndex, std::type_index const & derivedIndex, F && exceptionFunc )
+      static std::vector<PolymorphicCaster const *> const * lookup( type_index const & baseIndex, type_index const & derivedIndex, F && errorFunc )
       {
-        // First phase of lookup - match base type index
-        auto const & baseMap = StaticObject<PolymorphicCasters>::getInstance().map;
-        auto baseIter = baseMap.find( baseIndex );
-        if( baseIter == baseMap.end() )
-          exceptionFunc();
-
-        // Second phase - find a match from base to derived
-        auto const & derivedMap = baseIter->second;
-        auto derivedIter = derivedMap.find( derivedIndex );
-        if( derivedIter == derivedMap.end() )
-          exceptionFunc();
+        auto result = lookup_if_exists( baseIndex, derivedIndex );
+        if( !result.first )
+        {
+          errorFunc();
+          return nullptr;
+        }
 
-        return derivedIter->second;
+        return &result.second;
       }
 
       //! Performs a downcast to the derived type using a registered mapping
-      template <class Derived> inline
-      static const Derived * downcast( const void * dptr, std::type_info const & baseInfo )
+      /*! Returns nullptr and sets the error state of the archive if no mapping exists */
+      template <class Derived, class Archive> inline
+      static const Derived * downcast( Archive & ar, const void * dptr, type_index const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(save) } );
+        auto const * mapping = lookup( baseInfo, type_index_of<Derived>(), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(save) } );
+        if( !mapping )
+          return nullptr;
 
-        for( auto const * dmap : mapping )
+        for( auto const * dmap : *mapping )
           dptr = dmap->downcast( dptr );
 
         return static_cast<Derived const *>( dptr );
@@ -197,26 +196,30 @@ namespace cereal
       //! Performs an upcast to the registered base type using the given a derived type
       /*! The return is untyped because the final casting to the base type must happen in the polymorphic
           serialization function, where the type is known at compile time */
-      template <class Derived> inline
-      static void * upcast( Derived * const dptr, std::type_info const & baseInfo )
+      template <class Derived, class Archive> inline
+      static void * upcast( Archive & ar, Derived * const dptr, type_index const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        auto const * mapping = lookup( baseInfo, type_index_of<Derived>(), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        if( !mapping )
+          return nullptr;
 
         void * uptr = dptr;
-        for( auto mIter = mapping.rbegin(), mEnd = mapping.rend(); mIter != mEnd; ++mIter )
+        for( auto mIter = mapping->rbegin(), mEnd = mapping->rend(); mIter != mEnd; ++mIter )
           uptr = (*mIter)->upcast( uptr );
 
         return uptr;
       }
 
       //! Upcasts for shared pointers
-      template <class Derived> inline
-      static std::shared_ptr<void> upcast( std::shared_ptr<Derived> const & dptr, std::type_info const & baseInfo )
+      template <class Derived, class Archive> inline
+      static std::shared_ptr<void> upcast( Archive & ar, std::shared_ptr<Derived> const & dptr, type_index const & baseInfo )
       {
-        auto const & mapping = lookup( baseInfo, typeid(Derived), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        auto const * mapping = lookup( baseInfo, type_index_of<Derived>(), [&](){ UNREGISTERED_POLYMORPHIC_CAST_EXCEPTION(load) } );
+        if( !mapping )
+          return nullptr;
 
         std::shared_ptr<void> uptr = dptr;
-        for( auto mIter = mapping.rbegin(), mEnd = mapping.rend(); mIter != mEnd; ++mIter )
+        for( auto mIter = mapping->rbegin(), mEnd = mapping->rend(); mIter != mEnd; ++mIter )
           uptr = (*mIter)->upcast( uptr );
 
         return uptr;
@@ -233,6 +236,33 @@ namespace cereal
       map.emplace( key, value );
     #endif // NOT_CEREAL_OLDER_GCC
 
+    #if CEREAL_NO_RTTI
+    //! Checks whether Base can be downcast to Derived with a static_cast, i.e. it is not a virtual base
+    template <class Base, class Derived>
+    struct can_static_downcast
+    {
+      template <class B, class D>
+      static auto test(int) -> decltype( static_cast<D const *>( std::declval<B const *>() ), traits::yes() );
+      template <class, class>
+      static traits::no test(...);
+
+      using type = decltype( test<Base, Derived>( 0 ) );
+      static const bool value = type::value;
+    };
+
+    //! Checks whether T declares its own CEREAL_POLYMORPHIC_TYPE_ID, rather than inheriting one
+    template <class T>
+    struct has_own_type_id
+    {
+      template <class TT>
+      static auto test(int) -> typename std::is_same<decltype( &TT::cereal_type_index ), type_index (TT::*)() const>::type;
+      template <class>
+      static traits::no test(...);
+
+      static const bool value = decltype( test<T>( 0 ) )::value;
+    };
+    #endif // CEREAL_NO_RTTI
+
     //! Strongly typed derivation of PolymorphicCaster
     template <class Base, class Derived>
     struct PolymorphicVirtualCaster : PolymorphicCaster
@@ -243,8 +273,8 @@ namespace cereal
           assuming dynamic type information is available */
       PolymorphicVirtualCaster()
       {
-        const auto baseKey = std::type_index(typeid(Base));
-        const auto derivedKey = std::type_index(typeid(Derived));
+        const auto baseKey = type_index_of<Base>();
+        const auto derivedKey = type_index_of<Derived>();
 
         // First insert the relation Base->Derived
         const auto lock = StaticObject<PolymorphicCasters>::lock();
@@ -271,7 +301,7 @@ namespace cereal
         {
           // Checks whether there is a path from parent->child and returns a <dist, path> pair
           // dist is set to MAX if the path does not exist
-          auto checkRelation = [](std::type_index const & parentInfo, std::type_index const & childInfo) ->
+          auto checkRelation = [](type_index const & parentInfo, type_index const & childInfo) ->
             std::pair<size_t, std::vector<PolymorphicCaster const *> const &>
           {
             auto result = PolymorphicCasters::lookup_if_exists( parentInfo, childInfo );
@@ -284,12 +314,12 @@ namespace cereal
               return {(std::numeric_limits<size_t>::max)(), {}};
           };
 
-          std::stack<std::type_index>         parentStack;      // Holds the parent nodes to be processed
-          std::vector<std::type_index> dirtySet;                // Marks child nodes that have been changed
-          std::unordered_set<std::type_index> processedParents; // Marks parent nodes that have been processed
+          std::stack<type_index>         parentStack;      // Holds the parent nodes to be processed
+          std::vector<type_index> dirtySet;                // Marks child nodes that have been changed
+          std::unordered_set<type_index> processedParents; // Marks parent nodes that have been processed
 
           // Checks if a child has been marked dirty
-          auto isDirty = [&](std::type_index const & c)
+          auto isDirty = [&](type_index const & c)
           {
             auto const dirtySetSize = dirtySet.size();
             for( size_t i = 0; i < dirtySetSize; ++i )
@@ -305,7 +335,7 @@ namespace cereal
 
           while( !parentStack.empty() )
           {
-            using Relations = std::unordered_multimap<std::type_index, std::pair<std::type_index, std::vector<PolymorphicCaster const *>>>;
+            using Relations = std::unordered_multimap<type_index, std::pair<type_index, std::vector<PolymorphicCaster const *>>>;
             Relations unregisteredRelations; // Defer insertions until after main loop to prevent iterator invalidation
 
             const auto parent = parentStack.top();
@@ -347,7 +377,7 @@ namespace cereal
                     if( uncommittedExists && (hint->second.second.size() <= newLength) )
                       continue;
 
-                    auto newPath = std::pair<std::type_index, std::vector<PolymorphicCaster const *>>{finalChild, std::move(path)};
+                    auto newPath = std::pair<type_index, std::vector<PolymorphicCaster const *>>{finalChild, std::move(path)};
 
                     // Insert the new path if it doesn't exist, otherwise this will just lookup where to do the
                     // replacement
@@ -393,6 +423,39 @@ namespace cereal
 
       #undef CEREAL_EMPLACE_MAP
 
+      #if CEREAL_NO_RTTI
+      //! Performs the proper downcast with the templated types
+      /*! Without RTTI the dynamic type has already been looked up through its type id,
+          so a static_cast is sufficient, except from a virtual base where none is possible */
+      void const * downcast( void const * const ptr ) const override
+      {
+        return downcast( ptr, typename can_static_downcast<Base, Derived>::type() );
+      }
+
+      //! Performs the proper upcast with the templated types
+      void * upcast( void * const ptr ) const override
+      {
+        return static_cast<Base*>( static_cast<Derived*>( ptr ) );
+      }
+
+      //! Performs the proper upcast with the templated types (shared_ptr version)
+      std::shared_ptr<void> upcast( std::shared_ptr<void> const & ptr ) const override
+      {
+        return std::static_pointer_cast<Base>( std::static_pointer_cast<Derived>( ptr ) );
+      }
+
+    private:
+      void const * downcast( void const * const ptr, std::true_type /* can_static_downcast */ ) const
+      {
+        return static_cast<Derived const*>( static_cast<Base const*>( ptr ) );
+      }
+
+      void const * downcast( void const * const, std::false_type /* can_static_downcast */ ) const
+      {
+        CEREAL_THROW_EXCEPTION(cereal::Exception("Cannot downcast from the virtual base class " + util::demangledName<Base>() +
+                                                 " to " + util::demangledName<Derived>() + " without RTTI"));
+      }
+      #else // RTTI is enabled
       //! Performs the proper downcast with the templated types
       void const * downcast( void const * const ptr ) const override
       {
@@ -410,6 +473,7 @@ namespace cereal
       {
         return std::dynamic_pointer_cast<Base>( std::static_pointer_cast<Derived>( ptr ) );
       }
+      #endif // CEREAL_NO_RTTI
     };
 
     //! Registers a polymorphic casting relation between a Base and Derived type
@@ -458,7 +522,7 @@ namespace cereal
           a pointer to actual data (contents of smart_ptr's get() function)
           as their second parameter, and the type info of the owning smart_ptr
           as their final parameter */
-      typedef std::function<void(void*, void const *, std::type_info const &)> Serializer;
+      typedef std::function<void(void*, void const *, type_index const &)> Serializer;
 
       //! Struct containing the serializer functions for all pointer types
       struct Serializers
@@ -468,7 +532,7 @@ namespace cereal
       };
 
       //! A map of serializers for pointers of all registered types
-      std::map<std::type_index, Serializers> map;
+      type_map<Serializers> map;
     };
 
     //! An empty noop deleter
@@ -488,9 +552,9 @@ namespace cereal
           a shared_ptr (or unique_ptr for the unique case) of any base
           type, and the type id of said base type as the third parameter.
           Internally it will properly be loaded and cast to the correct type. */
-      typedef std::function<void(void*, std::shared_ptr<void> &, std::type_info const &)> SharedSerializer;
+      typedef std::function<void(void*, std::shared_ptr<void> &, type_index const &)> SharedSerializer;
       //! Unique ptr serializer function
-      typedef std::function<void(void*, std::unique_ptr<void, EmptyDeleter<void>> &, std::type_info const &)> UniqueSerializer;
+      typedef std::function<void(void*, std::unique_ptr<void, EmptyDeleter<void>> &, type_index const &)> UniqueSerializer;
 
       //! Struct containing the serializer functions for all pointer types
       struct Serializers
@@ -528,25 +592,28 @@ namespace cereal
         typename InputBindingMap<Archive>::Serializers serializers;
 
         serializers.shared_ptr =
-          [](void * arptr, std::shared_ptr<void> & dptr, std::type_info const & baseInfo)
+          [](void * arptr, std::shared_ptr<void> & dptr, type_index const & baseInfo)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
             std::shared_ptr<T> ptr;
 
             ar( CEREAL_NVP_("ptr_wrapper", ::cereal::memory_detail::make_ptr_wrapper(ptr)) );
 
-            dptr = PolymorphicCasters::template upcast<T>( ptr, baseInfo );
+            dptr = PolymorphicCasters::template upcast<T>( ar, ptr, baseInfo );
           };
 
         serializers.unique_ptr =
-          [](void * arptr, std::unique_ptr<void, EmptyDeleter<void>> & dptr, std::type_info const & baseInfo)
+          [](void * arptr, std::unique_ptr<void, EmptyDeleter<void>> & dptr, type_index const & baseInfo)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
             std::unique_ptr<T> ptr;
 
             ar( CEREAL_NVP_("ptr_wrapper", ::cereal::memory_detail::make_ptr_wrapper(ptr)) );
 
-            dptr.reset( PolymorphicCasters::template upcast<T>( ptr.release(), baseInfo ));
+            void * uptr = PolymorphicCasters::template upcast<T>( ar, ptr.get(), baseInfo );
+            if( uptr )
+              ptr.release();
+            dptr.reset( uptr );
           };
 
         map.insert( lb, { std::move(key), std::move(serializers) } );
@@ -637,8 +704,14 @@ namespace cereal
       //! Initialize the binding
       OutputBindingCreator()
       {
+        #if CEREAL_NO_RTTI
+        static_assert( has_own_type_id<T>::value,
+                       "cereal could not find a type id for a registered polymorphic type while RTTI is disabled.\n"
+                       "Add CEREAL_POLYMORPHIC_TYPE_ID() to the public section of this type and of its bases." );
+        #endif // CEREAL_NO_RTTI
+
         auto & map = StaticObject<OutputBindingMap<Archive>>::getInstance().map;
-        auto key = std::type_index(typeid(T));
+        auto key = type_index_of<T>();
         auto lb = map.lower_bound(key);
 
         if (lb != map.end() && lb->first == key)
@@ -647,12 +720,14 @@ namespace cereal
         typename OutputBindingMap<Archive>::Serializers serializers;
 
         serializers.shared_ptr =
-          [&](void * arptr, void const * dptr, std::type_info const & baseInfo)
+          [&](void * arptr, void const * dptr, type_index const & baseInfo)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
             writeMetadata(ar);
 
-            auto ptr = PolymorphicCasters::template downcast<T>( dptr, baseInfo );
+            auto ptr = PolymorphicCasters::template downcast<T>( ar, dptr, baseInfo );
+            if( !ptr )
+              return;
 
             #ifdef _MSC_VER
             savePolymorphicSharedPtr( ar, ptr, ::cereal::traits::has_shared_from_this<T>::type() ); // MSVC doesn't like typename here
@@ -662,12 +737,14 @@ namespace cereal
           };
 
         serializers.unique_ptr =
-          [&](void * arptr, void const * dptr, std::type_info const & baseInfo)
+          [&](void * arptr, void const * dptr, type_index const & baseInfo)
           {
             Archive & ar = *static_cast<Archive*>(arptr);
             writeMetadata(ar);
 
-            std::unique_ptr<T const, EmptyDeleter<T const>> const ptr( PolymorphicCasters::template downcast<T>( dptr, baseInfo ) );
+            std::unique_ptr<T const, EmptyDeleter<T const>> const ptr( PolymorphicCasters::template downcast<T>( ar, dptr, baseInfo ) );
+            if( !ptr )
+              return;
 
             ar( CEREAL_NVP_("ptr_wrapper", memory_detail::make_ptr_wrapper(ptr)) );
           };
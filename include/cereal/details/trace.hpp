@@ -0,0 +1,308 @@
+/*! \file trace.hpp
+    \brief Static tracepoints and a hook for observing archive activity
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_TRACE_HPP_
+#define CEREAL_DETAILS_TRACE_HPP_
+
+#include "cereal/macros.hpp"
+#include "cereal/details/helpers.hpp"
+#include "cereal/details/type_index.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#ifndef CEREAL_TRACE_SDT
+//! Whether tracepoints emit SystemTap SDT probes
+/*! The probes can be listed with e.g. `readelf -n` and attached to with perf,
+    bpftrace or SystemTap without rebuilding.  A probe is a single nop until
+    something attaches to it.  This is enabled along with CEREAL_TRACE on ELF
+    targets where the probe notes are supported. */
+  #if CEREAL_TRACE && defined(__ELF__) && (defined(__GNUC__) || defined(__clang__)) && \
+      (defined(__x86_64__) || defined(__aarch64__))
+    #define CEREAL_TRACE_SDT 1
+  #else
+    #define CEREAL_TRACE_SDT 0
+  #endif
+#endif // CEREAL_TRACE_SDT
+
+#if CEREAL_TRACE_SDT
+//! Emits a SystemTap SDT probe named cereal:name with five 64 bit arguments
+/*! This writes the same .note.stapsdt entry as sys/sdt.h, without depending on it.
+    @internal */
+#define CEREAL_SDT_PROBE_(name, a0, a1, a2, a3, a4)                            \
+  __asm__ __volatile__ (                                                       \
+    "990: nop\n"                                                               \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                              \
+    ".balign 4\n"                                                              \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                         \
+    "991: .asciz \"stapsdt\"\n"                                                \
+    "992: .balign 4\n"                                                         \
+    "993: .8byte 990b\n"                                                       \
+    ".8byte _.stapsdt.base\n"                                                  \
+    ".8byte 0\n"                                                               \
+    ".asciz \"cereal\"\n"                                                      \
+    ".asciz \"" #name "\"\n"                                                   \
+    ".asciz \"8@%0 8@%1 8@%2 8@%3 8@%4\"\n"                                    \
+    "994: .balign 4\n"                                                         \
+    ".popsection\n"                                                            \
+    ".ifndef _.stapsdt.base\n"                                                 \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"    \
+    ".weak _.stapsdt.base\n"                                                   \
+    ".hidden _.stapsdt.base\n"                                                 \
+    "_.stapsdt.base: .space 1\n"                                               \
+    ".size _.stapsdt.base, 1\n"                                                \
+    ".popsection\n"                                                            \
+    ".endif\n"                                                                 \
+    :: "nor"(a0), "nor"(a1), "nor"(a2), "nor"(a3), "nor"(a4) )
+#endif // CEREAL_TRACE_SDT
+
+namespace cereal
+{
+  //! The points at which archives report their activity to tracing
+  /*! Each event is also available as an SDT probe named after it, e.g.
+      cereal:call_begin, see CEREAL_TRACE_SDT. */
+  enum class TraceEvent : std::uint8_t
+  {
+    ArchiveCreated,   //!< An archive was constructed (probe: archive_created)
+    ArchiveDestroyed, //!< An archive was destroyed (probe: archive_destroyed)
+    CallBegin,        //!< An outermost call to an archive started (probe: call_begin)
+    CallEnd,          //!< An outermost call to an archive returned (probe: call_end)
+    PolymorphicSave,  //!< A polymorphic pointer was dispatched for saving (probe: polymorphic_save)
+    PolymorphicLoad,  //!< A polymorphic pointer was dispatched for loading (probe: polymorphic_load)
+    SizeTag           //!< A container size was processed (probe: size_tag)
+  };
+
+  //! An event reported to the trace hook
+  /*! The probes receive the same fields as their arguments, in order: archive,
+      input, bytes, typeId and typeName. */
+  struct TraceRecord
+  {
+    TraceEvent event;     //!< What happened
+    bool input;           //!< Whether the archive is an input archive
+    void const * archive; //!< The archive, which identifies it across events
+    //! A byte count that depends on the event
+    /*! For CallBegin and ArchiveDestroyed, the number of bytes the archive processed so far.
+        For CallEnd, the number of bytes processed during the call.  For SizeTag, the size
+        itself.  Archives that do not count their bytes (the text archives) report 0. */
+    std::uint64_t bytes;
+    //! Identifies the type involved in the event
+    /*! This is the archive type for ArchiveCreated and ArchiveDestroyed, the type of the
+        first argument for calls, the dynamic type for PolymorphicSave and the type of
+        the size for SizeTag.  For PolymorphicLoad it is a hash of the registered name.
+        Ids are stable within a process but not across processes. */
+    std::size_t typeId;
+    //! The name of the type identified by typeId
+    /*! This is the registered name for PolymorphicLoad and the (possibly mangled)
+        implementation name of the type otherwise.  It is only valid during the hook. */
+    char const * typeName;
+  };
+
+  //! A function that receives trace events, see setTraceHook
+  using TraceHook = void (*)( TraceRecord const & record );
+
+  namespace detail
+  {
+    //! Holds the installed trace hook
+    /*! A static data member is initialized before any dynamic initialization takes place,
+        so reading it needs no guard.
+        @internal */
+    template <class T = void>
+    struct trace_hook
+    {
+      static std::atomic<TraceHook> value;
+    };
+
+    template <class T>
+    std::atomic<TraceHook> trace_hook<T>::value( nullptr );
+  } // namespace detail
+
+  //! Installs a hook that receives all trace events, or removes it when passed nullptr
+  /*! Events are only generated when cereal is built with CEREAL_TRACE.  Archives then
+      check for a hook with a single relaxed load and branch at each trace point, and only
+      describe the event when a hook is installed or SDT probes are built in.  The hook
+      is called on the thread using the archive and must not use that archive.
+
+      @code{.cpp}
+      #define CEREAL_TRACE 1
+      #include <cereal/archives/binary.hpp>
+
+      void onTrace( cereal::TraceRecord const & record )
+      {
+        if( record.event == cereal::TraceEvent::CallEnd )
+          std::cerr << record.typeName << ": " << record.bytes << " bytes\n";
+      }
+
+      cereal::setTraceHook( onTrace );
+      @endcode */
+  inline void setTraceHook( TraceHook hook ) CEREAL_NOEXCEPT
+  {
+    detail::trace_hook<>::value.store( hook, std::memory_order_release );
+  }
+
+  //! Gets the currently installed trace hook, or nullptr if there is none
+  inline TraceHook getTraceHook() CEREAL_NOEXCEPT
+  {
+    return detail::trace_hook<>::value.load( std::memory_order_acquire );
+  }
+
+  namespace detail
+  {
+    //! Whether anything can receive trace events, so that describing them is worthwhile
+    /*! SDT probes have no semaphore, so with them built in events are always described.
+        @internal */
+    inline bool tracing() CEREAL_NOEXCEPT
+    {
+      return CEREAL_TRACE_SDT || trace_hook<>::value.load( std::memory_order_relaxed ) != nullptr;
+    }
+
+    //! The id of the type T reported in trace records
+    /*! Hashing a std::type_index hashes the type name, so this is only done once per type.
+        @internal */
+    template <class T> inline
+    std::size_t trace_type_id()
+    {
+      static std::size_t const id = type_index_of<T>().hash_code();
+      return id;
+    }
+
+    //! Reports a trace event to the probes and the installed hook
+    /*! @internal */
+    inline void trace( TraceRecord const & record )
+    {
+      #if CEREAL_TRACE_SDT
+      std::uint64_t const archive = reinterpret_cast<std::uintptr_t>( record.archive );
+      std::uint64_t const input = record.input;
+      std::uint64_t const bytes = record.bytes;
+      std::uint64_t const typeId = record.typeId;
+      std::uint64_t const typeName = reinterpret_cast<std::uintptr_t>( record.typeName );
+
+      switch( record.event )
+      {
+        case TraceEvent::ArchiveCreated:   CEREAL_SDT_PROBE_( archive_created, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::ArchiveDestroyed: CEREAL_SDT_PROBE_( archive_destroyed, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::CallBegin:        CEREAL_SDT_PROBE_( call_begin, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::CallEnd:          CEREAL_SDT_PROBE_( call_end, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::PolymorphicSave:  CEREAL_SDT_PROBE_( polymorphic_save, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::PolymorphicLoad:  CEREAL_SDT_PROBE_( polymorphic_load, archive, input, bytes, typeId, typeName ); break;
+        case TraceEvent::SizeTag:          CEREAL_SDT_PROBE_( size_tag, archive, input, bytes, typeId, typeName ); break;
+      }
+      #endif // CEREAL_TRACE_SDT
+
+      if( TraceHook const hook = trace_hook<>::value.load( std::memory_order_relaxed ) )
+        hook( record );
+    }
+
+    //! Reports a trace event involving the type identified by index
+    /*! @internal */
+    template <class Archive> inline
+    void trace( TraceEvent event, Archive const * archive, std::uint64_t bytes, type_index const & index )
+    {
+      if( tracing() )
+        trace( TraceRecord{ event, std::is_base_of<InputArchiveBase, Archive>::value, archive, bytes, index.hash_code(), index.name() } );
+    }
+
+    //! Reports a trace event involving the type T
+    /*! @internal */
+    template <class T, class Archive> inline
+    void trace( TraceEvent event, Archive const * archive, std::uint64_t bytes )
+    {
+      if( tracing() )
+        trace( TraceRecord{ event, std::is_base_of<InputArchiveBase, Archive>::value, archive, bytes, trace_type_id<T>(), type_index_of<T>().name() } );
+    }
+
+    //! Reports a trace event involving a registered polymorphic type name
+    /*! @internal */
+    template <class Archive> inline
+    void trace( TraceEvent event, Archive const * archive, std::uint64_t bytes, std::string const & name )
+    {
+      if( tracing() )
+        trace( TraceRecord{ event, std::is_base_of<InputArchiveBase, Archive>::value, archive, bytes, std::hash<std::string>()( name ), name.c_str() } );
+    }
+
+    //! Reports processed SizeTags
+    /*! @internal */
+    template <class Archive, class T> inline
+    void trace_size_tag( Archive const & ar, SizeTag<T> const & tag )
+    {
+      trace<typename std::decay<T>::type>( TraceEvent::SizeTag, &ar, static_cast<std::uint64_t>( tag.size ) );
+    }
+
+    //! Everything other than a SizeTag is not traced by itself
+    /*! @internal */
+    template <class Archive, class T> inline
+    void trace_size_tag( Archive const &, T const & )
+    { }
+
+    //! The type reported for a call to an archive with arguments of types Types
+    /*! @internal */
+    template <class ... Types>
+    struct trace_call_type
+    {
+      using type = void;
+    };
+
+    template <class T, class ... Types>
+    struct trace_call_type<T, Types...>
+    {
+      using type = T;
+    };
+
+    //! Reports the beginning and end of an outermost call to an archive
+    /*! @internal */
+    template <class T, class Archive>
+    class TraceCall
+    {
+      public:
+        TraceCall( Archive const & ar, std::uint64_t const & bytes, bool outermost ) :
+          itsArchive( &ar ), itsBytes( bytes ), itsStart( bytes ), itsOutermost( outermost )
+        {
+          if( itsOutermost )
+            trace<T>( TraceEvent::CallBegin, itsArchive, itsStart );
+        }
+
+        ~TraceCall()
+        {
+          if( itsOutermost )
+            trace<T>( TraceEvent::CallEnd, itsArchive, itsBytes - itsStart );
+        }
+
+        TraceCall( TraceCall const & ) = delete;
+        TraceCall & operator=( TraceCall const & ) = delete;
+
+      private:
+        Archive const * itsArchive;
+        std::uint64_t const & itsBytes;
+        std::uint64_t const itsStart;
+        bool const itsOutermost;
+    };
+  } // namespace detail
+} // namespace cereal
+
+#endif // CEREAL_DETAILS_TRACE_HPP_
@@ -37,9 +37,13 @@
 #endif // __clang__
 
 #include <type_traits>
-#include <typeindex>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include "cereal/macros.hpp"
+#include "cereal/details/type_index.hpp"
 #include "cereal/access.hpp"
 
 namespace cereal
@@ -1146,19 +1150,75 @@ namespace cereal
       {
         template<class T>
           base_class_id(T const * const t) :
-          type(typeid(T)),
+          type(::cereal::detail::type_index_of<T>()),
           ptr(t),
-          hash(std::hash<std::type_index>()(typeid(T)) ^ (std::hash<void const *>()(t) << 1))
+          hash(type_hash<T>() ^ (std::hash<void const *>()(t) << 1))
           { }
 
           bool operator==(base_class_id const & other) const
           { return (type == other.type) && (ptr == other.ptr); }
 
-          std::type_index type;
+          ::cereal::detail::type_index type;
           void const * ptr;
           size_t hash;
+
+        private:
+          //! Hashes the type once, rather than once for every object
+          template <class T>
+          static size_t type_hash()
+          {
+            static const size_t typeHash = ::cereal::detail::type_index_of<T>().hash_code();
+            return typeHash;
+          }
       };
       struct base_class_id_hash { size_t operator()(base_class_id const & id) const { return id.hash; }  };
+
+      //! The virtual base classes serialized during one outermost call to an archive
+      /*! Most calls serialize only a few virtual bases, which are kept in a vector and
+          found by linear search.  Past a threshold they are moved into a hash set, which
+          is freed again by clear() so that later small calls do not pay for clearing
+          its buckets.
+          @internal */
+      class BaseClassSet
+      {
+        public:
+          //! Adds a base, returning whether it was not in the set yet
+          bool insert( base_class_id const & id )
+          {
+            if( itsLarge )
+              return itsLarge->insert( id ).second;
+
+            for( auto const & other : itsSmall )
+              if( other.hash == id.hash && other == id )
+                return false;
+
+            if( itsSmall.size() < smallSize )
+            {
+              itsSmall.push_back( id );
+              return true;
+            }
+
+            itsLarge.reset( new std::unordered_set<base_class_id, base_class_id_hash>( itsSmall.begin(), itsSmall.end() ) );
+            itsSmall.clear();
+            return itsLarge->insert( id ).second;
+          }
+
+          bool empty() const
+          { return itsSmall.empty() && !itsLarge; }
+
+          //! Removes all bases, keeping the capacity of the vector but freeing the hash set
+          void clear()
+          {
+            itsSmall.clear();
+            itsLarge.reset();
+          }
+
+        private:
+          static const std::size_t smallSize = 16;
+
+          std::vector<base_class_id> itsSmall;
+          std::unique_ptr<std::unordered_set<base_class_id, base_class_id_hash>> itsLarge;
+      };
     } // namespace detail
 
     namespace detail
@@ -1325,6 +1385,15 @@ namespace cereal
     struct is_text_archive : std::integral_constant<bool,
       std::is_base_of<TextArchive, detail::decay_archive<A>>::value>
     { };
+
+    //! The type used to save the index of the active alternative of a variant
+    /*! This is std::int32_t unless CEREAL_COMPACT_VARIANT_INDEX is enabled, in which case
+        binary archives use the smallest unsigned type able to hold Size alternatives
+        @internal */
+    template <class A, std::size_t Size>
+    using variant_index_type = typename std::conditional<!CEREAL_COMPACT_VARIANT_INDEX || is_text_archive<A>::value || ( Size > 65536 ),
+                                                         std::int32_t,
+                                                         typename std::conditional<( Size <= 256 ), std::uint8_t, std::uint16_t>::type>::type;
   } // namespace traits
 
   // ######################################################################
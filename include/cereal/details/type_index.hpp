@@ -0,0 +1,282 @@
+/*! \file type_index.hpp
+    \brief Internal type identification that works with or without RTTI
+    \ingroup Internal */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_DETAILS_TYPE_INDEX_HPP_
+#define CEREAL_DETAILS_TYPE_INDEX_HPP_
+
+#include "cereal/macros.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !CEREAL_NO_RTTI
+#include <typeindex>
+#endif
+
+#if CEREAL_NO_RTTI
+//! Gives a polymorphic type the virtual type id hook cereal needs when RTTI is disabled
+/*! Without RTTI cereal cannot ask an object for its dynamic type, so every polymorphic
+    type that is serialized through a pointer to one of its bases must report it through
+    this hook.  Place it in the public section of the base class and of every registered
+    derived class:
+
+    @code{.cpp}
+    struct Base
+    {
+      virtual ~Base() = default;
+      CEREAL_POLYMORPHIC_TYPE_ID()
+    };
+
+    struct Derived : Base
+    {
+      CEREAL_POLYMORPHIC_TYPE_ID()
+    };
+    @endcode
+
+    A registered derived type that does not provide its own hook is a compile time error.
+    When RTTI is enabled this macro expands to nothing, so it can be left in place for
+    code that is built in both configurations. */
+#define CEREAL_POLYMORPHIC_TYPE_ID()                                                        \
+  virtual ::cereal::detail::type_index cereal_type_index() const                            \
+  {                                                                                         \
+    return ::cereal::detail::type_index_of<                                                 \
+      typename std::remove_reference<decltype(*this)>::type>();                             \
+  }
+
+#if defined(_MSC_VER)
+#define CEREAL_PRETTY_FUNCTION __FUNCSIG__
+#elif defined(__GNUC__)
+#define CEREAL_PRETTY_FUNCTION __PRETTY_FUNCTION__
+#else
+#define CEREAL_PRETTY_FUNCTION __func__
+#endif
+#else // RTTI is enabled
+#define CEREAL_POLYMORPHIC_TYPE_ID()
+#endif // CEREAL_NO_RTTI
+
+namespace cereal
+{
+  namespace detail
+  {
+    #if CEREAL_NO_RTTI
+    //! Stands in for std::type_info when RTTI is disabled
+    /*! One of these exists per type, and its address is the identity of that type.
+        @internal */
+    struct static_type_info
+    {
+      char const * (*name)(); //!< Gives a human readable name, for error messages only
+    };
+
+    //! Extracts the name of T from the signature of static_type_info_holder<T>::name
+    /*! @internal */
+    inline std::string type_name_from_signature( std::string const & signature )
+    {
+      // GCC and clang: "... static_type_info_holder<T>::name() [with T = Foo]"
+      auto const begin = signature.find( "T = " );
+      auto const end = signature.rfind( ']' );
+      if( begin != std::string::npos && end != std::string::npos && end > begin )
+        return signature.substr( begin + 4, end - begin - 4 );
+
+      // MSVC: "... static_type_info_holder<struct Foo>::name(void)"
+      auto const open = signature.find( "static_type_info_holder<" );
+      auto const close = signature.rfind( ">::name" );
+      if( open != std::string::npos && close != std::string::npos )
+        return signature.substr( open + 24, close - open - 24 );
+
+      return signature;
+    }
+
+    //! Holds the static_type_info for T
+    /*! @internal */
+    template <class T>
+    struct static_type_info_holder
+    {
+      static char const * name()
+      {
+        static const std::string typeName = type_name_from_signature( CEREAL_PRETTY_FUNCTION );
+        return typeName.c_str();
+      }
+
+      static const static_type_info info;
+    };
+
+    template <class T>
+    const static_type_info static_type_info_holder<T>::info = { &static_type_info_holder<T>::name };
+
+    //! Identifies a type without relying on RTTI
+    /*! Mirrors the interface of std::type_index, but compares the addresses of
+        static_type_info objects instead of std::type_info objects.  Like std::type_index
+        with merged type names, the identity of a type is only unique within a single
+        module; types shared between shared libraries must not be hidden.
+        @internal */
+    class type_index
+    {
+      public:
+        type_index( static_type_info const & info ) CEREAL_NOEXCEPT : itsInfo( &info ) {}
+
+        char const * name() const { return itsInfo->name(); }
+        std::size_t hash_code() const CEREAL_NOEXCEPT { return std::hash<static_type_info const *>()( itsInfo ); }
+
+        bool operator==( type_index const & other ) const CEREAL_NOEXCEPT { return itsInfo == other.itsInfo; }
+        bool operator!=( type_index const & other ) const CEREAL_NOEXCEPT { return itsInfo != other.itsInfo; }
+        bool operator<( type_index const & other ) const CEREAL_NOEXCEPT { return std::less<static_type_info const *>()( itsInfo, other.itsInfo ); }
+        bool operator>( type_index const & other ) const CEREAL_NOEXCEPT { return other < *this; }
+        bool operator<=( type_index const & other ) const CEREAL_NOEXCEPT { return !(other < *this); }
+        bool operator>=( type_index const & other ) const CEREAL_NOEXCEPT { return !(*this < other); }
+
+      private:
+        static_type_info const * itsInfo;
+    };
+
+    //! Gets the type_index of the static type T
+    /*! @internal */
+    template <class T> inline
+    type_index type_index_of()
+    {
+      using type = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+      return type_index( static_type_info_holder<type>::info );
+    }
+
+    //! Gets the type_index of the dynamic type of t, using CEREAL_POLYMORPHIC_TYPE_ID
+    /*! @internal */
+    template <class T> inline
+    type_index dynamic_type_index_of( T const & t )
+    {
+      return t.cereal_type_index();
+    }
+    #else // RTTI is enabled
+    using type_index = std::type_index;
+
+    //! Gets the type_index of the static type T
+    /*! @internal */
+    template <class T> inline
+    type_index type_index_of()
+    {
+      return std::type_index( typeid(T) );
+    }
+
+    //! Gets the type_index of the dynamic type of t
+    /*! @internal */
+    template <class T> inline
+    type_index dynamic_type_index_of( T const & t )
+    {
+      return std::type_index( typeid(t) );
+    }
+    #endif // CEREAL_NO_RTTI
+
+    //! A map from type_index to Value stored as a flat sorted table
+    /*! Entries are added while types register themselves during static initialization,
+        and looked up on every polymorphic save or load.  Lookups are a binary search over
+        contiguous storage instead of a walk through tree or hash nodes.
+
+        Inserting an entry invalidates references to all other entries.
+        @internal */
+    template <class Value>
+    class type_map
+    {
+      public:
+        using value_type = std::pair<type_index, Value>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        iterator begin() { return itsData.begin(); }
+        iterator end() { return itsData.end(); }
+        const_iterator begin() const { return itsData.begin(); }
+        const_iterator end() const { return itsData.end(); }
+
+        std::size_t size() const { return itsData.size(); }
+        bool empty() const { return itsData.empty(); }
+
+        //! Finds the first entry that is not less than key
+        iterator lower_bound( type_index const & key )
+        { return std::lower_bound( itsData.begin(), itsData.end(), key, compare ); }
+
+        //! Finds the first entry that is not less than key
+        const_iterator lower_bound( type_index const & key ) const
+        { return std::lower_bound( itsData.begin(), itsData.end(), key, compare ); }
+
+        //! Finds the entry for key, or end() if there is none
+        iterator find( type_index const & key )
+        {
+          auto iter = lower_bound( key );
+          return (iter != end() && iter->first == key) ? iter : end();
+        }
+
+        //! Finds the entry for key, or end() if there is none
+        const_iterator find( type_index const & key ) const
+        {
+          auto iter = lower_bound( key );
+          return (iter != end() && iter->first == key) ? iter : end();
+        }
+
+        std::size_t count( type_index const & key ) const
+        { return find( key ) != end() ? 1 : 0; }
+
+        //! Inserts value if there is no entry for its key yet
+        /*! @return The entry for the key, and whether an insertion took place */
+        std::pair<iterator, bool> insert( value_type value )
+        {
+          auto iter = lower_bound( value.first );
+          if( iter != end() && iter->first == value.first )
+            return {iter, false};
+
+          return {itsData.insert( iter, std::move( value ) ), true};
+        }
+
+        //! Gets the entry for key, default constructing it if there is none
+        Value & operator[]( type_index const & key )
+        { return insert( value_type( key, Value() ) ).first->second; }
+
+      private:
+        static bool compare( value_type const & entry, type_index const & key )
+        { return entry.first < key; }
+
+        std::vector<value_type> itsData;
+    };
+  } // namespace detail
+} // namespace cereal
+
+#if CEREAL_NO_RTTI
+namespace std
+{
+  //! Allows cereal::detail::type_index to be used in unordered containers, like std::type_index
+  template <>
+  struct hash<::cereal::detail::type_index>
+  {
+    std::size_t operator()( ::cereal::detail::type_index const & index ) const CEREAL_NOEXCEPT
+    { return index.hash_code(); }
+  };
+} // namespace std
+#endif // CEREAL_NO_RTTI
+
+#endif // CEREAL_DETAILS_TYPE_INDEX_HPP_
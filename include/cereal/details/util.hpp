@@ -30,6 +30,7 @@
 #ifndef CEREAL_DETAILS_UTIL_HPP_
 #define CEREAL_DETAILS_UTIL_HPP_
 
+#include "cereal/details/type_index.hpp"
 #include <typeinfo>
 #include <string>
 
@@ -47,7 +48,7 @@ namespace cereal
     /*! @internal */
     template <class T> inline
     std::string demangledName()
-    { return typeid( T ).name(); }
+    { return ::cereal::detail::type_index_of<T>().name(); }
   } // namespace util
 } // namespace cereal
 #else // clang or gcc
@@ -67,6 +68,10 @@ namespace cereal
 
       demangledName = abi::__cxa_demangle(mangledName.c_str(), 0, &len, &status);
 
+      // names that are not mangled (e.g. without RTTI) are returned as they are
+      if( status != 0 )
+        return mangledName;
+
       std::string retName(demangledName);
       free(demangledName);
 
@@ -77,7 +82,7 @@ namespace cereal
     /*! @internal */
     template<class T> inline
     std::string demangledName()
-    { return demangle(typeid(T).name()); }
+    { return demangle(::cereal::detail::type_index_of<T>().name()); }
   }
 } // namespace cereal
 #endif // clang or gcc branch of _MSC_VER
@@ -0,0 +1,329 @@
+/*! \file encoded_cache.hpp
+    \brief Caching the encoding of immutable shared objects */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_ENCODED_CACHE_HPP_
+#define CEREAL_ENCODED_CACHE_HPP_
+
+#include "cereal/cereal.hpp"
+#include "cereal/details/type_index.hpp"
+#include "cereal/types/memory.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace cereal
+{
+  // ######################################################################
+  //! Caches the encoding of immutable shared objects that are saved many times
+  /*! Objects such as a configuration or a reference table are often shared by
+      many messages, each of which serializes them again from scratch.  Wrapping
+      such a pointer with cached_encoding serializes the object once per archive
+      type, and later saves copy the recorded bytes directly into the output.
+
+      Cached objects are saved as a self-contained encoding (a size followed by the
+      bytes of a nested archive), so they must be loaded through cached_encoding as
+      well.  Pointer tracking does not extend across this boundary: a cached object
+      is loaded as a new object each time.
+
+      Entries are keyed by the identity of the object together with a generation
+      number.  The object must not change while it is cached; if it does, save it
+      with a new generation, which replaces the cached bytes.  The cache does not
+      keep objects alive, and the entry of an object that was destroyed is never
+      used for a new object at the same address.
+
+      A cache can be shared between threads and archives, only its lookups are
+      serialized.  It can only be used with archives that support binary data, such
+      as the binary and portable binary archives.
+
+      @code{.cpp}
+      struct Response
+      {
+        std::shared_ptr<Config const> config;
+        std::vector<Item> items;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( cereal::cached_encoding( config, configCache, configGeneration ), items );
+        }
+      };
+      @endcode */
+  class EncodedCache
+  {
+    public:
+      EncodedCache() = default;
+
+      EncodedCache( EncodedCache const & ) = delete;
+      EncodedCache & operator=( EncodedCache const & ) = delete;
+
+      //! Gets the encoding of ptr for the archive type Archive, encoding it if it is not cached
+      /*! Encodings that failed are not cached.
+
+          @param ptr The object to encode
+          @param generation The generation of the object, see EncodedCache
+          @param throwOnError Whether the nested Archive throws on errors, see OutputArchive::setThrowOnError
+          @param error Set to the error of the nested Archive if saving failed without throwing
+          @return The bytes of a nested Archive that saved ptr, or nullptr if saving failed */
+      template <class Archive, class T>
+      std::shared_ptr<std::string const> encode( std::shared_ptr<T> const & ptr, std::uint64_t generation,
+                                                 bool throwOnError, char const * & error )
+      {
+        Key const key( ptr.get(), detail::type_index_of<Archive>() );
+
+        {
+          std::lock_guard<std::mutex> lock( itsMutex );
+          auto iter = itsEntries.find( key );
+          if( iter != itsEntries.end() && iter->second.generation == generation && sameObject( iter->second.owner, ptr ) )
+          {
+            ++itsHits;
+            return iter->second.bytes;
+          }
+        }
+
+        std::ostringstream os;
+        {
+          Archive ar( os );
+          ar.setThrowOnError( throwOnError );
+          ar( ptr );
+
+          if( !ar.ok() )
+          {
+            error = ar.error();
+            return nullptr;
+          }
+        }
+        auto bytes = std::make_shared<std::string const>( os.str() );
+
+        std::lock_guard<std::mutex> lock( itsMutex );
+        ++itsMisses;
+
+        if( ptr )
+        {
+          if( itsEntries.size() >= itsSweepSize )
+            sweep();
+          itsEntries[key] = Entry{ ptr, generation, bytes };
+        }
+
+        return bytes;
+      }
+
+      //! Removes all entries for the object at ptr
+      void erase( void const * ptr )
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        for( auto iter = itsEntries.begin(); iter != itsEntries.end(); )
+          if( iter->first.first == ptr )
+            iter = itsEntries.erase( iter );
+          else
+            ++iter;
+      }
+
+      //! Removes all entries
+      void clear()
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        itsEntries.clear();
+      }
+
+      //! The number of cached encodings
+      std::size_t size() const
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        return itsEntries.size();
+      }
+
+      //! The number of saves that used a cached encoding
+      std::uint64_t hits() const
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        return itsHits;
+      }
+
+      //! The number of saves that had to encode their object
+      std::uint64_t misses() const
+      {
+        std::lock_guard<std::mutex> lock( itsMutex );
+        return itsMisses;
+      }
+
+    private:
+      //! The address of an object and the archive type it was encoded with
+      using Key = std::pair<void const *, detail::type_index>;
+
+      struct Entry
+      {
+        std::weak_ptr<void const> owner;           //!< Detects objects that were destroyed
+        std::uint64_t generation;
+        std::shared_ptr<std::string const> bytes;
+      };
+
+      //! Whether ptr is the object the entry was made for, and not a new one at the same address
+      template <class T>
+      static bool sameObject( std::weak_ptr<void const> const & owner, std::shared_ptr<T> const & ptr )
+      {
+        return !owner.expired() && !owner.owner_before( ptr ) && !ptr.owner_before( owner );
+      }
+
+      //! Drops the entries of destroyed objects, and lets the cache grow if that is not enough
+      void sweep()
+      {
+        for( auto iter = itsEntries.begin(); iter != itsEntries.end(); )
+          if( iter->second.owner.expired() )
+            iter = itsEntries.erase( iter );
+          else
+            ++iter;
+
+        if( itsEntries.size() * 2 > itsSweepSize )
+          itsSweepSize *= 2;
+      }
+
+      mutable std::mutex itsMutex;
+      std::map<Key, Entry> itsEntries;
+      std::size_t itsSweepSize = 16;
+      std::uint64_t itsHits = 0;
+      std::uint64_t itsMisses = 0;
+  };
+
+  // ######################################################################
+  //! A shared pointer whose encoding is cached, see cached_encoding
+  /*! @internal */
+  template <class T>
+  class CachedEncoding
+  {
+    private:
+      // Store a reference if passed an lvalue reference, otherwise
+      // make a copy of the data
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      CachedEncoding & operator=( CachedEncoding const & ) = delete;
+
+    public:
+      CachedEncoding( T && p, EncodedCache & c, std::uint64_t g ) :
+        ptr( std::forward<T>( p ) ), cache( c ), generation( g ) {}
+
+      Type ptr;
+      EncodedCache & cache;
+      std::uint64_t generation;
+  };
+
+  //! Saves a std::shared_ptr through an EncodedCache
+  /*! When saving, the encoding of the pointer is taken from cache if it holds one for
+      the same object and generation.  When loading, the cache is not used.
+
+      @param ptr The std::shared_ptr to save or load
+      @param cache The cache of encodings
+      @param generation The generation of the object, which must change if the object changes
+      @relates EncodedCache */
+  template <class T> inline
+  CachedEncoding<T> cached_encoding( T && ptr, EncodedCache & cache, std::uint64_t generation = 0 )
+  {
+    return { std::forward<T>( ptr ), cache, generation };
+  }
+
+  namespace encoded_cache_detail
+  {
+    //! A read only stream buffer over existing memory
+    class MemoryStreambuf : public std::streambuf
+    {
+      public:
+        MemoryStreambuf( char const * data, std::size_t size )
+        {
+          char * begin = const_cast<char *>( data );
+          setg( begin, begin, begin + size );
+        }
+    };
+
+    template <class>
+    struct void_type { using type = void; };
+
+    //! The archive an encoding is made with, which for measuring archives is the one they measure
+    template <class Archive, class SFINAE = void>
+    struct encoding_archive { using type = Archive; };
+
+    template <class Archive>
+    struct encoding_archive<Archive, typename void_type<typename Archive::measured_archive>::type>
+    { using type = typename Archive::measured_archive; };
+  } // namespace encoded_cache_detail
+
+  //! Saving for CachedEncoding
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<char>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, CachedEncoding<T> const & c )
+  {
+    using Encoding = typename encoded_cache_detail::encoding_archive<Archive>::type;
+    char const * error = nullptr;
+    auto const bytes = c.cache.template encode<Encoding>( c.ptr, c.generation, ar.throwsOnError(), error );
+    if( !bytes )
+    {
+      ar.setError( error );
+      return;
+    }
+
+    ar( make_size_tag( static_cast<size_type>( bytes->size() ) ) );
+    ar( binary_data( bytes->data(), bytes->size() ) );
+  }
+
+  //! Loading for CachedEncoding
+  template <class Archive, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<char>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, CachedEncoding<T> & c )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    // Read in chunks, so a malformed size does not allocate more than the data that is there
+    std::string bytes;
+    detail::append_binary_data( ar, bytes, static_cast<std::size_t>( size ) );
+    if( !ar.ok() )
+      return;
+
+    encoded_cache_detail::MemoryStreambuf buffer( bytes.data(), bytes.size() );
+    std::istream is( &buffer );
+
+    Archive nested( is );
+    nested.setThrowOnError( ar.throwsOnError() );
+    nested.setTrustedSource( ar.isTrustedSource() );
+    nested.setReuseStorage( ar.reusesStorage() );
+    nested( c.ptr );
+
+    if( !nested.ok() )
+      ar.setError( nested.error() );
+  }
+} // namespace cereal
+
+#endif // CEREAL_ENCODED_CACHE_HPP_
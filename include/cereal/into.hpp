@@ -0,0 +1,263 @@
+/*! \file into.hpp
+    \brief Loading into caller provided storage without allocating */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_INTO_HPP_
+#define CEREAL_INTO_HPP_
+
+#include "cereal/cereal.hpp"
+#include "cereal/types/concepts/contiguous_container.hpp"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace cereal
+{
+  // ######################################################################
+  //! Elements loaded into a caller provided array of fixed capacity
+  /*! Use into to create these.  The elements are saved exactly like a
+      std::vector, preceded by their number.  When loading, that number is
+      checked against the capacity before anything is written to the array.
+
+      @internal */
+  template <class T>
+  class IntoArray
+  {
+    private:
+      using SizeType = typename std::conditional<std::is_const<T>::value, std::size_t const, std::size_t>::type;
+
+      IntoArray & operator=( IntoArray const & ) = delete;
+
+    public:
+      IntoArray( T * d, std::size_t c, SizeType & s ) : data( d ), capacity( c ), size( s ) {}
+
+      T * data;
+      std::size_t capacity;
+      SizeType & size;
+  };
+
+  //! A container loaded without growing its storage
+  /*! Use into to create these.  The container is saved exactly like a std::vector
+      (or a std::string), so it can be loaded from data saved normally and vice
+      versa.  When loading, the number of elements is checked against the capacity
+      of the container before it is resized, so the container never reallocates.
+
+      @internal */
+  template <class Container>
+  class IntoContainer
+  {
+    private:
+      IntoContainer & operator=( IntoContainer const & ) = delete;
+
+    public:
+      IntoContainer( Container & c ) : container( c ) {}
+
+      Container & container;
+  };
+
+  //! Loads elements into an existing array
+  /*! The number of elements is loaded into size.  If the data holds more than
+      capacity elements, the archive reports an error (see InputArchive::setThrowOnError)
+      and size is set to 0.
+
+      With an archive that supports binary data, arithmetic elements (and those opted
+      into trivially_serializable, see contiguous_container.hpp) are read in a single
+      block straight into the array.  Loading never allocates unless loading
+      an individual element does.
+
+      @code{.cpp}
+      struct Frame
+      {
+        float samples[512];
+        std::size_t count;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( cereal::into( samples, count ) );
+        }
+      };
+      @endcode
+
+      @param data The first element of the storage
+      @param capacity The number of elements the storage can hold
+      @param size The number of elements in use, which is saved and loaded
+      @relates IntoArray */
+  template <class T> inline
+  IntoArray<T> into( T * data, std::size_t capacity, std::size_t & size )
+  {
+    return { data, capacity, size };
+  }
+
+  //! @overload
+  template <class T> inline
+  IntoArray<T const> into( T const * data, std::size_t capacity, std::size_t const & size )
+  {
+    return { data, capacity, size };
+  }
+
+  //! Loads elements into an existing array, using its whole length as the capacity
+  /*! @relates IntoArray */
+  template <class T, std::size_t N> inline
+  IntoArray<T> into( T (&array)[N], std::size_t & size )
+  {
+    return { array, N, size };
+  }
+
+  //! @overload
+  template <class T, std::size_t N> inline
+  IntoArray<T const> into( T const (&array)[N], std::size_t const & size )
+  {
+    return { array, N, size };
+  }
+
+  //! Loads a container without growing its storage
+  /*! Works with any container that has contiguous storage and provides capacity(),
+      resize() and clear(), such as a std::vector or std::string with storage
+      reserved in advance, or fixed capacity containers like boost::container::static_vector.
+      If the data holds more elements than the capacity of the container, the archive
+      reports an error (see InputArchive::setThrowOnError) and the container is cleared.
+
+      Strings can only be loaded this way from archives that support binary data.
+
+      @code{.cpp}
+      std::vector<std::int32_t> ids;
+      ids.reserve( 1024 ); // the only allocation
+
+      while( running )
+        archive( cereal::into( ids ) ); // never reallocates
+      @endcode
+
+      @relates IntoContainer */
+  template <class Container> inline
+  IntoContainer<Container> into( Container & container )
+  {
+    return { container };
+  }
+
+  namespace into_detail
+  {
+    //! Whether a container is a std::basic_string
+    template <class T>
+    struct is_string : std::false_type {};
+
+    template <class C, class T, class A>
+    struct is_string<std::basic_string<C, T, A>> : std::true_type {};
+
+    //! Checks that a container is saved in the same format as it would be without into
+    template <class Archive, class Container> inline
+    void check_container()
+    {
+      static_assert( !is_string<Container>::value || contiguous_detail::use_binary<Archive, typename Container::value_type>::value,
+                     "cereal::into can only load strings from archives that support binary data" );
+    }
+
+    //! Loads a number of elements and checks that it fits into capacity
+    /*! @return Whether the size fits, otherwise an error has been reported to the archive */
+    template <class Archive> inline
+    bool load_size( Archive & ar, std::size_t capacity, std::size_t & size )
+    {
+      size_type loaded;
+      ar( make_size_tag( loaded ) );
+
+      if( loaded > capacity )
+      {
+        CEREAL_THROW_ON_ERROR( ar, "Cannot load " + std::to_string( loaded ) + " elements into storage with a capacity of " + std::to_string( capacity ) );
+        ar.setError( "Cannot load more elements than the capacity of the storage they are loaded into" );
+        return false;
+      }
+
+      size = static_cast<std::size_t>( loaded );
+      return true;
+    }
+  } // namespace into_detail
+
+  //! Saving for IntoArray
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, IntoArray<T> const & into )
+  {
+    if( into.size > into.capacity )
+    {
+      CEREAL_THROW_ON_ERROR( ar, "Cannot save " + std::to_string( into.size ) + " elements from storage with a capacity of " + std::to_string( into.capacity ) );
+      ar.setError( "Cannot save more elements than the capacity of the storage they are saved from" );
+      return;
+    }
+
+    ar( make_size_tag( static_cast<size_type>( into.size ) ) );
+    contiguous_detail::save_elements( ar, static_cast<T const *>( into.data ), into.size );
+  }
+
+  //! Loading for IntoArray
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, IntoArray<T> & into )
+  {
+    static_assert( !std::is_const<T>::value, "cereal::into cannot load into const storage" );
+
+    std::size_t size;
+    if( !into_detail::load_size( ar, into.capacity, size ) )
+    {
+      into.size = 0;
+      return;
+    }
+
+    contiguous_detail::load_elements( ar, into.data, size );
+    into.size = size;
+  }
+
+  //! Saving for IntoContainer
+  template <class Archive, class Container> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, IntoContainer<Container> const & into )
+  {
+    into_detail::check_container<Archive, Container>();
+    auto const & container = into.container;
+
+    ar( make_size_tag( static_cast<size_type>( container.size() ) ) );
+    contiguous_detail::save_elements( ar, container.data(), container.size() );
+  }
+
+  //! Loading for IntoContainer
+  template <class Archive, class Container> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, IntoContainer<Container> & into )
+  {
+    into_detail::check_container<Archive, Container>();
+    auto & container = into.container;
+
+    std::size_t size;
+    if( !into_detail::load_size( ar, container.capacity(), size ) )
+    {
+      container.clear();
+      return;
+    }
+
+    container.resize( size );
+    if( size )
+      contiguous_detail::load_elements( ar, &container[0], size );
+  }
+} // namespace cereal
+
+#endif // CEREAL_INTO_HPP_
@@ -70,6 +70,77 @@
 #define CEREAL_SIZE_TYPE uint64_t
 #endif // CEREAL_SIZE_TYPE
 
+#ifndef CEREAL_NO_RTTI
+//! Whether cereal should avoid relying on RTTI
+/*! When RTTI is disabled, cereal identifies types by the address of a
+    per-type static object instead of std::type_info.  Polymorphic types
+    must then report their dynamic type through CEREAL_POLYMORPHIC_TYPE_ID,
+    see cereal/details/type_index.hpp.
+
+    This is detected from the compiler flags (e.g. -fno-rtti or /GR-)
+    but can be forced by defining it to 0 or 1. */
+  #if defined(__GXX_RTTI) || defined(__cpp_rtti) || defined(_CPPRTTI)
+    #define CEREAL_NO_RTTI 0
+  #else
+    #define CEREAL_NO_RTTI 1
+  #endif
+#endif // CEREAL_NO_RTTI
+
+#ifndef CEREAL_EXCEPTIONS
+//! Whether cereal can use exceptions
+/*! When exceptions are disabled (e.g. -fno-exceptions), archives report
+    errors through their sticky error state instead of throwing, see
+    InputArchive::setThrowOnError.  Errors that can only result from
+    misusing cereal abort the program.
+
+    This is detected from the compiler flags but can be forced by
+    defining it to 0 or 1. */
+  #if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    #define CEREAL_EXCEPTIONS 1
+  #else
+    #define CEREAL_EXCEPTIONS 0
+  #endif
+#endif // CEREAL_EXCEPTIONS
+
+#ifndef CEREAL_TRACE
+//! Whether archives report their activity to tracepoints
+/*! When enabled, archives report their construction and destruction, outermost
+    calls, polymorphic dispatch and container sizes to SDT probes and to a hook
+    installed with cereal::setTraceHook, see cereal/details/trace.hpp.  When
+    disabled, no tracing code is generated. */
+#define CEREAL_TRACE 0
+#endif // CEREAL_TRACE
+
+#ifndef CEREAL_COMPACT_VARIANT_INDEX
+//! Whether binary archives save variant indices in the smallest type that fits
+/*! By default, the index of the active alternative of a std::variant or
+    boost::variant is saved as a std::int32_t.  When enabled, binary archives
+    save it as a std::uint8_t for variants with at most 256 alternatives (and a
+    std::uint16_t for larger ones).  Text archives are not affected.
+
+    Like CEREAL_SIZE_TYPE, this changes the binary format, so data must be
+    loaded with the same setting it was saved with. */
+#define CEREAL_COMPACT_VARIANT_INDEX 0
+#endif // CEREAL_COMPACT_VARIANT_INDEX
+
+#ifndef CEREAL_PREFETCH_DISTANCE
+//! How many elements ahead container saves prefetch
+/*! Only elements that own memory are prefetched: strings, smart pointers, and
+    pairs holding either, such as the entries of a std::map<int, std::string>.
+    Saving them chases a pointer per element, which usually misses the cache
+    when that memory is scattered over the heap.  cereal prefetches the memory
+    owned by the element this many positions ahead of the one being saved, and
+    in node based containers (std::list, std::map, std::set and their relatives)
+    the node after it.
+
+    Containers of elements owning no memory, like a std::map<std::uint64_t,
+    std::uint64_t>, are not prefetched, since that made saving them slower.
+
+    Larger values hide more latency when each element is cheap to save.
+    Set to 0 to disable prefetching. */
+#define CEREAL_PREFETCH_DISTANCE 8
+#endif // CEREAL_PREFETCH_DISTANCE
+
 // ######################################################################
 #ifndef CEREAL_SERIALIZE_FUNCTION_NAME
 //! The serialization/deserialization function name to search for.
@@ -132,6 +203,29 @@
   #endif // end !defined(CEREAL_HAS_NOEXCEPT)
 #endif // ifndef CEREAL_NOEXCEPT
 
+// ######################################################################
+//! Defines the CEREAL_PREFETCH macro to hint that memory will soon be read
+/*! Expands to nothing on compilers without __builtin_prefetch
+    @internal */
+#if defined(__GNUC__) || defined(__clang__)
+#define CEREAL_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define CEREAL_PREFETCH(addr) static_cast<void>(addr)
+#endif
+
+// ######################################################################
+//! Defines the CEREAL_NOINLINE macro to keep rarely taken paths out of their callers
+/*! Marks a function as never inlined and, where supported, as unlikely to be called.
+    Expands to nothing on other compilers
+    @internal */
+#if defined(__GNUC__) || defined(__clang__)
+#define CEREAL_NOINLINE __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define CEREAL_NOINLINE __declspec(noinline)
+#else
+#define CEREAL_NOINLINE
+#endif
+
 // ######################################################################
 //! Checks if C++17 is available
 #if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
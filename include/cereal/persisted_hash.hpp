@@ -0,0 +1,228 @@
+/*! \file persisted_hash.hpp
+    \brief A hasher that lets unordered containers be loaded without rehashing their keys
+    \ingroup OtherTypes */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_PERSISTED_HASH_HPP_
+#define CEREAL_PERSISTED_HASH_HPP_
+
+#include "cereal/cereal.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace cereal
+{
+  namespace persisted_hash_detail
+  {
+    //! A hash value handed to PersistedHash for one particular key object
+    template <class Key>
+    struct Forwarded
+    {
+      Key const * key;
+      std::size_t hash;
+    };
+
+    //! The hash currently forwarded on this thread for keys of type Key
+    template <class Key> inline
+    Forwarded<Key> & forwarded()
+    {
+      static thread_local Forwarded<Key> f = { nullptr, 0 };
+      return f;
+    }
+
+    //! The number of containers with keys of type Key being loaded with forwarded hashes, on any thread
+    /*! PersistedHash only looks up the forwarded hash while this is not zero, so hashing
+        outside of loads does not read the thread local state.
+        @internal */
+    template <class Key> inline
+    std::atomic<std::size_t> & forwarding()
+    {
+      static std::atomic<std::size_t> count( 0 );
+      return count;
+    }
+
+    //! Enables forwarded hashes for keys of type Key while a container is loaded
+    /*! @internal */
+    template <class Key>
+    class ForwardingScope
+    {
+      public:
+        ForwardingScope( bool active ) : itsActive( active )
+        {
+          if( itsActive )
+            forwarding<Key>().fetch_add( 1, std::memory_order_relaxed );
+        }
+
+        ~ForwardingScope()
+        {
+          if( itsActive )
+            forwarding<Key>().fetch_sub( 1, std::memory_order_relaxed );
+        }
+
+      private:
+        ForwardingScope( ForwardingScope const & ) = delete;
+        ForwardingScope & operator=( ForwardingScope const & ) = delete;
+
+        bool itsActive;
+    };
+
+    //! Forwards a hash to PersistedHash while a key is inserted into a container
+    /*! Only the key object passed to the constructor is affected: hashing any
+        other object, even an equal one, computes its hash as usual.  Only has an
+        effect within a ForwardingScope.
+        @internal */
+    template <class Key>
+    class ForwardHash
+    {
+      public:
+        ForwardHash( Key const & key, std::size_t hash ) : itsPrevious( forwarded<Key>() )
+        {
+          forwarded<Key>() = { std::addressof( key ), hash };
+        }
+
+        ~ForwardHash()
+        {
+          forwarded<Key>() = itsPrevious;
+        }
+
+      private:
+        ForwardHash( ForwardHash const & ) = delete;
+        ForwardHash & operator=( ForwardHash const & ) = delete;
+
+        Forwarded<Key> itsPrevious;
+    };
+
+    //! Whether an archive stores the hash of every element of containers using PersistedHash
+    template <class Archive>
+    struct use_persisted_hash : std::integral_constant<bool,
+      traits::is_output_serializable<BinaryData<char>, Archive>::value ||
+      traits::is_input_serializable<BinaryData<char>, Archive>::value> {};
+
+    //! Saves what identifies the hash function of a container
+    /*! This is the size of its hash values and the hash of a default constructed key,
+        which differs between hash functions and between seeds of the same function.
+        @internal */
+    template <class Archive, class Container> inline
+    void save_identity( Archive & ar, Container const & container )
+    {
+      ar( static_cast<std::uint8_t>( sizeof(std::size_t) ),
+          static_cast<std::uint64_t>( container.hash_function()( typename Container::key_type() ) ) );
+    }
+
+    //! Loads what identifies the hash function used to save a container
+    /*! @return Whether the stored hashes can be used by the container
+        @internal */
+    template <class Archive, class Container> inline
+    bool load_identity( Archive & ar, Container const & container )
+    {
+      std::uint8_t width;
+      std::uint64_t probe;
+      ar( width, probe );
+
+      return width == sizeof(std::size_t) &&
+             probe == static_cast<std::uint64_t>( container.hash_function()( typename Container::key_type() ) );
+    }
+
+    //! Checks the hash stored for the first key against the container's hash function
+    /*! This catches hash functions that agree on the default constructed key used
+        by save_identity but not in general.
+        @internal */
+    template <class Container> inline
+    bool check_first( Container const & container, typename Container::key_type const & key, std::uint64_t hash )
+    {
+      return static_cast<std::uint64_t>( container.hash_function()( key ) ) == hash;
+    }
+  } // namespace persisted_hash_detail
+
+  //! A hasher for unordered containers whose hash values are saved along with their elements
+  /*! Using PersistedHash as the hasher of a std::unordered_map or std::unordered_set
+      changes how binary archives serialize the container: the hash of every key is
+      saved alongside it, so that loading does not need to hash the keys again.  This
+      pays off for keys that are expensive to hash, such as long strings.
+
+      @code{.cpp}
+      using Index = std::unordered_map<std::string, std::uint32_t,
+                                       cereal::PersistedHash<std::hash<std::string>>>;
+      @endcode
+
+      The saved data also identifies the hash function (and its seed, for hashers with
+      state).  If the container being loaded hashes differently, for example because
+      the data was saved on another platform or with another seed, the stored hashes
+      are ignored and every key is hashed as usual.
+
+      Stored hashes are only used when loading from an archive marked as a trusted
+      source (see InputArchive::setTrustedSource), since only the hash of the first key
+      is checked against the hash function.  Altered data could otherwise hand the
+      container a wrong hash, leaving a key in a bucket where it cannot be found.  For
+      untrusted archives the stored hashes are skipped and every key is hashed as usual.
+
+      Stored hashes are handed to the container while each element is inserted, which
+      only helps with standard libraries that hash the key passed to the insertion
+      before moving it into the container (e.g. libstdc++).  Otherwise keys are hashed
+      as usual.  Outside of such loads, PersistedHash only adds the check of a global
+      counter to the wrapped hash function.
+
+      Other archives and std::unordered_multimap and std::unordered_multiset are not
+      affected.  Since the binary format of the container changes, data must be loaded
+      into a container using PersistedHash if and only if it was saved from one.
+
+      @tparam Hash The hash function to use */
+  template <class Hash>
+  class PersistedHash
+  {
+    public:
+      PersistedHash() = default;
+
+      //! Uses a copy of hash, e.g. a seeded hash function
+      PersistedHash( Hash const & hash ) : itsHash( hash ) {}
+
+      //! Hashes a key, unless its hash is being forwarded from an archive
+      template <class Key>
+      std::size_t operator()( Key const & key ) const
+      {
+        if( persisted_hash_detail::forwarding<Key>().load( std::memory_order_relaxed ) != 0 )
+        {
+          auto const & forwarded = persisted_hash_detail::forwarded<Key>();
+          if( forwarded.key == std::addressof( key ) )
+            return forwarded.hash;
+        }
+
+        return itsHash( key );
+      }
+
+      //! The wrapped hash function
+      Hash const & hash() const { return itsHash; }
+
+    private:
+      Hash itsHash;
+  };
+} // namespace cereal
+
+#endif // CEREAL_PERSISTED_HASH_HPP_
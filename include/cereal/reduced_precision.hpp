@@ -0,0 +1,466 @@
+/*! \file reduced_precision.hpp
+    \brief Lossy reduced precision encodings for floating point data */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_REDUCED_PRECISION_HPP_
+#define CEREAL_REDUCED_PRECISION_HPP_
+
+#include "cereal/cereal.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace cereal
+{
+  namespace reduced_precision_detail
+  {
+    //! The number of values converted at a time, bounding the temporary storage on the stack
+    static const std::size_t chunk_size = 256;
+
+    //! Reinterprets the bits of a float
+    inline std::uint32_t float_bits( float f )
+    {
+      std::uint32_t u;
+      std::memcpy( &u, &f, sizeof(u) );
+      return u;
+    }
+
+    //! Builds a float from its bits
+    inline float bits_float( std::uint32_t u )
+    {
+      float f;
+      std::memcpy( &f, &u, sizeof(f) );
+      return f;
+    }
+
+    //! Converts a float to IEEE half precision, rounding to nearest even
+    /*! Values too large for a half become infinity, NaNs stay NaN */
+    inline std::uint16_t float_to_half( float value )
+    {
+      std::uint32_t f = float_bits( value );
+      std::uint32_t const sign = ( f >> 16 ) & 0x8000u;
+      f &= 0x7FFFFFFFu;
+
+      std::uint32_t h;
+      if( f >= 0x47800000u )      // too large for a half: infinity or NaN
+        h = f > 0x7F800000u ? 0x7E00u : 0x7C00u;
+      else if( f < 0x38800000u )  // subnormal half: let the FPU round by adding a magic number
+        h = float_bits( bits_float( f ) + 0.5f ) - 0x3F000000u;
+      else                        // normal half: rebias the exponent and round the mantissa
+        h = ( f + 0xC8000FFFu + ( ( f >> 13 ) & 1u ) ) >> 13;
+
+      return static_cast<std::uint16_t>( sign | h );
+    }
+
+    //! Converts an IEEE half precision value to a float (exactly)
+    inline float half_to_float( std::uint16_t value )
+    {
+      std::uint32_t const shiftedExponent = 0x7C00u << 13;
+      std::uint32_t f = ( value & 0x7FFFu ) << 13;
+      std::uint32_t const exponent = f & shiftedExponent;
+      f += ( 127 - 15 ) << 23;
+
+      if( exponent == shiftedExponent ) // infinity or NaN
+        f += ( 128 - 16 ) << 23;
+      else if( exponent == 0 )          // zero or subnormal: renormalize through the FPU
+        f = float_bits( bits_float( f + ( 1u << 23 ) ) - bits_float( 113u << 23 ) );
+
+      return bits_float( f | ( static_cast<std::uint32_t>( value & 0x8000u ) << 16 ) );
+    }
+
+    //! Converts floats to halves
+    inline void encode_half( float const * in, std::uint16_t * out, std::size_t n )
+    {
+      std::size_t i = 0;
+      #if defined(__F16C__)
+      for( ; i + 8 <= n; i += 8 )
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ),
+                          _mm256_cvtps_ph( _mm256_loadu_ps( in + i ), _MM_FROUND_TO_NEAREST_INT ) );
+      #endif
+      for( ; i < n; ++i )
+        out[i] = float_to_half( in[i] );
+    }
+
+    //! Converts halves to floats
+    inline void decode_half( std::uint16_t const * in, float * out, std::size_t n )
+    {
+      std::size_t i = 0;
+      #if defined(__F16C__)
+      for( ; i + 8 <= n; i += 8 )
+        _mm256_storeu_ps( out + i, _mm256_cvtph_ps( _mm_loadu_si128( reinterpret_cast<__m128i const *>( in + i ) ) ) );
+      #endif
+      for( ; i < n; ++i )
+        out[i] = half_to_float( in[i] );
+    }
+
+    //! Converts floats to bfloat16, rounding to nearest even
+    inline void encode_bfloat16( float const * in, std::uint16_t * out, std::size_t n )
+    {
+      std::size_t i = 0;
+      #if defined(__SSE2__)
+      __m128i const one = _mm_set1_epi32( 1 );
+      __m128i const bias = _mm_set1_epi32( 0x7FFF );
+      __m128i const quiet = _mm_set1_epi32( 0x40 );
+      __m128i const absMask = _mm_set1_epi32( 0x7FFFFFFF );
+      __m128i const infinity = _mm_set1_epi32( 0x7F800000 );
+      for( ; i + 8 <= n; i += 8 )
+      {
+        __m128i halves[2];
+        for( int h = 0; h < 2; ++h )
+        {
+          __m128i const f = _mm_castps_si128( _mm_loadu_ps( in + i + 4 * h ) );
+          __m128i const upper = _mm_srli_epi32( f, 16 );
+          __m128i const rounded = _mm_srli_epi32( _mm_add_epi32( _mm_add_epi32( f, bias ), _mm_and_si128( upper, one ) ), 16 );
+          __m128i const isNaN = _mm_cmpgt_epi32( _mm_and_si128( f, absMask ), infinity );
+          __m128i const result = _mm_or_si128( _mm_andnot_si128( isNaN, rounded ), _mm_and_si128( isNaN, _mm_or_si128( upper, quiet ) ) );
+          // sign extend the low 16 bits so that the saturating signed pack keeps them unchanged
+          halves[h] = _mm_srai_epi32( _mm_slli_epi32( result, 16 ), 16 );
+        }
+        _mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ), _mm_packs_epi32( halves[0], halves[1] ) );
+      }
+      #endif
+      for( ; i < n; ++i )
+      {
+        std::uint32_t const f = float_bits( in[i] );
+        std::uint32_t const rounded = ( f + 0x7FFFu + ( ( f >> 16 ) & 1u ) ) >> 16;
+        std::uint32_t const quietNaN = ( f >> 16 ) | 0x40u;
+        out[i] = static_cast<std::uint16_t>( ( f & 0x7FFFFFFFu ) > 0x7F800000u ? quietNaN : rounded );
+      }
+    }
+
+    //! Converts bfloat16 values to floats (exactly)
+    inline void decode_bfloat16( std::uint16_t const * in, float * out, std::size_t n )
+    {
+      std::size_t i = 0;
+      #if defined(__SSE2__)
+      __m128i const zero = _mm_setzero_si128();
+      for( ; i + 8 <= n; i += 8 )
+      {
+        __m128i const b = _mm_loadu_si128( reinterpret_cast<__m128i const *>( in + i ) );
+        _mm_storeu_ps( out + i, _mm_castsi128_ps( _mm_unpacklo_epi16( zero, b ) ) );
+        _mm_storeu_ps( out + i + 4, _mm_castsi128_ps( _mm_unpackhi_epi16( zero, b ) ) );
+      }
+      #endif
+      for( ; i < n; ++i )
+        out[i] = bits_float( static_cast<std::uint32_t>( in[i] ) << 16 );
+    }
+
+    //! Adapts a float kernel to any floating point type by converting through floats
+    template <class F, class Storage, class Kernel> inline
+    void encode_through_float( F const * in, Storage * out, std::size_t n, Kernel kernel )
+    {
+      float converted[chunk_size];
+      for( std::size_t i = 0; i < n; ++i )
+        converted[i] = static_cast<float>( in[i] );
+      kernel( converted, out, n );
+    }
+
+    //! @overload
+    template <class Storage, class Kernel> inline
+    void encode_through_float( float const * in, Storage * out, std::size_t n, Kernel kernel )
+    {
+      kernel( in, out, n );
+    }
+
+    //! Adapts a float kernel to any floating point type by converting through floats
+    template <class F, class Storage, class Kernel> inline
+    void decode_through_float( Storage const * in, F * out, std::size_t n, Kernel kernel )
+    {
+      float converted[chunk_size];
+      kernel( in, converted, n );
+      for( std::size_t i = 0; i < n; ++i )
+        out[i] = static_cast<F>( converted[i] );
+    }
+
+    //! @overload
+    template <class Storage, class Kernel> inline
+    void decode_through_float( Storage const * in, float * out, std::size_t n, Kernel kernel )
+    {
+      kernel( in, out, n );
+    }
+  } // namespace reduced_precision_detail
+
+  // ######################################################################
+  //! Encodes floating point values as IEEE 754 half precision (binary16)
+  /*! Halves keep about 3 significant decimal digits over a range of roughly
+      6e-8 to 65504; larger values become infinity.  Conversion uses F16C
+      instructions when the compiler targets them (e.g. -mf16c or -march=native),
+      and portable scalar code otherwise.
+      @relates ReducedPrecision */
+  struct HalfFormat
+  {
+    using storage_type = std::uint16_t;
+
+    template <class F>
+    void encode( F const * in, storage_type * out, std::size_t n ) const
+    { reduced_precision_detail::encode_through_float( in, out, n, &reduced_precision_detail::encode_half ); }
+
+    template <class F>
+    void decode( storage_type const * in, F * out, std::size_t n ) const
+    { reduced_precision_detail::decode_through_float( in, out, n, &reduced_precision_detail::decode_half ); }
+  };
+
+  //! Encodes floating point values as bfloat16
+  /*! bfloat16 keeps the full range of a float but only about 2 to 3 significant
+      decimal digits.  Conversion uses SSE2 when available.
+      @relates ReducedPrecision */
+  struct BFloat16Format
+  {
+    using storage_type = std::uint16_t;
+
+    template <class F>
+    void encode( F const * in, storage_type * out, std::size_t n ) const
+    { reduced_precision_detail::encode_through_float( in, out, n, &reduced_precision_detail::encode_bfloat16 ); }
+
+    template <class F>
+    void decode( storage_type const * in, F * out, std::size_t n ) const
+    { reduced_precision_detail::decode_through_float( in, out, n, &reduced_precision_detail::decode_bfloat16 ); }
+  };
+
+  //! Encodes floating point values as integer multiples of a fixed scale
+  /*! Each value is stored as value / scale rounded to the nearest Int (halfway
+      cases away from zero), saturating at the limits of Int; NaN is stored as 0.  The scale is not saved, the same scale
+      must be given when loading.
+      @tparam Int The integral type values are stored as
+      @relates ReducedPrecision */
+  template <class Int>
+  struct FixedPointFormat
+  {
+    static_assert( std::is_integral<Int>::value && !std::is_same<Int, bool>::value,
+                   "FixedPointFormat requires an integral storage type" );
+
+    using storage_type = Int;
+
+    template <class F>
+    void encode( F const * in, storage_type * out, std::size_t n ) const
+    {
+      // the largest Int is not representable as a double if Int has 64 bits, so stay just below it
+      double const lowest = static_cast<double>( std::numeric_limits<Int>::lowest() );
+      double const highest = sizeof(Int) < sizeof(double) ? static_cast<double>( std::numeric_limits<Int>::max() )
+                                                          : std::nextafter( static_cast<double>( std::numeric_limits<Int>::max() ), 0.0 );
+      double const inverse = 1.0 / scale;
+
+      // written as selects so that compilers can vectorize it
+      for( std::size_t i = 0; i < n; ++i )
+      {
+        double const v = static_cast<double>( in[i] ) * inverse;
+        double r = v + std::copysign( 0.5, v );
+        r = r < lowest ? lowest : r;
+        r = r > highest ? highest : r;
+        out[i] = static_cast<Int>( r == r ? r : 0.0 );
+      }
+    }
+
+    template <class F>
+    void decode( storage_type const * in, F * out, std::size_t n ) const
+    {
+      for( std::size_t i = 0; i < n; ++i )
+        out[i] = static_cast<F>( static_cast<double>( in[i] ) * scale );
+    }
+
+    double scale; //!< The value represented by one unit of Int
+  };
+
+  // ######################################################################
+  //! A floating point value or container saved in a reduced precision Format
+  /*! Use half_precision, bfloat16_precision or quantized to create these.
+      They can only be used with archives that support binary data, such as the
+      binary and portable binary archives.
+
+      The wrapped data can be a single float, double or long double, or a
+      std::vector or std::array of them.  A vector is saved with its size,
+      exactly like a full precision vector.
+
+      @code{.cpp}
+      struct Telemetry
+      {
+        std::vector<float> temperatures;
+        std::vector<double> positions;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( cereal::half_precision( temperatures ),          // 2 bytes per value
+              cereal::quantized<std::int32_t>( positions, 1e-4 ) ); // 4 bytes, 0.1 mm resolution
+        }
+      };
+      @endcode
+
+      @internal */
+  template <class Format, class T>
+  class ReducedPrecision
+  {
+    private:
+      // Store a reference if passed an lvalue reference, otherwise
+      // make a copy of the data
+      using Type = typename std::conditional<std::is_lvalue_reference<T>::value,
+                                             T,
+                                             typename std::decay<T>::type>::type;
+
+      ReducedPrecision & operator=( ReducedPrecision const & ) = delete;
+
+    public:
+      ReducedPrecision( T && v, Format f ) : value( std::forward<T>( v ) ), format( f ) {}
+
+      Type value;
+      Format format;
+  };
+
+  //! Saves floating point data as IEEE half precision
+  /*! @relates ReducedPrecision */
+  template <class T> inline
+  ReducedPrecision<HalfFormat, T> half_precision( T && value )
+  {
+    return { std::forward<T>( value ), HalfFormat() };
+  }
+
+  //! Saves floating point data as bfloat16
+  /*! @relates ReducedPrecision */
+  template <class T> inline
+  ReducedPrecision<BFloat16Format, T> bfloat16_precision( T && value )
+  {
+    return { std::forward<T>( value ), BFloat16Format() };
+  }
+
+  //! Saves floating point data as integer multiples of scale
+  /*! @tparam Int The integral type each value is stored as
+      @param scale The value represented by one unit of Int, which must be the same when loading
+      @relates ReducedPrecision */
+  template <class Int, class T> inline
+  ReducedPrecision<FixedPointFormat<Int>, T> quantized( T && value, double scale )
+  {
+    return { std::forward<T>( value ), FixedPointFormat<Int>{ scale } };
+  }
+
+  namespace reduced_precision_detail
+  {
+    //! Encodes and saves n values in chunks
+    template <class Archive, class Format, class F> inline
+    void save_values( Archive & ar, Format const & format, F const * data, std::size_t n )
+    {
+      static_assert( std::is_floating_point<F>::value, "reduced precision encodings require floating point data" );
+
+      typename Format::storage_type encoded[chunk_size];
+      for( std::size_t i = 0; i < n; i += chunk_size )
+      {
+        std::size_t const count = n - i < chunk_size ? n - i : chunk_size;
+        format.encode( data + i, encoded, count );
+        ar( binary_data( encoded, count * sizeof(encoded[0]) ) );
+      }
+    }
+
+    //! Loads and decodes n values in chunks
+    template <class Archive, class Format, class F> inline
+    void load_values( Archive & ar, Format const & format, F * data, std::size_t n )
+    {
+      static_assert( std::is_floating_point<F>::value, "reduced precision encodings require floating point data" );
+
+      typename Format::storage_type encoded[chunk_size];
+      for( std::size_t i = 0; i < n; i += chunk_size )
+      {
+        std::size_t const count = n - i < chunk_size ? n - i : chunk_size;
+        ar( binary_data( encoded, count * sizeof(encoded[0]) ) );
+        format.decode( encoded, data + i, count );
+      }
+    }
+
+    //! Saves a single value
+    template <class Archive, class Format, class F> inline
+    void save_data( Archive & ar, Format const & format, F const & value )
+    { save_values( ar, format, &value, 1 ); }
+
+    //! Loads a single value
+    template <class Archive, class Format, class F> inline
+    void load_data( Archive & ar, Format const & format, F & value )
+    { load_values( ar, format, &value, 1 ); }
+
+    //! Saves a std::vector, preceded by its size
+    template <class Archive, class Format, class F, class A> inline
+    void save_data( Archive & ar, Format const & format, std::vector<F, A> const & vector )
+    {
+      ar( make_size_tag( static_cast<size_type>( vector.size() ) ) );
+      save_values( ar, format, vector.data(), vector.size() );
+    }
+
+    //! Loads a std::vector, preceded by its size
+    /*! The vector is grown in steps, so a malformed size does not allocate more than the data that is there */
+    template <class Archive, class Format, class F, class A> inline
+    void load_data( Archive & ar, Format const & format, std::vector<F, A> & vector )
+    {
+      size_type size;
+      ar( make_size_tag( size ) );
+
+      if( !detail::check_load_size( ar, vector, static_cast<std::size_t>( size ) ) )
+        return;
+
+      detail::load_in_steps( ar, vector, static_cast<std::size_t>( size ), [&ar, &format, &vector]( std::size_t first, std::size_t last )
+      {
+        load_values( ar, format, vector.data() + first, last - first );
+      } );
+    }
+
+    //! Saves a std::array
+    template <class Archive, class Format, class F, size_t N> inline
+    void save_data( Archive & ar, Format const & format, std::array<F, N> const & array )
+    { save_values( ar, format, array.data(), N ); }
+
+    //! Loads a std::array
+    template <class Archive, class Format, class F, size_t N> inline
+    void load_data( Archive & ar, Format const & format, std::array<F, N> & array )
+    { load_values( ar, format, array.data(), N ); }
+  } // namespace reduced_precision_detail
+
+  //! Saving for ReducedPrecision
+  template <class Archive, class Format, class T> inline
+  typename std::enable_if<traits::is_output_serializable<BinaryData<typename Format::storage_type>, Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, ReducedPrecision<Format, T> const & rp )
+  {
+    reduced_precision_detail::save_data( ar, rp.format, rp.value );
+  }
+
+  //! Loading for ReducedPrecision
+  template <class Archive, class Format, class T> inline
+  typename std::enable_if<traits::is_input_serializable<BinaryData<typename Format::storage_type>, Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, ReducedPrecision<Format, T> & rp )
+  {
+    reduced_precision_detail::load_data( ar, rp.format, rp.value );
+  }
+} // namespace cereal
+
+#endif // CEREAL_REDUCED_PRECISION_HPP_
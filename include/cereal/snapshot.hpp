@@ -0,0 +1,744 @@
+/*! \file snapshot.hpp
+    \brief Background (forked) snapshotting of in-memory state */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_SNAPSHOT_HPP_
+#define CEREAL_SNAPSHOT_HPP_
+
+#include "cereal/details/helpers.hpp"
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+//! Defined when fork based snapshotting is available on this platform
+#define CEREAL_HAS_FORK_SNAPSHOT
+#endif
+
+#ifdef CEREAL_HAS_FORK_SNAPSHOT
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace cereal
+{
+  class Snapshot;
+
+  namespace snapshot_detail
+  {
+    template <class Archive, class ... Types> class Runner;
+  }
+
+  // ######################################################################
+  //! Options for a background snapshot
+  /*! Options can either be directly passed to fork_snapshot, or chained
+      using the modifier functions for an interface analogous to named
+      parameters:
+
+      @code{.cpp}
+      auto snapshot = cereal::fork_snapshot<cereal::BinaryOutputArchive>( "state.bin",
+                        cereal::SnapshotOptions().timeout( std::chrono::seconds(60) )
+                                                 .minAvailableMemory( 1ull << 30 ),
+                        myState );
+      @endcode */
+  class SnapshotOptions
+  {
+    public:
+      //! Default options: no timeout, no memory limit, progress every MiB, sync on completion
+      static SnapshotOptions Default(){ return SnapshotOptions(); }
+
+      //! Specify specific options for the snapshot
+      /*! @param timeout_ Time after which a still running snapshot is killed (0 to disable)
+          @param minAvailableMemory_ Minimum available system memory, in bytes, required to start
+                                     or continue the snapshot (0 to disable)
+          @param progressInterval_ Number of bytes written between progress reports to the parent
+          @param sync_ Whether the snapshot file is synced to disk before being moved into place */
+      explicit SnapshotOptions( std::chrono::milliseconds timeout_ = std::chrono::milliseconds(0),
+                                std::uint64_t minAvailableMemory_ = 0,
+                                std::uint64_t progressInterval_ = 1 << 20,
+                                bool sync_ = true ) :
+        itsTimeout( timeout_ ),
+        itsMinAvailableMemory( minAvailableMemory_ ),
+        itsProgressInterval( progressInterval_ ),
+        itsSync( sync_ )
+      { }
+
+      /*! @name Option Modifiers
+          An interface for setting option settings analogous to named parameters.
+
+          @code{cpp}
+          cereal::SnapshotOptions()
+            .timeout( std::chrono::seconds(30) )
+            .progressInterval( 16 << 20 )
+          @endcode
+          */
+      //! @{
+
+      //! Kills the snapshot if it has not completed within this time (0 to disable)
+      SnapshotOptions & timeout( std::chrono::milliseconds value ){ itsTimeout = value; return *this; }
+      //! Refuses to start, or aborts, the snapshot when available system memory drops below this many bytes (0 to disable)
+      /*! Copy-on-write pages duplicated while the parent keeps mutating its state count against available
+          memory, so this bounds how far a snapshot may push the machine towards swapping.  Available memory
+          is read from /proc/meminfo, at most every 100 ms while the snapshot runs; on platforms without it
+          this option has no effect. */
+      SnapshotOptions & minAvailableMemory( std::uint64_t bytes ){ itsMinAvailableMemory = bytes; return *this; }
+      //! Number of bytes written between progress reports sent to the parent
+      SnapshotOptions & progressInterval( std::uint64_t bytes ){ itsProgressInterval = bytes; return *this; }
+      //! Whether the snapshot file is synced to disk before it is renamed into place
+      SnapshotOptions & sync( bool enable ){ itsSync = enable; return *this; }
+
+      //! @}
+
+    private:
+      friend class Snapshot;
+      template <class Archive, class ... Types> friend class snapshot_detail::Runner;
+
+      std::chrono::milliseconds itsTimeout;
+      std::uint64_t itsMinAvailableMemory;
+      std::uint64_t itsProgressInterval;
+      bool itsSync;
+  };
+
+  //! The state of a background snapshot
+  enum class SnapshotStatus
+  {
+    Running,        //!< The child process is still serializing
+    Completed,      //!< The snapshot was written and moved into place
+    Failed,         //!< The child could not be started, reported an error, or terminated abnormally
+    TimedOut,       //!< The snapshot was killed after exceeding its timeout
+    MemoryPressure, //!< The snapshot was not started, or was killed, due to low available memory
+    Cancelled       //!< The snapshot was cancelled by the parent
+  };
+
+  namespace snapshot_detail
+  {
+    //! Message types sent from the snapshot child to its parent
+    /*! @internal */
+    enum MessageType : std::uint8_t { Progress = 1, Done = 2, Error = 3 };
+
+    //! Size of a message header: type followed by a 64 bit value
+    /*! @internal */
+    static const std::size_t messageSize = 1 + sizeof(std::uint64_t);
+
+    //! Longest error message forwarded to the parent, keeping every message below PIPE_BUF
+    /*! @internal */
+    static const std::size_t maxErrorLength = 256;
+
+    //! Writes all of the given bytes to a file descriptor, retrying on interruption
+    /*! @internal */
+    inline bool writeAll( int fd, char const * data, std::size_t size )
+    {
+      while( size > 0 )
+      {
+        auto const written = ::write( fd, data, size );
+        if( written < 0 )
+        {
+          if( errno == EINTR )
+            continue;
+          return false;
+        }
+
+        data += written;
+        size -= static_cast<std::size_t>( written );
+      }
+
+      return true;
+    }
+
+    //! Sends a single message to the parent
+    /*! Messages are smaller than PIPE_BUF so each one is written atomically
+        @internal */
+    inline void sendMessage( int fd, MessageType type, std::uint64_t value, std::string const & text = std::string() )
+    {
+      char buffer[messageSize + maxErrorLength];
+      auto const textSize = (std::min)( text.size(), maxErrorLength );
+      if( type == Error )
+        value = textSize;
+
+      buffer[0] = static_cast<char>( type );
+      std::memcpy( buffer + 1, &value, sizeof(value) );
+      std::memcpy( buffer + messageSize, text.data(), textSize );
+      writeAll( fd, buffer, messageSize + textSize );
+    }
+
+    //! Reads the memory available to new allocations, in bytes
+    /*! This reads MemAvailable from /proc/meminfo.
+        @return Whether the available memory is known, which it is not on platforms without /proc/meminfo
+        @internal */
+    inline bool availableMemory( std::uint64_t & bytes )
+    {
+      std::ifstream meminfo( "/proc/meminfo" );
+      std::string key;
+      std::uint64_t value;
+      std::string unit;
+
+      while( meminfo >> key >> value )
+      {
+        if( key == "MemAvailable:" )
+        {
+          bytes = value * 1024;
+          return true;
+        }
+
+        std::getline( meminfo, unit );
+      }
+
+      return false;
+    }
+
+    //! Whether the available memory is known to be below a minimum, where a minimum of 0 disables the check
+    /*! @internal */
+    inline bool belowAvailableMemory( std::uint64_t minimum )
+    {
+      std::uint64_t available;
+      return minimum > 0 && availableMemory( available ) && available < minimum;
+    }
+
+    //! How often poll() reads the available memory of a running snapshot
+    /*! Reading /proc/meminfo on every poll() would tax serving loops that poll often.
+        @internal */
+    inline std::chrono::milliseconds memoryCheckInterval()
+    {
+      return std::chrono::milliseconds( 100 );
+    }
+
+    //! The path of the temporary file a snapshot child writes to before renaming it into place
+    /*! @internal */
+    inline std::string temporaryPath( std::string const & path, pid_t pid )
+    {
+      return path + ".tmp." + std::to_string( pid );
+    }
+
+    //! A stream buffer that writes to a file descriptor and reports progress through a pipe
+    /*! @internal */
+    class FileSink : public std::streambuf
+    {
+      public:
+        FileSink( int fd, int progressFd, std::uint64_t progressInterval ) :
+          itsFd( fd ),
+          itsProgressFd( progressFd ),
+          itsProgressInterval( progressInterval ),
+          itsBuffer( 1 << 16 ),
+          itsWritten( 0 ),
+          itsLastReport( 0 ),
+          itsFailed( false )
+        {
+          setp( itsBuffer.data(), itsBuffer.data() + itsBuffer.size() );
+        }
+
+        ~FileSink() CEREAL_NOEXCEPT
+        {
+          flushBuffer();
+        }
+
+        //! Total number of bytes written to the file
+        std::uint64_t written() const { return itsWritten; }
+
+        //! Whether any write to the file has failed
+        bool failed() const { return itsFailed; }
+
+      protected:
+        int_type overflow( int_type ch ) override
+        {
+          if( !flushBuffer() )
+            return traits_type::eof();
+
+          if( !traits_type::eq_int_type( ch, traits_type::eof() ) )
+          {
+            *pptr() = traits_type::to_char_type( ch );
+            pbump( 1 );
+          }
+
+          return traits_type::not_eof( ch );
+        }
+
+        std::streamsize xsputn( char const * s, std::streamsize n ) override
+        {
+          // Large writes bypass the buffer entirely
+          if( n >= static_cast<std::streamsize>( itsBuffer.size() ) )
+          {
+            if( !flushBuffer() || !write( s, static_cast<std::size_t>( n ) ) )
+              return 0;
+            return n;
+          }
+
+          return std::streambuf::xsputn( s, n );
+        }
+
+        int sync() override
+        {
+          return flushBuffer() ? 0 : -1;
+        }
+
+      private:
+        bool flushBuffer()
+        {
+          auto const pending = static_cast<std::size_t>( pptr() - pbase() );
+          setp( itsBuffer.data(), itsBuffer.data() + itsBuffer.size() );
+          return pending == 0 || write( itsBuffer.data(), pending );
+        }
+
+        bool write( char const * data, std::size_t size )
+        {
+          if( itsFailed || !writeAll( itsFd, data, size ) )
+          {
+            itsFailed = true;
+            return false;
+          }
+
+          itsWritten += size;
+          if( itsWritten - itsLastReport >= itsProgressInterval )
+          {
+            itsLastReport = itsWritten;
+            sendMessage( itsProgressFd, Progress, itsWritten );
+          }
+
+          return true;
+        }
+
+        int itsFd;
+        int itsProgressFd;
+        std::uint64_t itsProgressInterval;
+        std::vector<char> itsBuffer;
+        std::uint64_t itsWritten;
+        std::uint64_t itsLastReport;
+        bool itsFailed;
+    };
+  } // namespace snapshot_detail
+
+  // ######################################################################
+  //! A handle to a snapshot being written by a forked child process
+  /*! A Snapshot is returned by fork_snapshot and is used by the parent to
+      track the progress of the child, which serializes a copy-on-write image
+      of the parent's memory taken at the moment of the fork.
+
+      The parent must periodically call poll() (or block in wait()) so that
+      progress is collected, timeouts and memory limits are enforced, and the
+      child is reaped once it finishes.  Destroying a Snapshot that is still
+      running cancels it.
+
+      The snapshot is first written to a temporary file next to the target
+      path and is only renamed into place once it has been completely written
+      (and, by default, synced), so an existing snapshot at the target path is
+      never left partially overwritten. */
+  class Snapshot
+  {
+    public:
+      Snapshot( Snapshot && other ) CEREAL_NOEXCEPT :
+        itsPid( other.itsPid ),
+        itsPipe( other.itsPipe ),
+        itsPath( std::move( other.itsPath ) ),
+        itsOptions( other.itsOptions ),
+        itsStart( other.itsStart ),
+        itsLastMemoryCheck( other.itsLastMemoryCheck ),
+        itsStatus( other.itsStatus ),
+        itsBytesWritten( other.itsBytesWritten ),
+        itsChildDone( other.itsChildDone ),
+        itsError( std::move( other.itsError ) ),
+        itsPending( std::move( other.itsPending ) )
+      {
+        other.itsPid = -1;
+        other.itsPipe = -1;
+        other.itsStatus = SnapshotStatus::Cancelled;
+      }
+
+      Snapshot( Snapshot const & ) = delete;
+      Snapshot & operator=( Snapshot const & ) = delete;
+      Snapshot & operator=( Snapshot && ) = delete;
+
+      //! Cancels the snapshot if it is still running
+      ~Snapshot() CEREAL_NOEXCEPT
+      {
+        if( itsStatus == SnapshotStatus::Running )
+          cancel();
+        closePipe();
+      }
+
+      //! Collects progress from the child without blocking
+      /*! This also enforces the timeout and memory limits and reaps the
+          child when it has finished.
+          @return The current status of the snapshot */
+      SnapshotStatus poll()
+      {
+        if( itsStatus != SnapshotStatus::Running )
+          return itsStatus;
+
+        readMessages();
+
+        int status;
+        if( ::waitpid( itsPid, &status, WNOHANG ) == itsPid )
+        {
+          finish( status );
+          return itsStatus;
+        }
+
+        auto const now = std::chrono::steady_clock::now();
+        if( itsOptions.itsTimeout.count() > 0 && now - itsStart >= itsOptions.itsTimeout )
+          terminate( SnapshotStatus::TimedOut, "Snapshot exceeded its timeout" );
+        else if( itsOptions.itsMinAvailableMemory > 0 && now - itsLastMemoryCheck >= snapshot_detail::memoryCheckInterval() )
+        {
+          itsLastMemoryCheck = now;
+          if( snapshot_detail::belowAvailableMemory( itsOptions.itsMinAvailableMemory ) )
+            terminate( SnapshotStatus::MemoryPressure, "Available memory fell below the snapshot limit" );
+        }
+
+        return itsStatus;
+      }
+
+      //! Blocks until the snapshot finishes, times out, or is aborted
+      /*! @return The final status of the snapshot */
+      SnapshotStatus wait()
+      {
+        while( poll() == SnapshotStatus::Running )
+        {
+          pollfd pfd;
+          pfd.fd = itsPipe;
+          pfd.events = POLLIN;
+          pfd.revents = 0;
+
+          // Wake up regularly so that limits are enforced even if the child is silent
+          if( ::poll( &pfd, 1, 50 ) > 0 && (pfd.revents & (POLLHUP | POLLERR)) && !(pfd.revents & POLLIN) )
+          {
+            // The child closed its end of the pipe, so it is exiting
+            readMessages();
+            int status;
+            while( ::waitpid( itsPid, &status, 0 ) < 0 && errno == EINTR ) {}
+            finish( status );
+          }
+        }
+
+        return itsStatus;
+      }
+
+      //! Kills the child and discards its partially written output
+      void cancel()
+      {
+        if( itsStatus == SnapshotStatus::Running )
+          terminate( SnapshotStatus::Cancelled, "Snapshot was cancelled" );
+      }
+
+      //! The status as of the last call to poll() or wait()
+      SnapshotStatus status() const { return itsStatus; }
+
+      //! The number of bytes the child has reported writing so far
+      std::uint64_t bytesWritten() const { return itsBytesWritten; }
+
+      //! A description of why the snapshot did not complete, if it did not
+      std::string const & error() const { return itsError; }
+
+      //! The process id of the child, or -1 if no child was started
+      pid_t pid() const { return itsPid; }
+
+    private:
+      template <class Archive, class ... Types> friend class snapshot_detail::Runner;
+
+      Snapshot( pid_t pid, int pipeFd, std::string const & path, SnapshotOptions const & options,
+                SnapshotStatus status = SnapshotStatus::Running, std::string const & error = std::string() ) :
+        itsPid( pid ),
+        itsPipe( pipeFd ),
+        itsPath( path ),
+        itsOptions( options ),
+        itsStart( std::chrono::steady_clock::now() ),
+        itsLastMemoryCheck( itsStart ),
+        itsStatus( status ),
+        itsBytesWritten( 0 ),
+        itsChildDone( false ),
+        itsError( error ),
+        itsPending()
+      { }
+
+      //! Reads and processes all messages currently available on the pipe
+      void readMessages()
+      {
+        char buffer[4096];
+        for( ;; )
+        {
+          auto const readSize = ::read( itsPipe, buffer, sizeof(buffer) );
+          if( readSize < 0 && errno == EINTR )
+            continue;
+          if( readSize <= 0 )
+            break;
+          itsPending.append( buffer, static_cast<std::size_t>( readSize ) );
+        }
+
+        std::size_t pos = 0;
+        while( itsPending.size() - pos >= snapshot_detail::messageSize )
+        {
+          auto const type = static_cast<snapshot_detail::MessageType>( itsPending[pos] );
+          std::uint64_t value;
+          std::memcpy( &value, itsPending.data() + pos + 1, sizeof(value) );
+
+          std::size_t const length = snapshot_detail::messageSize + (type == snapshot_detail::Error ? static_cast<std::size_t>( value ) : 0);
+          if( itsPending.size() - pos < length )
+            break;
+
+          switch( type )
+          {
+            case snapshot_detail::Progress: itsBytesWritten = value; break;
+            case snapshot_detail::Done: itsBytesWritten = value; itsChildDone = true; break;
+            case snapshot_detail::Error: itsError.assign( itsPending, pos + snapshot_detail::messageSize, static_cast<std::size_t>( value ) ); break;
+          }
+
+          pos += length;
+        }
+
+        itsPending.erase( 0, pos );
+      }
+
+      //! Records the outcome of a child that has exited
+      void finish( int status )
+      {
+        readMessages();
+        closePipe();
+
+        if( itsChildDone && WIFEXITED( status ) && WEXITSTATUS( status ) == 0 )
+          itsStatus = SnapshotStatus::Completed;
+        else
+        {
+          itsStatus = SnapshotStatus::Failed;
+          if( itsError.empty() )
+            itsError = WIFSIGNALED( status ) ? "Snapshot process terminated by signal " + std::to_string( WTERMSIG( status ) )
+                                             : "Snapshot process exited without completing";
+          std::remove( snapshot_detail::temporaryPath( itsPath, itsPid ).c_str() );
+        }
+      }
+
+      //! Kills the child, reaps it, and removes its partial output
+      void terminate( SnapshotStatus status, char const * reason )
+      {
+        ::kill( itsPid, SIGKILL );
+        int exitStatus;
+        while( ::waitpid( itsPid, &exitStatus, 0 ) < 0 && errno == EINTR ) {}
+
+        closePipe();
+        std::remove( snapshot_detail::temporaryPath( itsPath, itsPid ).c_str() );
+        itsStatus = status;
+        itsError = reason;
+      }
+
+      void closePipe()
+      {
+        if( itsPipe >= 0 )
+          ::close( itsPipe );
+        itsPipe = -1;
+      }
+
+      pid_t itsPid;
+      int itsPipe;
+      std::string itsPath;
+      SnapshotOptions itsOptions;
+      std::chrono::steady_clock::time_point itsStart;
+      std::chrono::steady_clock::time_point itsLastMemoryCheck; //!< Rate limits reading /proc/meminfo in poll()
+      SnapshotStatus itsStatus;
+      std::uint64_t itsBytesWritten;
+      bool itsChildDone;
+      std::string itsError;
+      std::string itsPending;
+  };
+
+  namespace snapshot_detail
+  {
+    //! Implementation of fork_snapshot
+    /*! @internal */
+    template <class Archive, class ... Types>
+    class Runner
+    {
+      public:
+        static Snapshot run( std::string const & path, SnapshotOptions const & options, Types const & ... data )
+        {
+          if( snapshot_detail::belowAvailableMemory( options.itsMinAvailableMemory ) )
+            return Snapshot( -1, -1, path, options, SnapshotStatus::MemoryPressure,
+                             "Not enough available memory to start a snapshot" );
+
+          int fds[2];
+          if( ::pipe( fds ) != 0 )
+            return failedToStart( path, options, "Failed to create snapshot pipe: " + std::string( std::strerror( errno ) ) );
+
+          pid_t const pid = ::fork();
+          if( pid < 0 )
+          {
+            auto const error = errno;
+            ::close( fds[0] );
+            ::close( fds[1] );
+            return failedToStart( path, options, "Failed to fork snapshot process: " + std::string( std::strerror( error ) ) );
+          }
+
+          if( pid == 0 )
+          {
+            // Child: never return into the caller's code
+            ::close( fds[0] );
+            ::_exit( child( path, options, fds[1], data... ) );
+          }
+
+          ::close( fds[1] );
+          ::fcntl( fds[0], F_SETFD, FD_CLOEXEC );
+          ::fcntl( fds[0], F_SETFL, ::fcntl( fds[0], F_GETFL ) | O_NONBLOCK );
+
+          return Snapshot( pid, fds[0], path, options );
+        }
+
+      private:
+        //! Reports that the child process could not be created
+        /*! Throws an Exception, or without exceptions returns a Snapshot that has failed */
+        static Snapshot failedToStart( std::string const & path, SnapshotOptions const & options, std::string const & error )
+        {
+          #if CEREAL_EXCEPTIONS
+          (void)path;
+          (void)options;
+          throw Exception( error );
+          #else
+          return Snapshot( -1, -1, path, options, SnapshotStatus::Failed, error );
+          #endif
+        }
+
+        //! Serializes the data in the child process
+        /*! @return The exit code for the child */
+        static int child( std::string const & path, SnapshotOptions const & options, int pipeFd, Types const & ... data )
+        {
+          auto const tmpPath = snapshot_detail::temporaryPath( path, ::getpid() );
+
+          std::string error;
+          #if CEREAL_EXCEPTIONS
+          try
+          {
+            error = write( tmpPath, path, options, pipeFd, data... );
+          }
+          catch( std::exception const & e )
+          {
+            error = e.what();
+          }
+          #else
+          error = write( tmpPath, path, options, pipeFd, data... );
+          #endif
+
+          if( error.empty() )
+            return 0;
+
+          std::remove( tmpPath.c_str() );
+          snapshot_detail::sendMessage( pipeFd, snapshot_detail::Error, 0, error );
+          return 1;
+        }
+
+        //! Writes the data to the temporary file and moves it into place at path
+        /*! @return A description of the error, or an empty string on success */
+        static std::string write( std::string const & tmpPath, std::string const & path, SnapshotOptions const & options,
+                                  int pipeFd, Types const & ... data )
+        {
+          int const fd = ::open( tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+          if( fd < 0 )
+            return "Failed to open snapshot file " + tmpPath + ": " + std::strerror( errno );
+
+          std::uint64_t written;
+          bool failed;
+          char const * archiveError = nullptr;
+          {
+            snapshot_detail::FileSink sink( fd, pipeFd, options.itsProgressInterval );
+            std::ostream os( &sink );
+            {
+              Archive ar( os );
+              ar( data... );
+              archiveError = ar.error();
+            } // some archives only finish writing on destruction
+            os.flush();
+            written = sink.written();
+            failed = sink.failed();
+          }
+
+          if( failed || (options.itsSync && ::fsync( fd ) != 0) )
+          {
+            auto const error = errno;
+            ::close( fd );
+            return "Failed to write snapshot file " + tmpPath + ": " + std::strerror( error );
+          }
+
+          if( archiveError )
+          {
+            ::close( fd );
+            return archiveError;
+          }
+
+          if( ::close( fd ) != 0 || std::rename( tmpPath.c_str(), path.c_str() ) != 0 )
+            return "Failed to move snapshot into place at " + path + ": " + std::strerror( errno );
+
+          snapshot_detail::sendMessage( pipeFd, snapshot_detail::Done, written );
+          return std::string();
+        }
+    };
+  } // namespace snapshot_detail
+
+  // ######################################################################
+  //! Writes a snapshot of some data in the background using a forked child process
+  /*! The calling process is paused only for the duration of the fork() call.
+      The child process serializes the copy-on-write image of the data, as it
+      was at the moment of the fork, through a newly constructed Archive to the
+      given path, while the parent continues to run and modify its state.
+
+      @code{.cpp}
+      auto snapshot = cereal::fork_snapshot<cereal::BinaryOutputArchive>( "store.bin", cereal::SnapshotOptions(), store );
+
+      while( snapshot.poll() == cereal::SnapshotStatus::Running )
+      {
+        handleRequests( store ); // keep serving while the snapshot is written
+        std::cout << snapshot.bytesWritten() << " bytes written" << std::endl;
+      }
+      @endcode
+
+      Like any use of fork(), this is only safe if no other thread holds a lock
+      (including locks internal to the memory allocator) that the serialization
+      functions need, since only the calling thread exists in the child.
+
+      @tparam Archive The output archive to use, constructible from a std::ostream
+      @param path The file to write the snapshot to
+      @param options Timeout, memory, and progress options for the snapshot
+      @param data The data to serialize
+      @return A handle used to track the snapshot
+      @throws Exception if the child process cannot be created.  Without exceptions,
+              a Snapshot with SnapshotStatus::Failed and the error is returned instead */
+  template <class Archive, class ... Types> inline
+  Snapshot fork_snapshot( std::string const & path, SnapshotOptions const & options, Types const & ... data )
+  {
+    static_assert( sizeof...(Types) > 0, "fork_snapshot requires data to serialize" );
+    return snapshot_detail::Runner<Archive, Types...>::run( path, options, data... );
+  }
+} // namespace cereal
+
+#endif // CEREAL_HAS_FORK_SNAPSHOT
+
+#endif // CEREAL_SNAPSHOT_HPP_
@@ -33,6 +33,7 @@
 #include "cereal/cereal.hpp"
 #include "cereal/types/string.hpp"
 #include <bitset>
+#include <limits>
 
 namespace cereal
 {
@@ -89,25 +90,23 @@ namespace cereal
             = traits::sfinae> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::bitset<N> const & bits )
   {
-    try
+    // Checked up front rather than by catching std::overflow_error, so this works without exceptions
+    if( (bits >> std::numeric_limits<unsigned long>::digits).none() )
     {
       auto const b = bits.to_ulong();
       ar( CEREAL_NVP_("type", bitset_detail::type::ulong) );
       ar( CEREAL_NVP_("data", b) );
     }
-    catch( std::overflow_error const & )
+    else if( (bits >> std::numeric_limits<unsigned long long>::digits).none() )
     {
-      try
-      {
-        auto const b = bits.to_ullong();
-        ar( CEREAL_NVP_("type", bitset_detail::type::ullong) );
-        ar( CEREAL_NVP_("data", b) );
-      }
-      catch( std::overflow_error const & )
-      {
-        ar( CEREAL_NVP_("type", bitset_detail::type::string) );
-        ar( CEREAL_NVP_("data", bits.to_string()) );
-      }
+      auto const b = bits.to_ullong();
+      ar( CEREAL_NVP_("type", bitset_detail::type::ullong) );
+      ar( CEREAL_NVP_("data", b) );
+    }
+    else
+    {
+      ar( CEREAL_NVP_("type", bitset_detail::type::string) );
+      ar( CEREAL_NVP_("data", bits.to_string()) );
     }
   }
 
@@ -168,7 +167,7 @@ namespace cereal
         break;
       }
       default:
-        throw Exception("Invalid bitset data representation");
+        ar.setError("Invalid bitset data representation");
     }
   }
 } // namespace cereal
@@ -40,6 +40,7 @@
 #include "cereal/cereal.hpp"
 #include <boost/variant/variant_fwd.hpp>
 #include <boost/variant/static_visitor.hpp>
+#include <boost/variant/get.hpp>
 
 namespace cereal
 {
@@ -104,13 +105,17 @@ namespace cereal
     template <class T>
     struct load_variant_wrapper
     {
-      // default constructible
+      // default constructible, loaded in place (reusing the current value if it has type T)
       template <class Archive, class Variant>
       static void load_variant_impl( Archive & ar, Variant & variant, std::true_type )
       {
-        T value;
-        ar( CEREAL_NVP_("data", value) );
-        variant = std::move(value);
+        T * value = boost::get<T>( &variant );
+        if( !value )
+        {
+          variant = T();
+          value = boost::get<T>( &variant );
+        }
+        ar( CEREAL_NVP_("data", *value) );
       }
 
       // not default constructible
@@ -136,7 +141,8 @@ namespace cereal
   template <class Archive, typename ... VariantTypes> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, boost::variant<VariantTypes...> const & variant )
   {
-    int32_t which = variant.which();
+    using which_t = traits::variant_index_type<Archive, sizeof...(VariantTypes)>;
+    which_t which = static_cast<which_t>( variant.which() );
     ar( CEREAL_NVP_("which", which) );
     boost_variant_detail::variant_save_visitor<Archive> visitor(ar);
     variant.apply_visitor(visitor);
@@ -146,14 +152,17 @@ namespace cereal
   template <class Archive, typename ... VariantTypes> inline
   void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, boost::variant<VariantTypes...> & variant )
   {
-    int32_t which;
+    traits::variant_index_type<Archive, sizeof...(VariantTypes)> which;
     ar( CEREAL_NVP_("which", which) );
 
     using LoadFuncType = void(*)(Archive &, boost::variant<VariantTypes...> &);
     CEREAL_CONSTEXPR_LAMBDA LoadFuncType loadFuncArray[] = {&boost_variant_detail::load_variant_wrapper<VariantTypes>::load_variant...};
 
-    if(which >= int32_t(sizeof(loadFuncArray)/sizeof(loadFuncArray[0])))
-      throw Exception("Invalid 'which' selector when deserializing boost::variant");
+    if(static_cast<std::size_t>(which) >= sizeof(loadFuncArray)/sizeof(loadFuncArray[0]))
+    {
+      ar.setError("Invalid 'which' selector when deserializing boost::variant");
+      return;
+    }
 
     loadFuncArray[which](ar, variant);
   }
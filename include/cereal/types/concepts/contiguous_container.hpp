@@ -0,0 +1,183 @@
+/*! \file contiguous_container.hpp
+    \brief Support for containers that store their elements contiguously,
+    such as small or inline vectors
+    \ingroup TypeConcepts */
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_CONCEPTS_CONTIGUOUS_CONTAINER_HPP_
+#define CEREAL_CONCEPTS_CONTIGUOUS_CONTAINER_HPP_
+
+#include "cereal/cereal.hpp"
+#include <cstddef>
+#include <type_traits>
+
+namespace cereal
+{
+  //! Opts a container into being serialized like a std::vector
+  /*! Specialize this to derive from std::true_type for containers that store
+      their elements contiguously and provide value_type, data(), size() and
+      resize(), such as boost::container::small_vector or in-house inline vectors.
+      Containers with a fixed capacity should also provide max_size(), so that
+      loading a larger size reports an error through the archive instead of
+      calling resize() with it.
+      They are then saved in exactly the same format as a std::vector, so data can
+      be exchanged between the two, and use the same fast paths: elements that are
+      arithmetic or trivially_serializable are copied as a single block of binary
+      data where the archive supports it.
+
+      Do not specialize this for types cereal already knows how to serialize.
+
+      @code{.cpp}
+      #include <cereal/types/concepts/contiguous_container.hpp>
+
+      namespace cereal
+      {
+        template <class T, std::size_t N, class A>
+        struct contiguous_container<boost::container::small_vector<T, N, A>> : std::true_type {};
+      }
+      @endcode */
+  template <class T>
+  struct contiguous_container : std::false_type {};
+
+  //! Opts a type into being saved and loaded as raw bytes by binary archives
+  /*! Specialize this to derive from std::true_type for trivially copyable types
+      whose in-memory representation is exactly what should be stored, typically
+      plain structs of arithmetic members without padding.  Sequences of such
+      types held in a std::vector or a contiguous_container are then copied as a
+      single block by BinaryOutputArchive and BinaryInputArchive.
+
+      The type must still provide its normal serialization functions, which are used
+      by all other archives.  Since the raw bytes depend on the platform (endianness,
+      padding, sizes), the portable binary archive also serializes element by element.
+
+      Opting a type in changes its binary format, unless its serialize function
+      happens to save every byte of the type in order.
+
+      @code{.cpp}
+      struct Vec3
+      {
+        float x, y, z;
+
+        template <class Archive>
+        void serialize( Archive & ar ) { ar( x, y, z ); }
+      };
+
+      namespace cereal { template <> struct trivially_serializable<Vec3> : std::true_type {}; }
+      @endcode */
+  template <class T>
+  struct trivially_serializable : std::false_type {};
+
+  namespace contiguous_detail
+  {
+    //! Whether an archive stores binary data in the native representation of the platform
+    template <class Archive>
+    struct native_layout : std::integral_constant<bool,
+      std::is_same<Archive, BinaryOutputArchive>::value || std::is_same<Archive, BinaryInputArchive>::value ||
+      std::is_same<Archive, BinarySizeArchive>::value> {};
+
+    //! Whether a sequence of T is saved and loaded as a single block of binary data
+    template <class Archive, class T>
+    struct use_binary : std::integral_constant<bool,
+      (std::is_arithmetic<T>::value &&
+       (traits::is_output_serializable<BinaryData<T>, Archive>::value ||
+        traits::is_input_serializable<BinaryData<T>, Archive>::value)) ||
+      (trivially_serializable<T>::value && native_layout<Archive>::value)> {};
+
+    //! Checks that a type opted into trivially_serializable can be copied as bytes
+    template <class T> inline
+    void check_trivially_serializable()
+    {
+      #if !defined(__GNUC__) || defined(__clang__) || __GNUC__ >= 5
+      static_assert( !trivially_serializable<T>::value || std::is_trivially_copyable<T>::value,
+                     "cereal::trivially_serializable can only be specialized for trivially copyable types" );
+      #endif
+    }
+
+    //! Saves a number of contiguous elements
+    template <class Archive, class T> inline
+    typename std::enable_if<use_binary<Archive, T>::value>::type
+    save_elements( Archive & ar, T const * data, std::size_t size )
+    {
+      check_trivially_serializable<T>();
+      ar( binary_data( data, size * sizeof(T) ) );
+    }
+
+    //! @overload
+    template <class Archive, class T> inline
+    typename std::enable_if<!use_binary<Archive, T>::value>::type
+    save_elements( Archive & ar, T const * data, std::size_t size )
+    {
+      detail::for_each_element_prefetched( data, data + size, [&ar]( T const & v ){ ar( v ); } );
+    }
+
+    //! Loads a number of contiguous elements
+    template <class Archive, class T> inline
+    typename std::enable_if<use_binary<Archive, T>::value>::type
+    load_elements( Archive & ar, T * data, std::size_t size )
+    {
+      check_trivially_serializable<T>();
+      ar( binary_data( data, size * sizeof(T) ) );
+    }
+
+    //! @overload
+    template <class Archive, class T> inline
+    typename std::enable_if<!use_binary<Archive, T>::value>::type
+    load_elements( Archive & ar, T * data, std::size_t size )
+    {
+      for( std::size_t i = 0; i < size; ++i )
+        ar( data[i] );
+    }
+  } // namespace contiguous_detail
+
+  //! Saving for contiguous containers
+  template <class Archive, class Container> inline
+  typename std::enable_if<contiguous_container<Container>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, Container const & container )
+  {
+    ar( make_size_tag( static_cast<size_type>( container.size() ) ) ); // number of elements
+    contiguous_detail::save_elements( ar, container.data(), static_cast<std::size_t>( container.size() ) );
+  }
+
+  //! Loading for contiguous containers
+  template <class Archive, class Container> inline
+  typename std::enable_if<contiguous_container<Container>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, Container & container )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    if( !detail::check_load_size( ar, container, static_cast<std::size_t>( size ) ) )
+      return;
+
+    detail::load_in_steps( ar, container, static_cast<std::size_t>( size ), [&ar, &container]( std::size_t first, std::size_t last )
+    {
+      contiguous_detail::load_elements( ar, container.data() + first, last - first );
+    } );
+  }
+} // namespace cereal
+
+#endif // CEREAL_CONCEPTS_CONTIGUOUS_CONTAINER_HPP_
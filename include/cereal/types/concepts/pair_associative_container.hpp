@@ -41,10 +41,38 @@ namespace cereal
   {
     ar( make_size_tag( static_cast<size_type>(map.size()) ) );
 
-    for( const auto & i : map )
+    detail::for_each_node_prefetched( map.begin(), map.end(), [&ar]( typename Map<Args...>::value_type const & i )
+    {
       ar( make_map_item(i.first, i.second) );
+    } );
   }
 
+  namespace map_detail
+  {
+    //! Loads the entries of a map into the nodes it already holds, see InputArchive::setReuseStorage
+    /*! @return Whether the entries were loaded
+        @internal */
+    template <class Archive, class MapT> inline
+    bool load_into_nodes( Archive & ar, MapT & map, size_type size, std::true_type /* has_node_handles */ )
+    {
+      if( !ar.reusesStorage() )
+        return false;
+
+      detail::load_into_nodes( map, static_cast<std::size_t>( size ), ar.isTrustedSource(), [&ar]( typename MapT::node_type & node )
+      {
+        ar( make_map_item( node.key(), node.mapped() ) );
+      } );
+      return true;
+    }
+
+    //! @overload
+    template <class Archive, class MapT> inline
+    bool load_into_nodes( Archive &, MapT &, size_type, std::false_type /* has_node_handles */ )
+    {
+      return false;
+    }
+  } // namespace map_detail
+
   //! Loading for std-like pair associative containers
   template <class Archive, template <typename...> class Map, typename... Args, typename = typename Map<Args...>::mapped_type> inline
   void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, Map<Args...> & map )
@@ -52,8 +80,14 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
+    if( map_detail::load_into_nodes( ar, map, size, detail::has_node_handles<Map<Args...>>() ) )
+      return;
+
     map.clear();
 
+    // Trusted data was saved in iteration order, so every element belongs at the end
+    bool const appendAtEnd = ar.isTrustedSource();
+
     auto hint = map.begin();
     for( size_t i = 0; i < size; ++i )
     {
@@ -61,6 +95,8 @@ namespace cereal
       typename Map<Args...>::mapped_type value;
 
       ar( make_map_item(key, value) );
+      if( appendAtEnd )
+        hint = map.end();
       #ifdef CEREAL_OLDER_GCC
       hint = map.insert( hint, std::make_pair(std::move(key), std::move(value)) );
       #else // NOT CEREAL_OLDER_GCC
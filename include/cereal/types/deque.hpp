@@ -45,17 +45,44 @@ namespace cereal
       ar( i );
   }
 
+  //! Loading for std::deque of arithmetic types from binary archives
+  /*! The elements already in the deque are overwritten and the rest are read in
+      chunks and appended, instead of zero filling the deque with resize and reading
+      the elements one at a time.  The data is the same. */
+  template <class Archive, class T, class A> inline
+  typename std::enable_if<std::is_same<Archive, BinaryInputArchive>::value && std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    if( !detail::check_load_size( ar, deque, static_cast<std::size_t>( size ) ) )
+      return;
+
+    std::size_t const existing = static_cast<std::size_t>( size ) < deque.size() ? static_cast<std::size_t>( size ) : deque.size();
+    deque.resize( existing );
+
+    detail::overwrite_binary_data( ar, deque.begin(), existing );
+    if( existing < size )
+      detail::append_binary_data( ar, deque, static_cast<std::size_t>( size ) - existing );
+  }
+
   //! Loading for std::deque
   template <class Archive, class T, class A> inline
-  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
+  typename std::enable_if<!std::is_same<Archive, BinaryInputArchive>::value || !std::is_arithmetic<T>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::deque<T, A> & deque )
   {
     size_type size;
     ar( make_size_tag( size ) );
 
-    deque.resize( static_cast<size_t>( size ) );
+    if( !detail::check_load_size( ar, deque, static_cast<std::size_t>( size ) ) )
+      return;
 
-    for( auto & i : deque )
-      ar( i );
+    detail::load_in_steps( ar, deque, static_cast<std::size_t>( size ), [&ar, &deque]( std::size_t first, std::size_t last )
+    {
+      for( std::size_t i = first; i < last; ++i )
+        ar( deque[i] );
+    } );
   }
 } // namespace cereal
 
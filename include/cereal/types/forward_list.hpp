@@ -47,8 +47,7 @@ namespace cereal
     ar( make_size_tag( size ) );
 
     // write the list
-    for( const auto & i : forward_list )
-      ar( i );
+    detail::for_each_node_prefetched( forward_list.begin(), forward_list.end(), [&ar]( T const & i ){ ar( i ); } );
   }
 
   //! Loading for std::forward_list all other types from
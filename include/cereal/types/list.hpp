@@ -41,8 +41,7 @@ namespace cereal
   {
     ar( make_size_tag( static_cast<size_type>(list.size()) ) );
 
-    for( auto const & i : list )
-      ar( i );
+    detail::for_each_node_prefetched( list.begin(), list.end(), [&ar]( T const & i ){ ar( i ); } );
   }
 
   //! Loading for std::list
@@ -59,6 +59,34 @@ namespace cereal
       return {std::forward<T>(t)};
     }
 
+    //! A wrapper class that marks a smart pointer as a chained edge, see cereal::chain
+    /*! @internal */
+    template<class T>
+    struct ChainWrapper
+    {
+      ChainWrapper(T & p) : ptr(p) {}
+      T & ptr;
+
+      ChainWrapper( ChainWrapper const & ) = default;
+      ChainWrapper & operator=( ChainWrapper const & ) = delete;
+    };
+
+    //! Saves the object behind a chained pointer, see OutputArchive::saveChained
+    /*! @internal */
+    template <class T, class Archive> inline
+    void saveChainedObject( Archive & ar, void const * addr )
+    {
+      ar( *static_cast<T const *>( addr ) );
+    }
+
+    //! Loads the object behind a chained pointer, see InputArchive::loadChained
+    /*! @internal */
+    template <class T, class Archive> inline
+    void loadChainedObject( Archive & ar, void * addr )
+    {
+      ar( *static_cast<T *>( addr ) );
+    }
+
     //! A struct that acts as a wrapper around calling load_andor_construct
     /*! The purpose of this is to allow a load_and_construct call to properly enter into the
         'data' NVP of the ptr_wrapper
@@ -417,6 +445,144 @@ namespace cereal
       wrapper.ptr.reset( nullptr );
     }
   }
+
+  // ######################################################################
+  // Chained pointers
+
+  //! Marks a smart pointer as an edge of a deeply nested structure
+  /*! Serializing a long linked list, or any other structure whose objects are reached
+      through a chain of pointers, recurses once per object and eventually overflows the
+      stack.  Wrapping the pointers that form the chain with this function breaks the
+      recursion: a chained pointer only saves its id (or validity flag) where it appears,
+      and the object it points to is saved after the object containing the pointer has
+      been saved.  The archive keeps these objects on a work stack, so structures of any
+      depth are serialized with constant stack depth.
+
+      @code{.cpp}
+      struct Node
+      {
+        int value;
+        std::shared_ptr<Node> next;
+
+        template <class Archive>
+        void serialize( Archive & ar )
+        {
+          ar( value, cereal::chain( next ) );
+        }
+      };
+      @endcode
+
+      This works with std::shared_ptr and std::unique_ptr to non polymorphic types that
+      can be constructed before they are loaded, i.e. that do not use load_and_construct.
+      Since an object behind a chained pointer is loaded later, its contents must not be
+      used while loading the object that points to it.
+
+      Chained pointers are saved differently from plain pointers, so data must be loaded
+      with the same pointers chained as it was saved with.
+
+      @relates memory_detail::ChainWrapper */
+  template <class T> inline
+  memory_detail::ChainWrapper<T> chain( T & ptr )
+  {
+    return {ptr};
+  }
+
+  namespace memory_detail
+  {
+    //! Saves a chained std::shared_ptr
+    /*! @internal */
+    template <class Archive, class T> inline
+    void saveChainedPtr( Archive & ar, std::shared_ptr<T> const & ptr )
+    {
+      static_assert( !std::is_polymorphic<T>::value, "cereal::chain does not support polymorphic types" );
+
+      std::uint32_t id = ar.registerSharedPointer( ptr.get() );
+      ar( CEREAL_NVP_("id", id) );
+
+      if( id & detail::msb_32bit )
+        ar.saveChained( &saveChainedObject<T>, ptr.get() );
+    }
+
+    //! Loads a chained std::shared_ptr
+    /*! @internal */
+    template <class Archive, class T> inline
+    void loadChainedPtr( Archive & ar, std::shared_ptr<T> & ptr )
+    {
+      static_assert( !std::is_polymorphic<T>::value, "cereal::chain does not support polymorphic types" );
+      static_assert( !traits::has_load_and_construct<T, Archive>::value,
+                     "cereal::chain does not support types that use load_and_construct" );
+
+      std::uint32_t id;
+      ar( CEREAL_NVP_("id", id) );
+
+      if( id & detail::msb_32bit )
+      {
+        using NonConstT = typename std::remove_const<T>::type;
+        std::shared_ptr<NonConstT> object( detail::Construct<NonConstT, Archive>::load_andor_construct() );
+        ar.registerSharedPointer( id, object );
+        ptr = object;
+        ar.loadChained( &loadChainedObject<NonConstT>, object.get() );
+      }
+      else
+        ptr = std::static_pointer_cast<T>(ar.getSharedPointer(id));
+    }
+
+    //! Saves a chained std::unique_ptr
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void saveChainedPtr( Archive & ar, std::unique_ptr<T, D> const & ptr )
+    {
+      static_assert( !std::is_polymorphic<T>::value, "cereal::chain does not support polymorphic types" );
+
+      if( !ptr )
+        ar( CEREAL_NVP_("valid", std::uint8_t(0)) );
+      else
+      {
+        ar( CEREAL_NVP_("valid", std::uint8_t(1)) );
+        ar.saveChained( &saveChainedObject<T>, ptr.get() );
+      }
+    }
+
+    //! Loads a chained std::unique_ptr
+    /*! @internal */
+    template <class Archive, class T, class D> inline
+    void loadChainedPtr( Archive & ar, std::unique_ptr<T, D> & ptr )
+    {
+      static_assert( !std::is_polymorphic<T>::value, "cereal::chain does not support polymorphic types" );
+      static_assert( !traits::has_load_and_construct<T, Archive>::value,
+                     "cereal::chain does not support types that use load_and_construct" );
+
+      std::uint8_t isValid;
+      ar( CEREAL_NVP_("valid", isValid) );
+
+      if( isValid )
+      {
+        using NonConstT = typename std::remove_const<T>::type;
+        std::unique_ptr<NonConstT, D> object( detail::Construct<NonConstT, Archive>::load_andor_construct() );
+        NonConstT * const addr = object.get();
+        ptr = std::move( object );
+        ar.loadChained( &loadChainedObject<NonConstT>, addr );
+      }
+      else
+        ptr.reset( nullptr );
+    }
+  } // end namespace memory_detail
+
+  //! Saving chained smart pointers
+  /*! @internal */
+  template <class Archive, class T> inline
+  void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, memory_detail::ChainWrapper<T> const & wrapper )
+  {
+    memory_detail::saveChainedPtr( ar, wrapper.ptr );
+  }
+
+  //! Loading chained smart pointers
+  /*! @internal */
+  template <class Archive, class T> inline
+  void CEREAL_LOAD_FUNCTION_NAME( Archive & ar, memory_detail::ChainWrapper<T> & wrapper )
+  {
+    memory_detail::loadChainedPtr( ar, wrapper.ptr );
+  }
 } // namespace cereal
 
 // automatically include polymorphic support
@@ -77,8 +77,10 @@
     if placed in a source file, but see the above comments
     on registering in source files.
 
-    Polymorphic support in cereal requires RTTI to be
-    enabled */
+    Without RTTI (see CEREAL_NO_RTTI), the registered type and
+    its bases must also provide CEREAL_POLYMORPHIC_TYPE_ID so
+    that cereal can find their dynamic type.  Downcasting from
+    a virtual base class is not possible in this configuration. */
 #define CEREAL_REGISTER_TYPE(...)                                        \
   namespace cereal {                                                     \
   namespace detail {                                                     \
@@ -183,13 +185,25 @@ namespace cereal
 {
   namespace polymorphic_detail
   {
-    //! Error message used for unregistered polymorphic types
+    //! Reports an unregistered polymorphic type to the archive ar
     /*! @internal */
     #define UNREGISTERED_POLYMORPHIC_EXCEPTION(LoadSave, Name)                                                                                      \
-      throw cereal::Exception("Trying to " #LoadSave " an unregistered polymorphic type (" + Name + ").\n"                                          \
-                              "Make sure your type is registered with CEREAL_REGISTER_TYPE and that the archive "                                   \
-                              "you are using was included (and registered with CEREAL_REGISTER_ARCHIVE) prior to calling CEREAL_REGISTER_TYPE.\n"   \
-                              "If your type is already registered and you still see this error, you may need to use CEREAL_REGISTER_DYNAMIC_INIT.");
+      CEREAL_THROW_ON_ERROR(ar, "Trying to " #LoadSave " an unregistered polymorphic type (" + Name + ").\n"                                        \
+                                "Make sure your type is registered with CEREAL_REGISTER_TYPE and that the archive "                                 \
+                                "you are using was included (and registered with CEREAL_REGISTER_ARCHIVE) prior to calling CEREAL_REGISTER_TYPE.\n" \
+                                "If your type is already registered and you still see this error, you may need to use CEREAL_REGISTER_DYNAMIC_INIT."); \
+      ar.setError("Trying to " #LoadSave " an unregistered polymorphic type");
+
+    //! Gets an input binding that loads a null pointer
+    /*! @internal */
+    template<class Archive> inline
+    typename ::cereal::detail::InputBindingMap<Archive>::Serializers getEmptyInputBinding()
+    {
+      typename ::cereal::detail::InputBindingMap<Archive>::Serializers emptySerializers;
+      emptySerializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, ::cereal::detail::type_index const &) { ptr.reset(); };
+      emptySerializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, ::cereal::detail::type_index const &) { ptr.reset( nullptr ); };
+      return emptySerializers;
+    }
 
     //! Get an input binding from the given archive by deserializing the type meta data
     /*! @internal */
@@ -198,12 +212,7 @@ namespace cereal
     {
       // If the nameid is zero, we serialized a null pointer
       if(nameid == 0)
-      {
-        typename ::cereal::detail::InputBindingMap<Archive>::Serializers emptySerializers;
-        emptySerializers.shared_ptr = [](void*, std::shared_ptr<void> & ptr, std::type_info const &) { ptr.reset(); };
-        emptySerializers.unique_ptr = [](void*, std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> & ptr, std::type_info const &) { ptr.reset( nullptr ); };
-        return emptySerializers;
-      }
+        return getEmptyInputBinding<Archive>();
 
       std::string name;
       if(nameid & detail::msb_32bit)
@@ -218,7 +227,15 @@ namespace cereal
 
       auto binding = bindingMap.find(name);
       if(binding == bindingMap.end())
+      {
         UNREGISTERED_POLYMORPHIC_EXCEPTION(load, name)
+        return getEmptyInputBinding<Archive>();
+      }
+
+      #if CEREAL_TRACE
+      detail::trace( TraceEvent::PolymorphicLoad, &ar, ar.tracedBytes(), name );
+      #endif
+
       return binding->second;
     }
 
@@ -271,10 +288,13 @@ namespace cereal
     typename std::enable_if<(!traits::is_default_constructible<T>::value
                              && !traits::has_load_and_construct<T, Archive>::value)
                              || std::is_abstract<T>::value, bool>::type
-    serialize_wrapper(Archive &, std::shared_ptr<T> &, std::uint32_t const nameid)
+    serialize_wrapper(Archive & ar, std::shared_ptr<T> &, std::uint32_t const nameid)
     {
       if(nameid & detail::msb2_32bit)
-        throw cereal::Exception("Cannot load a polymorphic type that is not default constructable and does not have a load_and_construct function");
+      {
+        ar.setError("Cannot load a polymorphic type that is not default constructable and does not have a load_and_construct function");
+        return true;
+      }
       return false;
     }
 
@@ -288,10 +308,13 @@ namespace cereal
      typename std::enable_if<(!traits::is_default_constructible<T>::value
                                && !traits::has_load_and_construct<T, Archive>::value)
                                || std::is_abstract<T>::value, bool>::type
-    serialize_wrapper(Archive &, std::unique_ptr<T, D> &, std::uint32_t const nameid)
+    serialize_wrapper(Archive & ar, std::unique_ptr<T, D> &, std::uint32_t const nameid)
     {
       if(nameid & detail::msb2_32bit)
-        throw cereal::Exception("Cannot load a polymorphic type that is not default constructable and does not have a load_and_construct function");
+      {
+        ar.setError("Cannot load a polymorphic type that is not default constructable and does not have a load_and_construct function");
+        return true;
+      }
       return false;
     }
   } // polymorphic_detail
@@ -311,17 +334,24 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
-    static std::type_info const & tinfo = typeid(T);
+    auto const ptrinfo = detail::dynamic_type_index_of(*ptr.get());
+    auto const tinfo = detail::type_index_of<T>();
     // ptrinfo can never be equal to T info since we can't have an instance
     // of an abstract object
     //  this implies we need to do the lookup
 
     auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
 
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
+    auto binding = bindingMap.find(ptrinfo);
     if(binding == bindingMap.end())
+    {
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+      return;
+    }
+
+    #if CEREAL_TRACE
+    detail::trace( TraceEvent::PolymorphicSave, &ar, ar.tracedBytes(), ptrinfo );
+    #endif
 
     binding->second.shared_ptr(&ar, ptr.get(), tinfo);
   }
@@ -338,8 +368,8 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
-    static std::type_info const & tinfo = typeid(T);
+    auto const ptrinfo = detail::dynamic_type_index_of(*ptr.get());
+    auto const tinfo = detail::type_index_of<T>();
 
     if(ptrinfo == tinfo)
     {
@@ -354,9 +384,16 @@ namespace cereal
 
     auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
 
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
+    auto binding = bindingMap.find(ptrinfo);
     if(binding == bindingMap.end())
+    {
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+      return;
+    }
+
+    #if CEREAL_TRACE
+    detail::trace( TraceEvent::PolymorphicSave, &ar, ar.tracedBytes(), ptrinfo );
+    #endif
 
     binding->second.shared_ptr(&ar, ptr.get(), tinfo);
   }
@@ -375,7 +412,7 @@ namespace cereal
 
     auto binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::shared_ptr<void> result;
-    binding.shared_ptr(&ar, result, typeid(T));
+    binding.shared_ptr(&ar, result, detail::type_index_of<T>());
     ptr = std::static_pointer_cast<T>(result);
   }
 
@@ -410,17 +447,24 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
-    static std::type_info const & tinfo = typeid(T);
+    auto const ptrinfo = detail::dynamic_type_index_of(*ptr.get());
+    auto const tinfo = detail::type_index_of<T>();
     // ptrinfo can never be equal to T info since we can't have an instance
     // of an abstract object
     //  this implies we need to do the lookup
 
     auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
 
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
+    auto binding = bindingMap.find(ptrinfo);
     if(binding == bindingMap.end())
+    {
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+      return;
+    }
+
+    #if CEREAL_TRACE
+    detail::trace( TraceEvent::PolymorphicSave, &ar, ar.tracedBytes(), ptrinfo );
+    #endif
 
     binding->second.unique_ptr(&ar, ptr.get(), tinfo);
   }
@@ -437,8 +481,8 @@ namespace cereal
       return;
     }
 
-    std::type_info const & ptrinfo = typeid(*ptr.get());
-    static std::type_info const & tinfo = typeid(T);
+    auto const ptrinfo = detail::dynamic_type_index_of(*ptr.get());
+    auto const tinfo = detail::type_index_of<T>();
 
     if(ptrinfo == tinfo)
     {
@@ -453,9 +497,16 @@ namespace cereal
 
     auto const & bindingMap = detail::StaticObject<detail::OutputBindingMap<Archive>>::getInstance().map;
 
-    auto binding = bindingMap.find(std::type_index(ptrinfo));
+    auto binding = bindingMap.find(ptrinfo);
     if(binding == bindingMap.end())
+    {
       UNREGISTERED_POLYMORPHIC_EXCEPTION(save, cereal::util::demangle(ptrinfo.name()))
+      return;
+    }
+
+    #if CEREAL_TRACE
+    detail::trace( TraceEvent::PolymorphicSave, &ar, ar.tracedBytes(), ptrinfo );
+    #endif
 
     binding->second.unique_ptr(&ar, ptr.get(), tinfo);
   }
@@ -474,7 +525,7 @@ namespace cereal
 
     auto binding = polymorphic_detail::getInputBinding(ar, nameid);
     std::unique_ptr<void, ::cereal::detail::EmptyDeleter<void>> result;
-    binding.unique_ptr(&ar, result, typeid(T));
+    binding.unique_ptr(&ar, result, detail::type_index_of<T>());
     ptr.reset(static_cast<T*>(result.release()));
   }
 
@@ -74,6 +74,22 @@ namespace cereal
       return H::get( priority_queue );
     }
 
+    //! Allows mutable access to the protected container in priority queue
+    /*! @internal */
+    template <class T, class C, class Comp> inline
+    C & container( std::priority_queue<T, C, Comp> & priority_queue )
+    {
+      struct H : public std::priority_queue<T, C, Comp>
+      {
+        static C & get( std::priority_queue<T, C, Comp> & pq )
+        {
+          return pq.*(&H::c);
+        }
+      };
+
+      return H::get( priority_queue );
+    }
+
     //! Allows access to the protected comparator in priority queue
     /*! @internal */
     template <class T, class C, class Comp> inline
@@ -125,7 +141,14 @@ namespace cereal
     C container;
     ar( CEREAL_NVP_("container", container) );
 
-    priority_queue = std::priority_queue<T, C, Comp>( comparator, std::move( container ) );
+    if( ar.isTrustedSource() )
+    {
+      // The container was saved in heap order, so there is no need to heapify it again
+      priority_queue = std::priority_queue<T, C, Comp>( comparator );
+      queue_detail::container( priority_queue ) = std::move( container );
+    }
+    else
+      priority_queue = std::priority_queue<T, C, Comp>( comparator, std::move( container ) );
   }
 } // namespace cereal
 
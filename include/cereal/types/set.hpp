@@ -43,8 +43,30 @@ namespace cereal
     {
       ar( make_size_tag( static_cast<size_type>(set.size()) ) );
 
-      for( const auto & i : set )
-        ar( i );
+      detail::for_each_node_prefetched( set.begin(), set.end(), [&ar]( typename SetT::value_type const & i ){ ar( i ); } );
+    }
+
+    //! Loads the keys of a set into the nodes it already holds, see InputArchive::setReuseStorage
+    /*! @return Whether the keys were loaded
+        @internal */
+    template <class Archive, class SetT> inline
+    bool load_into_nodes( Archive & ar, SetT & set, size_type size, std::true_type /* has_node_handles */ )
+    {
+      if( !ar.reusesStorage() )
+        return false;
+
+      detail::load_into_nodes( set, static_cast<std::size_t>( size ), ar.isTrustedSource(), [&ar]( typename SetT::node_type & node )
+      {
+        ar( node.value() );
+      } );
+      return true;
+    }
+
+    //! @overload
+    template <class Archive, class SetT> inline
+    bool load_into_nodes( Archive &, SetT &, size_type, std::false_type /* has_node_handles */ )
+    {
+      return false;
     }
 
     //! @internal
@@ -54,14 +76,22 @@ namespace cereal
       size_type size;
       ar( make_size_tag( size ) );
 
+      if( load_into_nodes( ar, set, size, detail::has_node_handles<SetT>() ) )
+        return;
+
       set.clear();
 
+      // Trusted data was saved in iteration order, so every element belongs at the end
+      bool const appendAtEnd = ar.isTrustedSource();
+
       auto hint = set.begin();
       for( size_type i = 0; i < size; ++i )
       {
         typename SetT::key_type key;
 
         ar( key );
+        if( appendAtEnd )
+          hint = set.end();
         #ifdef CEREAL_OLDER_GCC
         hint = set.insert( hint, std::move( key ) );
         #else // NOT CEREAL_OLDER_GCC
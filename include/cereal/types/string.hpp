@@ -52,8 +52,11 @@ namespace cereal
   {
     size_type size;
     ar( make_size_tag( size ) );
-    str.resize(static_cast<std::size_t>(size));
-    ar( binary_data( const_cast<CharT *>( str.data() ), static_cast<std::size_t>(size) * sizeof(CharT) ) );
+
+    if( !detail::check_load_size( ar, str, static_cast<std::size_t>( size ) ) )
+      return;
+
+    detail::load_binary_in_steps( ar, str, static_cast<std::size_t>( size ) );
   }
 } // namespace cereal
 
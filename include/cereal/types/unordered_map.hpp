@@ -31,6 +31,82 @@
 #define CEREAL_TYPES_UNORDERED_MAP_HPP_
 
 #include "cereal/types/concepts/pair_associative_container.hpp"
+#include "cereal/persisted_hash.hpp"
 #include <unordered_map>
 
+namespace cereal
+{
+  namespace unordered_map_detail
+  {
+    //! Inserts an element whose key is not yet in the map
+    /*! Both forms hash the key object passed in before moving it into the map
+        with libstdc++, so that a hash forwarded by PersistedHash is used.
+        @internal */
+    template <class MapT> inline
+    void insert_unique( MapT & map, typename MapT::key_type && key, typename MapT::mapped_type && value )
+    {
+      #ifdef CEREAL_HAS_CPP17
+      map.try_emplace( std::move( key ), std::move( value ) );
+      #else // NOT CEREAL_HAS_CPP17
+      map[std::move( key )] = std::move( value );
+      #endif // NOT CEREAL_HAS_CPP17
+    }
+  } // namespace unordered_map_detail
+
+  //! Saving for std::unordered_map using PersistedHash to binary archives
+  /*! The hash of every key is saved after its element, see PersistedHash */
+  template <class Archive, class K, class T, class H, class KE, class A> inline
+  typename std::enable_if<persisted_hash_detail::use_persisted_hash<Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::unordered_map<K, T, PersistedHash<H>, KE, A> const & map )
+  {
+    ar( make_size_tag( static_cast<size_type>(map.size()) ) );
+    persisted_hash_detail::save_identity( ar, map );
+
+    auto const hasher = map.hash_function();
+    detail::for_each_node_prefetched( map.begin(), map.end(), [&ar, &hasher]( std::pair<K const, T> const & i )
+    {
+      // hashed after saving, when the key is in the cache
+      ar( i.first, i.second );
+      ar( static_cast<std::uint64_t>( hasher( i.first ) ) );
+    } );
+  }
+
+  //! Loading for std::unordered_map using PersistedHash from binary archives
+  /*! For archives marked as a trusted source, the stored hashes are used instead of
+      hashing the keys if they were computed by the same hash function, see PersistedHash */
+  template <class Archive, class K, class T, class H, class KE, class A> inline
+  typename std::enable_if<persisted_hash_detail::use_persisted_hash<Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::unordered_map<K, T, PersistedHash<H>, KE, A> & map )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    map.clear();
+
+    // stored hashes are not verified, so they are only used for trusted data
+    bool useStored = persisted_hash_detail::load_identity( ar, map ) && ar.isTrustedSource();
+    persisted_hash_detail::ForwardingScope<K> forwarding( useStored );
+
+    for( size_type i = 0; i < size; ++i )
+    {
+      K key;
+      T value;
+      std::uint64_t hash;
+      ar( key, value, hash );
+
+      if( i == 0 && useStored )
+        useStored = persisted_hash_detail::check_first( map, key, hash );
+
+      detail::reserve_for_load( ar, map, map.size() + 1, static_cast<std::size_t>( size ) );
+      if( useStored )
+      {
+        persisted_hash_detail::ForwardHash<K> forward( key, static_cast<std::size_t>( hash ) );
+        unordered_map_detail::insert_unique( map, std::move( key ), std::move( value ) );
+      }
+      else
+        unordered_map_detail::insert_unique( map, std::move( key ), std::move( value ) );
+    }
+  }
+} // namespace cereal
+
 #endif // CEREAL_TYPES_UNORDERED_MAP_HPP_
@@ -31,6 +31,7 @@
 #define CEREAL_TYPES_UNORDERED_SET_HPP_
 
 #include "cereal/cereal.hpp"
+#include "cereal/persisted_hash.hpp"
 #include <unordered_set>
 
 namespace cereal
@@ -43,8 +44,30 @@ namespace cereal
     {
       ar( make_size_tag( static_cast<size_type>(set.size()) ) );
 
-      for( const auto & i : set )
-        ar( i );
+      detail::for_each_node_prefetched( set.begin(), set.end(), [&ar]( typename SetT::value_type const & i ){ ar( i ); } );
+    }
+
+    //! Loads the keys of a set into the nodes it already holds, see InputArchive::setReuseStorage
+    /*! @return Whether the keys were loaded
+        @internal */
+    template <class Archive, class SetT> inline
+    bool load_into_nodes( Archive & ar, SetT & set, size_type size, std::true_type /* has_node_handles */ )
+    {
+      if( !ar.reusesStorage() )
+        return false;
+
+      detail::load_into_nodes( set, static_cast<std::size_t>( size ), false, [&ar]( typename SetT::node_type & node )
+      {
+        ar( node.value() );
+      } );
+      return true;
+    }
+
+    //! @overload
+    template <class Archive, class SetT> inline
+    bool load_into_nodes( Archive &, SetT &, size_type, std::false_type /* has_node_handles */ )
+    {
+      return false;
     }
 
     //! @internal
@@ -54,14 +77,17 @@ namespace cereal
       size_type size;
       ar( make_size_tag( size ) );
 
+      if( load_into_nodes( ar, set, size, detail::has_node_handles<SetT>() ) )
+        return;
+
       set.clear();
-      set.reserve( static_cast<std::size_t>( size ) );
 
       for( size_type i = 0; i < size; ++i )
       {
         typename SetT::key_type key;
 
         ar( key );
+        detail::reserve_for_load( ar, set, set.size() + 1, static_cast<std::size_t>( size ) );
         set.emplace( std::move( key ) );
       }
     }
@@ -81,6 +107,60 @@ namespace cereal
     unordered_set_detail::load( ar, unordered_set );
   }
 
+  //! Saving for std::unordered_set using PersistedHash to binary archives
+  /*! The hash of every key is saved after it, see PersistedHash */
+  template <class Archive, class K, class H, class KE, class A> inline
+  typename std::enable_if<persisted_hash_detail::use_persisted_hash<Archive>::value, void>::type
+  CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::unordered_set<K, PersistedHash<H>, KE, A> const & unordered_set )
+  {
+    ar( make_size_tag( static_cast<size_type>(unordered_set.size()) ) );
+    persisted_hash_detail::save_identity( ar, unordered_set );
+
+    auto const hasher = unordered_set.hash_function();
+    detail::for_each_node_prefetched( unordered_set.begin(), unordered_set.end(), [&ar, &hasher]( K const & i )
+    {
+      // hashed after saving, when the key is in the cache
+      ar( i );
+      ar( static_cast<std::uint64_t>( hasher( i ) ) );
+    } );
+  }
+
+  //! Loading for std::unordered_set using PersistedHash from binary archives
+  /*! For archives marked as a trusted source, the stored hashes are used instead of
+      hashing the keys if they were computed by the same hash function, see PersistedHash */
+  template <class Archive, class K, class H, class KE, class A> inline
+  typename std::enable_if<persisted_hash_detail::use_persisted_hash<Archive>::value, void>::type
+  CEREAL_LOAD_FUNCTION_NAME( Archive & ar, std::unordered_set<K, PersistedHash<H>, KE, A> & unordered_set )
+  {
+    size_type size;
+    ar( make_size_tag( size ) );
+
+    unordered_set.clear();
+
+    // stored hashes are not verified, so they are only used for trusted data
+    bool useStored = persisted_hash_detail::load_identity( ar, unordered_set ) && ar.isTrustedSource();
+    persisted_hash_detail::ForwardingScope<K> forwarding( useStored );
+
+    for( size_type i = 0; i < size; ++i )
+    {
+      K key;
+      std::uint64_t hash;
+      ar( key, hash );
+
+      if( i == 0 && useStored )
+        useStored = persisted_hash_detail::check_first( unordered_set, key, hash );
+
+      detail::reserve_for_load( ar, unordered_set, unordered_set.size() + 1, static_cast<std::size_t>( size ) );
+      if( useStored )
+      {
+        persisted_hash_detail::ForwardHash<K> forward( key, static_cast<std::size_t>( hash ) );
+        unordered_set.insert( std::move( key ) );
+      }
+      else
+        unordered_set.insert( std::move( key ) );
+    }
+  }
+
   //! Saving for std::unordered_multiset
   template <class Archive, class K, class H, class KE, class A> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::unordered_multiset<K, H, KE, A> const & unordered_multiset )
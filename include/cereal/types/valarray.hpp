@@ -56,7 +56,9 @@ namespace cereal
     size_type valarraySize;
     ar( make_size_tag( valarraySize ) );
 
-    valarray.resize( static_cast<std::size_t>( valarraySize ) );
+    // resize() reinitializes every element, even if the size does not change
+    if( valarray.size() != static_cast<std::size_t>( valarraySize ) )
+      valarray.resize( static_cast<std::size_t>( valarraySize ) );
     ar( binary_data( &valarray[0], static_cast<std::size_t>( valarraySize ) * sizeof(T) ) );
   }
 
@@ -80,7 +82,8 @@ namespace cereal
     size_type valarraySize;
     ar( make_size_tag( valarraySize ) );
 
-    valarray.resize( static_cast<size_t>( valarraySize ) );
+    if( valarray.size() != static_cast<std::size_t>( valarraySize ) )
+      valarray.resize( static_cast<std::size_t>( valarraySize ) );
     for(auto && v : valarray)
       ar(v);
   }
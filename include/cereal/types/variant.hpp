@@ -33,6 +33,7 @@
 #include "cereal/cereal.hpp"
 #include <variant>
 #include <cstdint>
+#include <utility>
 
 namespace cereal
 {
@@ -53,26 +54,24 @@ namespace cereal
       Archive & ar;
     };
 
-    //! @internal
-    template<int N, class Variant, class ... Args, class Archive>
-    typename std::enable_if<N == std::variant_size_v<Variant>, void>::type
-    load_variant(Archive & /*ar*/, int /*target*/, Variant & /*variant*/)
+    //! Loads alternative I into the variant, reusing it if it is already active
+    /*! @internal */
+    template <std::size_t I, class Variant, class Archive>
+    void load_alternative( Archive & ar, Variant & variant )
     {
-      throw ::cereal::Exception("Error traversing variant during load");
+      if( variant.index() != I )
+        variant.template emplace<I>();
+      ar( CEREAL_NVP_("data", *std::get_if<I>( &variant )) );
     }
-    //! @internal
-    template<int N, class Variant, class H, class ... T, class Archive>
-    typename std::enable_if<N < std::variant_size_v<Variant>, void>::type
-    load_variant(Archive & ar, int target, Variant & variant)
+
+    //! Dispatches to the loader for the alternative at index through a table
+    /*! @internal */
+    template <class Variant, class Archive, std::size_t ... Is>
+    void load_variant( Archive & ar, std::size_t index, Variant & variant, std::index_sequence<Is...> )
     {
-      if(N == target)
-      {
-        H value;
-        ar( CEREAL_NVP_("data", value) );
-        variant = std::move(value);
-      }
-      else
-        load_variant<N+1, Variant, T...>(ar, target, variant);
+      using LoadFuncType = void(*)( Archive &, Variant & );
+      static constexpr LoadFuncType loadFuncArray[] = { &load_alternative<Is, Variant, Archive>... };
+      loadFuncArray[index]( ar, variant );
     }
 
   } // namespace variant_detail
@@ -81,7 +80,8 @@ namespace cereal
   template <class Archive, typename VariantType1, typename... VariantTypes> inline
   void CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::variant<VariantType1, VariantTypes...> const & variant )
   {
-    std::int32_t index = static_cast<std::int32_t>(variant.index());
+    using index_t = traits::variant_index_type<Archive, 1 + sizeof...(VariantTypes)>;
+    index_t index = static_cast<index_t>(variant.index());
     ar( CEREAL_NVP_("index", index) );
     variant_detail::variant_save_visitor<Archive> visitor(ar);
     std::visit(visitor, variant);
@@ -93,12 +93,15 @@ namespace cereal
   {
     using variant_t = typename std::variant<VariantTypes...>;
 
-    std::int32_t index;
+    traits::variant_index_type<Archive, sizeof...(VariantTypes)> index;
     ar( CEREAL_NVP_("index", index) );
-    if(index >= static_cast<std::int32_t>(std::variant_size_v<variant_t>))
-      throw Exception("Invalid 'index' selector when deserializing std::variant");
+    if(static_cast<std::size_t>(index) >= std::variant_size_v<variant_t>)
+    {
+      ar.setError("Invalid 'index' selector when deserializing std::variant");
+      return;
+    }
 
-    variant_detail::load_variant<0, variant_t, VariantTypes...>(ar, index, variant);
+    variant_detail::load_variant<variant_t>(ar, static_cast<std::size_t>(index), variant, std::index_sequence_for<VariantTypes...>{});
   }
 
   //! Serializing a std::monostate
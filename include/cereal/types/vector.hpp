@@ -31,10 +31,26 @@
 #define CEREAL_TYPES_VECTOR_HPP_
 
 #include "cereal/cereal.hpp"
+#include "cereal/types/concepts/contiguous_container.hpp"
 #include <vector>
 
 namespace cereal
 {
+  namespace vector_detail
+  {
+    //! Loads binary data straight into the storage of a vector
+    /*! The vector is grown a step at a time, see detail::load_binary_in_steps.  Each step
+        is resized before it is read, so unless the vector uses default_init_allocator its
+        new elements are zero filled first, while they are still in cache.
+        @internal */
+    template <class Archive, class T, class A> inline
+    void load_binary( Archive & ar, std::vector<T, A> & vector, std::size_t size )
+    {
+      if( detail::check_load_size( ar, vector, size ) )
+        detail::load_binary_in_steps( ar, vector, size );
+    }
+  } // namespace vector_detail
+
   //! Serialization for std::vectors of arithmetic (but not bool) using binary serialization, if supported
   template <class Archive, class T, class A> inline
   typename std::enable_if<traits::is_output_serializable<BinaryData<T>, Archive>::value
@@ -54,19 +70,18 @@ namespace cereal
     size_type vectorSize;
     ar( make_size_tag( vectorSize ) );
 
-    vector.resize( static_cast<std::size_t>( vectorSize ) );
-    ar( binary_data( vector.data(), static_cast<std::size_t>( vectorSize ) * sizeof(T) ) );
+    vector_detail::load_binary( ar, vector, static_cast<std::size_t>( vectorSize ) );
   }
 
   //! Serialization for non-arithmetic vector types
+  /*! Elements opted into trivially_serializable are saved as a single block by binary archives */
   template <class Archive, class T, class A> inline
   typename std::enable_if<(!traits::is_output_serializable<BinaryData<T>, Archive>::value
                           || !std::is_arithmetic<T>::value) && !std::is_same<T, bool>::value, void>::type
   CEREAL_SAVE_FUNCTION_NAME( Archive & ar, std::vector<T, A> const & vector )
   {
     ar( make_size_tag( static_cast<size_type>(vector.size()) ) ); // number of elements
-    for(auto && v : vector)
-      ar( v );
+    contiguous_detail::save_elements( ar, vector.data(), vector.size() );
   }
 
   //! Serialization for non-arithmetic vector types
@@ -78,9 +93,13 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    vector.resize( static_cast<std::size_t>( size ) );
-    for(auto && v : vector)
-      ar( v );
+    if( !detail::check_load_size( ar, vector, static_cast<std::size_t>( size ) ) )
+      return;
+
+    detail::load_in_steps( ar, vector, static_cast<std::size_t>( size ), [&ar, &vector]( std::size_t first, std::size_t last )
+    {
+      contiguous_detail::load_elements( ar, vector.data() + first, last - first );
+    } );
   }
 
   //! Serialization for bool vector types
@@ -99,13 +118,18 @@ namespace cereal
     size_type size;
     ar( make_size_tag( size ) );
 
-    vector.resize( static_cast<std::size_t>( size ) );
-    for(auto v : vector)
+    if( !detail::check_load_size( ar, vector, static_cast<std::size_t>( size ) ) )
+      return;
+
+    detail::load_in_steps( ar, vector, static_cast<std::size_t>( size ), [&ar, &vector]( std::size_t first, std::size_t last )
     {
-      bool b;
-      ar( b );
-      v = b;
-    }
+      for( std::size_t i = first; i < last; ++i )
+      {
+        bool b;
+        ar( b );
+        vector[i] = b;
+      }
+    } );
   }
 } // namespace cereal
 
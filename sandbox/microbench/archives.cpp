@@ -0,0 +1,579 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+// Measures encoding and decoding with each archive for a set of representative types.
+//
+//   microbench_archives [--filter text] [--repetitions n] [--save file] [--compare file]
+//
+// To evaluate a change, run the baseline build with --save and the changed build
+// with --compare on the saved file.
+
+#include "microbench.hpp"
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/bitstream.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+#include <cereal/archives/binary_size.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/list.hpp>
+#include <cereal/types/memory.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/encoded_cache.hpp>
+#include <cereal/reduced_precision.hpp>
+#include <cereal/compressed_strings.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <streambuf>
+
+//! An output buffer that reuses its storage between operations
+class ReusedOutputBuf : public std::streambuf
+{
+  public:
+    void reset()
+    { setp( itsData.data(), itsData.data() + itsData.size() ); }
+
+    std::size_t size() const
+    { return static_cast<std::size_t>( pptr() - pbase() ); }
+
+    std::string str() const
+    { return std::string( pbase(), pptr() ); }
+
+  protected:
+    int_type overflow( int_type c ) override
+    {
+      auto const used = size();
+      itsData.resize( itsData.empty() ? 4096 : itsData.size() * 2 );
+      setp( itsData.data(), itsData.data() + itsData.size() );
+      pbump( static_cast<int>( used ) );
+
+      if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+      {
+        *pptr() = traits_type::to_char_type( c );
+        pbump( 1 );
+      }
+      return traits_type::not_eof( c );
+    }
+
+    std::streamsize xsputn( char const * s, std::streamsize n ) override
+    {
+      if( epptr() - pptr() < n )
+      {
+        auto const used = size();
+        itsData.resize( std::max( itsData.size() * 2, used + static_cast<std::size_t>( n ) ) );
+        setp( itsData.data(), itsData.data() + itsData.size() );
+        pbump( static_cast<int>( used ) );
+      }
+      std::copy( s, s + n, pptr() );
+      pbump( static_cast<int>( n ) );
+      return n;
+    }
+
+  private:
+    std::vector<char> itsData;
+};
+
+//! An input buffer over existing memory
+class MemoryInputBuf : public std::streambuf
+{
+  public:
+    explicit MemoryInputBuf( std::string const & data ) : itsData( data ) { reset(); }
+
+    void reset()
+    {
+      char * begin = const_cast<char *>( itsData.data() );
+      setg( begin, begin, begin + itsData.size() );
+    }
+
+  private:
+    std::string const & itsData;
+};
+
+struct Record
+{
+  std::uint32_t id;
+  double value;
+  std::string name;
+  std::vector<std::int16_t> samples;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(value), CEREAL_NVP(name), CEREAL_NVP(samples) ); }
+};
+
+template <class OArchive, class IArchive, class T>
+void benchmark( microbench::Runner & runner, std::string const & archiveName, std::string const & typeName, T const & data )
+{
+  std::string const prefix = archiveName + "/" + typeName;
+  if( !runner.selected( prefix ) )
+    return;
+
+  ReusedOutputBuf outBuf;
+  std::ostream os( &outBuf );
+
+  auto const save = [&]()
+  {
+    outBuf.reset();
+    OArchive oar( os );
+    oar( data );
+  };
+
+  // The text archives only finish their output when they are destroyed, which save includes
+  save();
+  std::string const encoded = outBuf.str();
+
+  runner.run( prefix + "/save", encoded.size(), save );
+
+  MemoryInputBuf inBuf( encoded );
+  std::istream is( &inBuf );
+  T result;
+
+  runner.run( prefix + "/load", encoded.size(), [&]()
+  {
+    inBuf.reset();
+    is.clear();
+    IArchive iar( is );
+    iar( result );
+    microbench::doNotOptimize( result );
+  } );
+}
+
+template <class OArchive, class IArchive>
+void benchmarkArchive( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937 gen( 42 );
+
+  std::vector<std::uint8_t> bytes( 1 << 16 );
+  for( auto & b : bytes )
+    b = static_cast<std::uint8_t>( gen() );
+  benchmark<OArchive, IArchive>( runner, archiveName, "vector<uint8>", bytes );
+
+  std::vector<std::int32_t> ints( 1 << 14 );
+  for( auto & i : ints )
+    i = static_cast<std::int32_t>( gen() );
+  benchmark<OArchive, IArchive>( runner, archiveName, "vector<int32>", ints );
+
+  std::vector<double> doubles( 1 << 13 );
+  std::normal_distribution<double> normal;
+  for( auto & d : doubles )
+    d = normal( gen );
+  benchmark<OArchive, IArchive>( runner, archiveName, "vector<double>", doubles );
+
+  std::string text( 1 << 14, ' ' );
+  for( auto & c : text )
+    c = static_cast<char>( 'a' + gen() % 26 );
+  benchmark<OArchive, IArchive>( runner, archiveName, "string", text );
+
+  std::map<std::int32_t, std::string> map;
+  for( int i = 0; i < 1024; ++i )
+    map[static_cast<std::int32_t>( gen() )] = text.substr( gen() % 1000, 16 );
+  benchmark<OArchive, IArchive>( runner, archiveName, "map<int32,string>", map );
+
+  std::vector<Record> records( 512 );
+  for( auto & r : records )
+  {
+    r.id = static_cast<std::uint32_t>( gen() );
+    r.value = normal( gen );
+    r.name = text.substr( gen() % 1000, 12 );
+    r.samples.resize( 8 + gen() % 16 );
+    for( auto & s : r.samples )
+      s = static_cast<std::int16_t>( gen() );
+  }
+  benchmark<OArchive, IArchive>( runner, archiveName, "vector<Record>", records );
+}
+
+//! A message that embeds a large shared configuration
+struct Message
+{
+  std::shared_ptr<std::map<std::int32_t, std::string> const> config;
+  std::vector<std::int32_t> items;
+  cereal::EncodedCache * cache;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    if( cache )
+      ar( cereal::cached_encoding( config, *cache ), items );
+    else
+      ar( config, items );
+  }
+};
+
+//! Compares saving messages that share a configuration with and without an EncodedCache
+template <class OArchive>
+void benchmarkEncodedCache( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937 gen( 42 );
+
+  auto config = std::make_shared<std::map<std::int32_t, std::string>>();
+  for( int i = 0; i < 1024; ++i )
+    (*config)[static_cast<std::int32_t>( gen() )] = std::string( 16, static_cast<char>( 'a' + i % 26 ) );
+
+  cereal::EncodedCache cache;
+  Message message{ config, std::vector<std::int32_t>( 64, 7 ), nullptr };
+
+  ReusedOutputBuf outBuf;
+  std::ostream os( &outBuf );
+  auto const save = [&]()
+  {
+    outBuf.reset();
+    OArchive oar( os );
+    oar( message );
+  };
+
+  save();
+  runner.run( archiveName + "/message<config>/save", outBuf.size(), save );
+
+  message.cache = &cache;
+  save();
+  runner.run( archiveName + "/message<cached config>/save", outBuf.size(), save );
+}
+
+//! Measures only saving some data
+template <class OArchive, class T>
+void benchmarkSave( microbench::Runner & runner, std::string const & name, T const & data )
+{
+  ReusedOutputBuf outBuf;
+  std::ostream os( &outBuf );
+  auto const save = [&]()
+  {
+    outBuf.reset();
+    OArchive oar( os );
+    oar( data );
+  };
+
+  save();
+  runner.run( name, outBuf.size(), save );
+}
+
+//! A small object that is saved through a pointer
+struct Point
+{
+  std::int64_t x, y;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(x), CEREAL_NVP(y) ); }
+};
+
+//! Measures saving large containers whose elements are scattered over the heap
+/*! Saving these is bound by the latency of following pointers, part of which
+    CEREAL_PREFETCH_DISTANCE hides. */
+template <class OArchive>
+void benchmarkScattered( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937_64 gen( 42 );
+  std::size_t const size = 1 << 20;
+  std::string name;
+
+  // strings too long for the small string optimization, in random heap order
+  auto const makeStrings = [&]()
+  {
+    std::vector<std::string> strings( size );
+    for( auto & s : strings )
+    {
+      s.resize( 32 );
+      for( auto & c : s )
+        c = static_cast<char>( 'a' + gen() % 26 );
+    }
+    std::shuffle( strings.begin(), strings.end(), gen );
+    return strings;
+  };
+
+  name = archiveName + "/scattered vector<string>/save";
+  if( runner.selected( name ) )
+    benchmarkSave<OArchive>( runner, name, makeStrings() );
+
+  // sorting relinks the nodes in random order
+  name = archiveName + "/scattered list<string>/save";
+  if( runner.selected( name ) )
+  {
+    auto strings = makeStrings();
+    std::list<std::string> list;
+    for( auto & s : strings )
+      list.emplace_back( std::move( s ) );
+    list.sort();
+    benchmarkSave<OArchive>( runner, name, list );
+  }
+
+  // nodes are allocated in insertion order but visited in key order
+  name = archiveName + "/scattered map<uint64,string>/save";
+  if( runner.selected( name ) )
+  {
+    auto strings = makeStrings();
+    std::map<std::uint64_t, std::string> map;
+    for( auto & s : strings )
+      map.emplace( gen(), std::move( s ) );
+    benchmarkSave<OArchive>( runner, name, map );
+  }
+
+  name = archiveName + "/scattered map<uint64,uint64>/save";
+  if( runner.selected( name ) )
+  {
+    std::map<std::uint64_t, std::uint64_t> map;
+    for( std::size_t i = 0; i < size; ++i )
+      map.emplace( gen(), i );
+    benchmarkSave<OArchive>( runner, name, map );
+  }
+
+  name = archiveName + "/scattered vector<unique_ptr<Point>>/save";
+  if( runner.selected( name ) )
+  {
+    std::vector<std::unique_ptr<Point>> vector( size );
+    for( auto & p : vector )
+      p.reset( new Point{ static_cast<std::int64_t>( gen() ), static_cast<std::int64_t>( gen() ) } );
+    std::shuffle( vector.begin(), vector.end(), gen );
+    benchmarkSave<OArchive>( runner, name, vector );
+  }
+
+  name = archiveName + "/scattered vector<shared_ptr<Point>>/save";
+  if( runner.selected( name ) )
+  {
+    std::vector<std::shared_ptr<Point>> vector( size );
+    for( auto & p : vector )
+      p = std::make_shared<Point>( Point{ static_cast<std::int64_t>( gen() ), static_cast<std::int64_t>( gen() ) } );
+    std::shuffle( vector.begin(), vector.end(), gen );
+    benchmarkSave<OArchive>( runner, name, vector );
+  }
+}
+
+//! Precisions that samples can be saved with
+enum class Precision { Full, Half, BFloat16, FixedPoint };
+
+//! Telemetry samples saved with some precision
+template <Precision P>
+struct Samples
+{
+  std::vector<float> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    switch( P )
+    {
+      case Precision::Full: ar( values ); break;
+      case Precision::Half: ar( cereal::half_precision( values ) ); break;
+      case Precision::BFloat16: ar( cereal::bfloat16_precision( values ) ); break;
+      case Precision::FixedPoint: ar( cereal::quantized<std::int16_t>( values, 1e-3 ) ); break;
+    }
+  }
+};
+
+//! Compares saving float samples at full and reduced precision
+template <class OArchive, class IArchive>
+void benchmarkReducedPrecision( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937 gen( 42 );
+  std::normal_distribution<float> normal;
+
+  std::vector<float> values( 1 << 14 );
+  for( auto & v : values )
+    v = normal( gen );
+
+  benchmark<OArchive, IArchive>( runner, archiveName, "samples<float>", Samples<Precision::Full>{ values } );
+  benchmark<OArchive, IArchive>( runner, archiveName, "samples<half>", Samples<Precision::Half>{ values } );
+  benchmark<OArchive, IArchive>( runner, archiveName, "samples<bfloat16>", Samples<Precision::BFloat16>{ values } );
+  benchmark<OArchive, IArchive>( runner, archiveName, "samples<int16>", Samples<Precision::FixedPoint>{ values } );
+}
+
+//! An input archive that trusts its data, which stored hashes require to be used
+template <class IArchive>
+struct TrustedInputArchive : IArchive
+{
+  TrustedInputArchive( std::istream & is ) : IArchive( is ) { this->setTrustedSource( true ); }
+};
+
+//! Compares loading unordered maps with long string keys with and without stored hashes
+template <class OArchive, class IArchive>
+void benchmarkPersistedHash( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937 gen( 42 );
+  std::uniform_int_distribution<int> letter( 'a', 'z' );
+
+  std::unordered_map<std::string, std::uint32_t> map;
+  for( std::uint32_t i = 0; i < ( 1 << 14 ); ++i )
+  {
+    std::string key( 1024, ' ' );
+    for( auto & c : key )
+      c = static_cast<char>( letter( gen ) );
+    map.emplace( std::move( key ), i );
+  }
+
+  std::unordered_map<std::string, std::uint32_t, cereal::PersistedHash<std::hash<std::string>>> persisted( map.begin(), map.end() );
+
+  benchmark<OArchive, IArchive>( runner, archiveName, "unordered_map<string,uint32>", map );
+  benchmark<OArchive, TrustedInputArchive<IArchive>>( runner, archiveName, "unordered_map<string,uint32,PersistedHash>", persisted );
+}
+
+//! Compares measuring the size of some data with serialized_size to saving it
+template <class T>
+void benchmarkMeasure( microbench::Runner & runner, std::string const & typeName, T const & data )
+{
+  std::string const prefix = "binary/" + typeName;
+  if( !runner.selected( prefix ) )
+    return;
+
+  std::uint64_t const size = cereal::serialized_size( data );
+  benchmarkSave<cereal::BinaryOutputArchive>( runner, prefix + "/save", data );
+  runner.run( prefix + "/measure", static_cast<std::size_t>( size ), [&]()
+  {
+    microbench::doNotOptimize( cereal::serialized_size( data ) );
+  } );
+}
+
+void benchmarkSerializedSize( microbench::Runner & runner )
+{
+  std::mt19937 gen( 42 );
+  std::string const text( 1 << 10, 'x' );
+
+  std::map<std::int32_t, std::string> map;
+  for( int i = 0; i < 1024; ++i )
+    map[static_cast<std::int32_t>( gen() )] = text.substr( gen() % 1000, 16 );
+  benchmarkMeasure( runner, "map<int32,string>", map );
+
+  std::vector<Record> records( 512 );
+  for( auto & r : records )
+  {
+    r.id = static_cast<std::uint32_t>( gen() );
+    r.name = text.substr( gen() % 1000, 12 );
+    r.samples.resize( 8 + gen() % 16 );
+  }
+  benchmarkMeasure( runner, "vector<Record>", records );
+
+  std::vector<std::shared_ptr<Point>> points;
+  for( int i = 0; i < 4096; ++i )
+    points.push_back( std::make_shared<Point>( Point{ i, -i } ) );
+  benchmarkMeasure( runner, "vector<shared_ptr<Point>>", points );
+}
+
+//! Urls saved raw or compressed with a trained symbol table
+template <bool Compressed>
+struct Urls
+{
+  std::vector<std::string> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    if( Compressed )
+      ar( cereal::compressed_strings( values ) );
+    else
+      ar( values );
+  }
+};
+
+//! Compares saving short strings raw and compressed
+template <class OArchive, class IArchive>
+void benchmarkCompressedStrings( microbench::Runner & runner, std::string const & archiveName )
+{
+  std::mt19937 gen( 42 );
+  char const * const hosts[] = { "www.example.com", "cdn.example.org", "api.example.net", "static.example.com" };
+  char const * const paths[] = { "/products/", "/search?q=", "/users/", "/images/thumbnails/", "/api/v2/items/" };
+
+  std::vector<std::string> urls( 1 << 14 );
+  for( auto & url : urls )
+    url = std::string( "https://" ) + hosts[gen() % 4] + paths[gen() % 5] + std::to_string( gen() % 100000 );
+
+  benchmark<OArchive, IArchive>( runner, archiveName, "urls", Urls<false>{ urls } );
+  benchmark<OArchive, IArchive>( runner, archiveName, "urls<compressed>", Urls<true>{ urls } );
+}
+
+int main( int argc, char * argv[] )
+{
+  microbench::Options options;
+  std::string saveFile, compareFile;
+
+  for( int i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    bool const hasValue = i + 1 < argc;
+
+    if( arg == "--filter" && hasValue )
+      options.filter = argv[++i];
+    else if( arg == "--repetitions" && hasValue )
+      options.repetitions = static_cast<std::size_t>( std::strtoul( argv[++i], nullptr, 10 ) );
+    else if( arg == "--save" && hasValue )
+      saveFile = argv[++i];
+    else if( arg == "--compare" && hasValue )
+      compareFile = argv[++i];
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--filter text] [--repetitions n] [--save file] [--compare file]\n";
+      return 1;
+    }
+  }
+
+  microbench::Runner runner( options );
+
+  benchmarkArchive<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( runner, "binary" );
+  benchmarkArchive<cereal::PortableBinaryOutputArchive, cereal::PortableBinaryInputArchive>( runner, "portable_binary" );
+  benchmarkArchive<cereal::BitstreamOutputArchive, cereal::BitstreamInputArchive>( runner, "bitstream" );
+  benchmarkArchive<cereal::JSONOutputArchive, cereal::JSONInputArchive>( runner, "json" );
+  benchmarkArchive<cereal::XMLOutputArchive, cereal::XMLInputArchive>( runner, "xml" );
+
+  benchmarkEncodedCache<cereal::BinaryOutputArchive>( runner, "binary" );
+  benchmarkEncodedCache<cereal::PortableBinaryOutputArchive>( runner, "portable_binary" );
+
+  benchmarkReducedPrecision<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( runner, "binary" );
+
+  benchmarkScattered<cereal::BinaryOutputArchive>( runner, "binary" );
+
+  benchmarkPersistedHash<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( runner, "binary" );
+
+  benchmarkSerializedSize( runner );
+
+  benchmarkCompressedStrings<cereal::BinaryOutputArchive, cereal::BinaryInputArchive>( runner, "binary" );
+
+  runner.report( std::cout );
+
+  if( !saveFile.empty() )
+  {
+    std::ofstream out( saveFile );
+    microbench::writeResults( out, runner.results() );
+  }
+
+  if( !compareFile.empty() )
+  {
+    std::ifstream in( compareFile );
+    if( !in )
+    {
+      std::cerr << "could not open " << compareFile << "\n";
+      return 1;
+    }
+
+    std::cout << "\n";
+    microbench::compare( std::cout, microbench::readResults( in ), runner.results() );
+  }
+
+  return 0;
+}
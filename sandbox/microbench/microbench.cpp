@@ -0,0 +1,403 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "microbench.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#define MICROBENCH_HAS_PERF 1
+#else
+#define MICROBENCH_HAS_PERF 0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define MICROBENCH_HAS_TSC 1
+#else
+#define MICROBENCH_HAS_TSC 0
+#endif
+
+namespace microbench
+{
+  namespace
+  {
+    #if MICROBENCH_HAS_PERF
+    //! Opens a hardware counter for the calling thread, as part of group (or as its leader if group is -1)
+    int openCounter( std::uint64_t config, int group )
+    {
+      perf_event_attr attr;
+      std::memset( &attr, 0, sizeof(attr) );
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config;
+      attr.disabled = group == -1 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+
+      return static_cast<int>( syscall( __NR_perf_event_open, &attr, 0, -1, group, 0 ) );
+    }
+    #endif // MICROBENCH_HAS_PERF
+
+    std::uint64_t readTimestampCounter()
+    {
+      #if MICROBENCH_HAS_TSC
+      return __rdtsc();
+      #else
+      return 0;
+      #endif
+    }
+
+    //! Scales per-operation statistics by a divisor, e.g. to get values per byte
+    Statistics perByte( Statistics s, std::size_t bytes )
+    {
+      double const b = bytes ? static_cast<double>( bytes ) : 1.0;
+      s.median /= b; s.mad /= b; s.min /= b; s.max /= b;
+      return s;
+    }
+  } // anonymous namespace
+
+  // ######################################################################
+  PerfCounters::PerfCounters() : itsGroup( -1 ), itsFds{ -1, -1, -1, -1 }, itsAvailable( false ), itsTimestamp( 0 )
+  {
+    #if MICROBENCH_HAS_PERF
+    std::uint64_t const configs[4] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                       PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+    itsGroup = openCounter( configs[0], -1 );
+    if( itsGroup < 0 )
+      return;
+
+    itsFds[0] = itsGroup;
+    for( int i = 1; i < 4; ++i )
+    {
+      itsFds[i] = openCounter( configs[i], itsGroup );
+      if( itsFds[i] < 0 )
+        return;
+    }
+
+    itsAvailable = true;
+    #endif // MICROBENCH_HAS_PERF
+  }
+
+  PerfCounters::~PerfCounters()
+  {
+    #if MICROBENCH_HAS_PERF
+    for( int fd : itsFds )
+      if( fd >= 0 )
+        close( fd );
+    #endif
+  }
+
+  bool PerfCounters::usesTimestampCounter() const
+  {
+    return !itsAvailable && MICROBENCH_HAS_TSC;
+  }
+
+  void PerfCounters::start()
+  {
+    #if MICROBENCH_HAS_PERF
+    if( itsAvailable )
+    {
+      ioctl( itsGroup, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+      ioctl( itsGroup, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+      return;
+    }
+    #endif
+
+    itsTimestamp = readTimestampCounter();
+  }
+
+  Counters PerfCounters::stop()
+  {
+    Counters counters;
+
+    #if MICROBENCH_HAS_PERF
+    if( itsAvailable )
+    {
+      ioctl( itsGroup, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP );
+
+      // With PERF_FORMAT_GROUP, a read returns the number of counters followed by their values
+      std::uint64_t values[5] = {};
+      if( read( itsGroup, values, sizeof(values) ) == static_cast<ssize_t>( sizeof(values) ) && values[0] == 4 )
+      {
+        counters.cycles = static_cast<double>( values[1] );
+        counters.instructions = static_cast<double>( values[2] );
+        counters.cacheMisses = static_cast<double>( values[3] );
+        counters.branchMisses = static_cast<double>( values[4] );
+      }
+      return counters;
+    }
+    #endif
+
+    counters.cycles = static_cast<double>( readTimestampCounter() - itsTimestamp );
+    return counters;
+  }
+
+  // ######################################################################
+  Statistics Statistics::of( std::vector<double> & samples )
+  {
+    Statistics s;
+    if( samples.empty() )
+      return s;
+
+    auto median = []( std::vector<double> & v )
+    {
+      std::sort( v.begin(), v.end() );
+      auto const n = v.size();
+      return n % 2 ? v[n / 2] : ( v[n / 2 - 1] + v[n / 2] ) / 2;
+    };
+
+    s.median = median( samples );
+    s.min = samples.front();
+    s.max = samples.back();
+
+    std::vector<double> deviations;
+    deviations.reserve( samples.size() );
+    for( double x : samples )
+      deviations.push_back( std::abs( x - s.median ) );
+    s.mad = median( deviations );
+
+    return s;
+  }
+
+  // ######################################################################
+  Runner::Runner( Options options ) : itsOptions( std::move( options ) ), itsCounters( new PerfCounters() )
+  { }
+
+  bool Runner::selected( std::string const & name ) const
+  {
+    return itsOptions.filter.empty() || name.find( itsOptions.filter ) != std::string::npos;
+  }
+
+  void Runner::measure( std::string const & name, std::size_t bytes, std::function<void(std::size_t)> const & batch )
+  {
+    using clock = std::chrono::steady_clock;
+
+    // Calibrate the number of iterations so that a batch lasts at least batchTime
+    std::size_t iterations = 1;
+    for( ;; )
+    {
+      auto const start = clock::now();
+      batch( iterations );
+      auto const elapsed = clock::now() - start;
+      if( elapsed >= itsOptions.batchTime || iterations >= ( std::size_t( 1 ) << 30 ) )
+        break;
+      iterations *= 2;
+    }
+
+    for( std::size_t i = 0; i < itsOptions.warmup; ++i )
+      batch( iterations );
+
+    std::vector<double> ns, cycles, instructions, cacheMisses, branchMisses;
+    double const n = static_cast<double>( iterations );
+
+    for( std::size_t i = 0; i < itsOptions.repetitions; ++i )
+    {
+      auto const start = clock::now();
+      itsCounters->start();
+      batch( iterations );
+      Counters const c = itsCounters->stop();
+      auto const elapsed = std::chrono::duration<double, std::nano>( clock::now() - start ).count();
+
+      ns.push_back( elapsed / n );
+      cycles.push_back( c.cycles / n );
+      instructions.push_back( c.instructions / n );
+      cacheMisses.push_back( c.cacheMisses / n );
+      branchMisses.push_back( c.branchMisses / n );
+    }
+
+    Result result;
+    result.name = name;
+    result.bytes = bytes;
+    result.hasCounters = itsCounters->available();
+    result.nanoseconds = Statistics::of( ns );
+    result.cycles = Statistics::of( cycles );
+    result.instructions = Statistics::of( instructions );
+    result.cacheMisses = Statistics::of( cacheMisses );
+    result.branchMisses = Statistics::of( branchMisses );
+
+    itsResults.push_back( result );
+  }
+
+  void Runner::report( std::ostream & os ) const
+  {
+    if( itsCounters->available() )
+      os << "# hardware counters: cycles, instructions, cache misses, branch misses\n";
+    else if( itsCounters->usesTimestampCounter() )
+      os << "# hardware counters unavailable, cycles are time stamp counter ticks\n";
+    else
+      os << "# hardware counters unavailable, reporting time only\n";
+
+    os << std::left << std::setw( 44 ) << "benchmark" << std::right
+       << std::setw( 10 ) << "bytes"
+       << std::setw( 12 ) << "ns/op"
+       << std::setw( 8 ) << "+/-%"
+       << std::setw( 10 ) << "MB/s"
+       << std::setw( 10 ) << "cyc/B"
+       << std::setw( 10 ) << "ins/B"
+       << std::setw( 12 ) << "cmiss/op"
+       << std::setw( 12 ) << "bmiss/op" << "\n";
+
+    for( auto const & r : itsResults )
+    {
+      auto const relative = r.nanoseconds.median > 0 ? 100.0 * r.nanoseconds.mad / r.nanoseconds.median : 0.0;
+      auto const mbps = r.nanoseconds.median > 0 ? 1e3 * static_cast<double>( r.bytes ) / r.nanoseconds.median : 0.0;
+
+      os << std::left << std::setw( 44 ) << r.name << std::right << std::fixed
+         << std::setw( 10 ) << r.bytes
+         << std::setw( 12 ) << std::setprecision( 1 ) << r.nanoseconds.median
+         << std::setw( 8 ) << std::setprecision( 1 ) << relative
+         << std::setw( 10 ) << std::setprecision( 1 ) << mbps;
+
+      if( r.hasCounters || itsCounters->usesTimestampCounter() )
+        os << std::setw( 10 ) << std::setprecision( 3 ) << perByte( r.cycles, r.bytes ).median;
+      else
+        os << std::setw( 10 ) << "n/a";
+
+      if( r.hasCounters )
+        os << std::setw( 10 ) << std::setprecision( 3 ) << perByte( r.instructions, r.bytes ).median
+           << std::setw( 12 ) << std::setprecision( 2 ) << r.cacheMisses.median
+           << std::setw( 12 ) << std::setprecision( 2 ) << r.branchMisses.median;
+      else
+        os << std::setw( 10 ) << "n/a" << std::setw( 12 ) << "n/a" << std::setw( 12 ) << "n/a";
+
+      os << "\n";
+    }
+
+    os.unsetf( std::ios::floatfield );
+  }
+
+  // ######################################################################
+  void writeResults( std::ostream & os, std::vector<Result> const & results )
+  {
+    auto const write = [&]( Statistics const & s )
+    { os << '\t' << s.median << '\t' << s.mad << '\t' << s.min << '\t' << s.max; };
+
+    os << std::setprecision( 17 );
+    for( auto const & r : results )
+    {
+      os << r.name << '\t' << r.bytes << '\t' << r.hasCounters;
+      write( r.nanoseconds );
+      write( r.cycles );
+      write( r.instructions );
+      write( r.cacheMisses );
+      write( r.branchMisses );
+      os << '\n';
+    }
+  }
+
+  std::vector<Result> readResults( std::istream & is )
+  {
+    std::vector<Result> results;
+    std::string line;
+
+    while( std::getline( is, line ) )
+    {
+      auto const tab = line.find( '\t' );
+      if( line.empty() || line[0] == '#' || tab == std::string::npos )
+        continue;
+
+      Result r;
+      r.name = line.substr( 0, tab );
+
+      std::istringstream fields( line.substr( tab + 1 ) );
+      auto const read = [&]( Statistics & s )
+      { fields >> s.median >> s.mad >> s.min >> s.max; };
+
+      fields >> r.bytes >> r.hasCounters;
+      read( r.nanoseconds );
+      read( r.cycles );
+      read( r.instructions );
+      read( r.cacheMisses );
+      read( r.branchMisses );
+
+      if( fields )
+        results.push_back( r );
+    }
+
+    return results;
+  }
+
+  void compare( std::ostream & os, std::vector<Result> const & baseline, std::vector<Result> const & current )
+  {
+    std::map<std::string, Result const *> base;
+    for( auto const & r : baseline )
+      base[r.name] = &r;
+
+    os << std::left << std::setw( 44 ) << "benchmark" << std::right
+       << std::setw( 12 ) << "base ns/op"
+       << std::setw( 12 ) << "new ns/op"
+       << std::setw( 10 ) << "change"
+       << std::setw( 12 ) << "base cyc/B"
+       << std::setw( 12 ) << "new cyc/B"
+       << std::setw( 12 ) << "ins/B delta" << "\n";
+
+    for( auto const & r : current )
+    {
+      auto const iter = base.find( r.name );
+      if( iter == base.end() )
+        continue;
+
+      Result const & b = *iter->second;
+      auto const change = b.nanoseconds.median > 0 ? 100.0 * ( r.nanoseconds.median - b.nanoseconds.median ) / b.nanoseconds.median : 0.0;
+      bool const significant = std::abs( r.nanoseconds.median - b.nanoseconds.median ) > 3.0 * ( r.nanoseconds.mad + b.nanoseconds.mad );
+
+      os << std::left << std::setw( 44 ) << r.name << std::right << std::fixed
+         << std::setw( 12 ) << std::setprecision( 1 ) << b.nanoseconds.median
+         << std::setw( 12 ) << std::setprecision( 1 ) << r.nanoseconds.median
+         << std::setw( 9 ) << std::showpos << std::setprecision( 1 ) << change << "%" << std::noshowpos
+         << std::setw( 12 ) << std::setprecision( 3 ) << perByte( b.cycles, b.bytes ).median
+         << std::setw( 12 ) << std::setprecision( 3 ) << perByte( r.cycles, r.bytes ).median;
+
+      if( r.hasCounters && b.hasCounters )
+        os << std::setw( 12 ) << std::showpos << std::setprecision( 3 )
+           << perByte( r.instructions, r.bytes ).median - perByte( b.instructions, b.bytes ).median << std::noshowpos;
+      else
+        os << std::setw( 12 ) << "n/a";
+
+      os << ( significant ? "  *" : "" ) << "\n";
+    }
+
+    os.unsetf( std::ios::floatfield );
+    os << "# * the change exceeds three times the combined median absolute deviation\n";
+  }
+} // namespace microbench
@@ -0,0 +1,190 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_SANDBOX_MICROBENCH_HPP_
+#define CEREAL_SANDBOX_MICROBENCH_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! A micro-benchmark harness that reports costs per byte from hardware counters
+/*! Each benchmark is calibrated to run in batches long enough for the clock and
+    counters to be accurate, warmed up, and then repeated.  Results are summarized
+    by their median and median absolute deviation, which are robust against the
+    occasional repetition disturbed by an interrupt or a migration.
+
+    Cycles, instructions, cache misses and branch misses are read with perf_event_open
+    on Linux.  When the counters are unavailable (other platforms, containers, or
+    kernel.perf_event_paranoid forbids them), only time is measured, and cycles fall
+    back to the time stamp counter where there is one.
+
+    Results can be written to a file and compared against a later run, which is used
+    to evaluate a change (A/B): run the baseline build with --save, then the changed
+    build with --compare. */
+namespace microbench
+{
+  //! Counter values accumulated over a measured region
+  struct Counters
+  {
+    double cycles = 0;
+    double instructions = 0;
+    double cacheMisses = 0;
+    double branchMisses = 0;
+  };
+
+  //! Reads hardware counters for the calling thread
+  class PerfCounters
+  {
+    public:
+      PerfCounters();
+      ~PerfCounters();
+
+      PerfCounters( PerfCounters const & ) = delete;
+      PerfCounters & operator=( PerfCounters const & ) = delete;
+
+      //! Whether cycles and instructions come from hardware counters
+      bool available() const { return itsAvailable; }
+
+      //! Whether cycles come from the time stamp counter because hardware counters are unavailable
+      bool usesTimestampCounter() const;
+
+      //! Starts counting
+      void start();
+
+      //! Stops counting and returns the counts since start
+      Counters stop();
+
+    private:
+      int itsGroup;
+      int itsFds[4];
+      bool itsAvailable;
+      std::uint64_t itsTimestamp;
+  };
+
+  //! Robust summary statistics of a set of samples
+  struct Statistics
+  {
+    double median = 0;
+    double mad = 0;    //!< Median absolute deviation from the median
+    double min = 0;
+    double max = 0;
+
+    //! Summarizes samples, which are reordered in the process
+    static Statistics of( std::vector<double> & samples );
+  };
+
+  //! The result of one benchmark, all values per operation
+  struct Result
+  {
+    std::string name;
+    std::size_t bytes = 0;         //!< Bytes processed per operation
+    bool hasCounters = false;      //!< Whether the counter statistics are valid
+    Statistics nanoseconds;
+    Statistics cycles;
+    Statistics instructions;
+    Statistics cacheMisses;
+    Statistics branchMisses;
+  };
+
+  //! Controls how benchmarks are measured
+  struct Options
+  {
+    std::size_t warmup = 3;        //!< Batches run before measuring
+    std::size_t repetitions = 15;  //!< Measured batches
+    std::chrono::nanoseconds batchTime = std::chrono::milliseconds( 5 ); //!< Minimum duration of a batch
+    std::string filter;            //!< Only run benchmarks whose name contains this
+  };
+
+  //! Runs benchmarks and collects their results
+  class Runner
+  {
+    public:
+      explicit Runner( Options options = Options() );
+
+      //! Whether a benchmark with the given name passes the filter
+      bool selected( std::string const & name ) const;
+
+      //! Measures op, which processes bytes bytes each time it is called
+      /*! The operation is called in a loop, so it should not be trivially optimized
+          away.  Nothing is measured if the name does not pass the filter. */
+      template <class F>
+      void run( std::string const & name, std::size_t bytes, F && op )
+      {
+        if( !selected( name ) )
+          return;
+
+        measure( name, bytes, [&op]( std::size_t iterations )
+        {
+          for( std::size_t i = 0; i < iterations; ++i )
+            op();
+        } );
+      }
+
+      //! The results collected so far
+      std::vector<Result> const & results() const { return itsResults; }
+
+      //! Prints the results as a table
+      void report( std::ostream & os ) const;
+
+    private:
+      void measure( std::string const & name, std::size_t bytes, std::function<void(std::size_t)> const & batch );
+
+      Options itsOptions;
+      std::unique_ptr<PerfCounters> itsCounters;
+      std::vector<Result> itsResults;
+  };
+
+  //! Writes results in a tab separated format that readResults understands
+  void writeResults( std::ostream & os, std::vector<Result> const & results );
+
+  //! Reads results written by writeResults
+  std::vector<Result> readResults( std::istream & is );
+
+  //! Prints the change from the baseline to the current results for benchmarks present in both
+  /*! A change is flagged as significant when the medians differ by more than three times
+      their combined median absolute deviation. */
+  void compare( std::ostream & os, std::vector<Result> const & baseline, std::vector<Result> const & current );
+
+  //! Prevents the compiler from optimizing away the computation of value
+  template <class T> inline
+  void doNotOptimize( T const & value )
+  {
+    #if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__( "" : : "g"( &value ) : "memory" );
+    #else
+    static volatile char const * sink;
+    sink = reinterpret_cast<char const volatile *>( &value );
+    #endif
+  }
+} // namespace microbench
+
+#endif // CEREAL_SANDBOX_MICROBENCH_HPP_
@@ -0,0 +1,100 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Compares how quickly truncated binary input is rejected when errors throw
+// and when they are recorded in the sticky error state of the archive.
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+struct Packet
+{
+  std::vector<std::uint32_t> header;
+  std::string payload;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( header, payload ); }
+};
+
+template <class F>
+double timeIt( F && f, int iterations )
+{
+  auto const start = std::chrono::high_resolution_clock::now();
+  for( int i = 0; i < iterations; ++i )
+    f();
+  auto const end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::nano>( end - start ).count() / iterations;
+}
+
+int main()
+{
+  Packet p;
+  p.header.assign( 16, 7 );
+  p.payload.assign( 256, 'c' );
+
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar( os );
+    oar( p );
+  }
+
+  // Cut the packet in the middle of its payload
+  std::string const truncated = os.str().substr( 0, os.str().size() / 2 );
+  int const iterations = 100000;
+  std::size_t rejected = 0;
+
+  double const throwing = timeIt( [&]()
+  {
+    std::istringstream is( truncated );
+    cereal::BinaryInputArchive iar( is );
+    Packet q;
+    try { iar( q ); }
+    catch( cereal::Exception const & ) { ++rejected; }
+  }, iterations );
+
+  double const sticky = timeIt( [&]()
+  {
+    std::istringstream is( truncated );
+    cereal::BinaryInputArchive iar( is );
+    iar.setThrowOnError( false );
+    Packet q;
+    iar( q );
+    if( !iar.ok() )
+      ++rejected;
+  }, iterations );
+
+  std::cout << "rejected " << rejected << " of " << 2 * iterations << " truncated packets" << std::endl;
+  std::cout << "throw on error: " << throwing << " ns per packet" << std::endl;
+  std::cout << "sticky error:   " << sticky << " ns per packet" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,183 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Compares loading a chunked snapshot on one thread against loading it with
+// cereal::load_chunked, which loads each chunk on the NUMA node of the thread
+// that will use it.  For both, reports how many pages of each chunk ended up
+// on the node of its owner thread and how long the owners take to scan them.
+//
+// usage: sandbox_numa_load [megabytes of state] [chunks]
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/chunked.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+struct Shard
+{
+  std::vector<std::uint64_t> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( values );
+  }
+};
+
+using Clock = std::chrono::steady_clock;
+
+double milliseconds( Clock::duration d )
+{
+  return std::chrono::duration<double, std::milli>( d ).count();
+}
+
+//! The kernel's id of the node the calling thread runs on, or -1 if unknown
+long currentKernelNode()
+{
+  #if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0, node = 0;
+  if( syscall( SYS_getcpu, &cpu, &node, nullptr ) == 0 )
+    return static_cast<long>( node );
+  #endif
+  return -1;
+}
+
+//! Counts the pages of a shard that are on the given kernel node
+std::size_t localPages( Shard const & shard, long node, std::size_t & pages )
+{
+  std::size_t const pageSize = 4096;
+  auto const begin = reinterpret_cast<std::uintptr_t>( shard.values.data() ) / pageSize * pageSize;
+  auto const end = reinterpret_cast<std::uintptr_t>( shard.values.data() + shard.values.size() );
+
+  std::vector<void *> addresses;
+  for( auto page = begin; page < end; page += pageSize )
+    addresses.push_back( reinterpret_cast<void *>( page ) );
+  pages += addresses.size();
+
+  #if defined(__linux__) && defined(SYS_move_pages)
+  std::vector<int> status( addresses.size(), -1 );
+  if( syscall( SYS_move_pages, 0, addresses.size(), addresses.data(), nullptr, status.data(), 0 ) == 0 )
+    return static_cast<std::size_t>( std::count( status.begin(), status.end(), static_cast<int>( node ) ) );
+  #endif
+  static_cast<void>( node );
+  return addresses.size();
+}
+
+//! Has one thread per node, pinned to it, scan the chunks it owns
+void scan( std::vector<Shard> const & shards, cereal::NumaTopology const & topology, char const * name )
+{
+  std::size_t const nodes = topology.nodes();
+  std::vector<std::size_t> local( nodes ), pages( nodes );
+  std::vector<std::uint64_t> sums( nodes );
+
+  auto const start = Clock::now();
+  std::vector<std::thread> owners;
+  for( std::size_t node = 0; node < nodes; ++node )
+    owners.emplace_back( [&, node]()
+    {
+      cereal::chunked_detail::pin_to_cpus( topology.cpus( node ) );
+      long const kernelNode = currentKernelNode();
+
+      for( int pass = 0; pass < 10; ++pass )
+        for( std::size_t i = node; i < shards.size(); i += nodes )
+          for( auto v : shards[i].values )
+            sums[node] += v;
+
+      for( std::size_t i = node; i < shards.size(); i += nodes )
+        local[node] += localPages( shards[i], kernelNode, pages[node] );
+    } );
+  for( auto & owner : owners )
+    owner.join();
+  auto const elapsed = Clock::now() - start;
+
+  std::size_t totalLocal = 0, totalPages = 0;
+  for( std::size_t node = 0; node < nodes; ++node )
+  {
+    totalLocal += local[node];
+    totalPages += pages[node];
+  }
+
+  std::cout << name << ": " << 100.0 * static_cast<double>( totalLocal ) / static_cast<double>( (std::max)( totalPages, std::size_t( 1 ) ) )
+            << "% of pages local to their owner, owners scanned in " << milliseconds( elapsed ) << " ms" << std::endl;
+}
+
+int main( int argc, char ** argv )
+{
+  std::size_t const megabytes = argc > 1 ? static_cast<std::size_t>( std::atoi( argv[1] ) ) : 512;
+  std::size_t const chunks = argc > 2 ? static_cast<std::size_t>( std::atoi( argv[2] ) ) : 64;
+
+  auto const & topology = cereal::NumaTopology::system();
+  std::cout << "NUMA nodes: " << topology.nodes() << ", state size: ~" << megabytes << " MiB in " << chunks << " chunks" << std::endl;
+  if( topology.nodes() == 1 )
+    std::cout << "(single node: chunks are loaded in parallel without pinning, and every page is local)" << std::endl;
+
+  std::string data;
+  {
+    std::vector<Shard> shards( chunks );
+    for( std::size_t i = 0; i < chunks; ++i )
+    {
+      shards[i].values.resize( megabytes * (1 << 20) / chunks / sizeof(std::uint64_t) );
+      for( std::size_t j = 0; j < shards[i].values.size(); ++j )
+        shards[i].values[j] = i * j;
+    }
+
+    std::ostringstream os;
+    cereal::save_chunked<cereal::BinaryOutputArchive>( os, shards );
+    data = os.str();
+  }
+
+  // chunk i is used by the owner thread of node i % nodes
+  {
+    std::vector<Shard> shards;
+    auto const start = Clock::now();
+    cereal::load_chunked<cereal::BinaryInputArchive>( data.data(), data.size(), shards,
+      cereal::ChunkedLoadOptions().topology( cereal::NumaTopology() ).threadsPerNode( 1 ) );
+    std::cout << "single thread load:  " << milliseconds( Clock::now() - start ) << " ms" << std::endl;
+    scan( shards, topology, "single thread load" );
+  }
+
+  {
+    std::vector<Shard> shards;
+    auto const start = Clock::now();
+    cereal::load_chunked<cereal::BinaryInputArchive>( data.data(), data.size(), shards );
+    std::cout << "NUMA aware load:     " << milliseconds( Clock::now() - start ) << " ms" << std::endl;
+    scan( shards, topology, "NUMA aware load" );
+  }
+
+  return 0;
+}
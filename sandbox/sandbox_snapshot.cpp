@@ -0,0 +1,129 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES OR SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Compares the time a process is paused by a stop-the-world save against
+// the pause caused by a forked background snapshot of the same data.
+//
+// usage: sandbox_snapshot [megabytes of state]
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/snapshot.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#ifdef CEREAL_HAS_FORK_SNAPSHOT
+
+struct Store
+{
+  std::vector<double> samples;
+  std::map<std::uint32_t, std::string> names;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( samples, names );
+  }
+};
+
+using Clock = std::chrono::steady_clock;
+
+double milliseconds( Clock::duration d )
+{
+  return std::chrono::duration<double, std::milli>( d ).count();
+}
+
+int main( int argc, char ** argv )
+{
+  std::size_t const megabytes = argc > 1 ? static_cast<std::size_t>( std::atoi( argv[1] ) ) : 512;
+
+  std::mt19937 gen( 1 );
+  Store store;
+  store.samples.resize( megabytes * (1 << 20) / 2 / sizeof(double) );
+  for( auto & s : store.samples )
+    s = std::uniform_real_distribution<double>()( gen );
+  for( std::uint32_t i = 0; i < megabytes * (1 << 20) / 2 / 64; ++i )
+    store.names.emplace( i, std::string( 40, static_cast<char>( 'a' + i % 26 ) ) );
+
+  std::cout << "State size: ~" << megabytes << " MiB" << std::endl;
+
+  std::string const path = "sandbox_snapshot.bin";
+
+  // Stop-the-world: the process cannot do anything else until the save completes
+  {
+    auto const start = Clock::now();
+    {
+      std::ofstream os( path, std::ios::binary );
+      cereal::BinaryOutputArchive ar( os );
+      ar( store );
+    }
+    auto const pause = Clock::now() - start;
+    std::cout << "stop-the-world save: pause " << milliseconds( pause ) << " ms" << std::endl;
+  }
+
+  // Forked: the process is paused only for the fork, then keeps mutating its state
+  {
+    auto const start = Clock::now();
+    auto snapshot = cereal::fork_snapshot<cereal::BinaryOutputArchive>( path,
+        cereal::SnapshotOptions().progressInterval( 64 << 20 ).sync( false ), store );
+    auto const pause = Clock::now() - start;
+
+    std::size_t mutations = 0;
+    auto const stride = 4096 / sizeof(double); // touch one value per page, forcing copy-on-write
+    while( snapshot.poll() == cereal::SnapshotStatus::Running )
+    {
+      for( std::size_t i = 0; i < 1024; ++i, ++mutations )
+        store.samples[(mutations * stride) % store.samples.size()] += 1.0;
+    }
+
+    auto const total = Clock::now() - start;
+    std::cout << "forked snapshot:     pause " << milliseconds( pause ) << " ms, completed in "
+              << milliseconds( total ) << " ms (" << snapshot.bytesWritten() << " bytes, "
+              << mutations << " mutations while running, status "
+              << static_cast<int>( snapshot.status() ) << ")" << std::endl;
+  }
+
+  std::remove( path.c_str() );
+  return 0;
+}
+
+#else // NOT CEREAL_HAS_FORK_SNAPSHOT
+
+int main()
+{
+  std::cout << "Forked snapshots are not supported on this platform" << std::endl;
+  return 0;
+}
+
+#endif // CEREAL_HAS_FORK_SNAPSHOT
@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_BINARY_SIZE_H_
+#define CEREAL_TEST_BINARY_SIZE_H_
+#include "common.hpp"
+#include <cereal/archives/binary_size.hpp>
+#include <cereal/encoded_cache.hpp>
+
+struct BinarySizeBase
+{
+  virtual ~BinarySizeBase() {}
+  virtual void foo() = 0;
+};
+
+struct BinarySizeDerived : BinarySizeBase
+{
+  std::string name;
+  std::vector<double> values;
+
+  void foo() override {}
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( name, values ); }
+};
+
+CEREAL_REGISTER_TYPE(BinarySizeDerived)
+CEREAL_REGISTER_POLYMORPHIC_RELATION(BinarySizeBase, BinarySizeDerived)
+
+struct BinarySizeVersioned
+{
+  std::int16_t x = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const )
+  { ar( x ); }
+};
+
+CEREAL_CLASS_VERSION( BinarySizeVersioned, 2 )
+
+struct BinarySizeMessage
+{
+  std::map<std::string, std::vector<std::int32_t>> index;
+  std::deque<StructInternalSplit> structs;
+  std::shared_ptr<BinarySizeBase> first;
+  std::shared_ptr<BinarySizeBase> second;
+  std::shared_ptr<BinarySizeBase> repeated;
+  std::unique_ptr<std::string> unique;
+  std::vector<BinarySizeVersioned> versioned;
+  std::tuple<bool, std::complex<float>, std::bitset<70>> misc;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(index), CEREAL_NVP(structs), first, second, repeated, unique, versioned, misc ); }
+};
+
+template <class T> inline
+std::uint64_t saved_size( T const & data )
+{
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( data );
+  }
+  return os.str().size();
+}
+
+inline void test_binary_size()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 100; ++ii )
+  {
+    BinarySizeMessage message;
+    for( std::size_t i = 0, n = random_index( 0, 20, gen ); i < n; ++i )
+      message.index[random_value<std::string>( gen )].resize( random_index( 0, 50, gen ) );
+    for( std::size_t i = 0, n = random_index( 0, 20, gen ); i < n; ++i )
+      message.structs.emplace_back( random_value<int>( gen ), random_value<int>( gen ) );
+
+    auto derived = std::make_shared<BinarySizeDerived>();
+    derived->name = random_value<std::string>( gen );
+    derived->values.resize( random_index( 0, 100, gen ) );
+    message.first = derived;
+    if( gen() % 2 )
+      message.second = std::make_shared<BinarySizeDerived>();
+    message.repeated = gen() % 2 ? message.first : nullptr;
+    if( gen() % 2 )
+      message.unique.reset( new std::string( random_value<std::string>( gen ) ) );
+    message.versioned.resize( random_index( 0, 10, gen ) );
+
+    CHECK_EQ( cereal::serialized_size( message ), saved_size( message ) );
+  }
+
+  // metadata is only counted the first time, as it is written
+  BinarySizeMessage message;
+  message.first = std::make_shared<BinarySizeDerived>();
+  message.versioned.resize( 3 );
+  std::ostringstream os;
+  {
+    cereal::BinaryOutputArchive oar(os);
+    oar( message, message.first, message );
+  }
+  CHECK_EQ( cereal::serialized_size( message, message.first, message ), os.str().size() );
+
+  // cached encodings are measured as the binary archive encodes them, and reuse the cache
+  cereal::EncodedCache cache;
+  auto const cached = std::make_shared<BinarySizeDerived>();
+  cached->name = "cached";
+  cached->values.resize( 10 );
+  auto const measured = cereal::serialized_size( cereal::cached_encoding( cached, cache ) );
+  CHECK_EQ( measured, saved_size( cereal::cached_encoding( cached, cache ) ) );
+  CHECK_EQ( cache.misses(), 1 );
+  CHECK_EQ( cache.hits(), 1 );
+}
+
+inline void test_binary_size_fixed()
+{
+  static_assert( cereal::serialized_size<std::uint16_t>() == 2, "" );
+  static_assert( cereal::serialized_size<std::array<std::int32_t, 5>>() == 20, "" );
+  static_assert( cereal::serialized_size<std::pair<std::uint8_t, double>>() == 9, "" );
+  static_assert( cereal::serialized_size<std::tuple<std::int64_t, float[3], std::array<std::pair<char, bool>, 2>>>() == 24, "" );
+  static_assert( !cereal::binary_size_detail::has_fixed_size<std::string>::value, "" );
+  static_assert( !cereal::binary_size_detail::has_fixed_size<std::pair<int, std::vector<int>>>::value, "" );
+
+  std::array<std::pair<std::uint8_t, double>, 4> data{};
+  std::tuple<std::int64_t, float[3], std::array<std::pair<char, bool>, 2>> tuple{};
+  CHECK_EQ( saved_size( data ), cereal::serialized_size<decltype( data )>() );
+  CHECK_EQ( saved_size( tuple ), cereal::serialized_size<decltype( tuple )>() );
+}
+
+#endif // CEREAL_TEST_BINARY_SIZE_H_
@@ -0,0 +1,203 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_BITSTREAM_H_
+#define CEREAL_TEST_BITSTREAM_H_
+#include "common.hpp"
+#include <cereal/archives/bitstream.hpp>
+
+enum class BitstreamMode : std::uint8_t { Idle, Walk, Run, Jump, Fall };
+
+struct BitstreamState
+{
+  bool grounded = false;
+  BitstreamMode mode = BitstreamMode::Idle;
+  std::int32_t health = 0;
+  std::uint8_t team = 0;
+  std::int16_t offset = 0;
+  std::int64_t tick = 0;
+  float heading = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(grounded),
+        cereal::make_nvp( "mode", cereal::bounded<0, 4>( mode ) ),
+        cereal::make_nvp( "health", cereal::bounded<-100, 1000>( health ) ),
+        cereal::make_nvp( "team", cereal::bits<3>( team ) ),
+        cereal::make_nvp( "offset", cereal::bits<6>( offset ) ),
+        cereal::make_nvp( "tick", cereal::bits<40>( tick ) ),
+        CEREAL_NVP(heading) );
+  }
+
+  bool operator==( BitstreamState const & other ) const
+  {
+    return grounded == other.grounded && mode == other.mode && health == other.health && team == other.team &&
+           offset == other.offset && tick == other.tick && heading == other.heading;
+  }
+};
+
+inline BitstreamState randomBitstreamState( std::mt19937 & gen )
+{
+  BitstreamState s;
+  s.grounded = gen() % 2 == 0;
+  s.mode = static_cast<BitstreamMode>( gen() % 5 );
+  s.health = static_cast<std::int32_t>( gen() % 1101 ) - 100;
+  s.team = static_cast<std::uint8_t>( gen() % 8 );
+  s.offset = static_cast<std::int16_t>( static_cast<int>( gen() % 64 ) - 32 );
+  s.tick = static_cast<std::int64_t>( gen() ) << 7;
+  s.heading = random_value<float>( gen );
+  return s;
+}
+
+//! The wrappers load back the same values in every archive
+template <class IArchive, class OArchive> inline
+void test_bitstream()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    BitstreamState const o_state = randomBitstreamState( gen );
+    std::vector<BitstreamState> o_states( gen() % 10 );
+    for( auto & s : o_states )
+      s = randomBitstreamState( gen );
+    std::vector<bool> const o_flags = { true, false, true, true, false };
+    std::string const o_string = random_basic_string<char>( gen );
+    std::vector<std::int32_t> const o_ints = { 1, -2, 3 };
+    std::map<std::string, double> const o_map = { { "a", random_value<double>( gen ) }, { "b", random_value<double>( gen ) } };
+    bool const o_bool = gen() % 2 == 0;
+    std::uint8_t const o_byte = random_value<std::uint8_t>( gen );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_state, o_bool, o_states, o_flags, o_byte, o_string, o_ints, o_map );
+    }
+
+    BitstreamState i_state;
+    std::vector<BitstreamState> i_states;
+    std::vector<bool> i_flags;
+    std::string i_string;
+    std::vector<std::int32_t> i_ints;
+    std::map<std::string, double> i_map;
+    bool i_bool;
+    std::uint8_t i_byte;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_state, i_bool, i_states, i_flags, i_byte, i_string, i_ints, i_map );
+    }
+
+    CHECK_UNARY( i_state == o_state );
+    CHECK_UNARY( i_states == o_states );
+    CHECK_UNARY( i_flags == o_flags );
+    CHECK_EQ( i_string, o_string );
+    CHECK_UNARY( i_ints == o_ints );
+    CHECK_UNARY( i_map == o_map );
+    CHECK_EQ( i_bool, o_bool );
+    CHECK_EQ( i_byte, o_byte );
+  }
+}
+
+//! Values take exactly the bits they need, and archives only read their own data
+inline void test_bitstream_density()
+{
+  std::ostringstream os;
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    for( int i = 0; i < 9; ++i )
+      oar( i % 2 == 0 );
+  }
+  CHECK_EQ( os.str().size(), 2 );
+
+  os.str( "" );
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    oar( BitstreamState() );
+  }
+  // 1 + 3 + 11 + 3 + 6 + 40 + 32 bits
+  CHECK_EQ( os.str().size(), ( 96 + 7 ) / 8 );
+
+  // two archives back to back in the same stream
+  std::mt19937 gen( 7 );
+  auto const first = randomBitstreamState( gen );
+  auto const second = randomBitstreamState( gen );
+  os.str( "" );
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    oar( first, std::string( "unaligned" ) );
+  }
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    oar( second );
+  }
+
+  BitstreamState i_first, i_second;
+  std::string i_string;
+  std::istringstream is( os.str() );
+  {
+    cereal::BitstreamInputArchive iar(is);
+    iar( i_first, i_string );
+  }
+  {
+    cereal::BitstreamInputArchive iar(is);
+    iar( i_second );
+  }
+  CHECK_UNARY( i_first == first );
+  CHECK_EQ( i_string, "unaligned" );
+  CHECK_UNARY( i_second == second );
+}
+
+//! Values outside of the bounds of bounded are errors when saving and loading
+inline void test_bitstream_bounds()
+{
+  std::ostringstream os;
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    CHECK_THROWS_AS( oar( cereal::bounded<0, 4>( 5 ) ), cereal::Exception );
+    CHECK_THROWS_AS( oar( cereal::bounded<-3, 4>( -4 ) ), cereal::Exception );
+    CHECK_THROWS_AS( oar( cereal::bounded<3, 4>( 1u ) ), cereal::Exception );
+  }
+
+  os.str( "" );
+  {
+    cereal::BitstreamOutputArchive oar(os);
+    oar( cereal::bits<3>( 6u ) );
+  }
+
+  int value = 0;
+  std::istringstream is( os.str() );
+  cereal::BitstreamInputArchive iar(is);
+  iar.setThrowOnError( false );
+  iar( cereal::bounded<0, 4>( value ) );
+  CHECK_FALSE( iar.ok() );
+  CHECK_EQ( value, 0 );
+}
+
+#endif // CEREAL_TEST_BITSTREAM_H_
@@ -0,0 +1,159 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_CHUNKED_H_
+#define CEREAL_TEST_CHUNKED_H_
+#include "common.hpp"
+#include <cereal/chunked.hpp>
+#include <thread>
+
+struct ChunkedShard
+{
+  std::vector<std::uint64_t> values;
+  std::map<std::uint32_t, std::string> names;
+  std::thread::id loadedBy;
+
+  template <class Archive>
+  void save( Archive & ar ) const
+  {
+    ar( values, names );
+  }
+
+  template <class Archive>
+  void load( Archive & ar )
+  {
+    ar( values, names );
+    loadedBy = std::this_thread::get_id();
+  }
+};
+
+inline std::vector<ChunkedShard> make_chunked_shards( std::size_t count )
+{
+  std::mt19937 gen( 7 );
+  std::vector<ChunkedShard> shards( count );
+  for( auto & shard : shards )
+  {
+    shard.values.resize( gen() % 100 );
+    for( auto & v : shard.values )
+      v = random_value<std::uint64_t>( gen );
+    for( std::size_t i = gen() % 20; i > 0; --i )
+      shard.names.emplace( random_value<std::uint32_t>( gen ), random_basic_string<char>( gen ) );
+  }
+  return shards;
+}
+
+template <class IArchive, class OArchive> inline
+void test_chunked()
+{
+  for( std::size_t count : { 0, 1, 37 } )
+  {
+    auto const shards = make_chunked_shards( count );
+
+    std::ostringstream os;
+    cereal::save_chunked<OArchive>( os, shards );
+    std::string const data = os.str();
+
+    std::vector<ChunkedShard> loaded( 3 );
+    CHECK_UNARY( cereal::load_chunked<IArchive>( data.data(), data.size(), loaded ) );
+
+    REQUIRE_EQ( loaded.size(), shards.size() );
+    for( std::size_t i = 0; i < shards.size(); ++i )
+    {
+      CHECK_EQ( loaded[i].values, shards[i].values );
+      CHECK_EQ( loaded[i].names, shards[i].names );
+    }
+
+    std::istringstream is( data );
+    std::vector<ChunkedShard> streamed;
+    CHECK_UNARY( cereal::load_chunked<IArchive>( is, streamed ) );
+    REQUIRE_EQ( streamed.size(), shards.size() );
+    for( std::size_t i = 0; i < shards.size(); ++i )
+      CHECK_EQ( streamed[i].values, shards[i].values );
+  }
+}
+
+template <class IArchive, class OArchive> inline
+void test_chunked_placement()
+{
+  auto const shards = make_chunked_shards( 24 );
+
+  std::ostringstream os;
+  cereal::save_chunked<OArchive>( os, shards );
+  std::string const data = os.str();
+
+  // three nodes sharing CPU 0; where it cannot be used, the threads stay unpinned
+  std::vector<ChunkedShard> loaded;
+  CHECK_UNARY( cereal::load_chunked<IArchive>( data.data(), data.size(), loaded,
+                 cereal::ChunkedLoadOptions()
+                   .topology( cereal::NumaTopology( std::vector<std::vector<int>>( 3, std::vector<int>{ 0 } ) ) )
+                   .nodeOfChunk( []( std::size_t chunk ) { return chunk / 8; } )
+                   .threadsPerNode( 1 ) ) );
+
+  REQUIRE_EQ( loaded.size(), shards.size() );
+  for( std::size_t i = 0; i < shards.size(); ++i )
+  {
+    CHECK_EQ( loaded[i].values, shards[i].values );
+    CHECK_NE( loaded[i].loadedBy, std::this_thread::get_id() );
+
+    // each node has one thread, which loads all chunks of that node
+    CHECK_EQ( loaded[i].loadedBy == loaded[i / 8 * 8].loadedBy, true );
+    if( i >= 8 )
+      CHECK_NE( loaded[i].loadedBy, loaded[i - 8].loadedBy );
+  }
+}
+
+template <class IArchive, class OArchive> inline
+void test_chunked_errors()
+{
+  std::vector<std::vector<std::uint32_t>> chunks( 4, std::vector<std::uint32_t>( 10, 1 ) );
+
+  std::ostringstream os;
+  cereal::save_chunked<OArchive>( os, chunks );
+  std::string const data = os.str();
+
+  std::vector<std::vector<std::uint32_t>> loaded;
+
+  // not a chunked archive
+  CHECK_THROWS_AS( cereal::load_chunked<IArchive>( data.data(), data.size() - 1, loaded ), cereal::Exception );
+
+  // an index pointing past the chunks
+  std::string corrupted = data;
+  corrupted[data.size() - 16 - 8] = '\x7f';
+  CHECK_THROWS_AS( cereal::load_chunked<IArchive>( corrupted.data(), corrupted.size(), loaded ), cereal::Exception );
+
+  // chunks that hold less than their type needs
+  std::vector<std::vector<std::uint64_t>> wider;
+  CHECK_THROWS_AS( cereal::load_chunked<IArchive>( data.data(), data.size(), wider ), cereal::Exception );
+
+  // nothing is thrown when the archives record errors instead, and the error is reported
+  struct Sticky : IArchive
+  {
+    Sticky( std::istream & is ) : IArchive( is ) { this->setThrowOnError( false ); }
+  };
+  CHECK_FALSE( cereal::load_chunked<Sticky>( data.data(), data.size(), wider ) );
+}
+
+#endif // CEREAL_TEST_CHUNKED_H_
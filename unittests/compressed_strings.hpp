@@ -0,0 +1,232 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_COMPRESSED_STRINGS_H_
+#define CEREAL_TEST_COMPRESSED_STRINGS_H_
+#include "common.hpp"
+#include <cereal/compressed_strings.hpp>
+
+//! Strings with a lot of common substrings, like the URLs of a web log
+template <class Generator> inline
+std::string random_url( Generator & gen )
+{
+  static char const * const hosts[] = { "www.example.com", "api.example.org", "cdn.example.net", "static.example.com" };
+  static char const * const paths[] = { "/index.html", "/api/v2/users/", "/images/thumbnail_", "/search?q=" };
+
+  std::string url = gen() % 2 ? "https://" : "http://";
+  url += hosts[gen() % 4];
+  url += paths[gen() % 4];
+  url += std::to_string( gen() % 100000 );
+  return url;
+}
+
+//! Strings of arbitrary bytes, including the ones that are escaped
+template <class Generator> inline
+std::string random_bytes( Generator & gen )
+{
+  std::string bytes( random_index( 0, 40, gen ), '\0' );
+  for( auto & c : bytes )
+    c = static_cast<char>( gen() % 4 == 0 ? 0xFF : gen() );
+  return bytes;
+}
+
+template <class IArchive, class OArchive> inline
+void test_compressed_strings()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 20; ++ii )
+  {
+    std::vector<std::string> o_urls( random_index( 0, 2000, gen ) );
+    for( auto & url : o_urls )
+      url = random_url( gen );
+    std::deque<std::string> o_bytes( random_index( 0, 100, gen ) );
+    for( auto & bytes : o_bytes )
+      bytes = random_bytes( gen );
+    std::string const o_string = random_url( gen ) + random_bytes( gen );
+    std::vector<std::string> const o_empty;
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( cereal::compressed_strings( o_urls ), cereal::compressed_strings( o_bytes ),
+           cereal::compressed_strings( o_string ), cereal::compressed_strings( o_empty ) );
+    }
+
+    std::vector<std::string> i_urls( 3, "stale" );
+    std::deque<std::string> i_bytes;
+    std::string i_string;
+    std::vector<std::string> i_empty( 2 );
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( cereal::compressed_strings( i_urls ), cereal::compressed_strings( i_bytes ),
+           cereal::compressed_strings( i_string ), cereal::compressed_strings( i_empty ) );
+    }
+
+    CHECK_EQ( i_urls, o_urls );
+    CHECK_EQ( i_bytes, o_bytes );
+    CHECK_EQ( i_string, o_string );
+    CHECK( i_empty.empty() );
+  }
+}
+
+//! Strings saved with a table that is shared by the whole archive
+template <class IArchive, class OArchive> inline
+void test_compressed_strings_shared_table()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> sample( 1000 );
+  for( auto & url : sample )
+    url = random_url( gen );
+  auto const o_table = cereal::StringSymbolTable::train( sample.begin(), sample.end() );
+  CHECK_GT( o_table.size(), 0 );
+
+  std::vector<std::string> o_urls( 100 );
+  for( auto & url : o_urls )
+    url = random_url( gen );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_table );
+    for( auto const & url : o_urls )
+      oar( cereal::compressed_strings( url, o_table ) );
+    oar( cereal::compressed_strings( o_urls, o_table ) );
+  }
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    cereal::StringSymbolTable i_table;
+    iar( i_table );
+    CHECK_EQ( i_table.size(), o_table.size() );
+
+    for( auto const & url : o_urls )
+    {
+      std::string i_url;
+      iar( cereal::compressed_strings( i_url, i_table ) );
+      CHECK_EQ( i_url, url );
+    }
+
+    std::vector<std::string> i_urls;
+    iar( cereal::compressed_strings( i_urls, i_table ) );
+    CHECK_EQ( i_urls, o_urls );
+  }
+}
+
+//! Each string is encoded on its own, and common substrings compress well
+inline void test_compressed_strings_encoding()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::string> urls( 10000 );
+  std::size_t rawSize = 0;
+  for( auto & url : urls )
+  {
+    url = random_url( gen );
+    rawSize += url.size();
+  }
+
+  auto const table = cereal::StringSymbolTable::train( urls.begin(), urls.end() );
+
+  std::string encoded;
+  std::vector<std::size_t> offsets;
+  for( auto const & url : urls )
+  {
+    offsets.push_back( encoded.size() );
+    table.encode( url.data(), url.size(), encoded );
+  }
+  offsets.push_back( encoded.size() );
+  CHECK_LT( encoded.size(), rawSize / 2 );
+
+  for( int i = 0; i < 100; ++i )
+  {
+    std::size_t const index = random_index( 0, urls.size() - 1, gen );
+    std::string decoded;
+    CHECK( table.decode( encoded.data() + offsets[index], offsets[index + 1] - offsets[index], decoded ) );
+    CHECK_EQ( decoded, urls[index] );
+  }
+
+  // a table without symbols escapes every byte
+  cereal::StringSymbolTable const empty;
+  std::string const bytes = random_bytes( gen );
+  std::string escaped, decoded;
+  empty.encode( bytes.data(), bytes.size(), escaped );
+  CHECK_EQ( escaped.size(), 2 * bytes.size() );
+  CHECK( empty.decode( escaped.data(), escaped.size(), decoded ) );
+  CHECK_EQ( decoded, bytes );
+
+  // codes without a symbol and a missing escaped byte are invalid
+  CHECK_FALSE( empty.decode( "\x01", 1, decoded ) );
+  CHECK_FALSE( empty.decode( "\xFF", 1, decoded ) );
+}
+
+//! Loading corrupted data stops with an error
+template <class IArchive, class OArchive> inline
+void test_compressed_strings_invalid()
+{
+  std::vector<std::string> urls( 3, "http://www.example.com/" );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::compressed_strings( urls ) );
+  }
+
+  // the trained table is followed by the number of strings, which is changed to
+  // claim more strings than the block can hold
+  std::ostringstream tableStream;
+  {
+    OArchive oar(tableStream);
+    oar( cereal::StringSymbolTable::train( urls.begin(), urls.end() ) );
+  }
+  std::string data = os.str();
+  data[tableStream.str().size()] = 100;
+
+  {
+    std::istringstream is(data);
+    IArchive iar(is);
+    std::vector<std::string> loaded;
+    CHECK_THROWS_AS( iar( cereal::compressed_strings( loaded ) ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is(data);
+    IArchive iar(is);
+    iar.setThrowOnError( false );
+    std::vector<std::string> loaded;
+    iar( cereal::compressed_strings( loaded ) );
+    CHECK_FALSE( iar.ok() );
+  }
+}
+
+#endif // CEREAL_TEST_COMPRESSED_STRINGS_H_
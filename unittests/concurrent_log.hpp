@@ -0,0 +1,248 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_CONCURRENT_LOG_H_
+#define CEREAL_TEST_CONCURRENT_LOG_H_
+#include "common.hpp"
+#include <cereal/archives/concurrent_log.hpp>
+#include <thread>
+
+struct ConcurrentLogEvent
+{
+  std::uint32_t worker;
+  std::uint64_t index;
+  std::string text;
+  std::shared_ptr<std::uint64_t> shared;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( worker, index, text, shared );
+  }
+};
+
+inline ConcurrentLogEvent make_concurrent_log_event( std::uint32_t worker, std::uint64_t index )
+{
+  return { worker, index, std::string( index % 50, static_cast<char>( 'a' + worker ) ), std::make_shared<std::uint64_t>( index ) };
+}
+
+inline void test_concurrent_log_threads()
+{
+  std::uint32_t const workers = 8;
+  std::uint64_t const records = 2000;
+
+  std::ostringstream os;
+  {
+    // a small buffer makes the workers wait for the background writer
+    cereal::ConcurrentLogArchive log( os, cereal::ConcurrentLogOptions().bufferSize( 1 << 10 ) );
+
+    std::vector<std::thread> threads;
+    for( std::uint32_t w = 0; w < workers; ++w )
+      threads.emplace_back( [&log, w, records]()
+      {
+        for( std::uint64_t i = 0; i < records; ++i )
+          log( make_concurrent_log_event( w, i ) );
+      } );
+
+    for( auto & thread : threads )
+      thread.join();
+
+    CHECK_UNARY( log.ok() );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::ConcurrentLogReader reader( is );
+
+  std::map<std::uint32_t, std::uint32_t> workerOfThread;
+  std::vector<std::uint64_t> expected( workers, 0 );
+  std::uint64_t count = 0;
+
+  while( reader.next() )
+  {
+    ConcurrentLogEvent event;
+    reader( event );
+    REQUIRE( event.worker < workers );
+    REQUIRE( event.shared );
+
+    auto const inserted = workerOfThread.emplace( reader.threadId(), event.worker );
+    CHECK_EQ( inserted.first->second, event.worker );
+
+    CHECK_EQ( reader.sequence(), event.index );
+    CHECK_EQ( event.index, expected[event.worker]++ );
+    CHECK_EQ( event.text, std::string( event.index % 50, static_cast<char>( 'a' + event.worker ) ) );
+    CHECK_EQ( *event.shared, event.index );
+    ++count;
+  }
+
+  CHECK_EQ( count, workers * records );
+  CHECK_EQ( workerOfThread.size(), workers );
+}
+
+inline void test_concurrent_log_oversized()
+{
+  std::ostringstream os;
+  {
+    cereal::ConcurrentLogArchive log( os, cereal::ConcurrentLogOptions().bufferSize( 64 ) );
+    for( int i = 0; i < 20; ++i )
+      log( i, std::vector<int>( i % 2 ? 1000 : 1, i ) );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::ConcurrentLogReader reader( is );
+
+  for( int i = 0; i < 20; ++i )
+  {
+    REQUIRE( reader.next() );
+    CHECK_EQ( reader.threadId(), 0u );
+    CHECK_EQ( reader.sequence(), static_cast<std::uint64_t>( i ) );
+
+    int index;
+    std::vector<int> values;
+    reader( index, values );
+    CHECK_EQ( index, i );
+    CHECK_EQ( values, std::vector<int>( i % 2 ? 1000 : 1, i ) );
+  }
+
+  CHECK_FALSE( reader.next() );
+}
+
+inline void test_concurrent_log_flush()
+{
+  std::ostringstream os;
+  // a long interval, so that only flush writes the record
+  cereal::ConcurrentLogArchive log( os, cereal::ConcurrentLogOptions().flushInterval( std::chrono::seconds( 60 ) ) );
+
+  std::thread( [&log]() { log( std::string( "first" ) ); } ).join();
+  log( std::string( "second" ) );
+  log.flush();
+
+  std::istringstream is( os.str() );
+  cereal::ConcurrentLogReader reader( is );
+
+  std::vector<std::string> texts;
+  std::vector<std::uint32_t> threads;
+  while( reader.next() )
+  {
+    std::string text;
+    reader( text );
+    texts.push_back( text );
+    threads.push_back( reader.threadId() );
+  }
+
+  CHECK_EQ( texts, ( std::vector<std::string>{ "first", "second" } ) );
+  CHECK_EQ( threads, ( std::vector<std::uint32_t>{ 0, 1 } ) );
+}
+
+inline void test_concurrent_log_full_buffers()
+{
+  std::ostringstream os;
+  auto const start = std::chrono::steady_clock::now();
+  {
+    // a long interval, so that only threads waiting on their full buffers wake the writer
+    cereal::ConcurrentLogArchive log( os, cereal::ConcurrentLogOptions().bufferSize( 64 ).flushInterval( std::chrono::seconds( 60 ) ) );
+
+    std::vector<std::thread> threads;
+    for( std::uint32_t w = 0; w < 4; ++w )
+      threads.emplace_back( [&log, w]()
+      {
+        for( std::uint32_t i = 0; i < 2000; ++i )
+          log( w, i );
+      } );
+
+    for( auto & thread : threads )
+      thread.join();
+  }
+  CHECK_UNARY( std::chrono::steady_clock::now() - start < std::chrono::seconds( 30 ) );
+
+  std::istringstream is( os.str() );
+  cereal::ConcurrentLogReader reader( is );
+
+  std::size_t count = 0;
+  while( reader.next() )
+    ++count;
+
+  CHECK_UNARY( reader.ok() );
+  CHECK_EQ( count, 4u * 2000u );
+}
+
+inline void test_concurrent_log_sequential()
+{
+  std::ostringstream os;
+  for( int l = 0; l < 2; ++l )
+  {
+    // the same thread logs to a new log after the previous one is destroyed
+    cereal::ConcurrentLogArchive log( os );
+    for( std::uint32_t i = 0; i < 100; ++i )
+      log( i, std::to_string( i ) );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::BinaryInputArchive iar( is );
+
+  for( int l = 0; l < 2; ++l )
+    for( std::uint32_t i = 0; i < 100; ++i )
+    {
+      std::uint32_t thread, value;
+      std::uint64_t sequence;
+      cereal::size_type size;
+      std::string text;
+      iar( thread, sequence, cereal::make_size_tag( size ) );
+      iar( value, text );
+
+      CHECK_EQ( thread, 0u );
+      CHECK_EQ( sequence, i );
+      CHECK_EQ( size, sizeof(std::uint32_t) + sizeof(cereal::size_type) + text.size() );
+      CHECK_EQ( value, i );
+      CHECK_EQ( text, std::to_string( i ) );
+    }
+}
+
+inline void test_concurrent_log_truncated()
+{
+  std::ostringstream os;
+  {
+    cereal::ConcurrentLogArchive log( os );
+    log( std::string( 100, 'x' ) );
+  }
+
+  std::string const data = os.str();
+  for( std::size_t size : { std::size_t( 10 ), data.size() - 1 } )
+  {
+    std::istringstream is( data.substr( 0, size ) );
+    cereal::ConcurrentLogReader reader( is );
+    CHECK_FALSE( reader.next() );
+    CHECK_FALSE( reader.ok() );
+    CHECK_FALSE( reader.next() );
+  }
+
+  std::istringstream is( data );
+  cereal::ConcurrentLogReader reader( is );
+  CHECK_UNARY( reader.next() );
+  CHECK_FALSE( reader.next() );
+  CHECK_UNARY( reader.ok() );
+}
+
+#endif // CEREAL_TEST_CONCURRENT_LOG_H_
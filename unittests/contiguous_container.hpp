@@ -0,0 +1,309 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_CONTIGUOUS_CONTAINER_H_
+#define CEREAL_TEST_CONTIGUOUS_CONTAINER_H_
+#include "common.hpp"
+#include <cereal/types/concepts/contiguous_container.hpp>
+
+//! A vector that keeps up to N elements inline before moving to the heap, like boost::container::small_vector
+template <class T, std::size_t N>
+class SmallVector
+{
+  public:
+    using value_type = T;
+
+    SmallVector() = default;
+    SmallVector( SmallVector const & ) = delete;
+    SmallVector & operator=( SmallVector const & ) = delete;
+
+    T * data() { return itsHeap ? itsHeap.get() : itsInline; }
+    T const * data() const { return itsHeap ? itsHeap.get() : itsInline; }
+    std::size_t size() const { return itsSize; }
+    bool inlined() const { return !itsHeap; }
+    T & operator[]( std::size_t i ) { return data()[i]; }
+    T const & operator[]( std::size_t i ) const { return data()[i]; }
+
+    void resize( std::size_t size )
+    {
+      if( size > itsCapacity )
+      {
+        std::unique_ptr<T[]> heap( new T[size] );
+        std::move( data(), data() + itsSize, heap.get() );
+        itsHeap = std::move( heap );
+        itsCapacity = size;
+      }
+      itsSize = size;
+    }
+
+  private:
+    T itsInline[N];
+    std::unique_ptr<T[]> itsHeap;
+    std::size_t itsSize = 0;
+    std::size_t itsCapacity = N;
+};
+
+namespace cereal
+{
+  template <class T, std::size_t N>
+  struct contiguous_container<SmallVector<T, N>> : std::true_type {};
+}
+
+//! A vector with a fixed inline capacity, like boost::container::static_vector
+template <class T, std::size_t N>
+class StaticVector
+{
+  public:
+    using value_type = T;
+
+    T * data() { return itsData; }
+    T const * data() const { return itsData; }
+    std::size_t size() const { return itsSize; }
+    std::size_t max_size() const { return N; }
+
+    void resize( std::size_t size )
+    {
+      if( size > N )
+        throw std::length_error( "StaticVector::resize" );
+      itsSize = size;
+    }
+
+  private:
+    T itsData[N] = {};
+    std::size_t itsSize = 0;
+};
+
+namespace cereal
+{
+  template <class T, std::size_t N>
+  struct contiguous_container<StaticVector<T, N>> : std::true_type {};
+}
+
+//! A plain struct copied as raw bytes by binary archives
+struct TriviallySerializablePoint
+{
+  std::int32_t x;
+  std::int32_t y;
+  float z;
+
+  //! Counts the calls to serialize, which binary archives should skip
+  static std::size_t & serializeCalls()
+  {
+    static std::size_t count = 0;
+    return count;
+  }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ++serializeCalls();
+    ar( x, y, z );
+  }
+
+  bool operator==( TriviallySerializablePoint const & other ) const
+  { return x == other.x && y == other.y && z == other.z; }
+};
+
+namespace cereal
+{
+  template <> struct trivially_serializable<TriviallySerializablePoint> : std::true_type {};
+}
+
+template <class T, std::size_t N, class Generator> inline
+void fill_small_vector( SmallVector<T, N> & vector, std::size_t size, Generator gen )
+{
+  vector.resize( size );
+  for( std::size_t i = 0; i < size; ++i )
+    vector[i] = gen();
+}
+
+template <class T, std::size_t N, class Compare> inline
+void check_small_vector( SmallVector<T, N> const & i_vector, SmallVector<T, N> const & o_vector, Compare compare )
+{
+  REQUIRE_EQ( i_vector.size(), o_vector.size() );
+  for( std::size_t i = 0; i < o_vector.size(); ++i )
+    compare( i_vector[i], o_vector[i] );
+}
+
+template <class IArchive, class OArchive> inline
+void test_contiguous_container()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 100; ++ii )
+  {
+    // sizes on both sides of the inline capacity
+    SmallVector<std::int32_t, 8> o_ints;
+    fill_small_vector( o_ints, gen() % 17, [&](){ return random_value<std::int32_t>( gen ); } );
+    SmallVector<double, 8> o_doubles;
+    fill_small_vector( o_doubles, gen() % 17, [&](){ return random_value<double>( gen ); } );
+    SmallVector<std::string, 4> o_strings;
+    fill_small_vector( o_strings, gen() % 9, [&](){ return random_basic_string<char>( gen ); } );
+    SmallVector<StructInternalSerialize, 4> o_structs;
+    fill_small_vector( o_structs, gen() % 9, [&](){ return StructInternalSerialize( random_value<int>( gen ), random_value<int>( gen ) ); } );
+    SmallVector<TriviallySerializablePoint, 4> o_points;
+    fill_small_vector( o_points, gen() % 9, [&](){ return TriviallySerializablePoint{ random_value<std::int32_t>( gen ), random_value<std::int32_t>( gen ), random_value<float>( gen ) }; } );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_ints, o_doubles, o_strings, o_structs, o_points );
+    }
+
+    SmallVector<std::int32_t, 8> i_ints;
+    SmallVector<double, 8> i_doubles;
+    SmallVector<std::string, 4> i_strings;
+    SmallVector<StructInternalSerialize, 4> i_structs;
+    SmallVector<TriviallySerializablePoint, 4> i_points;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_ints, i_doubles, i_strings, i_structs, i_points );
+    }
+
+    check_small_vector( i_ints, o_ints, []( std::int32_t a, std::int32_t b ){ CHECK_EQ( a, b ); } );
+    check_small_vector( i_doubles, o_doubles, []( double a, double b ){ CHECK_EQ( a, doctest::Approx( b ).epsilon( 1e-5 ) ); } );
+    check_small_vector( i_strings, o_strings, []( std::string const & a, std::string const & b ){ CHECK_EQ( a, b ); } );
+    check_small_vector( i_structs, o_structs, []( StructInternalSerialize const & a, StructInternalSerialize const & b ){ CHECK_EQ( a, b ); } );
+    check_small_vector( i_points, o_points, []( TriviallySerializablePoint const & a, TriviallySerializablePoint const & b )
+    {
+      CHECK_EQ( a.x, b.x );
+      CHECK_EQ( a.y, b.y );
+      CHECK_EQ( a.z, doctest::Approx( b.z ).epsilon( 1e-5 ) );
+    } );
+  }
+}
+
+//! Loading more elements than a container can hold is reported through the archive
+template <class IArchive, class OArchive> inline
+void test_contiguous_container_max_size()
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( std::vector<std::int32_t>( 10, 3 ) );
+  }
+
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    StaticVector<std::int32_t, 4> i_ints;
+    CHECK_THROWS_AS( iar( i_ints ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar.setThrowOnError( false );
+    StaticVector<std::int32_t, 4> i_ints;
+    iar( i_ints );
+    CHECK_FALSE( iar.ok() );
+    CHECK_EQ( i_ints.size(), 0 );
+  }
+}
+
+//! Contiguous containers share their format with std::vector
+template <class IArchive, class OArchive> inline
+void test_contiguous_container_vector_format()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<std::int32_t> o_ints( gen() % 20 );
+  for( auto & v : o_ints )
+    v = random_value<std::int32_t>( gen );
+  std::vector<TriviallySerializablePoint> o_points( gen() % 20 );
+  for( auto & p : o_points )
+    p = { random_value<std::int32_t>( gen ), random_value<std::int32_t>( gen ), 0.5f };
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_ints, o_points );
+  }
+
+  SmallVector<std::int32_t, 4> m_ints;
+  SmallVector<TriviallySerializablePoint, 4> m_points;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( m_ints, m_points );
+  }
+
+  std::ostringstream os2;
+  {
+    OArchive oar(os2);
+    oar( m_ints, m_points );
+  }
+
+  std::vector<std::int32_t> i_ints;
+  std::vector<TriviallySerializablePoint> i_points;
+  {
+    std::istringstream is(os2.str());
+    IArchive iar(is);
+    iar( i_ints, i_points );
+  }
+
+  CHECK_EQ( i_ints, o_ints );
+  CHECK( i_points == o_points );
+}
+
+//! Binary archives copy trivially serializable elements as a single block
+template <class IArchive, class OArchive> inline
+void test_contiguous_container_bulk()
+{
+  SmallVector<TriviallySerializablePoint, 4> o_points;
+  fill_small_vector( o_points, 100, [](){ return TriviallySerializablePoint{ 1, 2, 3.0f }; } );
+  std::vector<TriviallySerializablePoint> o_vector( 50, TriviallySerializablePoint{ 4, 5, 6.0f } );
+
+  TriviallySerializablePoint::serializeCalls() = 0;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_points, o_vector );
+  }
+
+  CHECK_EQ( os.str().size(), 2 * sizeof(cereal::size_type) + 150 * sizeof(TriviallySerializablePoint) );
+
+  SmallVector<TriviallySerializablePoint, 4> i_points;
+  std::vector<TriviallySerializablePoint> i_vector;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_points, i_vector );
+  }
+
+  CHECK_EQ( TriviallySerializablePoint::serializeCalls(), 0 );
+  REQUIRE_EQ( i_points.size(), 100 );
+  for( std::size_t i = 0; i < i_points.size(); ++i )
+    CHECK( i_points[i] == o_points[i] );
+  CHECK( i_vector == o_vector );
+}
+
+#endif // CEREAL_TEST_CONTIGUOUS_CONTAINER_H_
@@ -42,6 +42,8 @@ void test_std_variant()
   std::variant<int, double, std::string> o_bv1 = random_value<int>(gen);
   std::variant<int, double, std::string> o_bv2 = random_value<double>(gen);
   std::variant<int, double, std::string> o_bv3 = random_basic_string<char>(gen);
+  std::variant<int, int, std::vector<int>> o_bv4( std::in_place_index<1>, random_value<int>(gen) );
+  std::variant<int, int, std::vector<int>> o_bv5( std::in_place_index<2>, std::vector<int>{ 1, 2, 3 } );
 
   std::ostringstream os;
   {
@@ -50,11 +52,16 @@ void test_std_variant()
     oar(o_bv1);
     oar(o_bv2);
     oar(o_bv3);
+    oar(o_bv4);
+    oar(o_bv5);
   }
 
   decltype(o_bv1) i_bv1;
   decltype(o_bv2) i_bv2;
   decltype(o_bv3) i_bv3;
+  decltype(o_bv4) i_bv4;
+  decltype(o_bv5) i_bv5( std::in_place_index<2>, std::vector<int>( 100 ) );
+  auto const i_bv5_data = std::get<2>(i_bv5).data();
 
   std::istringstream is(os.str());
   {
@@ -63,11 +70,17 @@ void test_std_variant()
     iar(i_bv1);
     iar(i_bv2);
     iar(i_bv3);
+    iar(i_bv4);
+    iar(i_bv5);
   }
 
   CHECK_EQ( std::get<int>(i_bv1), std::get<int>(o_bv1) );
   CHECK_EQ( std::get<double>(i_bv2), doctest::Approx(std::get<double>(o_bv2)).epsilon(1e-5) );
   CHECK_EQ( std::get<std::string>(i_bv3), std::get<std::string>(o_bv3) );
+  CHECK_EQ( i_bv4.index(), 1 );
+  CHECK_EQ( std::get<1>(i_bv4), std::get<1>(o_bv4) );
+  CHECK_UNARY( std::get<2>(i_bv5) == std::get<2>(o_bv5) );
+  CHECK_EQ( std::get<2>(i_bv5).data(), i_bv5_data ); // the active alternative was loaded in place
 }
 
 #endif // CEREAL_HAS_CPP17
@@ -0,0 +1,172 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_ENCODED_CACHE_H_
+#define CEREAL_TEST_ENCODED_CACHE_H_
+#include "common.hpp"
+#include <cereal/encoded_cache.hpp>
+
+struct EncodedCacheConfig
+{
+  std::string name;
+  std::map<std::string, int> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( name, values ); }
+};
+
+struct EncodedCacheMessage
+{
+  std::shared_ptr<EncodedCacheConfig const> config;
+  std::vector<int> items;
+  cereal::EncodedCache * cache = nullptr;
+  std::uint64_t generation = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::cached_encoding( config, *cache, generation ), items ); }
+};
+
+template <class IArchive, class OArchive> inline
+std::string encodedCacheSave( EncodedCacheMessage const & message )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( message );
+  }
+  return os.str();
+}
+
+template <class IArchive, class OArchive> inline
+EncodedCacheMessage encodedCacheLoad( std::string const & data, cereal::EncodedCache & cache )
+{
+  EncodedCacheMessage message;
+  message.cache = &cache;
+
+  std::istringstream is(data);
+  IArchive iar(is);
+  iar( message );
+  return message;
+}
+
+template <class IArchive, class OArchive> inline
+void test_encoded_cache()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto config = std::make_shared<EncodedCacheConfig>();
+  config->name = random_basic_string<char>(gen);
+  for( int i = 0; i < 50; ++i )
+    config->values[random_basic_string<char>(gen)] = random_value<int>(gen);
+
+  cereal::EncodedCache cache;
+
+  EncodedCacheMessage first;
+  first.config = config;
+  first.items = { 1, 2, 3 };
+  first.cache = &cache;
+
+  EncodedCacheMessage second = first;
+  second.items = { 4, 5 };
+
+  // The first save encodes the config, later saves reuse its bytes
+  auto const firstData = encodedCacheSave<IArchive, OArchive>( first );
+  CHECK_EQ( cache.misses(), 1u );
+  CHECK_EQ( cache.hits(), 0u );
+  CHECK_EQ( cache.size(), 1u );
+
+  auto const secondData = encodedCacheSave<IArchive, OArchive>( second );
+  CHECK_EQ( cache.misses(), 1u );
+  CHECK_EQ( cache.hits(), 1u );
+
+  cereal::EncodedCache loadCache;
+  for( auto const & data : { std::make_pair( firstData, first ), std::make_pair( secondData, second ) } )
+  {
+    auto const loaded = encodedCacheLoad<IArchive, OArchive>( data.first, loadCache );
+    REQUIRE( loaded.config );
+    CHECK_NE( loaded.config, config );
+    CHECK_EQ( loaded.config->name, config->name );
+    CHECK_UNARY( loaded.config->values == config->values );
+    CHECK_EQ( loaded.items, data.second.items );
+  }
+  CHECK_EQ( loadCache.size(), 0u );
+
+  // A new generation replaces the cached bytes
+  config->values["changed"] = 1;
+  first.generation = 1;
+  auto const changedData = encodedCacheSave<IArchive, OArchive>( first );
+  CHECK_EQ( cache.misses(), 2u );
+  CHECK_EQ( cache.size(), 1u );
+  CHECK_EQ( encodedCacheLoad<IArchive, OArchive>( changedData, loadCache ).config->values.count( "changed" ), 1u );
+
+  // A different object is never served the bytes of another
+  auto copy = std::make_shared<EncodedCacheConfig>( *config );
+  copy->name += "copy";
+  first.config = copy;
+  auto const copyData = encodedCacheSave<IArchive, OArchive>( first );
+  CHECK_EQ( cache.misses(), 3u );
+  CHECK_EQ( encodedCacheLoad<IArchive, OArchive>( copyData, loadCache ).config->name, copy->name );
+
+  // Entries do not keep their objects alive, and can be erased explicitly
+  CHECK_EQ( cache.size(), 2u );
+  void const * copyAddress = copy.get();
+  std::weak_ptr<EncodedCacheConfig const> weakCopy = first.config;
+  first.config.reset();
+  copy.reset();
+  CHECK_UNARY( weakCopy.expired() );
+  cache.erase( copyAddress );
+  CHECK_EQ( cache.size(), 1u );
+
+  // Null pointers are not cached
+  auto const nullData = encodedCacheSave<IArchive, OArchive>( first );
+  CHECK_UNARY( !encodedCacheLoad<IArchive, OArchive>( nullData, loadCache ).config );
+
+  cache.clear();
+  CHECK_EQ( cache.size(), 0u );
+
+  // A malformed size is reported through the archive instead of being allocated
+  std::ostringstream malformed;
+  {
+    OArchive oar( malformed );
+    oar( cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) << 62 ) );
+  }
+  {
+    std::istringstream is( malformed.str() );
+    IArchive iar( is );
+    iar.setThrowOnError( false );
+
+    EncodedCacheMessage message;
+    message.cache = &loadCache;
+    iar( message );
+    CHECK_UNARY( !iar.ok() );
+    CHECK_UNARY( !message.config );
+  }
+}
+
+#endif // CEREAL_TEST_ENCODED_CACHE_H_
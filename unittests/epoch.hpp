@@ -0,0 +1,158 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_EPOCH_H_
+#define CEREAL_TEST_EPOCH_H_
+#include "common.hpp"
+
+struct EpochBase
+{
+  virtual ~EpochBase() {}
+  virtual void foo() = 0;
+};
+
+struct EpochDerived : EpochBase
+{
+  EpochDerived() = default;
+  EpochDerived( int xx, double yy ) : x( xx ), y( yy ) {}
+
+  int x = 0;
+  double y = 0;
+
+  void foo() override {}
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x, y ); }
+
+  bool operator==( EpochDerived const & other ) const
+  { return x == other.x && std::abs( y - other.y ) < 1e-5; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, EpochDerived const & s)
+{
+    os << "[x: " << s.x << " y: " << s.y << "]";
+    return os;
+}
+
+CEREAL_REGISTER_TYPE(EpochDerived)
+CEREAL_REGISTER_POLYMORPHIC_RELATION(EpochBase, EpochDerived)
+
+struct EpochVersioned
+{
+  int x = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( x );
+    CHECK_EQ( version, 3u );
+  }
+};
+
+CEREAL_CLASS_VERSION( EpochVersioned, 3 )
+
+template <class IArchive, class OArchive> inline
+void test_epoch( bool retainTypeInfo )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    auto o_shared = std::make_shared<int>( random_value<int>(gen) );
+    auto o_poly = std::make_shared<EpochDerived>( random_value<int>(gen), random_value<double>(gen) );
+    std::shared_ptr<EpochBase> o_poly_base = o_poly;
+    EpochVersioned o_versioned;
+    o_versioned.x = random_value<int>(gen);
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      oar( o_shared, o_shared, o_poly_base, o_versioned );
+      oar.startEpoch( retainTypeInfo );
+      oar( o_shared, o_poly_base, o_versioned );
+      oar.startEpoch( retainTypeInfo );
+      oar( o_shared );
+    }
+
+    std::shared_ptr<int> i_shared1, i_shared2, i_shared3, i_shared4;
+    std::shared_ptr<EpochBase> i_poly1, i_poly2;
+    EpochVersioned i_versioned1, i_versioned2;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+
+      iar( i_shared1, i_shared2, i_poly1, i_versioned1 );
+      CHECK_EQ( i_shared1, i_shared2 );
+      CHECK_EQ( i_shared1.use_count(), 3 ); // two loaded copies and the archive's
+
+      iar.startEpoch();
+      // The archive no longer keeps previously loaded pointers alive
+      CHECK_EQ( i_shared1.use_count(), 2 );
+      CHECK_EQ( i_poly1.use_count(), 1 );
+
+      iar( i_shared3, i_poly2, i_versioned2 );
+      iar.startEpoch();
+      iar( i_shared4 );
+    }
+
+    // Identity is not preserved across epochs
+    CHECK_NE( i_shared1, i_shared3 );
+    CHECK_NE( i_shared3, i_shared4 );
+    CHECK_NE( i_poly1, i_poly2 );
+
+    CHECK_EQ( *i_shared1, *o_shared );
+    CHECK_EQ( *i_shared3, *o_shared );
+    CHECK_EQ( *i_shared4, *o_shared );
+    CHECK_EQ( i_versioned1.x, o_versioned.x );
+    CHECK_EQ( i_versioned2.x, o_versioned.x );
+
+    auto i_poly_derived1 = std::dynamic_pointer_cast<EpochDerived>( i_poly1 );
+    auto i_poly_derived2 = std::dynamic_pointer_cast<EpochDerived>( i_poly2 );
+    REQUIRE( i_poly_derived1 );
+    REQUIRE( i_poly_derived2 );
+    CHECK_EQ( *i_poly_derived1, *o_poly );
+    CHECK_EQ( *i_poly_derived2, *o_poly );
+
+    // Starting an epoch where none was written is an error
+    std::ostringstream bad_os;
+    {
+      OArchive oar(bad_os);
+      oar( o_shared );
+    }
+
+    std::istringstream bad_is(bad_os.str());
+    {
+      IArchive iar(bad_is);
+      CHECK_THROWS_AS( iar.startEpoch(), cereal::Exception );
+    }
+  }
+}
+
+#endif // CEREAL_TEST_EPOCH_H_
@@ -0,0 +1,241 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_INTO_H_
+#define CEREAL_TEST_INTO_H_
+#include "common.hpp"
+#include <cereal/into.hpp>
+
+//! A vector with inline storage of fixed capacity, like boost::container::static_vector
+template <class T, std::size_t N>
+class FixedVector
+{
+  public:
+    using value_type = T;
+
+    T * data() { return itsData; }
+    T const * data() const { return itsData; }
+    std::size_t size() const { return itsSize; }
+    std::size_t capacity() const { return N; }
+    void clear() { itsSize = 0; }
+    T & operator[]( std::size_t i ) { return itsData[i]; }
+
+    void resize( std::size_t size )
+    {
+      REQUIRE( size <= N );
+      itsSize = size;
+    }
+
+  private:
+    T itsData[N];
+    std::size_t itsSize = 0;
+};
+
+struct IntoFrame
+{
+  std::int32_t ids[64];
+  std::size_t idCount = 0;
+  StructInternalSerialize points[16];
+  std::size_t pointCount = 0;
+  FixedVector<double, 32> values;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::make_nvp( "ids", cereal::into( ids, idCount ) ),
+        cereal::make_nvp( "points", cereal::into( points, 16, pointCount ) ),
+        cereal::make_nvp( "values", cereal::into( values ) ) );
+  }
+};
+
+template <class IArchive, class OArchive> inline
+void test_into()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 100; ++ii )
+  {
+    IntoFrame o_frame;
+    o_frame.idCount = gen() % 65;
+    for( std::size_t i = 0; i < o_frame.idCount; ++i )
+      o_frame.ids[i] = random_value<std::int32_t>( gen );
+    o_frame.pointCount = gen() % 17;
+    for( std::size_t i = 0; i < o_frame.pointCount; ++i )
+      o_frame.points[i] = StructInternalSerialize( random_value<int>( gen ), random_value<int>( gen ) );
+    o_frame.values.resize( gen() % 33 );
+    for( std::size_t i = 0; i < o_frame.values.size(); ++i )
+      o_frame.values[i] = random_value<double>( gen );
+
+    std::vector<std::int32_t> o_vector( gen() % 100 );
+    for( auto & v : o_vector )
+      v = random_value<std::int32_t>( gen );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_frame );
+      oar( o_vector );
+    }
+
+    IntoFrame i_frame;
+    i_frame.idCount = 99;
+    std::vector<std::int32_t> i_vector;
+    i_vector.reserve( 100 );
+    auto const i_vectorData = i_vector.data();
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_frame );
+      iar( cereal::into( i_vector ) );
+    }
+
+    REQUIRE_EQ( i_frame.idCount, o_frame.idCount );
+    for( std::size_t i = 0; i < o_frame.idCount; ++i )
+      CHECK_EQ( i_frame.ids[i], o_frame.ids[i] );
+
+    REQUIRE_EQ( i_frame.pointCount, o_frame.pointCount );
+    for( std::size_t i = 0; i < o_frame.pointCount; ++i )
+      CHECK_EQ( i_frame.points[i], o_frame.points[i] );
+
+    REQUIRE_EQ( i_frame.values.size(), o_frame.values.size() );
+    for( std::size_t i = 0; i < o_frame.values.size(); ++i )
+      CHECK_EQ( i_frame.values[i], doctest::Approx( o_frame.values[i] ).epsilon( 1e-5 ) );
+
+    // loaded from data saved as a plain vector, without reallocating
+    CHECK_EQ( i_vector, o_vector );
+    CHECK_EQ( i_vector.data(), i_vectorData );
+  }
+}
+
+//! Loading more elements than fit reports an error
+template <class IArchive, class OArchive> inline
+void test_into_overflow()
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( std::vector<std::int32_t>( 10, 7 ) );
+    oar( std::vector<std::int32_t>( 10, 7 ) );
+  }
+
+  {
+    std::int32_t data[4];
+    std::size_t size = 4;
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    CHECK_THROWS_AS( iar( cereal::into( data, size ) ), cereal::Exception );
+  }
+
+  {
+    std::int32_t data[4];
+    std::size_t size = 4;
+    std::vector<std::int32_t> vector;
+    vector.reserve( 4 );
+    vector.push_back( 1 );
+
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar.setThrowOnError( false );
+    iar( cereal::into( data, size ) );
+    CHECK_FALSE( iar.ok() );
+    CHECK_EQ( size, 0 );
+
+    iar( cereal::into( vector ) );
+    CHECK( vector.empty() );
+  }
+
+  // saving more elements than the storage holds is an error as well
+  {
+    std::int32_t data[4] = {};
+    std::size_t size = 5;
+    std::ostringstream os2;
+    OArchive oar(os2);
+    CHECK_THROWS_AS( oar( cereal::into( data, size ) ), cereal::Exception );
+  }
+}
+
+//! Counts the allocations made through CountingAllocator
+inline std::size_t & counting_allocations()
+{
+  static std::size_t count = 0;
+  return count;
+}
+
+template <class T>
+struct CountingAllocator
+{
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <class U> CountingAllocator( CountingAllocator<U> const & ) {}
+
+  T * allocate( std::size_t n )
+  {
+    ++counting_allocations();
+    return std::allocator<T>().allocate( n );
+  }
+
+  void deallocate( T * p, std::size_t n )
+  {
+    std::allocator<T>().deallocate( p, n );
+  }
+
+  template <class U> bool operator==( CountingAllocator<U> const & ) const { return true; }
+  template <class U> bool operator!=( CountingAllocator<U> const & ) const { return false; }
+};
+
+//! Loading into a reserved string and vector from a binary archive does not allocate
+template <class IArchive, class OArchive> inline
+void test_into_no_allocation()
+{
+  std::string const o_string( 200, 'x' );
+  std::vector<float> const o_floats( 300, 1.5f );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_string, o_floats );
+  }
+
+  std::basic_string<char, std::char_traits<char>, CountingAllocator<char>> i_string;
+  i_string.reserve( 256 );
+  std::vector<float, CountingAllocator<float>> i_floats;
+  i_floats.reserve( 512 );
+
+  std::istringstream is(os.str());
+  IArchive iar(is);
+
+  std::size_t const before = counting_allocations();
+  iar( cereal::into( i_string ), cereal::into( i_floats ) );
+  CHECK_EQ( counting_allocations(), before );
+
+  CHECK( std::equal( o_string.begin(), o_string.end(), i_string.begin() ) );
+  CHECK( std::equal( o_floats.begin(), o_floats.end(), i_floats.begin() ) );
+}
+
+#endif // CEREAL_TEST_INTO_H_
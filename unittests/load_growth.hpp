@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_LOAD_GROWTH_H_
+#define CEREAL_TEST_LOAD_GROWTH_H_
+#include "common.hpp"
+
+template <class Container, class Generator> inline
+void fill_random( Container & container, std::size_t size, Generator gen )
+{
+  container.resize( size );
+  for( auto & v : container )
+    v = gen();
+}
+
+//! Loads sequences into containers that already hold fewer or more elements
+template <class IArchive, class OArchive> inline
+void test_load_growth()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // sizes cross the chunks that loading appends in
+  auto const randomSize = [&](){ return random_index( 0, 20000, gen ); };
+
+  for( int ii = 0; ii < 20; ++ii )
+  {
+    std::vector<std::int32_t> o_ints;
+    fill_random( o_ints, randomSize(), [&](){ return random_value<std::int32_t>( gen ); } );
+    std::vector<double, cereal::default_init_allocator<double>> o_doubles;
+    fill_random( o_doubles, randomSize(), [&](){ return random_value<double>( gen ); } );
+    std::string o_string;
+    fill_random( o_string, randomSize(), [&](){ return static_cast<char>( random_value<std::int8_t>( gen ) ); } );
+    std::u16string o_u16string;
+    fill_random( o_u16string, randomSize(), [&](){ return static_cast<char16_t>( random_value<std::uint16_t>( gen ) ); } );
+    std::deque<std::int16_t> o_deque;
+    fill_random( o_deque, randomSize(), [&](){ return random_value<std::int16_t>( gen ); } );
+    std::valarray<float> o_valarray( randomSize() );
+    for( auto & v : o_valarray )
+      v = random_value<float>( gen );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_ints, o_doubles, o_string, o_u16string, o_deque, o_valarray );
+    }
+
+    std::vector<std::int32_t> i_ints;
+    fill_random( i_ints, randomSize(), [](){ return 1; } );
+    std::vector<double, cereal::default_init_allocator<double>> i_doubles;
+    fill_random( i_doubles, randomSize(), [](){ return 1.0; } );
+    std::string i_string;
+    fill_random( i_string, randomSize(), [](){ return 'x'; } );
+    std::u16string i_u16string;
+    fill_random( i_u16string, randomSize(), [](){ return u'x'; } );
+    std::deque<std::int16_t> i_deque;
+    fill_random( i_deque, randomSize(), [](){ return std::int16_t( 1 ); } );
+    // the same size as saved half of the time, which leaves the valarray as it is
+    std::valarray<float> i_valarray( ii % 2 ? o_valarray.size() : randomSize() );
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_ints, i_doubles, i_string, i_u16string, i_deque, i_valarray );
+    }
+
+    CHECK_EQ( i_ints, o_ints );
+    REQUIRE_EQ( i_doubles.size(), o_doubles.size() );
+    for( std::size_t i = 0; i < o_doubles.size(); ++i )
+      CHECK_EQ( i_doubles[i], doctest::Approx( o_doubles[i] ).epsilon( 1e-5 ) );
+    CHECK_EQ( i_string, o_string );
+    CHECK( i_u16string == o_u16string );
+    CHECK_EQ( i_deque, o_deque );
+    REQUIRE_EQ( i_valarray.size(), o_valarray.size() );
+    for( std::size_t i = 0; i < o_valarray.size(); ++i )
+      CHECK_EQ( i_valarray[i], doctest::Approx( o_valarray[i] ).epsilon( 1e-5 ) );
+  }
+}
+
+//! A stream buffer that makes only a small window of its data available at a time
+class LoadGrowthWindowBuf : public std::streambuf
+{
+  public:
+    explicit LoadGrowthWindowBuf( std::string const & data ) : itsData( data ), itsPos( 0 ) {}
+
+  protected:
+    int_type underflow() override
+    {
+      if( itsPos == itsData.size() )
+        return traits_type::eof();
+
+      std::size_t const count = itsData.size() - itsPos < 4096 ? itsData.size() - itsPos : 4096;
+      char * begin = const_cast<char *>( itsData.data() ) + itsPos;
+      setg( begin, begin, begin + count );
+      itsPos += count;
+      return traits_type::to_int_type( *begin );
+    }
+
+  private:
+    std::string const & itsData;
+    std::size_t itsPos;
+};
+
+//! Loads sequences larger than the steps containers are grown in
+template <class IArchive, class OArchive> inline
+void test_load_growth_large()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::size_t const size = 3 * cereal::detail::load_step<std::int32_t>() + 17;
+
+  std::vector<std::int32_t> o_ints;
+  fill_random( o_ints, size, [&](){ return random_value<std::int32_t>( gen ); } );
+  std::string o_string;
+  fill_random( o_string, 3 * cereal::detail::load_step<char>() + 17, [&](){ return static_cast<char>( random_value<std::int8_t>( gen ) ); } );
+  std::unordered_set<std::int32_t> o_set;
+  for( std::size_t i = 0; i < 3 * cereal::detail::load_step<std::int32_t>() + 17; ++i )
+    o_set.insert( static_cast<std::int32_t>( i * 7 ) );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_ints, o_string, o_set );
+  }
+
+  std::string const data = os.str();
+  for( bool trusted : { false, true } )
+    for( bool windowed : { false, true } )
+    {
+      std::vector<std::int32_t> i_ints( 10, 1 );
+      std::string i_string;
+      std::unordered_set<std::int32_t> i_set;
+
+      // a stream that shows little of its data at a time is not known to hold it all
+      LoadGrowthWindowBuf buf( data );
+      std::istringstream full( data );
+      std::istream windowStream( &buf );
+      std::istream & is = windowed ? windowStream : full;
+      {
+        IArchive iar(is);
+        iar.setTrustedSource( trusted );
+        iar( i_ints, i_string, i_set );
+      }
+
+      CHECK( i_ints == o_ints );
+      // grown geometrically and clamped, or reserved at once, the storage fits exactly
+      CHECK_EQ( i_ints.capacity(), size );
+      CHECK( i_string == o_string );
+      CHECK( i_set == o_set );
+    }
+}
+
+//! Loading from truncated data stops with an error
+template <class IArchive, class OArchive> inline
+void test_load_growth_truncated()
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( std::vector<std::int32_t>( 10000, 7 ) );
+  }
+  auto const truncated = os.str().substr( 0, os.str().size() / 2 );
+
+  {
+    std::istringstream is(truncated);
+    IArchive iar(is);
+    std::vector<std::int32_t> vector;
+    CHECK_THROWS_AS( iar( vector ), cereal::Exception );
+  }
+
+  {
+    std::istringstream is(truncated);
+    IArchive iar(is);
+    iar.setThrowOnError( false );
+    std::deque<std::int32_t> deque;
+    iar( deque );
+    CHECK_FALSE( iar.ok() );
+    CHECK_LE( deque.size(), 10000 );
+    for( std::size_t i = 0; i < deque.size() && i < 4000; ++i )
+      CHECK_EQ( deque[i], 7 );
+  }
+}
+
+#endif // CEREAL_TEST_LOAD_GROWTH_H_
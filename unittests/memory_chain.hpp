@@ -0,0 +1,192 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_MEMORY_CHAIN_H_
+#define CEREAL_TEST_MEMORY_CHAIN_H_
+#include "common.hpp"
+
+struct ChainNode
+{
+  int value = 0;
+  std::shared_ptr<ChainNode> next;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( CEREAL_NVP(value), cereal::make_nvp("next", cereal::chain( next )) );
+  }
+};
+
+struct ChainTree
+{
+  int value = 0;
+  std::unique_ptr<ChainTree> left, right;
+  std::shared_ptr<ChainNode> list;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( value, cereal::chain( left ), cereal::chain( right ), list );
+  }
+};
+
+// Lists and trees this deep would overflow the stack when destroyed recursively
+inline void destroy_chain( std::shared_ptr<ChainNode> head )
+{
+  while( head && head.use_count() == 1 )
+    head = std::move( head->next );
+}
+
+inline void destroy_chain( std::unique_ptr<ChainTree> root )
+{
+  std::vector<std::unique_ptr<ChainTree>> stack;
+  stack.push_back( std::move( root ) );
+  while( !stack.empty() )
+  {
+    auto node = std::move( stack.back() );
+    stack.pop_back();
+    if( !node )
+      continue;
+    stack.push_back( std::move( node->left ) );
+    stack.push_back( std::move( node->right ) );
+  }
+}
+
+template <class IArchive, class OArchive> inline
+void test_memory_chain( std::size_t length )
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::vector<int> values( length );
+  for( auto & v : values )
+    v = random_value<int>(gen);
+
+  // A list, whose tail links back to the third node
+  auto o_head = std::make_shared<ChainNode>();
+  {
+    auto node = o_head;
+    node->value = values[0];
+    for( std::size_t i = 1; i < length; ++i )
+    {
+      node->next = std::make_shared<ChainNode>();
+      node = node->next;
+      node->value = values[i];
+    }
+    node->next = o_head->next->next;
+  }
+
+  // A degenerate tree that extends to the left, with a short right branch at each
+  // node, all of which share a single list
+  auto o_list = std::make_shared<ChainNode>();
+  o_list->value = values[1];
+  o_list->next = std::make_shared<ChainNode>();
+  o_list->next->value = values[2];
+
+  std::unique_ptr<ChainTree> o_root( new ChainTree );
+  {
+    auto node = o_root.get();
+    for( std::size_t i = 0; i < length; ++i )
+    {
+      node->value = values[i];
+      node->list = o_list;
+      node->right.reset( new ChainTree );
+      node->right->value = -values[i];
+      if( i + 1 < length )
+      {
+        node->left.reset( new ChainTree );
+        node = node->left.get();
+      }
+    }
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_head );
+    oar( o_root );
+  }
+
+  std::shared_ptr<ChainNode> i_head;
+  std::unique_ptr<ChainTree> i_root;
+
+  std::istringstream is(os.str());
+  {
+    IArchive iar(is);
+    iar( i_head );
+    iar( i_root );
+  }
+
+  {
+    bool valuesMatch = true;
+    auto node = i_head;
+    for( std::size_t i = 0; i < length; ++i )
+    {
+      valuesMatch = valuesMatch && node && node->value == values[i];
+      node = node ? node->next : nullptr;
+    }
+    CHECK( valuesMatch );
+    CHECK_EQ( node, i_head->next->next );
+  }
+
+  {
+    bool valuesMatch = true;
+    bool listShared = true;
+    auto node = i_root.get();
+    for( std::size_t i = 0; i < length && node; ++i )
+    {
+      valuesMatch = valuesMatch && node->value == values[i] &&
+                    node->right && node->right->value == -values[i] &&
+                    !node->right->left && !node->right->right;
+      listShared = listShared && node->list == i_root->list;
+      if( i + 1 == length )
+        valuesMatch = valuesMatch && !node->left;
+      node = node->left.get();
+    }
+    CHECK( valuesMatch );
+    CHECK( listShared );
+    REQUIRE( i_root->list );
+    CHECK_EQ( i_root->list->value, values[1] );
+    REQUIRE( i_root->list->next );
+    CHECK_EQ( i_root->list->next->value, values[2] );
+    CHECK_FALSE( i_root->list->next->next );
+  }
+
+  // break the cycles before taking the lists apart
+  for( auto node : {o_head, i_head} )
+  {
+    for( std::size_t i = 1; i < length; ++i )
+      node = node->next;
+    node->next.reset();
+  }
+
+  destroy_chain( std::move( o_head ) );
+  destroy_chain( std::move( i_head ) );
+  destroy_chain( std::move( o_root ) );
+  destroy_chain( std::move( i_root ) );
+}
+
+#endif // CEREAL_TEST_MEMORY_CHAIN_H_
@@ -0,0 +1,100 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "no_exceptions.hpp"
+
+#if CEREAL_EXCEPTIONS
+#error "This test must be built with exceptions disabled"
+#endif
+
+TEST_SUITE_BEGIN("no_exceptions");
+
+TEST_CASE("binary_no_exceptions")
+{
+  test_no_exceptions<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+TEST_CASE("portable_binary_no_exceptions")
+{
+  test_no_exceptions<cereal::PortableBinaryInputArchive, cereal::PortableBinaryOutputArchive>();
+}
+
+TEST_CASE("json_no_exceptions")
+{
+  test_no_exceptions_text<cereal::JSONInputArchive, cereal::JSONOutputArchive>();
+}
+
+TEST_CASE("xml_no_exceptions")
+{
+  test_no_exceptions_text<cereal::XMLInputArchive, cereal::XMLOutputArchive>();
+}
+
+TEST_CASE("xml_stream_no_exceptions")
+{
+  test_no_exceptions_text<cereal::XMLStreamInputArchive, cereal::XMLOutputArchive>();
+}
+
+TEST_CASE("binary_chunked_no_exceptions")
+{
+  test_no_exceptions_chunked<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+
+TEST_CASE("binary_encoded_cache_no_exceptions")
+{
+  test_no_exceptions_encoded_cache<cereal::BinaryOutputArchive>();
+}
+
+TEST_CASE("portable_binary_encoded_cache_no_exceptions")
+{
+  test_no_exceptions_encoded_cache<cereal::PortableBinaryOutputArchive>();
+}
+
+TEST_CASE("concurrent_log_no_exceptions")
+{
+  test_no_exceptions_concurrent_log();
+}
+
+#ifdef CEREAL_HAS_FORK_SNAPSHOT
+TEST_CASE("binary_snapshot_no_exceptions")
+{
+  test_no_exceptions_snapshot<cereal::BinaryInputArchive, cereal::BinaryOutputArchive>();
+}
+#endif // CEREAL_HAS_FORK_SNAPSHOT
+
+TEST_CASE("no_exceptions_default")
+{
+  std::istringstream is;
+  cereal::BinaryInputArchive iar( is );
+  CHECK_UNARY( !iar.throwsOnError() );
+
+  int x = 1;
+  iar( x );
+  CHECK_EQ( x, 0 );
+  CHECK_UNARY( !iar.ok() );
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,421 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_NO_EXCEPTIONS_H_
+#define CEREAL_TEST_NO_EXCEPTIONS_H_
+
+// This test is built without exceptions, so it cannot include common.hpp
+#include <cereal/types/memory.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/polymorphic.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+#include <cereal/archives/xml_stream.hpp>
+#include <cereal/archives/concurrent_log.hpp>
+#include <cereal/chunked.hpp>
+#include <cereal/encoded_cache.hpp>
+#include <cereal/reduced_precision.hpp>
+#include <cereal/snapshot.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "doctest.h"
+
+struct NoExceptionsData
+{
+  std::vector<int> v;
+  std::string s;
+  std::map<int, std::string> m;
+  std::shared_ptr<int> p1, p2;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( v, s, m, p1, p2 );
+  }
+};
+
+//! A stream buffer that only accepts a limited number of characters
+class NoExceptionsLimitedBuf : public std::streambuf
+{
+  public:
+    NoExceptionsLimitedBuf( std::size_t limit ) : itsLimit( limit ) {}
+
+  protected:
+    int_type overflow( int_type c ) override
+    {
+      if( itsLimit == 0 || traits_type::eq_int_type( c, traits_type::eof() ) )
+        return traits_type::eof();
+
+      --itsLimit;
+      return c;
+    }
+
+  private:
+    std::size_t itsLimit;
+};
+
+//! Loads a container from an input that holds nothing but a malformed size
+template <class IArchive, class T> inline
+void test_no_exceptions_malformed_size( std::string const & input )
+{
+  std::istringstream is( input );
+  IArchive iar( is );
+  iar.setThrowOnError( false );
+
+  T t;
+  iar( t );
+
+  CHECK_UNARY( !iar.ok() );
+  CHECK_UNARY( iar.error() != nullptr );
+  CHECK_UNARY( t.size() <= cereal::detail::load_step<typename T::value_type>() );
+}
+
+template <class IArchive, class OArchive> inline
+void test_no_exceptions()
+{
+  NoExceptionsData o_data;
+  for( int i = 0; i < 20; ++i )
+  {
+    o_data.v.push_back( i * 3 );
+    o_data.m[i] = std::string( static_cast<std::size_t>( i ), 'x' );
+  }
+  o_data.s = "cereal";
+  o_data.p1 = std::make_shared<int>( 42 );
+  o_data.p2 = o_data.p1;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar.setThrowOnError( false );
+    oar( o_data );
+    CHECK_UNARY( oar.ok() );
+    CHECK_UNARY( oar.error() == nullptr );
+  }
+
+  auto const full = os.str();
+
+  // The complete input loads without errors
+  {
+    std::istringstream is( full );
+    IArchive iar( is );
+    iar.setThrowOnError( false );
+
+    NoExceptionsData i_data;
+    iar( i_data );
+
+    CHECK_UNARY( iar.ok() );
+    CHECK_EQ( i_data.v, o_data.v );
+    CHECK_EQ( i_data.s, o_data.s );
+    CHECK_UNARY( i_data.m == o_data.m );
+    CHECK_UNARY( i_data.p1 && *i_data.p1 == 42 );
+    CHECK_EQ( i_data.p1, i_data.p2 );
+  }
+
+  // Every truncation of the input is rejected without throwing, and leaves the archive in a sticky error state
+  for( std::size_t size = 0; size < full.size(); ++size )
+  {
+    std::istringstream is( full.substr( 0, size ) );
+    IArchive iar( is );
+    iar.setThrowOnError( false );
+
+    NoExceptionsData i_data;
+    iar( i_data );
+
+    CHECK_UNARY( !iar.ok() );
+    CHECK_UNARY( iar.error() != nullptr );
+    CHECK_UNARY( i_data.v.size() <= o_data.v.size() );
+    CHECK_UNARY( i_data.m.size() <= o_data.m.size() );
+
+    // Further loads are no-ops that produce zeroed values
+    int x = 1;
+    iar( x );
+    CHECK_EQ( x, 0 );
+    CHECK_UNARY( !iar.ok() );
+  }
+
+  // Sizes far larger than the input are rejected without allocating them up front
+  {
+    std::ostringstream malformed;
+    {
+      OArchive oar( malformed );
+      oar( cereal::make_size_tag( static_cast<cereal::size_type>( 1 ) << 62 ) );
+    }
+
+    test_no_exceptions_malformed_size<IArchive, std::vector<int>>( malformed.str() );
+    test_no_exceptions_malformed_size<IArchive, std::vector<std::string>>( malformed.str() );
+    test_no_exceptions_malformed_size<IArchive, std::vector<bool>>( malformed.str() );
+    test_no_exceptions_malformed_size<IArchive, std::string>( malformed.str() );
+    test_no_exceptions_malformed_size<IArchive, std::string>( malformed.str() + "cereal" );
+
+    std::istringstream is( malformed.str() );
+    IArchive iar( is );
+    iar.setThrowOnError( false );
+    std::vector<float> halves;
+    iar( cereal::half_precision( halves ) );
+    CHECK_UNARY( !iar.ok() );
+    CHECK_UNARY( halves.size() <= cereal::detail::load_step<float>() );
+  }
+
+  // Writing to a stream that fails is reported through the output archive
+  {
+    NoExceptionsLimitedBuf buf( 8 );
+    std::ostream limited( &buf );
+    OArchive oar( limited );
+    oar.setThrowOnError( false );
+    oar( o_data );
+
+    CHECK_UNARY( !oar.ok() );
+    CHECK_UNARY( oar.error() != nullptr );
+  }
+}
+
+template <class IArchive, class OArchive> inline
+void test_no_exceptions_text()
+{
+  NoExceptionsData o_data;
+  o_data.v = { 1, 2, 3 };
+  o_data.s = "cereal";
+  o_data.m[1] = "one";
+  o_data.p1 = std::make_shared<int>( 42 );
+  o_data.p2 = o_data.p1;
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( cereal::make_nvp( "data", o_data ) );
+  }
+
+  auto const full = os.str();
+
+  // The complete input loads without errors
+  {
+    std::istringstream is( full );
+    IArchive iar( is );
+
+    NoExceptionsData i_data;
+    iar( cereal::make_nvp( "data", i_data ) );
+
+    CHECK_UNARY( iar.ok() );
+    CHECK_EQ( i_data.v, o_data.v );
+    CHECK_EQ( i_data.s, o_data.s );
+    CHECK_UNARY( i_data.m == o_data.m );
+    CHECK_UNARY( i_data.p1 && *i_data.p1 == 42 );
+  }
+
+  // Truncated input is reported without throwing, after which loads produce zeroed values
+  {
+    std::istringstream is( full.substr( 0, full.size() / 2 ) );
+    IArchive iar( is );
+
+    NoExceptionsData i_data;
+    iar( cereal::make_nvp( "data", i_data ) );
+    CHECK_UNARY( !iar.ok() );
+    CHECK_UNARY( !i_data.p1 );
+
+    int x = 1;
+    iar( x );
+    CHECK_EQ( x, 0 );
+    CHECK_UNARY( !iar.ok() );
+  }
+
+  // Missing nodes and values of the wrong type are reported without throwing
+  {
+    std::istringstream is( full );
+    IArchive iar( is );
+
+    int x = 1;
+    iar( cereal::make_nvp( "missing", x ) );
+    CHECK_EQ( x, 0 );
+    CHECK_UNARY( !iar.ok() );
+  }
+  {
+    std::istringstream is( full );
+    IArchive iar( is );
+
+    std::vector<int> v;
+    iar.setNextName( "data" );
+    iar.startNode();
+    iar( v );
+    int x = 1;
+    iar( x );
+    iar.finishNode();
+
+    CHECK_EQ( v, o_data.v );
+    CHECK_EQ( x, 0 );
+    CHECK_UNARY( !iar.ok() );
+    CHECK_UNARY( iar.error() != nullptr );
+  }
+}
+
+template <class IArchive, class OArchive> inline
+void test_no_exceptions_chunked()
+{
+  std::vector<std::vector<std::uint32_t>> chunks( 4, std::vector<std::uint32_t>( 10, 1 ) );
+
+  std::ostringstream os;
+  CHECK_UNARY( cereal::save_chunked<OArchive>( os, chunks ) );
+  std::string const data = os.str();
+
+  std::vector<std::vector<std::uint32_t>> loaded;
+  CHECK_UNARY( cereal::load_chunked<IArchive>( data.data(), data.size(), loaded ) );
+  CHECK_UNARY( loaded == chunks );
+
+  // not a chunked archive
+  CHECK_FALSE( cereal::load_chunked<IArchive>( data.data(), data.size() - 1, loaded ) );
+
+  // an index pointing past the chunks
+  std::string corrupted = data;
+  corrupted[data.size() - 16 - 8] = '\x7f';
+  CHECK_FALSE( cereal::load_chunked<IArchive>( corrupted.data(), corrupted.size(), loaded ) );
+
+  // chunks that hold less than their type needs
+  std::vector<std::vector<std::uint64_t>> wider;
+  CHECK_FALSE( cereal::load_chunked<IArchive>( data.data(), data.size(), wider ) );
+
+  // a stream that cannot hold the archive
+  NoExceptionsLimitedBuf buf( 8 );
+  std::ostream limited( &buf );
+  CHECK_FALSE( cereal::save_chunked<OArchive>( limited, chunks ) );
+}
+
+struct NoExceptionsBase
+{
+  virtual ~NoExceptionsBase() = default;
+
+  template <class Archive>
+  void serialize( Archive & )
+  { }
+};
+
+//! Never registered, so saving it through a pointer to its base fails
+struct NoExceptionsUnregistered : NoExceptionsBase
+{
+  template <class Archive>
+  void serialize( Archive & )
+  { }
+};
+
+template <class OArchive> inline
+void test_no_exceptions_encoded_cache()
+{
+  cereal::EncodedCache cache;
+
+  std::shared_ptr<NoExceptionsBase const> unregistered = std::make_shared<NoExceptionsUnregistered>();
+  for( int ii = 0; ii < 2; ++ii )
+  {
+    std::ostringstream os;
+    OArchive oar( os );
+    oar( cereal::cached_encoding( unregistered, cache ) );
+    CHECK_UNARY( !oar.ok() );
+    CHECK_UNARY( oar.error() != nullptr );
+  }
+  // a failed encoding is not cached
+  CHECK_EQ( cache.size(), 0 );
+  CHECK_EQ( cache.hits(), 0 );
+
+  auto const value = std::make_shared<int const>( 5 );
+  std::ostringstream os;
+  OArchive oar( os );
+  oar( cereal::cached_encoding( value, cache ) );
+  CHECK_UNARY( oar.ok() );
+  CHECK_EQ( cache.size(), 1 );
+}
+
+inline void test_no_exceptions_concurrent_log()
+{
+  std::shared_ptr<NoExceptionsBase const> unregistered = std::make_shared<NoExceptionsUnregistered>();
+
+  std::ostringstream os;
+  {
+    cereal::ConcurrentLogArchive log( os );
+    CHECK_UNARY( log( 1 ) );
+    // the failed record is dropped
+    CHECK_FALSE( log( 2, unregistered ) );
+    CHECK_UNARY( log( 3 ) );
+    log.flush();
+    CHECK_UNARY( log.ok() );
+  }
+
+  std::istringstream is( os.str() );
+  cereal::ConcurrentLogReader reader( is );
+  for( int expected : { 1, 3 } )
+  {
+    bool const more = reader.next();
+    CHECK_UNARY( more );
+    if( !more )
+      break;
+    CHECK_EQ( reader.sequence(), static_cast<std::uint64_t>( expected / 2 ) );
+
+    int value = 0;
+    CHECK_UNARY( reader( value ) );
+    CHECK_EQ( value, expected );
+  }
+  CHECK_FALSE( reader.next() );
+  CHECK_UNARY( reader.ok() );
+}
+
+#ifdef CEREAL_HAS_FORK_SNAPSHOT
+template <class IArchive, class OArchive> inline
+void test_no_exceptions_snapshot()
+{
+  std::string const path = "cereal_test_no_exceptions_snapshot_" + std::to_string( ::getpid() );
+  std::vector<int> o_vector = { 1, 2, 3 };
+
+  auto snapshot = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions(), o_vector );
+  CHECK_EQ( snapshot.wait(), cereal::SnapshotStatus::Completed );
+  CHECK_UNARY( snapshot.error().empty() );
+
+  std::vector<int> i_vector;
+  {
+    std::ifstream is( path, std::ios::binary );
+    IArchive iar( is );
+    iar( i_vector );
+    CHECK_UNARY( iar.ok() );
+  }
+  std::remove( path.c_str() );
+  CHECK_EQ( i_vector, o_vector );
+
+  // Errors in the child are reported through the snapshot
+  auto failed = cereal::fork_snapshot<OArchive>( "/nonexistent_cereal_directory/snapshot", cereal::SnapshotOptions(), o_vector );
+  CHECK_EQ( failed.wait(), cereal::SnapshotStatus::Failed );
+  CHECK_UNARY( !failed.error().empty() );
+
+  // Errors recorded by the archive fail the snapshot and leave no file behind
+  std::shared_ptr<NoExceptionsBase const> unregistered = std::make_shared<NoExceptionsUnregistered>();
+  auto invalid = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions(), unregistered );
+  CHECK_EQ( invalid.wait(), cereal::SnapshotStatus::Failed );
+  CHECK_UNARY( !invalid.error().empty() );
+  CHECK_FALSE( std::ifstream( path ).good() );
+}
+#endif // CEREAL_HAS_FORK_SNAPSHOT
+
+#endif // CEREAL_TEST_NO_EXCEPTIONS_H_
@@ -0,0 +1,182 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_NO_RTTI_H_
+#define CEREAL_TEST_NO_RTTI_H_
+#include "common.hpp"
+
+struct NoRttiBase
+{
+  virtual ~NoRttiBase() {}
+  virtual int value() const = 0;
+
+  CEREAL_POLYMORPHIC_TYPE_ID()
+};
+
+struct NoRttiDerived : NoRttiBase
+{
+  NoRttiDerived() : x(0) {}
+  NoRttiDerived( int xx ) : x(xx) {}
+  int x;
+
+  int value() const override { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+
+  CEREAL_POLYMORPHIC_TYPE_ID()
+};
+
+struct NoRttiMostDerived : NoRttiDerived
+{
+  NoRttiMostDerived() : y(0) {}
+  NoRttiMostDerived( int xx, int yy ) : NoRttiDerived( xx ), y(yy) {}
+  int y;
+
+  int value() const override { return x + y; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<NoRttiDerived>( this ), y ); }
+
+  CEREAL_POLYMORPHIC_TYPE_ID()
+};
+
+CEREAL_REGISTER_TYPE(NoRttiDerived)
+CEREAL_REGISTER_TYPE(NoRttiMostDerived)
+CEREAL_REGISTER_POLYMORPHIC_RELATION(NoRttiBase, NoRttiDerived)
+
+struct NoRttiVersioned
+{
+  int x = 0;
+  std::uint32_t loadedVersion = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar, std::uint32_t const version )
+  {
+    ar( x );
+    loadedVersion = version;
+  }
+};
+
+CEREAL_CLASS_VERSION( NoRttiVersioned, 7 )
+
+struct NoRttiRoot
+{
+  int w = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( w ); }
+};
+
+struct NoRttiLeft : virtual NoRttiRoot
+{
+  int x = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::virtual_base_class<NoRttiRoot>( this ), x ); }
+};
+
+struct NoRttiRight : virtual NoRttiRoot
+{
+  int y = 0;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::virtual_base_class<NoRttiRoot>( this ), y ); }
+};
+
+struct NoRttiDiamond : NoRttiLeft, NoRttiRight
+{
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<NoRttiLeft>( this ), cereal::base_class<NoRttiRight>( this ) ); }
+};
+
+template <class IArchive, class OArchive> inline
+void test_no_rtti()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::shared_ptr<NoRttiBase> o_shared = std::make_shared<NoRttiMostDerived>( random_value<int>(gen) % 1000, random_value<int>(gen) % 1000 );
+    std::shared_ptr<NoRttiBase> o_shared2 = std::make_shared<NoRttiDerived>( random_value<int>(gen) );
+    std::unique_ptr<NoRttiBase> o_unique( new NoRttiMostDerived( random_value<int>(gen) % 1000, random_value<int>(gen) % 1000 ) );
+    std::shared_ptr<NoRttiBase> o_null;
+
+    NoRttiVersioned o_versioned;
+    o_versioned.x = random_value<int>(gen);
+
+    NoRttiDiamond o_diamond;
+    o_diamond.w = random_value<int>(gen);
+    o_diamond.x = random_value<int>(gen);
+    o_diamond.y = random_value<int>(gen);
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_shared, o_shared2, o_unique, o_null, o_shared, o_versioned, o_versioned, o_diamond );
+    }
+
+    std::shared_ptr<NoRttiBase> i_shared, i_shared2, i_null, i_shared_again;
+    std::unique_ptr<NoRttiBase> i_unique;
+    NoRttiVersioned i_versioned, i_versioned2;
+    NoRttiDiamond i_diamond;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_shared, i_shared2, i_unique, i_null, i_shared_again, i_versioned, i_versioned2, i_diamond );
+    }
+
+    REQUIRE( i_shared );
+    REQUIRE( i_shared2 );
+    REQUIRE( i_unique );
+    CHECK_EQ( i_shared->value(), o_shared->value() );
+    CHECK_EQ( i_shared2->value(), o_shared2->value() );
+    CHECK_EQ( i_unique->value(), o_unique->value() );
+    CHECK_UNARY( i_shared->cereal_type_index() == cereal::detail::type_index_of<NoRttiMostDerived>() );
+    CHECK_UNARY( i_shared2->cereal_type_index() == cereal::detail::type_index_of<NoRttiDerived>() );
+    CHECK_UNARY( i_unique->cereal_type_index() == cereal::detail::type_index_of<NoRttiMostDerived>() );
+    CHECK_UNARY( !i_null );
+    CHECK_EQ( i_shared, i_shared_again );
+
+    CHECK_EQ( i_versioned.x, o_versioned.x );
+    CHECK_EQ( i_versioned.loadedVersion, 7u );
+    CHECK_EQ( i_versioned2.loadedVersion, 7u );
+
+    CHECK_EQ( i_diamond.w, o_diamond.w );
+    CHECK_EQ( i_diamond.x, o_diamond.x );
+    CHECK_EQ( i_diamond.y, o_diamond.y );
+  }
+}
+
+#endif // CEREAL_TEST_NO_RTTI_H_
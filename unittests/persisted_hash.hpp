@@ -0,0 +1,218 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_PERSISTED_HASH_H_
+#define CEREAL_TEST_PERSISTED_HASH_H_
+#include "common.hpp"
+
+//! A seeded string hash that counts how often it is called
+struct SeededStringHash
+{
+  std::size_t seed = 0;
+
+  static std::size_t & calls()
+  {
+    static std::size_t count = 0;
+    return count;
+  }
+
+  std::size_t operator()( std::string const & s ) const
+  {
+    ++calls();
+    return std::hash<std::string>()( s ) ^ static_cast<std::size_t>( seed * 0x9e3779b97f4a7c15ull );
+  }
+};
+
+using PersistedStringMap = std::unordered_map<std::string, int, cereal::PersistedHash<SeededStringHash>>;
+using PersistedStringSet = std::unordered_set<std::string, cereal::PersistedHash<SeededStringHash>>;
+
+inline SeededStringHash seeded_string_hash( std::size_t seed )
+{
+  SeededStringHash hash;
+  hash.seed = seed;
+  return hash;
+}
+
+template <class IArchive, class OArchive> inline
+void test_persisted_hash()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 20; ++ii )
+  {
+    PersistedStringMap o_map;
+    PersistedStringSet o_set;
+    std::unordered_map<std::string, PersistedStringSet> o_nested;
+    for( int j = 0; j < 100; ++j )
+    {
+      auto const key = random_basic_string<char>( gen ) + std::to_string( j );
+      o_map.emplace( key, random_value<int>( gen ) );
+      o_set.insert( key );
+      o_nested[key.substr( 0, 1 )].insert( key );
+    }
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar( o_map, o_set, o_nested );
+    }
+
+    PersistedStringMap i_map;
+    PersistedStringSet i_set;
+    std::unordered_map<std::string, PersistedStringSet> i_nested;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar( i_map, i_set, i_nested );
+    }
+
+    CHECK( i_map == o_map );
+    CHECK( i_set == o_set );
+    CHECK( i_nested == o_nested );
+
+    // every key can be found through its real hash
+    for( auto const & v : o_map )
+    {
+      auto const found = i_map.find( v.first );
+      REQUIRE( found != i_map.end() );
+      CHECK_EQ( found->second, v.second );
+    }
+    for( auto const & v : o_set )
+      CHECK( i_set.count( v ) );
+  }
+}
+
+//! Loading trusted data with the hash function used for saving does not hash the keys again
+template <class IArchive, class OArchive> inline
+void test_persisted_hash_reuse()
+{
+  PersistedStringMap o_map( 0, seeded_string_hash( 1 ) );
+  PersistedStringSet o_set( 0, seeded_string_hash( 1 ) );
+  for( int j = 0; j < 1000; ++j )
+  {
+    o_map.emplace( std::string( 100, 'k' ) + std::to_string( j ), j );
+    o_set.insert( std::string( 100, 's' ) + std::to_string( j ) );
+  }
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_map, o_set );
+  }
+
+  PersistedStringMap i_map( 0, seeded_string_hash( 1 ) );
+  PersistedStringSet i_set( 0, seeded_string_hash( 1 ) );
+  SeededStringHash::calls() = 0;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar.setTrustedSource( true );
+    iar( i_map, i_set );
+  }
+
+  // forwarding depends on the standard library hashing the key passed to insert
+  #ifdef __GLIBCXX__
+  // the hasher identity and the first key of each container
+  CHECK_EQ( SeededStringHash::calls(), 4 );
+  #endif
+
+  CHECK( i_map == o_map );
+  CHECK( i_set == o_set );
+}
+
+//! Loading with a different hash function hashes the keys again
+template <class IArchive, class OArchive> inline
+void test_persisted_hash_mismatch()
+{
+  PersistedStringMap o_map( 0, seeded_string_hash( 1 ) );
+  for( int j = 0; j < 1000; ++j )
+    o_map.emplace( std::string( 100, 'k' ) + std::to_string( j ), j );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_map );
+  }
+
+  PersistedStringMap i_map( 0, seeded_string_hash( 2 ) );
+  SeededStringHash::calls() = 0;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_map );
+  }
+
+  CHECK_GE( SeededStringHash::calls(), 1000 );
+  REQUIRE_EQ( i_map.size(), o_map.size() );
+  for( auto const & v : o_map )
+  {
+    auto const found = i_map.find( v.first );
+    REQUIRE( found != i_map.end() );
+    CHECK_EQ( found->second, v.second );
+  }
+}
+
+//! Stored hashes are not used for untrusted data, which may have been altered
+template <class IArchive, class OArchive> inline
+void test_persisted_hash_untrusted()
+{
+  PersistedStringMap o_map;
+  for( int j = 0; j < 4; ++j )
+    o_map.emplace( std::string( 20, 'k' ) + std::to_string( j ), j );
+
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_map );
+  }
+
+  // the hash of the last element is saved last
+  std::string data = os.str();
+  data.back() = static_cast<char>( data.back() ^ 0x5a );
+
+  PersistedStringMap i_map;
+  SeededStringHash::calls() = 0;
+  {
+    std::istringstream is(data);
+    IArchive iar(is);
+    iar( i_map );
+    CHECK_UNARY( iar.ok() );
+  }
+
+  CHECK_GE( SeededStringHash::calls(), o_map.size() );
+  for( auto const & v : o_map )
+  {
+    auto const found = i_map.find( v.first );
+    REQUIRE( found != i_map.end() );
+    CHECK_EQ( found->second, v.second );
+    i_map[v.first] = v.second;
+  }
+  CHECK_EQ( i_map.size(), o_map.size() );
+}
+
+#endif // CEREAL_TEST_PERSISTED_HASH_H_
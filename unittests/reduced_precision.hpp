@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_REDUCED_PRECISION_H_
+#define CEREAL_TEST_REDUCED_PRECISION_H_
+#include "common.hpp"
+#include <cereal/reduced_precision.hpp>
+
+struct ReducedPrecisionData
+{
+  std::vector<float> halves;
+  std::vector<double> bfloats;
+  std::vector<double> fixed;
+  std::array<float, 3> array;
+  double scalar;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::half_precision( halves ),
+        cereal::bfloat16_precision( bfloats ),
+        cereal::quantized<std::int16_t>( fixed, 0.01 ),
+        cereal::half_precision( array ),
+        cereal::quantized<std::int32_t>( scalar, 1e-6 ) );
+  }
+};
+
+template <class IArchive, class OArchive> inline
+void test_reduced_precision()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_real_distribution<double> dist( -300, 300 );
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    ReducedPrecisionData o_data;
+    for( int i = 0; i < 1000 + ii; ++i )
+    {
+      o_data.halves.push_back( static_cast<float>( dist( gen ) ) );
+      o_data.bfloats.push_back( dist( gen ) * 1e20 );
+      o_data.fixed.push_back( dist( gen ) );
+    }
+    o_data.array = {{ 1.5f, -0.25f, 1e-7f }};
+    o_data.scalar = dist( gen );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+      oar(o_data);
+    }
+
+    // three sizes, two bytes per half and bfloat, two per fixed point, six for the array, four for the scalar
+    CHECK_EQ( os.str().size(), 3 * sizeof(cereal::size_type) + o_data.halves.size() * 6 + 6 + 4 + ( std::is_same<OArchive, cereal::PortableBinaryOutputArchive>::value ? 1 : 0 ) );
+
+    ReducedPrecisionData i_data;
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      iar(i_data);
+    }
+
+    REQUIRE_EQ( i_data.halves.size(), o_data.halves.size() );
+    REQUIRE_EQ( i_data.bfloats.size(), o_data.bfloats.size() );
+    REQUIRE_EQ( i_data.fixed.size(), o_data.fixed.size() );
+    for( size_t i = 0; i < o_data.halves.size(); ++i )
+    {
+      CHECK_LE( std::abs( i_data.halves[i] - o_data.halves[i] ), std::abs( o_data.halves[i] ) / 2048 );
+      CHECK_LE( std::abs( i_data.bfloats[i] - o_data.bfloats[i] ), std::abs( o_data.bfloats[i] ) / 256 );
+      CHECK_LE( std::abs( i_data.fixed[i] - o_data.fixed[i] ), 0.005 + 1e-9 );
+    }
+
+    CHECK_EQ( i_data.array[0], 1.5f );
+    CHECK_EQ( i_data.array[1], -0.25f );
+    CHECK_EQ( i_data.array[2], doctest::Approx( 1e-7f ).epsilon( 0.01 ) ); // a subnormal half
+    CHECK_LE( std::abs( i_data.scalar - o_data.scalar ), 0.5e-6 + 1e-12 );
+  }
+}
+
+//! Every half converts to a float and back unchanged, vectorized or not
+inline void test_reduced_precision_half_exhaustive()
+{
+  std::vector<std::uint16_t> halves( 65536 );
+  for( std::size_t i = 0; i < halves.size(); ++i )
+    halves[i] = static_cast<std::uint16_t>( i );
+
+  std::vector<float> floats( halves.size() );
+  cereal::reduced_precision_detail::decode_half( halves.data(), floats.data(), halves.size() );
+
+  std::vector<std::uint16_t> encoded( halves.size() );
+  cereal::reduced_precision_detail::encode_half( floats.data(), encoded.data(), floats.size() );
+
+  size_t mismatches = 0;
+  for( std::size_t i = 0; i < halves.size(); ++i )
+  {
+    bool const isNaN = ( halves[i] & 0x7C00u ) == 0x7C00u && ( halves[i] & 0x3FFu ) != 0;
+    if( isNaN )
+    {
+      CHECK_UNARY( std::isnan( floats[i] ) );
+      CHECK_UNARY( ( encoded[i] & 0x7C00u ) == 0x7C00u && ( encoded[i] & 0x3FFu ) != 0 );
+    }
+    else
+    {
+      if( cereal::reduced_precision_detail::half_to_float( halves[i] ) != floats[i] && !std::isnan( floats[i] ) ) ++mismatches;
+      if( encoded[i] != halves[i] ) ++mismatches;
+      if( cereal::reduced_precision_detail::float_to_half( floats[i] ) != halves[i] ) ++mismatches;
+    }
+  }
+  CHECK_EQ( mismatches, 0 );
+
+  // rounding and overflow
+  using cereal::reduced_precision_detail::float_to_half;
+  CHECK_EQ( float_to_half( 65504.0f ), 0x7BFF );
+  CHECK_EQ( float_to_half( 65520.0f ), 0x7C00 );
+  CHECK_EQ( float_to_half( 1e10f ), 0x7C00 );
+  CHECK_EQ( float_to_half( -std::numeric_limits<float>::infinity() ), 0xFC00 );
+  CHECK_EQ( float_to_half( 1.0f + 1.0f / 2048 ), 0x3C00 );     // tie rounds to even
+  CHECK_EQ( float_to_half( 1.0f + 3.0f / 2048 ), 0x3C02 );     // tie rounds to even
+  CHECK_EQ( float_to_half( 1e-9f ), 0x0000 );
+  CHECK_EQ( float_to_half( -0.0f ), 0x8000 );
+}
+
+//! bfloat16 rounds to nearest even, and fixed point saturates
+inline void test_reduced_precision_edges()
+{
+  std::vector<float> in = { 1.0f, 1.0f + 1.0f / 256, 1.0f + 3.0f / 256, std::numeric_limits<float>::quiet_NaN(),
+                            -1.0f - 3.0f / 256, std::numeric_limits<float>::max(), -std::numeric_limits<float>::infinity(), -0.0f };
+  std::mt19937 gen( 1 );
+  for( int i = 0; i < 1001; ++i )
+    in.push_back( std::ldexp( std::uniform_real_distribution<float>( -1, 1 )( gen ), static_cast<int>( gen() % 200 ) - 100 ) );
+
+  std::vector<std::uint16_t> out( in.size() );
+  cereal::reduced_precision_detail::encode_bfloat16( in.data(), out.data(), in.size() );
+  CHECK_EQ( out[0], 0x3F80 );
+  CHECK_EQ( out[1], 0x3F80 );
+  CHECK_EQ( out[2], 0x3F82 );
+  CHECK_UNARY( ( out[3] & 0x7F80u ) == 0x7F80u && ( out[3] & 0x7Fu ) != 0 );
+  CHECK_EQ( out[4], 0xBF82 );
+  CHECK_EQ( out[5], 0x7F80 );
+  CHECK_EQ( out[6], 0xFF80 );
+  CHECK_EQ( out[7], 0x8000 );
+
+  std::vector<float> decoded( out.size() );
+  cereal::reduced_precision_detail::decode_bfloat16( out.data(), decoded.data(), out.size() );
+  size_t mismatches = 0;
+  for( size_t i = 8; i < in.size(); ++i )
+  {
+    // the nearest bfloat16 is within half a unit in the last place
+    float const ulp = std::ldexp( 1.0f, std::ilogb( in[i] ) - 7 );
+    if( std::abs( decoded[i] - in[i] ) > ulp / 2 ) ++mismatches;
+    if( cereal::reduced_precision_detail::float_bits( decoded[i] ) >> 16 != out[i] ) ++mismatches;
+  }
+  CHECK_EQ( mismatches, 0 );
+
+  double const values[] = { 1e10, -1e10, std::numeric_limits<double>::quiet_NaN(), -0.015 };
+  std::int8_t fixed[4];
+  cereal::FixedPointFormat<std::int8_t>{ 0.01 }.encode( values, fixed, 4 );
+  CHECK_EQ( fixed[0], 127 );
+  CHECK_EQ( fixed[1], -128 );
+  CHECK_EQ( fixed[2], 0 );
+  CHECK_EQ( fixed[3], -2 );
+}
+
+#endif // CEREAL_TEST_REDUCED_PRECISION_H_
@@ -0,0 +1,273 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_RELOAD_H_
+#define CEREAL_TEST_RELOAD_H_
+#include "common.hpp"
+
+//! Counts the allocations made through ReloadAllocator
+inline std::size_t & reload_allocations()
+{
+  static std::size_t count = 0;
+  return count;
+}
+
+template <class T>
+struct ReloadAllocator
+{
+  using value_type = T;
+
+  ReloadAllocator() = default;
+  template <class U> ReloadAllocator( ReloadAllocator<U> const & ) {}
+
+  T * allocate( std::size_t n )
+  {
+    ++reload_allocations();
+    return std::allocator<T>().allocate( n );
+  }
+
+  void deallocate( T * p, std::size_t n )
+  {
+    std::allocator<T>().deallocate( p, n );
+  }
+
+  template <class U> bool operator==( ReloadAllocator<U> const & ) const { return true; }
+  template <class U> bool operator!=( ReloadAllocator<U> const & ) const { return false; }
+};
+
+using ReloadString = std::basic_string<char, std::char_traits<char>, ReloadAllocator<char>>;
+using ReloadVector = std::vector<std::int32_t, ReloadAllocator<std::int32_t>>;
+
+template <class K, class V>
+using ReloadPair = std::pair<K const, V>;
+
+//! State that is reloaded periodically, made of containers that allocate through ReloadAllocator
+struct ReloadState
+{
+  std::map<ReloadString, ReloadVector, std::less<ReloadString>, ReloadAllocator<ReloadPair<ReloadString, ReloadVector>>> map;
+  std::multimap<std::int32_t, ReloadString, std::less<std::int32_t>, ReloadAllocator<ReloadPair<std::int32_t, ReloadString>>> multimap;
+  std::set<ReloadString, std::less<ReloadString>, ReloadAllocator<ReloadString>> set;
+  std::list<ReloadString, ReloadAllocator<ReloadString>> list;
+  std::forward_list<ReloadVector, ReloadAllocator<ReloadVector>> forward_list;
+  std::deque<std::int32_t, ReloadAllocator<std::int32_t>> deque;
+  std::vector<ReloadString, ReloadAllocator<ReloadString>> strings;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( map, multimap, set, list, forward_list, deque, strings ); }
+
+  bool operator==( ReloadState const & other ) const
+  {
+    // equal keys of a multimap may be loaded in a different order
+    return map == other.map && multimap.size() == other.multimap.size() &&
+           std::is_permutation( multimap.begin(), multimap.end(), other.multimap.begin() ) && set == other.set && list == other.list &&
+           forward_list == other.forward_list && deque == other.deque && strings == other.strings;
+  }
+};
+
+//! The unordered part of the state, whose loading may allocate a bucket array per container
+struct ReloadUnorderedState
+{
+  std::unordered_map<std::int32_t, ReloadString, std::hash<std::int32_t>, std::equal_to<std::int32_t>,
+                     ReloadAllocator<ReloadPair<std::int32_t, ReloadString>>> map;
+  std::unordered_multiset<std::int64_t, std::hash<std::int64_t>, std::equal_to<std::int64_t>, ReloadAllocator<std::int64_t>> set;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( map, set ); }
+};
+
+//! Random contents with strings and vectors of a fixed length, so that reloading never needs more capacity
+template <class Generator> inline
+ReloadString random_reload_string( Generator & gen )
+{
+  ReloadString s( 40, ' ' );
+  for( auto & c : s )
+    c = static_cast<char>( 'a' + gen() % 26 );
+  return s;
+}
+
+template <class Generator> inline
+ReloadVector random_reload_vector( Generator & gen )
+{
+  ReloadVector v( 16 );
+  for( auto & i : v )
+    i = random_value<std::int32_t>( gen );
+  return v;
+}
+
+template <class Generator> inline
+ReloadState random_reload_state( Generator & gen )
+{
+  ReloadState state;
+  while( state.map.size() < 50 )
+    state.map.emplace( random_reload_string( gen ), random_reload_vector( gen ) );
+  for( int i = 0; i < 50; ++i )
+    state.multimap.emplace( random_value<std::int32_t>( gen ) % 10, random_reload_string( gen ) );
+  while( state.set.size() < 50 )
+    state.set.insert( random_reload_string( gen ) );
+  for( int i = 0; i < 50; ++i )
+  {
+    state.list.push_back( random_reload_string( gen ) );
+    state.forward_list.push_front( random_reload_vector( gen ) );
+    state.deque.push_back( random_value<std::int32_t>( gen ) );
+    state.strings.push_back( random_reload_string( gen ) );
+  }
+  return state;
+}
+
+template <class Generator> inline
+ReloadUnorderedState random_reload_unordered_state( Generator & gen )
+{
+  ReloadUnorderedState state;
+  while( state.map.size() < 50 )
+    state.map.emplace( random_value<std::int32_t>( gen ), random_reload_string( gen ) );
+  for( int i = 0; i < 50; ++i )
+    state.set.insert( random_value<std::int64_t>( gen ) % 20 );
+  return state;
+}
+
+template <class OArchive, class T> inline
+std::string reload_save( T const & data )
+{
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( data );
+  }
+  return os.str();
+}
+
+template <class IArchive, class T> inline
+void reload_load( std::string const & data, T & target, bool reuse )
+{
+  std::istringstream is(data);
+  IArchive iar(is);
+  iar.setReuseStorage( reuse );
+  iar( target );
+}
+
+//! Reloading data of the same shape reuses the nodes, strings and vectors that were already loaded
+template <class IArchive, class OArchive> inline
+void test_reload()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 10; ++ii )
+  {
+    ReloadState const first = random_reload_state( gen );
+    ReloadState const second = random_reload_state( gen );
+    auto const firstData = reload_save<OArchive>( first );
+    auto const secondData = reload_save<OArchive>( second );
+
+    ReloadState state;
+    reload_load<IArchive>( firstData, state, true );
+    CHECK( state == first );
+
+    reload_allocations() = 0;
+    reload_load<IArchive>( secondData, state, true );
+    CHECK( state == second );
+    #ifdef CEREAL_HAS_CPP17
+    CHECK_EQ( reload_allocations(), 0 );
+    #endif
+
+    reload_load<IArchive>( firstData, state, true );
+    CHECK( state == first );
+
+    // without reusing storage, the result is the same
+    reload_load<IArchive>( secondData, state, false );
+    CHECK( state == second );
+
+    ReloadUnorderedState const u_first = random_reload_unordered_state( gen );
+    ReloadUnorderedState const u_second = random_reload_unordered_state( gen );
+    auto const u_secondData = reload_save<OArchive>( u_second );
+
+    ReloadUnorderedState u_state;
+    reload_load<IArchive>( reload_save<OArchive>( u_first ), u_state, true );
+    CHECK( u_state.map == u_first.map );
+    CHECK( u_state.set == u_first.set );
+
+    reload_allocations() = 0;
+    reload_load<IArchive>( u_secondData, u_state, true );
+    CHECK( u_state.map == u_second.map );
+    CHECK( u_state.set == u_second.set );
+    #ifdef CEREAL_HAS_CPP17
+    CHECK_LE( reload_allocations(), 2 );
+    #endif
+  }
+}
+
+//! Reloading data of a different shape frees or allocates the difference
+template <class IArchive, class OArchive> inline
+void test_reload_resize()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for( int ii = 0; ii < 10; ++ii )
+  {
+    ReloadState large = random_reload_state( gen );
+    ReloadState small = random_reload_state( gen );
+
+    auto map = small.map.begin();
+    std::advance( map, random_index( 0, small.map.size(), gen ) );
+    small.map.erase( map, small.map.end() );
+    small.multimap.erase( small.multimap.begin(), small.multimap.find( 5 ) );
+    small.set.clear();
+    small.list.resize( random_index( 0, 50, gen ) );
+    small.forward_list.resize( random_index( 0, 50, gen ) );
+    small.deque.resize( random_index( 0, 50, gen ) );
+    small.strings.resize( random_index( 0, 50, gen ) );
+    for( auto & s : small.strings )
+      s.resize( random_index( 0, 80, gen ), 'x' );
+
+    auto const largeData = reload_save<OArchive>( large );
+    auto const smallData = reload_save<OArchive>( small );
+
+    ReloadState state;
+    reload_load<IArchive>( largeData, state, true );
+    CHECK( state == large );
+    reload_load<IArchive>( smallData, state, true );
+    CHECK( state == small );
+    reload_load<IArchive>( largeData, state, true );
+    CHECK( state == large );
+
+    ReloadUnorderedState u_large = random_reload_unordered_state( gen );
+    ReloadUnorderedState u_small;
+    u_small.map.insert( u_large.map.begin(), std::next( u_large.map.begin(), random_index( 0, 50, gen ) ) );
+
+    ReloadUnorderedState u_state;
+    reload_load<IArchive>( reload_save<OArchive>( u_small ), u_state, true );
+    CHECK( u_state.map == u_small.map );
+    CHECK( u_state.set == u_small.set );
+    reload_load<IArchive>( reload_save<OArchive>( u_large ), u_state, true );
+    CHECK( u_state.map == u_large.map );
+    CHECK( u_state.set == u_large.set );
+  }
+}
+
+#endif // CEREAL_TEST_RELOAD_H_
@@ -0,0 +1,122 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_SNAPSHOT_H_
+#define CEREAL_TEST_SNAPSHOT_H_
+#include "common.hpp"
+#include <cereal/snapshot.hpp>
+
+#ifdef CEREAL_HAS_FORK_SNAPSHOT
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+//! A type that takes a long time to save, used to trigger snapshot timeouts
+struct SlowToSave
+{
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    std::this_thread::sleep_for( std::chrono::seconds(5) );
+    ar( value );
+  }
+
+  int value = 0;
+};
+
+template <class IArchive, class OArchive> inline
+void test_snapshot()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  std::string const path = "cereal_test_snapshot_" + std::to_string( ::getpid() );
+
+  std::map<std::string, int> o_map;
+  for(int i = 0; i < 1000; ++i)
+    o_map[random_value<std::string>(gen)] = random_value<int>(gen);
+  std::vector<StructInternalSerialize> o_vector;
+  for(int i = 0; i < 100; ++i)
+    o_vector.emplace_back( random_value<int>(gen), random_value<int>(gen) );
+
+  auto snapshot = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions().progressInterval( 64 ), o_map, o_vector );
+
+  // Changes made after the fork must not be visible in the snapshot
+  auto const expected_map = o_map;
+  o_map.clear();
+
+  CHECK_EQ( snapshot.wait(), cereal::SnapshotStatus::Completed );
+  CHECK( snapshot.error().empty() );
+  CHECK_GT( snapshot.bytesWritten(), 0u );
+
+  std::map<std::string, int> i_map;
+  std::vector<StructInternalSerialize> i_vector;
+  {
+    std::ifstream is( path, std::ios::binary );
+    IArchive iar(is);
+    iar( i_map, i_vector );
+  }
+  std::remove( path.c_str() );
+
+  check_collection( i_map, expected_map );
+  check_collection( i_vector, o_vector );
+}
+
+template <class OArchive> inline
+void test_snapshot_limits()
+{
+  std::string const path = "cereal_test_snapshot_limits_" + std::to_string( ::getpid() );
+
+  SlowToSave slow;
+  auto timed = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions().timeout( std::chrono::milliseconds(50) ), slow );
+  CHECK_EQ( timed.wait(), cereal::SnapshotStatus::TimedOut );
+
+  auto cancelled = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions(), slow );
+  CHECK_EQ( cancelled.poll(), cereal::SnapshotStatus::Running );
+  cancelled.cancel();
+  CHECK_EQ( cancelled.status(), cereal::SnapshotStatus::Cancelled );
+
+  // Available memory is only known on platforms with /proc/meminfo, elsewhere the limit has no effect
+  std::uint64_t available;
+  if( cereal::snapshot_detail::availableMemory( available ) )
+  {
+    auto starved = cereal::fork_snapshot<OArchive>( path, cereal::SnapshotOptions().minAvailableMemory( ~std::uint64_t(0) ), slow );
+    CHECK_EQ( starved.status(), cereal::SnapshotStatus::MemoryPressure );
+    CHECK_EQ( starved.pid(), -1 );
+  }
+
+  std::ifstream is( path );
+  CHECK( !is.good() );
+
+  auto failed = cereal::fork_snapshot<OArchive>( "/nonexistent_cereal_directory/snapshot", cereal::SnapshotOptions(), 42 );
+  CHECK_EQ( failed.wait(), cereal::SnapshotStatus::Failed );
+  CHECK( !failed.error().empty() );
+}
+
+#endif // CEREAL_HAS_FORK_SNAPSHOT
+
+#endif // CEREAL_TEST_SNAPSHOT_H_
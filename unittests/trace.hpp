@@ -0,0 +1,182 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_TRACE_H_
+#define CEREAL_TEST_TRACE_H_
+#include "common.hpp"
+
+struct TraceBase
+{
+  virtual ~TraceBase() {}
+  virtual void foo() = 0;
+};
+
+struct TraceDerived : TraceBase
+{
+  TraceDerived() = default;
+  TraceDerived( int xx ) : x( xx ) {}
+
+  int x = 0;
+
+  void foo() override {}
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( x ); }
+};
+
+CEREAL_REGISTER_TYPE(TraceDerived)
+CEREAL_REGISTER_POLYMORPHIC_RELATION(TraceBase, TraceDerived)
+
+struct TraceData
+{
+  std::vector<int> v;
+  std::shared_ptr<TraceBase> p;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( v, p ); }
+};
+
+struct TraceTestRecord
+{
+  cereal::TraceRecord record;
+  std::string name;
+};
+
+inline std::vector<TraceTestRecord> & traceTestRecords()
+{
+  static std::vector<TraceTestRecord> records;
+  return records;
+}
+
+inline void traceTestHook( cereal::TraceRecord const & record )
+{
+  traceTestRecords().push_back( { record, record.typeName } );
+}
+
+inline std::size_t traceTestCount( std::vector<TraceTestRecord> const & records, cereal::TraceEvent event )
+{
+  return static_cast<std::size_t>( std::count_if( records.begin(), records.end(),
+                                                  [&]( TraceTestRecord const & r ) { return r.record.event == event; } ) );
+}
+
+inline std::uint64_t traceTestBytes( std::vector<TraceTestRecord> const & records, cereal::TraceEvent event )
+{
+  std::uint64_t bytes = 0;
+  for( auto const & r : records )
+    if( r.record.event == event )
+      bytes += r.record.bytes;
+  return bytes;
+}
+
+inline TraceTestRecord const & traceTestFind( std::vector<TraceTestRecord> const & records, cereal::TraceEvent event )
+{
+  auto iter = std::find_if( records.begin(), records.end(),
+                            [&]( TraceTestRecord const & r ) { return r.record.event == event; } );
+  REQUIRE( iter != records.end() );
+  return *iter;
+}
+
+template <class IArchive, class OArchive> inline
+void test_trace( bool countsBytes )
+{
+  TraceData o_data;
+  o_data.v = { 1, 2, 3, 4, 5 };
+  o_data.p = std::make_shared<TraceDerived>( 7 );
+
+  CHECK_UNARY( cereal::getTraceHook() == nullptr );
+  cereal::setTraceHook( traceTestHook );
+  CHECK_UNARY( cereal::getTraceHook() == &traceTestHook );
+
+  traceTestRecords().clear();
+  std::ostringstream os;
+  {
+    OArchive oar(os);
+    oar( o_data );
+  }
+  auto const saveRecords = traceTestRecords();
+
+  traceTestRecords().clear();
+  TraceData i_data;
+  {
+    std::istringstream is(os.str());
+    IArchive iar(is);
+    iar( i_data );
+  }
+  auto const loadRecords = traceTestRecords();
+
+  cereal::setTraceHook( nullptr );
+
+  REQUIRE( i_data.p );
+  CHECK_EQ( i_data.v, o_data.v );
+  CHECK_EQ( dynamic_cast<TraceDerived &>( *i_data.p ).x, 7 );
+
+  auto const dataId = cereal::detail::type_index_of<TraceData>().hash_code();
+  auto const derivedId = cereal::detail::type_index_of<TraceDerived>().hash_code();
+
+  // Saving
+  REQUIRE( saveRecords.size() >= 5 );
+  CHECK_UNARY( saveRecords.front().record.event == cereal::TraceEvent::ArchiveCreated );
+  CHECK_UNARY( saveRecords.back().record.event == cereal::TraceEvent::ArchiveDestroyed );
+  CHECK_EQ( saveRecords.front().record.typeId, cereal::detail::type_index_of<OArchive>().hash_code() );
+  for( auto const & r : saveRecords )
+    CHECK_UNARY( !r.record.input );
+
+  // Only outermost calls are reported, which includes the call made by the portable
+  // binary archive to save its endianness
+  CHECK_EQ( traceTestCount( saveRecords, cereal::TraceEvent::CallBegin ), traceTestCount( saveRecords, cereal::TraceEvent::CallEnd ) );
+  CHECK_EQ( saveRecords[saveRecords.size() - 2].record.event, cereal::TraceEvent::CallEnd );
+  CHECK_EQ( saveRecords[saveRecords.size() - 2].record.typeId, dataId );
+
+  CHECK_EQ( traceTestCount( saveRecords, cereal::TraceEvent::PolymorphicSave ), 1u );
+  CHECK_EQ( traceTestFind( saveRecords, cereal::TraceEvent::PolymorphicSave ).record.typeId, derivedId );
+
+  // Loading
+  REQUIRE( loadRecords.size() >= 5 );
+  CHECK_UNARY( loadRecords.front().record.event == cereal::TraceEvent::ArchiveCreated );
+  CHECK_UNARY( loadRecords.back().record.event == cereal::TraceEvent::ArchiveDestroyed );
+  for( auto const & r : loadRecords )
+    CHECK_UNARY( r.record.input );
+
+  CHECK_EQ( traceTestCount( loadRecords, cereal::TraceEvent::CallBegin ), traceTestCount( loadRecords, cereal::TraceEvent::CallEnd ) );
+  CHECK_EQ( loadRecords[loadRecords.size() - 2].record.event, cereal::TraceEvent::CallEnd );
+  CHECK_EQ( loadRecords[loadRecords.size() - 2].record.typeId, dataId );
+
+  CHECK_EQ( traceTestCount( loadRecords, cereal::TraceEvent::PolymorphicLoad ), 1u );
+  CHECK_EQ( traceTestFind( loadRecords, cereal::TraceEvent::PolymorphicLoad ).name, "TraceDerived" );
+
+  CHECK_EQ( traceTestFind( loadRecords, cereal::TraceEvent::SizeTag ).record.bytes, o_data.v.size() );
+
+  // Byte counts
+  auto const saved = countsBytes ? os.str().size() : 0;
+  CHECK_EQ( traceTestBytes( saveRecords, cereal::TraceEvent::CallEnd ), saved );
+  CHECK_EQ( saveRecords.back().record.bytes, saved );
+  CHECK_EQ( traceTestBytes( loadRecords, cereal::TraceEvent::CallEnd ), saved );
+  CHECK_EQ( loadRecords.back().record.bytes, saved );
+}
+
+#endif // CEREAL_TEST_TRACE_H_
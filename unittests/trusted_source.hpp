@@ -0,0 +1,99 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_TRUSTED_SOURCE_H_
+#define CEREAL_TEST_TRUSTED_SOURCE_H_
+#include "common.hpp"
+
+template <class IArchive, class OArchive> inline
+void test_trusted_source()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    std::priority_queue<int> o_priority_queue;
+    std::priority_queue<StructInternalSerialize> o_ser_priority_queue;
+    std::map<std::string, int> o_map;
+    std::multimap<int, StructInternalSerialize> o_multimap;
+    std::set<StructExternalSplit> o_set;
+    std::multiset<int> o_multiset;
+
+    for(int j=0; j<100; ++j)
+    {
+      o_priority_queue.push( random_value<int>(gen) );
+      o_ser_priority_queue.push( { random_value<int>(gen), random_value<int>(gen) } );
+      o_map.emplace( random_value<std::string>(gen), random_value<int>(gen) );
+      o_multimap.emplace( random_value<int>(gen) % 10, StructInternalSerialize{ random_value<int>(gen), random_value<int>(gen) } );
+      o_set.insert( { random_value<int>(gen), random_value<int>(gen) } );
+      o_multiset.insert( random_value<int>(gen) % 10 );
+    }
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      oar(o_priority_queue, o_ser_priority_queue, o_map, o_multimap, o_set, o_multiset);
+    }
+
+    std::priority_queue<int> i_priority_queue;
+    std::priority_queue<StructInternalSerialize> i_ser_priority_queue;
+    std::map<std::string, int> i_map;
+    std::multimap<int, StructInternalSerialize> i_multimap;
+    std::set<StructExternalSplit> i_set;
+    std::multiset<int> i_multiset;
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+      CHECK_FALSE( iar.isTrustedSource() );
+      iar.setTrustedSource( true );
+      CHECK( iar.isTrustedSource() );
+
+      iar(i_priority_queue, i_ser_priority_queue, i_map, i_multimap, i_set, i_multiset);
+    }
+
+    check_collection( cereal::queue_detail::container( i_priority_queue ),
+                      cereal::queue_detail::container( o_priority_queue ) );
+    check_collection( cereal::queue_detail::container( i_ser_priority_queue ),
+                      cereal::queue_detail::container( o_ser_priority_queue ) );
+    check_collection( i_map, o_map );
+    check_collection( i_multimap, o_multimap );
+    check_collection( i_set, o_set );
+    check_collection( i_multiset, o_multiset );
+
+    // Heap order must still hold after the trusted load
+    while( !o_priority_queue.empty() )
+    {
+      CHECK_EQ( i_priority_queue.top(), o_priority_queue.top() );
+      i_priority_queue.pop();
+      o_priority_queue.pop();
+    }
+  }
+}
+
+#endif // CEREAL_TEST_TRUSTED_SOURCE_H_
@@ -102,6 +102,34 @@ void test_user_data_adapters()
       cereal::UserDataAdapter<UserData, IArchive> iar(ud, is);
 
       iar(i_ptr);
+
+      CHECK_EQ( &cereal::get_user_data<UserData>( iar ), &ud );
+      CHECK_THROWS_AS( cereal::get_user_data<SomeStruct>( iar ), ::cereal::Exception );
+    }
+
+    std::istringstream const_is(os.str());
+    {
+      SomeStruct const cs{};
+      cereal::UserDataAdapter<SomeStruct const, IArchive> iar(cs, const_is);
+
+      CHECK_EQ( &cereal::get_user_data<SomeStruct const>( iar ), &cs );
+      CHECK_THROWS_AS( cereal::get_user_data<SomeStruct>( iar ), ::cereal::Exception );
+    }
+
+    // nested adapters keep the user data of the adapters they wrap
+    std::istringstream nested_is(os.str());
+    {
+      UserData ud(&ss, ss);
+      SomeStruct const cs{};
+      cereal::UserDataAdapter<SomeStruct const, cereal::UserDataAdapter<UserData, IArchive>> iar(cs, ud, nested_is);
+
+      decltype( o_ptr ) n_ptr;
+      iar(n_ptr);
+      CHECK_EQ( n_ptr->i32, o_ptr->i32 );
+
+      CHECK_EQ( &cereal::get_user_data<UserData>( iar ), &ud );
+      CHECK_EQ( &cereal::get_user_data<SomeStruct const>( iar ), &cs );
+      CHECK_THROWS_AS( cereal::get_user_data<SomeStruct>( iar ), ::cereal::Exception );
     }
 
     CHECK_EQ( i_ptr->p, o_ptr->p );
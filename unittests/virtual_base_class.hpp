@@ -0,0 +1,147 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_VIRTUAL_BASE_CLASS_H_
+#define CEREAL_TEST_VIRTUAL_BASE_CLASS_H_
+#include "common.hpp"
+
+struct VirtualBaseRoot
+{
+  VirtualBaseRoot() : w(0) {}
+  VirtualBaseRoot( int ww ) : w(ww) {}
+  int w;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( w );
+  }
+};
+
+struct VirtualBaseLeft : virtual VirtualBaseRoot
+{
+  VirtualBaseLeft() : x(0) {}
+  int x;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::virtual_base_class<VirtualBaseRoot>( this ), x );
+  }
+};
+
+struct VirtualBaseRight : virtual VirtualBaseRoot
+{
+  VirtualBaseRight() : y(0) {}
+  int y;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::virtual_base_class<VirtualBaseRoot>( this ), y );
+  }
+};
+
+struct VirtualBaseDiamond : VirtualBaseLeft, VirtualBaseRight
+{
+  VirtualBaseDiamond() : z(0) {}
+  VirtualBaseDiamond( int ww, int xx, int yy, int zz ) : VirtualBaseRoot( ww ), z(zz)
+  {
+    x = xx;
+    y = yy;
+  }
+
+  int z;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  {
+    ar( cereal::base_class<VirtualBaseLeft>( this ),
+        cereal::base_class<VirtualBaseRight>( this ),
+        z );
+  }
+
+  bool operator==( VirtualBaseDiamond const & other ) const
+  {
+    return w == other.w && x == other.x && y == other.y && z == other.z;
+  }
+};
+
+inline std::ostream& operator<<(std::ostream& os, VirtualBaseDiamond const & d)
+{
+  os << "[w: " << d.w << " x: " << d.x << " y: " << d.y << " z: " << d.z << "]";
+  return os;
+}
+
+template <class IArchive, class OArchive> inline
+void test_virtual_base_class()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  auto rng = [&](){ return random_value<int>(gen); };
+
+  for(int ii=0; ii<100; ++ii)
+  {
+    VirtualBaseDiamond o_diamond( rng(), rng(), rng(), rng() );
+    std::vector<VirtualBaseDiamond> o_diamonds;
+    for(int j=0; j<100; ++j)
+      o_diamonds.emplace_back( rng(), rng(), rng(), rng() );
+
+    std::ostringstream os;
+    {
+      OArchive oar(os);
+
+      // Serializing the same object in separate calls must write its virtual base each time
+      oar( o_diamond );
+      oar( o_diamond );
+      oar( o_diamonds );
+      for( auto const & d : o_diamonds )
+        oar( d );
+    }
+
+    VirtualBaseDiamond i_diamond1, i_diamond2;
+    std::vector<VirtualBaseDiamond> i_diamonds, i_streamed( o_diamonds.size() );
+
+    std::istringstream is(os.str());
+    {
+      IArchive iar(is);
+
+      iar( i_diamond1 );
+      iar( i_diamond2 );
+      iar( i_diamonds );
+      for( auto & d : i_streamed )
+        iar( d );
+    }
+
+    CHECK_EQ( i_diamond1, o_diamond );
+    CHECK_EQ( i_diamond2, o_diamond );
+    check_collection( i_diamonds, o_diamonds );
+    check_collection( i_streamed, o_diamonds );
+  }
+}
+
+#endif // CEREAL_TEST_VIRTUAL_BASE_CLASS_H_
@@ -0,0 +1,67 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "xml_stream.hpp"
+
+TEST_SUITE_BEGIN("xml_stream");
+
+TEST_CASE("xml_dom_reference")
+{
+  test_xml_stream<cereal::XMLInputArchive>();
+}
+
+TEST_CASE("xml_stream")
+{
+  test_xml_stream<cereal::XMLStreamInputArchive>();
+}
+
+TEST_CASE("xml_stream_skip")
+{
+  test_xml_stream_skip();
+}
+
+TEST_CASE("xml_stream_markup")
+{
+  test_xml_stream_markup();
+}
+
+TEST_CASE("xml_stream_forward_only")
+{
+  test_xml_stream_forward_only();
+}
+
+TEST_CASE("xml_dom_truncated")
+{
+  test_xml_stream_truncated<cereal::XMLInputArchive>();
+}
+
+TEST_CASE("xml_stream_truncated")
+{
+  test_xml_stream_truncated<cereal::XMLStreamInputArchive>();
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,265 @@
+/*
+  Copyright (c) 2014, Randolph Voorhies, Shane Grant
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+      * Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the name of cereal nor the
+        names of its contributors may be used to endorse or promote products
+        derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL RANDOLPH VOORHIES AND SHANE GRANT BE LIABLE FOR ANY
+  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef CEREAL_TEST_XML_STREAM_H_
+#define CEREAL_TEST_XML_STREAM_H_
+#include "common.hpp"
+#include <cereal/archives/xml_stream.hpp>
+
+struct XMLStreamBase
+{
+  virtual ~XMLStreamBase() = default;
+  virtual int value() const = 0;
+
+  template <class Archive>
+  void serialize( Archive & )
+  { }
+};
+
+struct XMLStreamDerived : XMLStreamBase
+{
+  XMLStreamDerived( int xx = 0 ) : x( xx ) { }
+  int x;
+
+  int value() const override { return x; }
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( cereal::base_class<XMLStreamBase>( this ), CEREAL_NVP( x ) ); }
+};
+
+CEREAL_REGISTER_TYPE(XMLStreamDerived)
+
+struct XMLStreamRecord
+{
+  int id = 0;
+  std::string name;
+  std::vector<double> values;
+  std::map<std::string, int> tags;
+  std::shared_ptr<XMLStreamBase> poly;
+
+  template <class Archive>
+  void serialize( Archive & ar )
+  { ar( CEREAL_NVP(id), CEREAL_NVP(name), CEREAL_NVP(values), CEREAL_NVP(tags), CEREAL_NVP(poly) ); }
+
+  bool operator==( XMLStreamRecord const & other ) const
+  {
+    return id == other.id && name == other.name && values == other.values && tags == other.tags &&
+           ( poly ? other.poly && poly->value() == other.poly->value() : !other.poly );
+  }
+};
+
+//! Forwards reads to a string but cannot seek
+struct XMLStreamForwardOnlyBuf : std::streambuf
+{
+  XMLStreamForwardOnlyBuf( std::string & s )
+  { setg( &s[0], &s[0], &s[0] + s.size() ); }
+};
+
+//! Saves with the XMLOutputArchive and loads with IArchive
+template <class IArchive> inline
+void test_xml_stream()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for(int ii=0; ii<10; ++ii)
+  {
+    std::vector<XMLStreamRecord> o_records( 20 );
+    for( auto & r : o_records )
+    {
+      r.id = random_value<int>( gen );
+      r.name = random_basic_string<char>( gen );
+      for( int j = 0; j < 5; ++j )
+        r.values.push_back( random_value<double>( gen ) );
+      r.tags[random_basic_string<char>( gen )] = random_value<int>( gen );
+      if( random_value<int>( gen ) % 2 )
+        r.poly = std::make_shared<XMLStreamDerived>( random_value<int>( gen ) );
+    }
+
+    std::vector<std::vector<int>> o_nested = { {}, { 1 }, { 2, 3, 4 } };
+    std::unordered_map<std::string, std::vector<int>> o_unordered = { { "a", { 1, 2 } }, { "b", {} } };
+    std::string const o_padded = "  padded\t";
+    std::string const o_special = "<a & 'b'> \"c\"";
+    std::string const o_empty;
+    char const o_char = 'z';
+    int8_t const o_int8 = -12;
+    uint8_t const o_uint8 = 250;
+    bool const o_bool = true;
+    long double const o_ldouble = random_value<long double>( gen );
+    std::array<int, 4> const o_binary = {{ 1, -2, 3, -4 }};
+
+    std::ostringstream os;
+    {
+      cereal::XMLOutputArchive oar( os );
+      oar( cereal::make_nvp( "records", o_records ), o_nested, o_unordered );
+      oar( o_padded, o_special, o_empty, o_char, o_int8, o_uint8, o_bool, o_ldouble );
+      oar.saveBinaryValue( o_binary.data(), sizeof(o_binary), "binary" );
+    }
+
+    std::vector<XMLStreamRecord> i_records;
+    std::vector<std::vector<int>> i_nested;
+    std::unordered_map<std::string, std::vector<int>> i_unordered;
+    std::string i_padded, i_special, i_empty = "not empty";
+    char i_char;
+    int8_t i_int8;
+    uint8_t i_uint8;
+    bool i_bool;
+    long double i_ldouble;
+    std::array<int, 4> i_binary;
+
+    std::istringstream is( os.str() );
+    {
+      IArchive iar( is );
+      iar( cereal::make_nvp( "records", i_records ), i_nested, i_unordered );
+      iar( i_padded, i_special, i_empty, i_char, i_int8, i_uint8, i_bool, i_ldouble );
+      iar.loadBinaryValue( i_binary.data(), sizeof(i_binary), "binary" );
+    }
+
+    CHECK_UNARY( i_records == o_records );
+    CHECK_UNARY( i_nested == o_nested );
+    CHECK_UNARY( i_unordered == o_unordered );
+    CHECK_EQ( i_padded, o_padded );
+    CHECK_EQ( i_special, o_special );
+    CHECK_EQ( i_empty, o_empty );
+    CHECK_EQ( i_char, o_char );
+    CHECK_EQ( i_int8, o_int8 );
+    CHECK_EQ( i_uint8, o_uint8 );
+    CHECK_EQ( i_bool, o_bool );
+    CHECK_EQ( i_ldouble, doctest::Approx( o_ldouble ).epsilon( 1e-5L ) );
+    CHECK_UNARY( i_binary == o_binary );
+  }
+}
+
+//! NVPs that do not match skip forward, but never backward
+inline void test_xml_stream_skip()
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os );
+    oar( cereal::make_nvp( "a", 1 ), cereal::make_nvp( "b", std::vector<int>{ 2, 3 } ), cereal::make_nvp( "c", 4 ), cereal::make_nvp( "d", 5 ) );
+  }
+
+  int a = 0, c = 0;
+  std::istringstream is( os.str() );
+  cereal::XMLStreamInputArchive iar( is );
+  iar( cereal::make_nvp( "a", a ), cereal::make_nvp( "c", c ) );
+  CHECK_EQ( a, 1 );
+  CHECK_EQ( c, 4 );
+  CHECK_EQ( std::string( iar.getNodeName() ), "d" );
+  CHECK_THROWS_AS( iar( cereal::make_nvp( "a", a ) ), cereal::Exception );
+}
+
+//! Hand written input with entities, comments and attributes in either quoting style
+inline void test_xml_stream_markup()
+{
+  std::string const input =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- leading comment -->\n"
+    "<cereal>\n"
+    "  <value0 type='int' >  42  </value0>\n"
+    "  <!-- a comment between values -->\n"
+    "  <value1 xml:space=\"preserve\"> &lt;&#65;&#x42;&amp;&#xE9;&gt; </value1>\n"
+    "  <value2 size=\"dynamic\"><value0>1</value0><value1/><value2>3</value2></value2>\n"
+    "</cereal>\n";
+
+  int i = 0;
+  std::string s;
+  std::vector<std::string> v;
+  std::istringstream is( input );
+  {
+    cereal::XMLStreamInputArchive iar( is );
+    iar( i, s, v );
+  }
+
+  CHECK_EQ( i, 42 );
+  CHECK_EQ( s, " <AB&\xC3\xA9> " );
+  CHECK_UNARY( v == std::vector<std::string>( { "1", "", "3" } ) );
+
+  std::istringstream bad( "<root><value0>1</value0></root>" );
+  CHECK_THROWS_AS( cereal::XMLStreamInputArchive iar( bad ), cereal::Exception );
+}
+
+//! Values load from any stream, container sizes require seeking
+inline void test_xml_stream_forward_only()
+{
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os );
+    oar( 7, std::vector<int>{ 1, 2 } );
+  }
+
+  std::string data = os.str();
+  XMLStreamForwardOnlyBuf buf( data );
+  std::istream is( &buf );
+
+  int i = 0;
+  std::vector<int> v;
+  cereal::XMLStreamInputArchive iar( is );
+  iar( i );
+  CHECK_EQ( i, 7 );
+  CHECK_THROWS_AS( iar( v ), cereal::Exception );
+}
+
+//! Every truncation of the input either loads everything or records an error, without throwing
+template <class IArchive> inline
+void test_xml_stream_truncated()
+{
+  std::vector<XMLStreamRecord> o_records( 2 );
+  o_records[0].id = 1;
+  o_records[0].name = "a <b> & 'c'";
+  o_records[0].values = { 1.5, -2.0 };
+  o_records[0].tags["x"] = 3;
+  o_records[1].poly = std::make_shared<XMLStreamDerived>( 4 );
+
+  std::ostringstream os;
+  {
+    cereal::XMLOutputArchive oar( os );
+    oar( cereal::make_nvp( "records", o_records ) );
+  }
+
+  auto const full = os.str();
+  for( std::size_t size = 0; size <= full.size(); ++size )
+  {
+    std::istringstream is( full.substr( 0, size ) );
+
+    // the root node is found when the archive is constructed, before it can be told not to throw
+    std::unique_ptr<IArchive> iar;
+    try { iar.reset( new IArchive( is ) ); }
+    catch( cereal::Exception const & ) { continue; }
+
+    iar->setThrowOnError( false );
+    std::vector<XMLStreamRecord> i_records;
+    (*iar)( cereal::make_nvp( "records", i_records ) );
+
+    if( iar->ok() )
+      CHECK_UNARY( i_records == o_records );
+    else
+      CHECK_UNARY( iar->error() != nullptr );
+  }
+}
+
+#endif // CEREAL_TEST_XML_STREAM_H_